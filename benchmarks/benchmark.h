@@ -0,0 +1,76 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QElapsedTimer>
+#include <QJsonObject>
+#include <QString>
+#include <QVariant>
+
+/**
+ * @brief Collect the results of a benchmark and print them as JSON
+ *
+ * The elapsed time is measured from construction until the report is printed.
+ */
+class Benchmark
+{
+public:
+
+    /**
+     * @brief Begin a benchmark
+     * @param name identifier for the benchmark
+     */
+    explicit Benchmark(const QString &name);
+
+    /**
+     * @brief Retrieve the peak resident set size of the process
+     * @return size in bytes or 0 if unavailable
+     */
+    static qint64 peakMemory();
+
+    /**
+     * @brief Retrieve the CPU time used by the process
+     * @return user and system time in microseconds or 0 if unavailable
+     */
+    static qint64 cpuTime();
+
+    /**
+     * @brief Add a value to the report
+     */
+    void set(const QString &key, const QVariant &value);
+
+    /**
+     * @brief Print the report to stdout
+     */
+    void report();
+
+private:
+
+    QElapsedTimer mTimer;
+    QJsonObject mObject;
+};
+
+#endif // BENCHMARK_H
@@ -0,0 +1,125 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QEvent>
+#include <QStringList>
+#include <QVariant>
+
+#include <nitroshare/bundle.h>
+#include <nitroshare/item.h>
+
+#include "benchmark.h"
+#include "file.h"
+#include "filetable.h"
+
+// Number of files in each directory of the synthetic tree
+const int FilesPerDirectory = 1000;
+
+const int BlockSize = 65536;
+
+/**
+ * Measure the memory used by a bundle containing a large number of files
+ *
+ * Usage: bundlememory [items|table] [count]
+ *
+ * "items" adds a File object for each file (the way bundles were populated
+ * before item providers were introduced) and "table" adds the same files as
+ * FileTables. No files are accessed on disk.
+ */
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    QString mode = args.value(1, "table");
+    int count = args.value(2, "1000000").toInt();
+    if ((mode != "items" && mode != "table") || count <= 0) {
+        fprintf(stderr, "usage: bundlememory [items|table] [count]\n");
+        return 1;
+    }
+
+    Benchmark benchmark("bundlememory");
+    benchmark.set("mode", mode);
+    benchmark.set("count", count);
+    benchmark.set("baseline_rss_bytes", Benchmark::peakMemory());
+
+    Bundle bundle;
+    FileTable *table = nullptr;
+    int directory = 0;
+    QList<Item*> items;
+
+    for (int i = 0; i < count; ++i) {
+        QString absoluteDirectory = QString("/benchmark/directory%1").arg(i / FilesPerDirectory);
+        QString relativeDirectory = QString("directory%1").arg(i / FilesPerDirectory);
+        QString name = QString("file%1.dat").arg(i);
+
+        if (mode == "items") {
+            items.append(new File(nullptr, FileEntry{
+                absoluteDirectory + "/" + name,
+                relativeDirectory + "/" + name,
+                4096, false, false, 0, 0, 0
+            }, BlockSize, false, false, false));
+            if (items.count() == FilesPerDirectory) {
+                bundle.add(items);
+                items.clear();
+            }
+        } else {
+            if (!table) {
+                table = new FileTable;
+                table->setOptions(nullptr, BlockSize, false, false, false);
+                directory = table->addDirectory(absoluteDirectory, relativeDirectory);
+            }
+            table->addFile(directory, FileTable::encodeName(name), 4096, false, false, 0, 0, 0);
+            if (table->count() == FilesPerDirectory) {
+                bundle.add(table);
+                table = nullptr;
+            }
+        }
+    }
+    bundle.add(items);
+    if (table) {
+        bundle.add(table);
+    }
+
+    // Request every item once, releasing it afterwards, as a transfer would
+    qint64 totalSize = 0;
+    for (int row = 0; row < bundle.rowCount(); ++row) {
+        totalSize += bundle.index(row, 0).data(Qt::UserRole).value<Item*>()->size();
+        bundle.release(row);
+
+        // Items are deleted from the event loop
+        if (row % FilesPerDirectory == 0) {
+            QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        }
+    }
+
+    benchmark.set("rows", bundle.rowCount());
+    benchmark.set("total_size", totalSize);
+    benchmark.report();
+
+    return 0;
+}
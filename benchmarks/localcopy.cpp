@@ -0,0 +1,181 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QHostAddress>
+#include <QStringList>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include "benchmark.h"
+#include "filecloner.h"
+
+const int BlockSize = 65536;
+
+/**
+ * Send the contents of a file over a TCP connection
+ */
+class SendThread : public QThread
+{
+public:
+
+    SendThread(const QString &filename, quint16 port)
+        : mFilename(filename),
+          mPort(port)
+    {
+    }
+
+    virtual void run()
+    {
+        QFile file(mFilename);
+        QTcpSocket socket;
+        socket.connectToHost(QHostAddress::LocalHost, mPort);
+        if (!file.open(QIODevice::ReadOnly) || !socket.waitForConnected()) {
+            return;
+        }
+        while (!file.atEnd()) {
+            socket.write(file.read(BlockSize));
+            socket.waitForBytesWritten();
+        }
+        socket.disconnectFromHost();
+        if (socket.state() != QAbstractSocket::UnconnectedState) {
+            socket.waitForDisconnected();
+        }
+    }
+
+private:
+
+    QString mFilename;
+    quint16 mPort;
+};
+
+static bool createSource(const QString &filename, qint64 size)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QByteArray block(BlockSize, 'x');
+    for (qint64 written = 0; written < size; written += block.size()) {
+        if (file.write(block) != block.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool copyOverTcp(const QString &source, const QString &destination, qint64 size)
+{
+    QTcpServer server;
+    if (!server.listen(QHostAddress::LocalHost)) {
+        return false;
+    }
+
+    SendThread thread(source, server.serverPort());
+    thread.start();
+
+    QFile file(destination);
+    if (!server.waitForNewConnection(10000) || !file.open(QIODevice::WriteOnly)) {
+        thread.wait();
+        return false;
+    }
+    QTcpSocket *socket = server.nextPendingConnection();
+    qint64 received = 0;
+    while (received < size && socket->waitForReadyRead()) {
+        QByteArray data = socket->readAll();
+        file.write(data);
+        received += data.size();
+    }
+
+    thread.wait();
+    return received == size;
+}
+
+static bool copyWithClone(const QString &source, const QString &destination, qint64 size)
+{
+    QFile sourceFile(source);
+    QFile destinationFile(destination);
+    if (!sourceFile.open(QIODevice::ReadOnly) || !destinationFile.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QString error;
+    return FileCloner::clone(sourceFile.handle(), destinationFile.handle(), size, &error);
+}
+
+/**
+ * Compare copying a file directly with sending it over TCP loopback
+ *
+ * Usage: localcopy [size in MiB] [directory]
+ *
+ * The directory should be on the filesystem being tested, since whether
+ * files can be cloned depends on the filesystem.
+ */
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    qint64 size = args.value(1, "256").toLongLong() * 1024 * 1024;
+    QTemporaryDir dir(args.count() > 2 ? args.at(2) + "/localcopy-XXXXXX" : QString());
+    if (size <= 0 || !dir.isValid()) {
+        fprintf(stderr, "usage: localcopy [size in MiB] [directory]\n");
+        return 1;
+    }
+
+    QString source = dir.path() + "/source";
+    if (!createSource(source, size)) {
+        fprintf(stderr, "unable to create %s\n", qPrintable(source));
+        return 1;
+    }
+
+    Benchmark benchmark("localcopy");
+    benchmark.set("size", size);
+
+    QElapsedTimer timer;
+
+    timer.start();
+    bool tcp = copyOverTcp(source, dir.path() + "/tcp", size);
+    qint64 tcpElapsed = timer.nsecsElapsed();
+
+    timer.start();
+    bool clone = copyWithClone(source, dir.path() + "/clone", size);
+    qint64 cloneElapsed = timer.nsecsElapsed();
+
+    if (!tcp || !clone) {
+        fprintf(stderr, "copy failed\n");
+        return 1;
+    }
+
+    benchmark.set("tcp_gb_per_s", static_cast<double>(size) / tcpElapsed);
+    benchmark.set("clone_gb_per_s", static_cast<double>(size) / cloneElapsed);
+    benchmark.set("speedup", static_cast<double>(tcpElapsed) / cloneElapsed);
+    benchmark.report();
+
+    return 0;
+}
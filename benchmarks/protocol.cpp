@@ -0,0 +1,301 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTest>
+
+#include <nitroshare/handlerregistry.h>
+#include <nitroshare/jsonutil.h>
+#include <nitroshare/packet.h>
+#include <nitroshare/packetstream.h>
+#include <nitroshare/qtutil.h>
+#include <nitroshare/transfer.h>
+
+#include "file.h"
+#include "filetable.h"
+#include "mock/mockapplication.h"
+#include "mock/mockdevice.h"
+#include "mock/mockhandler.h"
+#include "mock/mockitem.h"
+#include "mock/mocktransport.h"
+
+// Number of items received for each iteration of the transfer benchmark
+const int ItemCount = 100;
+
+// Number of devices in the payload for the API benchmarks
+const int DeviceCount = 50;
+
+const int BlockSize = 65536;
+
+// Amount of data parsed for each iteration of the framing benchmark
+const int StreamSize = 1024 * 1024;
+
+/**
+ * Microbenchmarks for the code run for every packet and item in a transfer
+ *
+ * Run with "-o protocol.xml,xml" (or "-csv") and archive the output to track
+ * the results over time; the test registered with CTest does this already.
+ */
+class ProtocolBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void initTestCase();
+
+    void fileObjectToJson();
+    void fileProperties();
+    void packetLifetime_data();
+    void packetLifetime();
+    void packetFraming_data();
+    void packetFraming();
+    void transferReceive();
+    void apiEncode_data();
+    void apiEncode();
+    void apiDecode_data();
+    void apiDecode();
+
+private:
+
+    File *createFile();
+    static QJsonValue devicesPayload();
+
+    MockApplication mApplication;
+    MockHandler mHandler;
+};
+
+void ProtocolBenchmark::initTestCase()
+{
+    mApplication.application()->handlerRegistry()->add(&mHandler);
+}
+
+void ProtocolBenchmark::fileObjectToJson()
+{
+    File *file = createFile();
+    QBENCHMARK {
+        JsonUtil::objectToJson(file);
+    }
+    delete file;
+}
+
+void ProtocolBenchmark::fileProperties()
+{
+    File *file = createFile();
+    QBENCHMARK {
+        QtUtil::properties(file);
+    }
+    delete file;
+}
+
+void ProtocolBenchmark::packetLifetime_data()
+{
+    QTest::addColumn<int>("size");
+
+    QTest::newRow("empty") << 0;
+    QTest::newRow("block") << BlockSize;
+}
+
+void ProtocolBenchmark::packetLifetime()
+{
+    QFETCH(int, size);
+
+    // Packets are allocated on the heap for every block of every item
+    QByteArray data(size, 'x');
+    QBENCHMARK {
+        delete new Packet(Packet::Binary, data);
+    }
+}
+
+void ProtocolBenchmark::packetFraming_data()
+{
+    QTest::addColumn<int>("frameSize");
+    QTest::addColumn<int>("chunkSize");
+
+    // Chunks of 7 bytes split every header while the larger chunks
+    // correspond to a single segment and a full read from a socket
+    foreach (int frameSize, QList<int>{ 16, 1024, 65536 }) {
+        foreach (int chunkSize, QList<int>{ 7, 1500, 65536 }) {
+            QTest::newRow(qPrintable(QString("%1/%2").arg(frameSize).arg(chunkSize)))
+                << frameSize << chunkSize;
+        }
+    }
+}
+
+void ProtocolBenchmark::packetFraming()
+{
+    QFETCH(int, frameSize);
+    QFETCH(int, chunkSize);
+
+    // The transports all split the data they receive using PacketStream
+    int frameCount = qMax(StreamSize / frameSize, 1);
+    QByteArray frame;
+    PacketStream::encode(frame, Packet::Binary, QByteArray(frameSize, 'x'));
+    QByteArray stream = frame.repeated(frameCount);
+
+    QBENCHMARK {
+        PacketStream packetStream;
+        int received = 0;
+        char type;
+        QByteArray content;
+        for (int offset = 0; offset < stream.size(); offset += chunkSize) {
+            packetStream.addData(stream.mid(offset, chunkSize));
+            while (packetStream.readPacket(&type, &content)) {
+                ++received;
+            }
+        }
+        QCOMPARE(received, frameCount);
+    }
+}
+
+void ProtocolBenchmark::transferReceive()
+{
+    QByteArray transferHeader = QJsonDocument(QJsonObject{
+        { "name", MockDevice::Name },
+        { "size", QString::number(ItemCount * MockItem::Data.size()) },
+        { "count", QString::number(ItemCount) }
+    }).toJson();
+    QByteArray itemHeader = QJsonDocument(QJsonObject{
+        { "name", MockItem::Name },
+        { "type", MockItem::Type },
+        { "size", QString::number(MockItem::Data.size()) }
+    }).toJson();
+
+    // Run a complete transfer through each of the states
+    QBENCHMARK {
+        MockTransport *transport = new MockTransport;
+        Transfer transfer(mApplication.application(), transport);
+        transport->sendData(Packet::Json, transferHeader);
+        for (int i = 0; i < ItemCount; ++i) {
+            transport->sendData(Packet::Json, itemHeader);
+            transport->sendData(Packet::Binary, MockItem::Data);
+        }
+        while (!transfer.isFinished()) {
+            QCoreApplication::processEvents();
+        }
+        QCOMPARE(transfer.state(), Transfer::Succeeded);
+    }
+}
+
+void ProtocolBenchmark::apiEncode_data()
+{
+    QTest::addColumn<QJsonValue>("value");
+    QTest::addColumn<bool>("legacy");
+
+    QTest::newRow("legacy scalar") << QJsonValue(true) << true;
+    QTest::newRow("scalar") << QJsonValue(true) << false;
+    QTest::newRow("legacy devices") << devicesPayload() << true;
+    QTest::newRow("devices") << devicesPayload() << false;
+}
+
+void ProtocolBenchmark::apiEncode()
+{
+    QFETCH(QJsonValue, value);
+    QFETCH(bool, legacy);
+
+    // The legacy rows reproduce the conversion used before the compact
+    // format and direct handling of scalars were introduced
+    if (legacy) {
+        QBENCHMARK {
+            if (value.isArray()) {
+                QJsonDocument(value.toArray()).toJson().trimmed();
+            } else {
+                QByteArray json = QJsonDocument(QJsonArray{value}).toJson().trimmed();
+                json.mid(1, json.length() - 2).trimmed();
+            }
+        }
+    } else {
+        QBENCHMARK {
+            JsonUtil::jsonValueToByteArray(value, QJsonDocument::Compact);
+        }
+    }
+}
+
+void ProtocolBenchmark::apiDecode_data()
+{
+    QTest::addColumn<QByteArray>("data");
+    QTest::addColumn<bool>("legacy");
+
+    QByteArray devices = JsonUtil::jsonValueToByteArray(devicesPayload(), QJsonDocument::Compact);
+
+    QTest::newRow("legacy scalar") << QByteArray("true") << true;
+    QTest::newRow("scalar") << QByteArray("true") << false;
+    QTest::newRow("legacy devices") << devices << true;
+    QTest::newRow("devices") << devices << false;
+}
+
+void ProtocolBenchmark::apiDecode()
+{
+    QFETCH(QByteArray, data);
+    QFETCH(bool, legacy);
+
+    if (legacy) {
+        QBENCHMARK {
+            QJsonDocument::fromJson("[" + data + "]").array().at(0);
+        }
+    } else {
+        QBENCHMARK {
+            JsonUtil::byteArrayToJsonValue(data);
+        }
+    }
+}
+
+File *ProtocolBenchmark::createFile()
+{
+    FileEntry entry;
+    entry.absolutePath = "/tmp/benchmark/directory/file.txt";
+    entry.relativePath = "benchmark/directory/file.txt";
+    entry.size = 1234567890;
+    entry.readOnly = false;
+    entry.executable = false;
+    entry.created = 1500000000000;
+    entry.lastRead = 1500000000000;
+    entry.lastModified = 1500000000000;
+
+    // The file is never opened, so no engine is needed
+    return new File(nullptr, entry, BlockSize, false, false, false);
+}
+
+QJsonValue ProtocolBenchmark::devicesPayload()
+{
+    // Mimic the response to the "devices" action
+    QJsonArray devices;
+    for (int i = 0; i < DeviceCount; ++i) {
+        devices.append(QJsonObject{
+            { "uuid", QString("{00000000-0000-0000-0000-%1}").arg(i, 12, 10, QChar('0')) },
+            { "name", QString("Device %1").arg(i) },
+            { "transportName", "lan" },
+            { "deviceEnumeratorName", "mdns" },
+            { "addresses", QJsonArray{ QString("192.168.1.%1").arg(i) } },
+            { "port", 40818 }
+        });
+    }
+    return devices;
+}
+
+QTEST_MAIN(ProtocolBenchmark)
+#include "protocol.moc"
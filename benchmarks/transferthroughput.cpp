@@ -0,0 +1,472 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QHostAddress>
+#include <QSettings>
+#include <QStringList>
+#include <QTcpServer>
+#include <QTemporaryDir>
+#include <QUuid>
+#include <QVariantMap>
+
+#include <nitroshare/action.h>
+#include <nitroshare/actionregistry.h>
+#include <nitroshare/application.h>
+#include <nitroshare/device.h>
+#include <nitroshare/deviceenumerator.h>
+#include <nitroshare/devicemodel.h>
+#include <nitroshare/handlerregistry.h>
+#include <nitroshare/transfer.h>
+#include <nitroshare/transfermodel.h>
+#include <nitroshare/transportserverregistry.h>
+
+#include "benchmark.h"
+#include "directorycache.h"
+#include "directoryhandler.h"
+#include "filehandler.h"
+#include "ioengine.h"
+#include "lantransportserver.h"
+#include "senditemsaction.h"
+
+// Number of files in each directory of the synthetic trees
+const int FilesPerDirectory = 1000;
+
+// Size of each file in the small files scenario
+const qint64 SmallFileSize = 4096;
+
+// Bounds for the size of files in the mixed scenario
+const qint64 MixedMinimumSize = 512;
+const qint64 MixedMaximumSize = 8 * 1024 * 1024;
+
+// Number of transfers run at the same time in the concurrent scenario
+const int ConcurrentTransfers = 4;
+
+const int BlockSize = 65536;
+
+const QString EnumeratorName = "benchmark";
+
+/**
+ * Device for the receiving peer, reachable over loopback
+ */
+class BenchmarkDevice : public Device
+{
+public:
+
+    BenchmarkDevice(const QString &uuid, quint16 port)
+        : mUuid(uuid)
+    {
+        setProperty("addresses", QStringList{ "127.0.0.1" });
+        setProperty("port", port);
+    }
+
+    virtual QString uuid() const { return mUuid; }
+    virtual QString name() const { return "Receiver"; }
+    virtual QString transportName() const { return "lan"; }
+
+private:
+
+    QString mUuid;
+};
+
+/**
+ * Enumerator used for announcing the receiving peer to the sender
+ */
+class BenchmarkEnumerator : public DeviceEnumerator
+{
+public:
+
+    virtual QString name() const { return EnumeratorName; }
+};
+
+/**
+ * Application with the components of the lan and filesystem plugins
+ *
+ * The plugin modules cannot be loaded more than once in the same process, so
+ * the classes they register are created here directly instead.
+ */
+class Peer
+{
+public:
+
+    Peer(const QString &name, const QString &directory, quint16 port, const QStringList &tls)
+        : mSettings(mSettingsDirectory.path() + "/settings.ini", QSettings::IniFormat)
+    {
+        mSettings.setValue(Application::DeviceUuidSettingName, QUuid::createUuid().toString());
+        mSettings.setValue(Application::DeviceNameSettingName, name);
+        mSettings.setValue("TransferPort", port);
+        mSettings.setValue("TransferDirectory", directory);
+
+        if (tls.count() == 3) {
+            mSettings.setValue("TlsEnabled", true);
+            mSettings.setValue("TlsCaCertificate", tls.at(0));
+            mSettings.setValue("TlsCertificate", tls.at(1));
+            mSettings.setValue("TlsPrivateKey", tls.at(2));
+        }
+
+        mApplication = new Application(&mSettings);
+
+        mEngine = IoEngine::create();
+        mDirectoryCache = new DirectoryCache;
+        mDirectoryHandler = new DirectoryHandler(mApplication, mDirectoryCache);
+        mFileHandler = new FileHandler(mApplication, mEngine, mDirectoryCache);
+        mAction = new SendItemsAction(mApplication, mEngine);
+        mServer = new LanTransportServer(mApplication);
+
+        mApplication->handlerRegistry()->add(mDirectoryHandler);
+        mApplication->handlerRegistry()->add(mFileHandler);
+        mApplication->actionRegistry()->add(mAction);
+        mApplication->transportServerRegistry()->add(mServer);
+    }
+
+    ~Peer()
+    {
+        mApplication->transferModel()->dismissAll();
+
+        mApplication->handlerRegistry()->remove(mDirectoryHandler);
+        mApplication->handlerRegistry()->remove(mFileHandler);
+        mApplication->actionRegistry()->remove(mAction);
+        mApplication->transportServerRegistry()->remove(mServer);
+
+        delete mServer;
+        delete mDirectoryHandler;
+        delete mFileHandler;
+        delete mAction;
+        delete mDirectoryCache;
+        delete mEngine;
+        delete mApplication;
+    }
+
+    Application *application() const
+    {
+        return mApplication;
+    }
+
+    QString uuid() const
+    {
+        return mSettings.value(Application::DeviceUuidSettingName).toString();
+    }
+
+private:
+
+    QTemporaryDir mSettingsDirectory;
+    QSettings mSettings;
+
+    Application *mApplication;
+    IoEngine *mEngine;
+    DirectoryCache *mDirectoryCache;
+    DirectoryHandler *mDirectoryHandler;
+    FileHandler *mFileHandler;
+    SendItemsAction *mAction;
+    LanTransportServer *mServer;
+};
+
+/**
+ * Items for each transfer in a scenario and the amount of data they contain
+ */
+struct Scenario
+{
+    QList<QStringList> transfers;
+    qint64 bytes;
+    int files;
+};
+
+/**
+ * Find a port that is not in use on the loopback interface
+ */
+static quint16 findPort()
+{
+    QTcpServer server;
+    if (!server.listen(QHostAddress::LocalHost)) {
+        return 0;
+    }
+    return server.serverPort();
+}
+
+static bool createFile(const QString &filename, qint64 size)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        fprintf(stderr, "unable to create %s\n", qPrintable(filename));
+        return false;
+    }
+    QByteArray block(BlockSize, 'x');
+    for (qint64 written = 0; written < size; written += block.size()) {
+        int length = static_cast<int>(qMin<qint64>(block.size(), size - written));
+        if (file.write(block.constData(), length) != length) {
+            fprintf(stderr, "unable to write %s\n", qPrintable(filename));
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Create the files for the specified scenario below the root directory
+ */
+static bool createScenario(const QString &name, const QString &root, qint64 size, int count, Scenario *scenario)
+{
+    scenario->bytes = 0;
+    scenario->files = 0;
+
+    if (name == "large") {
+        QString filename = root + "/large";
+        if (!createFile(filename, size)) {
+            return false;
+        }
+        scenario->transfers.append(QStringList{ filename });
+        scenario->bytes = size;
+        scenario->files = 1;
+        return true;
+    }
+
+    if (name == "concurrent") {
+        for (int i = 0; i < ConcurrentTransfers; ++i) {
+            QString filename = QString("%1/concurrent%2").arg(root).arg(i);
+            if (!createFile(filename, size / ConcurrentTransfers)) {
+                return false;
+            }
+            scenario->transfers.append(QStringList{ filename });
+            scenario->bytes += size / ConcurrentTransfers;
+            ++scenario->files;
+        }
+        return true;
+    }
+
+    if (name == "small" || name == "mixed") {
+        QString directory = root + "/" + name;
+
+        // File sizes in the mixed tree are distributed evenly on a log scale,
+        // using a fixed seed so that each run sends the same tree
+        std::mt19937 generator;
+        std::uniform_real_distribution<double> distribution(
+            std::log(static_cast<double>(MixedMinimumSize)),
+            std::log(static_cast<double>(MixedMaximumSize))
+        );
+
+        // The small files are spread evenly over directories while the mixed
+        // tree is nested several levels deep
+        int mixedCount = qMax(count / 100, 1);
+        for (int i = 0; i < (name == "small" ? count : mixedCount); ++i) {
+            QString path;
+            qint64 fileSize;
+            if (name == "small") {
+                path = QString("%1/%2").arg(directory).arg(i / FilesPerDirectory);
+                fileSize = SmallFileSize;
+            } else {
+                path = QString("%1/%2/%3/%4").arg(directory).arg(i % 4).arg(i % 7).arg(i % 10);
+                fileSize = static_cast<qint64>(std::exp(distribution(generator)));
+            }
+            if (!QDir().mkpath(path) || !createFile(QString("%1/%2").arg(path).arg(i), fileSize)) {
+                return false;
+            }
+            scenario->bytes += fileSize;
+            ++scenario->files;
+        }
+        scenario->transfers.append(QStringList{ directory });
+        return true;
+    }
+
+    fprintf(stderr, "unknown scenario \"%s\"\n", qPrintable(name));
+    return false;
+}
+
+/**
+ * Check whether the expected number of transfers finished, setting failed if
+ * any of them did not succeed
+ */
+static bool transfersFinished(TransferModel *model, int count, bool *failed)
+{
+    if (model->rowCount() < count) {
+        return false;
+    }
+    bool finished = true;
+    for (int i = 0; i < model->rowCount(); ++i) {
+        Transfer *transfer = model->data(model->index(i, 0), Qt::UserRole).value<Transfer*>();
+        if (transfer->state() == Transfer::Failed) {
+            fprintf(stderr, "%s\n", qPrintable(transfer->error()));
+            *failed = true;
+        }
+        if (!transfer->isFinished()) {
+            finished = false;
+        }
+    }
+    return finished;
+}
+
+/**
+ * Send the items in a scenario and wait for both peers to finish, returning
+ * the results or an empty map on error
+ */
+static QVariantMap runScenario(Peer *sender, Peer *receiver, const Scenario &scenario)
+{
+    Action *action = sender->application()->actionRegistry()->find("senditems");
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 cpuTime = Benchmark::cpuTime();
+
+    foreach (const QStringList &items, scenario.transfers) {
+        QVariantMap params = {
+            { "device", receiver->uuid() },
+            { "enumerator", EnumeratorName },
+            { "items", items }
+        };
+        if (!action->invoke(params).toBool()) {
+            fprintf(stderr, "unable to start transfer\n");
+            return QVariantMap();
+        }
+    }
+
+    bool failed = false;
+    int count = scenario.transfers.count();
+    while (!failed && !(transfersFinished(sender->application()->transferModel(), count, &failed) &&
+            transfersFinished(receiver->application()->transferModel(), count, &failed))) {
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+
+    qint64 elapsed = timer.nsecsElapsed();
+    cpuTime = Benchmark::cpuTime() - cpuTime;
+
+    sender->application()->transferModel()->dismissAll();
+    receiver->application()->transferModel()->dismissAll();
+
+    if (failed) {
+        return QVariantMap();
+    }
+
+    return QVariantMap{
+        { "bytes", scenario.bytes },
+        { "files", scenario.files },
+        { "seconds", elapsed / 1e9 },
+        { "gb_per_s", static_cast<double>(scenario.bytes) / elapsed },
+        { "files_per_s", scenario.files / (elapsed / 1e9) },
+        { "cpu_s", cpuTime / 1e6 }
+    };
+}
+
+/**
+ * Measure the throughput of transfers between two applications over loopback
+ * using the real transport and file handlers
+ *
+ * Usage: transferthroughput [size in MiB] [small file count] [scenarios] [ca cert key]
+ *
+ * The scenarios are a comma-separated list of "large" (a single file of the
+ * specified size), "small" (many 4 KiB files), "mixed" (a nested tree with
+ * file sizes between 512 bytes and 8 MiB, one for every hundred small files)
+ * and "concurrent" (four transfers of a quarter of the size at once).
+ *
+ * Each scenario is run without TLS and then, if the paths to a CA certificate,
+ * certificate and private key are provided, with TLS. The certificate is used
+ * by both peers and must be valid for 127.0.0.1. Run the benchmark with a
+ * temporary directory on the filesystem being tested.
+ */
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    qint64 size = args.value(1, "1024").toLongLong() * 1024 * 1024;
+    int count = args.value(2, "100000").toInt();
+    QStringList names = args.value(3, "large,small,mixed,concurrent").split(',');
+    QStringList tls = args.mid(4, 3);
+    if (size <= 0 || count <= 0 || (tls.count() && tls.count() != 3)) {
+        fprintf(stderr, "usage: transferthroughput [size in MiB] [small file count] [scenarios] [ca cert key]\n");
+        return 1;
+    }
+
+#ifndef ENABLE_TLS
+    if (tls.count()) {
+        fprintf(stderr, "TLS support is not enabled\n");
+        return 1;
+    }
+#endif
+
+    QTemporaryDir dir;
+    QString source = dir.path() + "/source";
+    QString destination = dir.path() + "/destination";
+    if (!dir.isValid() || !QDir().mkpath(source) || !QDir().mkpath(destination)) {
+        fprintf(stderr, "unable to create temporary directory\n");
+        return 1;
+    }
+
+    // Create all of the files up front so that it is not part of the results
+    QList<Scenario> scenarios;
+    foreach (const QString &name, names) {
+        Scenario scenario;
+        if (!createScenario(name, source, size, count, &scenario)) {
+            return 1;
+        }
+        scenarios.append(scenario);
+    }
+
+    Benchmark benchmark("transferthroughput");
+    benchmark.set("size", size);
+    benchmark.set("small_files", count);
+
+    QList<QStringList> modes = { QStringList() };
+    if (tls.count()) {
+        modes.append(tls);
+    }
+
+    foreach (const QStringList &mode, modes) {
+        quint16 port = findPort();
+        Peer sender("Sender", destination, findPort(), mode);
+        Peer receiver("Receiver", destination, port, mode);
+
+        // Announce the receiver to the sender
+        BenchmarkEnumerator enumerator;
+        BenchmarkDevice device(receiver.uuid(), port);
+        sender.application()->deviceModel()->addDeviceEnumerator(&enumerator);
+        emit enumerator.deviceAdded(&device);
+
+        for (int i = 0; i < scenarios.count(); ++i) {
+            QVariantMap results = runScenario(&sender, &receiver, scenarios.at(i));
+            if (results.isEmpty()) {
+                return 1;
+            }
+            benchmark.set(mode.count() ? names.at(i) + "_tls" : names.at(i), results);
+
+            // Remove the received files before the next scenario
+            if (!QDir(destination).removeRecursively() || !QDir().mkpath(destination)) {
+                fprintf(stderr, "unable to remove received files\n");
+                return 1;
+            }
+        }
+
+        sender.application()->deviceModel()->removeDeviceEnumerator(&enumerator);
+    }
+
+    benchmark.report();
+
+    return 0;
+}
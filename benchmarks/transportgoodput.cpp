@@ -0,0 +1,313 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QtGlobal>
+
+#ifdef Q_OS_LINUX
+#  include <net/if.h>
+#  include <sched.h>
+#  include <sys/ioctl.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstring>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QHostAddress>
+#include <QProcess>
+#include <QStringList>
+
+#include <nitroshare/packet.h>
+#include <nitroshare/transport.h>
+
+#include "benchmark.h"
+#include "lantransport.h"
+#include "server.h"
+#include "udpserver.h"
+#include "udptransport.h"
+
+// Size of each packet sent
+const int BlockSize = 65536;
+
+/**
+ * Process events until the sender is connected and the receiver was created
+ */
+static bool waitForConnection(Transport *sender, Transport **receiver)
+{
+    bool connected = false;
+    bool failed = false;
+
+    QObject context;
+    QObject::connect(sender, &Transport::connected, &context, [&connected]() {
+        connected = true;
+    });
+    QObject::connect(sender, &Transport::error, &context, [&failed](const QString &message) {
+        fprintf(stderr, "%s\n", qPrintable(message));
+        failed = true;
+    });
+
+    while (!failed && !(connected && *receiver)) {
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+    return !failed;
+}
+
+/**
+ * Send the specified amount of data as quickly as the transport allows,
+ * returning the goodput in megabits per second or a negative value on error
+ */
+static double measure(Transport *sender, Transport *receiver, qint64 total)
+{
+    QByteArray block(BlockSize, 'x');
+    qint64 sent = 0;
+    qint64 received = 0;
+
+    QElapsedTimer timer;
+    QEventLoop loop;
+
+    auto send = [&]() {
+        if (sent < total) {
+            int size = static_cast<int>(qMin<qint64>(BlockSize, total - sent));
+            Packet packet(Packet::Binary, size == BlockSize ? block : block.left(size));
+            sent += size;
+            sender->sendPacket(&packet);
+        }
+    };
+
+    QObject context;
+    QObject::connect(sender, &Transport::packetSent, &context, send);
+    QObject::connect(receiver, &Transport::packetReceived, &context, [&](Packet *packet) {
+        received += packet->content().size();
+        if (received >= total) {
+            loop.quit();
+        }
+    });
+    QObject::connect(sender, &Transport::error, &loop, [&loop]() { loop.exit(1); });
+    QObject::connect(receiver, &Transport::error, &loop, [&loop]() { loop.exit(1); });
+
+    timer.start();
+    send();
+    if (loop.exec()) {
+        return -1;
+    }
+    return total * 8 / (timer.nsecsElapsed() / 1000.0);
+}
+
+#ifdef Q_OS_LINUX
+
+/**
+ * Write the entire contents of a file in /proc
+ */
+static bool writeProc(const QString &filename, const QByteArray &data)
+{
+    QFile file(filename);
+    return file.open(QIODevice::WriteOnly) && file.write(data) == data.size();
+}
+
+#endif
+
+/**
+ * Move into private user and network namespaces so that netem only ever
+ * changes the loopback interface of this process and never the host's
+ *
+ * This must happen before any threads are created.
+ */
+static bool isolate()
+{
+#ifdef Q_OS_LINUX
+    uid_t uid = getuid();
+    gid_t gid = getgid();
+    if (unshare(CLONE_NEWUSER | CLONE_NEWNET)) {
+        return false;
+    }
+
+    // Mapping the user to root in the namespace lets tc keep the capabilities
+    // needed to configure the interface when it is executed
+    if (!writeProc("/proc/self/setgroups", "deny") ||
+            !writeProc("/proc/self/uid_map", QString("0 %1 1").arg(uid).toUtf8()) ||
+            !writeProc("/proc/self/gid_map", QString("0 %1 1").arg(gid).toUtf8())) {
+        return false;
+    }
+
+    // The loopback interface starts out down in a new network namespace
+    int sock = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (sock == -1) {
+        return false;
+    }
+    struct ifreq request = {};
+    strncpy(request.ifr_name, "lo", IFNAMSIZ - 1);
+    request.ifr_flags = IFF_UP | IFF_LOOPBACK | IFF_RUNNING;
+    bool up = ioctl(sock, SIOCSIFFLAGS, &request) == 0;
+    close(sock);
+    return up;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Apply loss and delay to every packet on the (private) loopback interface
+ * using netem; no loss or delay removes the impairment
+ */
+static bool impair(double loss, int delay)
+{
+    if (!loss && !delay) {
+        QProcess::execute("tc", { "qdisc", "del", "dev", "lo", "root" });
+        return true;
+    }
+
+    if (QProcess::execute("tc", {
+        "qdisc", "replace", "dev", "lo", "root", "netem",
+        "loss", QString("%1%").arg(loss),
+        "delay", QString("%1ms").arg(delay)
+    })) {
+        fprintf(stderr, "unable to configure netem on the loopback interface\n");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Measure the LAN transport over TCP loopback
+ */
+static double measureLan(qint64 size)
+{
+    Server server;
+    if (!server.listen(QHostAddress::LocalHost)) {
+        fprintf(stderr, "%s\n", qPrintable(server.errorString()));
+        return -1;
+    }
+
+    Transport *receiver = nullptr;
+    QObject::connect(&server, &Server::newSocketDescriptor, [&receiver](qintptr socketDescriptor) {
+        receiver = new LanTransport(
+            socketDescriptor
+#ifdef ENABLE_TLS
+          , QSslConfiguration()
+#endif
+        );
+    });
+
+    LanTransport sender(
+        QHostAddress::LocalHost
+      , server.serverPort()
+#ifdef ENABLE_TLS
+      , QSslConfiguration()
+#endif
+    );
+
+    if (!waitForConnection(&sender, &receiver)) {
+        return -1;
+    }
+    double goodput = measure(&sender, receiver, size);
+    delete receiver;
+    return goodput;
+}
+
+/**
+ * Measure the UDP transport over loopback
+ */
+static double measureUdp(qint64 size)
+{
+    UdpServer server;
+    if (!server.listen(QHostAddress::LocalHost)) {
+        fprintf(stderr, "%s\n", qPrintable(server.errorString()));
+        return -1;
+    }
+
+    Transport *receiver = nullptr;
+    QObject::connect(&server, &UdpServer::transportReceived, [&receiver](UdpTransport *transport) {
+        receiver = transport;
+    });
+
+    UdpTransport sender(QHostAddress::LocalHost, server.serverPort());
+
+    if (!waitForConnection(&sender, &receiver)) {
+        return -1;
+    }
+    double goodput = measure(&sender, receiver, size);
+    delete receiver;
+    return goodput;
+}
+
+/**
+ * Compare the goodput of the UDP transport with the LAN transport (TCP) when
+ * packets are lost or delayed
+ *
+ * Both transports run over the loopback interface of a private network
+ * namespace, which netem configures to drop the specified percentage of
+ * packets and delay the rest, so that exactly the same impairment applies to
+ * each of them. Loss and delay require Linux with unprivileged user
+ * namespaces; the host's loopback interface is never changed.
+ *
+ * Usage: transportgoodput [size in MiB] [loss percentages] [delay in ms]
+ */
+int main(int argc, char **argv)
+{
+    bool isolated = isolate();
+
+    QCoreApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    qint64 size = args.value(1, "64").toLongLong() * 1024 * 1024;
+    QStringList losses = args.value(2, "0").split(',');
+    int delay = args.value(3, "0").toInt();
+    if (size <= 0 || delay < 0) {
+        fprintf(stderr, "usage: transportgoodput [size in MiB] [loss percentages] [delay in ms]\n");
+        return 1;
+    }
+
+    Benchmark benchmark("transportgoodput");
+    benchmark.set("size", size);
+    benchmark.set("delay_ms", delay);
+
+    foreach (const QString &loss, losses) {
+        bool impaired = loss.toDouble() || delay;
+        if (impaired && !isolated) {
+            fprintf(stderr, "unable to create a private network namespace for netem\n");
+            return 1;
+        }
+        if (isolated && !impair(loss.toDouble(), delay)) {
+            return 1;
+        }
+
+        double lan = measureLan(size);
+        double udp = lan < 0 ? -1 : measureUdp(size);
+        if (udp < 0) {
+            return 1;
+        }
+
+        benchmark.set(QString("lan_loss_%1_mbps").arg(loss), lan);
+        benchmark.set(QString("udp_loss_%1_mbps").arg(loss), udp);
+    }
+
+    benchmark.report();
+
+    return 0;
+}
@@ -0,0 +1,249 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QHostAddress>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QVector>
+
+#include <nitroshare/packet.h>
+#include <nitroshare/transport.h>
+
+#include "benchmark.h"
+#include "lantransport.h"
+#include "localserver.h"
+#include "localtransport.h"
+#include "server.h"
+#include "sharedmemorytransport.h"
+
+// Round trips that are not measured while the connection warms up
+const int Warmup = 100;
+
+/**
+ * Process events until the sender is connected and the receiver was created
+ */
+static bool waitForConnection(Transport *sender, Transport **receiver)
+{
+    bool connected = false;
+    bool failed = false;
+
+    QObject context;
+    QObject::connect(sender, &Transport::connected, &context, [&connected]() {
+        connected = true;
+    });
+    QObject::connect(sender, &Transport::error, &context, [&failed](const QString &message) {
+        fprintf(stderr, "%s\n", qPrintable(message));
+        failed = true;
+    });
+
+    while (!failed && !(connected && *receiver)) {
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+    return !failed;
+}
+
+/**
+ * Send a single small item and wait for the receiver to acknowledge it,
+ * returning the time taken for each round trip in nanoseconds
+ */
+static QVector<qint64> measure(Transport *sender, Transport *receiver, int iterations, int size)
+{
+    QByteArray header = QJsonDocument(QJsonObject{
+        { "name", "item" },
+        { "type", "file" },
+        { "size", QString::number(size) }
+    }).toJson(QJsonDocument::Compact);
+    QByteArray content(size, 'x');
+
+    QVector<qint64> samples;
+    samples.reserve(iterations);
+
+    QElapsedTimer timer;
+    QEventLoop loop;
+    int completed = 0;
+
+    auto send = [&]() {
+        timer.start();
+        Packet headerPacket(Packet::Json, header);
+        sender->sendPacket(&headerPacket);
+        Packet contentPacket(Packet::Binary, content);
+        sender->sendPacket(&contentPacket);
+    };
+
+    QObject context;
+    QObject::connect(receiver, &Transport::packetReceived, &context, [receiver](Packet *packet) {
+        if (packet->type() == Packet::Binary) {
+            Packet success(Packet::Success);
+            receiver->sendPacket(&success);
+        }
+    });
+    QObject::connect(sender, &Transport::packetReceived, &context, [&](Packet *packet) {
+        if (packet->type() != Packet::Success) {
+            return;
+        }
+        if (completed++ >= Warmup) {
+            samples.append(timer.nsecsElapsed());
+        }
+        if (completed < Warmup + iterations) {
+            send();
+        } else {
+            loop.quit();
+        }
+    });
+    QObject::connect(sender, &Transport::error, &loop, [&loop]() { loop.exit(1); });
+    QObject::connect(receiver, &Transport::error, &loop, [&loop]() { loop.exit(1); });
+
+    send();
+    if (loop.exec()) {
+        samples.clear();
+    }
+    return samples;
+}
+
+/**
+ * Add the 50th and 99th percentiles (in microseconds) to the report
+ */
+static void report(Benchmark *benchmark, const QString &name, QVector<qint64> samples)
+{
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&samples](double p) {
+        int index = qMax(0, static_cast<int>(std::ceil(p * samples.count())) - 1);
+        return samples.at(index) / 1000.0;
+    };
+    benchmark->set(name + "_p50_us", percentile(0.50));
+    benchmark->set(name + "_p99_us", percentile(0.99));
+}
+
+/**
+ * Compare the latency of the shared memory transport with the LAN transport
+ * over loopback (and the Unix domain socket transport for reference)
+ *
+ * Usage: transportlatency [iterations] [item size in bytes]
+ */
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QStringList args = app.arguments();
+    int iterations = args.value(1, "10000").toInt();
+    int size = args.value(2, "1024").toInt();
+    QTemporaryDir dir;
+    if (iterations <= 0 || size <= 0 || !dir.isValid()) {
+        fprintf(stderr, "usage: transportlatency [iterations] [item size in bytes]\n");
+        return 1;
+    }
+
+    Benchmark benchmark("transportlatency");
+    benchmark.set("iterations", iterations);
+    benchmark.set("item_size", size);
+
+    // LAN transport over TCP loopback
+    {
+        Server server;
+        if (!server.listen(QHostAddress::LocalHost)) {
+            fprintf(stderr, "%s\n", qPrintable(server.errorString()));
+            return 1;
+        }
+
+        Transport *receiver = nullptr;
+        QObject::connect(&server, &Server::newSocketDescriptor, [&receiver](qintptr socketDescriptor) {
+            receiver = new LanTransport(
+                socketDescriptor
+#ifdef ENABLE_TLS
+              , QSslConfiguration()
+#endif
+            );
+        });
+
+        LanTransport sender(
+            QHostAddress::LocalHost
+          , server.serverPort()
+#ifdef ENABLE_TLS
+          , QSslConfiguration()
+#endif
+        );
+
+        if (!waitForConnection(&sender, &receiver)) {
+            return 1;
+        }
+        QVector<qint64> samples = measure(&sender, receiver, iterations, size);
+        delete receiver;
+        if (samples.isEmpty()) {
+            return 1;
+        }
+        report(&benchmark, "lan", samples);
+    }
+
+    // Unix domain socket and shared memory transports
+    for (int i = 0; i < 2; ++i) {
+        bool sharedMemory = i == 1;
+        QString path = dir.path() + (sharedMemory ? "/transport.shm" : "/transport.sock");
+
+        LocalServer server;
+        if (!server.listen(path)) {
+            fprintf(stderr, "%s\n", qPrintable(server.errorString()));
+            return 1;
+        }
+
+        Transport *receiver = nullptr;
+        QObject::connect(&server, &LocalServer::newSocketDescriptor, [&receiver, sharedMemory](int socketDescriptor) {
+            if (sharedMemory) {
+                receiver = new SharedMemoryTransport(socketDescriptor);
+            } else {
+                receiver = new LocalTransport(socketDescriptor);
+            }
+        });
+
+        Transport *sender;
+        if (sharedMemory) {
+            sender = new SharedMemoryTransport(path);
+        } else {
+            sender = new LocalTransport(path);
+        }
+
+        if (!waitForConnection(sender, &receiver)) {
+            return 1;
+        }
+        QVector<qint64> samples = measure(sender, receiver, iterations, size);
+        delete sender;
+        delete receiver;
+        if (samples.isEmpty()) {
+            return 1;
+        }
+        report(&benchmark, sharedMemory ? "shared_memory" : "local", samples);
+    }
+
+    benchmark.report();
+
+    return 0;
+}
@@ -26,15 +26,30 @@
 #define LIBNITROSHARE_BUNDLE_H
 
 #include <QAbstractListModel>
+#include <QList>
 
 #include <nitroshare/config.h>
 
 class Item;
+class ItemProvider;
 
 class NITROSHARE_EXPORT BundlePrivate;
 
 /**
  * @brief Bundle for transfer
+ *
+ * Items may continue to be added to the bundle after it has been passed to a
+ * transfer. In that case, the bundle should be marked as incomplete until all
+ * items have been added and the transfer will wait for it before sending.
+ *
+ * Streaming bundles do not require the number of items or their total size to
+ * be known in advance. Transfers begin sending items from a streaming bundle
+ * immediately and remove them once sent, allowing an unbounded number of
+ * items to be sent with constant memory usage.
+ *
+ * Bundles with a very large number of items should use an ItemProvider. Only
+ * the provider's compact metadata is kept in memory and items are created
+ * when they are first requested.
  */
 class NITROSHARE_EXPORT Bundle : public QAbstractListModel
 {
@@ -57,16 +72,84 @@ public:
      */
     void add(Item *item);
 
+    /**
+     * @brief Add a list of items to the bundle
+     * @param items list of items to add
+     *
+     * The bundle assumes ownership of the items.
+     */
+    void add(const QList<Item*> &items);
+
+    /**
+     * @brief Add items created on demand by a provider
+     * @param provider source of the items
+     *
+     * The bundle assumes ownership of the provider. The number of items in
+     * the provider must not change once it was added.
+     */
+    void add(ItemProvider *provider);
+
+    /**
+     * @brief Remove and delete the first item in the bundle
+     */
+    void removeFirst();
+
+    /**
+     * @brief Indicate that an item is no longer in use
+     * @param row index of the item
+     *
+     * If the item was created by a provider, it is deleted and will be
+     * created again if requested. Items added directly are not affected.
+     */
+    void release(int row);
+
     /**
      * @brief Total size of bundle contents
      * @return size in bytes
+     *
+     * For streaming bundles, this includes items that were already removed.
      */
     qint64 totalSize() const;
 
+    /**
+     * @brief Determine if all items have been added to the bundle
+     * @return true if the bundle is complete
+     *
+     * Bundles are complete when created.
+     */
+    bool isComplete() const;
+
+    /**
+     * @brief Indicate whether all items have been added to the bundle
+     * @param complete true if no more items will be added
+     */
+    void setComplete(bool complete);
+
+    /**
+     * @brief Determine if the bundle is streamed
+     * @return true if the bundle is streamed
+     */
+    bool isStreaming() const;
+
+    /**
+     * @brief Set whether the bundle is streamed
+     * @param streaming true to stream the bundle
+     *
+     * This must be set before the bundle is passed to a transfer.
+     */
+    void setStreaming(bool streaming);
+
     // Reimplemented virtual methods
     virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
     virtual QVariant data(const QModelIndex &index, int role) const;
 
+Q_SIGNALS:
+
+    /**
+     * @brief Indicate that all items have been added to the bundle
+     */
+    void completed();
+
 private:
 
     BundlePrivate *const d;
@@ -69,6 +69,9 @@ public:
     /**
      * @brief Retrieve the size of the item
      * @return item size
+     *
+     * This is the number of bytes that will be read from the item. It may
+     * change when the item is opened for reading.
      */
     virtual qint64 size() const;
 
@@ -79,6 +82,27 @@ public:
      */
     virtual bool open(OpenMode openMode);
 
+    /**
+     * @brief Prepare the item for reading
+     *
+     * This method is invoked for items that will be sent shortly so that they
+     * can begin loading data in the background. It may be called more than
+     * once and is always followed by open() before any data is read. Data
+     * buffered by this method should be kept small. The default
+     * implementation does nothing.
+     */
+    virtual void prefetch();
+
+    /**
+     * @brief Determine if data can be read from the item without blocking
+     * @return true if read() will return data immediately
+     *
+     * Items that perform I/O asynchronously should return false while no data
+     * is available and emit readyRead() once it is. The default
+     * implementation always returns true.
+     */
+    virtual bool isReadyRead() const;
+
     /**
      * @brief Read data from the item
      * @return array of bytes
@@ -87,14 +111,30 @@ public:
      * avoid excess memory usage. Instead, return successive portions of the
      * item with each call.
      *
+     * This method is only invoked when isReadyRead() returns true.
+     *
      * Use the error() signal to indicate an error.
      */
     virtual QByteArray read();
 
+    /**
+     * @brief Determine if the item can accept more data without queueing it
+     * @return true if write() should be invoked with more data
+     *
+     * Items that perform I/O asynchronously should return false while too
+     * much data is queued and emit readyWrite() once more can be accepted.
+     * Data passed to write() in the meantime must still be accepted. The
+     * default implementation always returns true.
+     */
+    virtual bool isReadyWrite() const;
+
     /**
      * @brief Write data to the item
      * @param data information to write
      *
+     * Items may queue the data and complete the write asynchronously as long
+     * as all data is written by the time the item is closed.
+     *
      * Use the error() signal to indicate an error.
      */
     virtual void write(const QByteArray &data);
@@ -102,12 +142,48 @@ public:
     /**
      * @brief Close the item
      *
+     * Items with writes still in progress may finish closing in the
+     * background, in which case isClosed() returns false until closed() is
+     * emitted.
+     *
      * Use the error() signal to indicate an error.
      */
     virtual void close();
 
+    /**
+     * @brief Determine if the item has finished closing
+     * @return true if nothing remains to be done after close()
+     *
+     * The default implementation always returns true.
+     */
+    virtual bool isClosed() const;
+
 Q_SIGNALS:
 
+    /**
+     * @brief Indicate that data is available for reading
+     *
+     * This signal is only required for items that return false from
+     * isReadyRead().
+     */
+    void readyRead();
+
+    /**
+     * @brief Indicate that the item can accept more data
+     *
+     * This signal is only required for items that return false from
+     * isReadyWrite().
+     */
+    void readyWrite();
+
+    /**
+     * @brief Indicate that the item finished closing in the background
+     *
+     * This signal is only required for items that return false from
+     * isClosed().
+     */
+    void closed();
+
     /**
      * @brief Indicate an error has occurred
      * @param message description of the error
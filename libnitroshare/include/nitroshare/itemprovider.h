@@ -0,0 +1,67 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef LIBNITROSHARE_ITEMPROVIDER_H
+#define LIBNITROSHARE_ITEMPROVIDER_H
+
+#include <QtGlobal>
+
+#include <nitroshare/config.h>
+
+class Item;
+
+/**
+ * @brief Source of items that are created on demand
+ *
+ * Bundles with a very large number of items can store compact metadata for
+ * them in a provider instead of creating an Item for each one up front. The
+ * bundle asks the provider to create an item only when it is needed for
+ * transfer and deletes it again once the item has been transferred.
+ */
+class NITROSHARE_EXPORT ItemProvider
+{
+public:
+
+    virtual ~ItemProvider() {}
+
+    /**
+     * @brief Retrieve the number of items
+     */
+    virtual int count() const = 0;
+
+    /**
+     * @brief Retrieve the total size of all items
+     * @return size in bytes
+     */
+    virtual qint64 totalSize() const = 0;
+
+    /**
+     * @brief Create an item
+     * @param index position of the item in the provider
+     * @return newly created item
+     */
+    virtual Item *createItem(int index) = 0;
+};
+
+#endif // LIBNITROSHARE_ITEMPROVIDER_H
@@ -25,6 +25,7 @@
 #ifndef LIBNITROSHARE_JSONUTIL_H
 #define LIBNITROSHARE_JSONUTIL_H
 
+#include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonParseError>
 #include <QJsonValue>
@@ -52,9 +53,11 @@ public:
     /**
      * @brief Convert the provided JSON value to a byte array
      * @param value JSON value
+     * @param format indented for display or compact for transmission
      * @return byte array
      */
-    static QByteArray jsonValueToByteArray(const QJsonValue &value);
+    static QByteArray jsonValueToByteArray(const QJsonValue &value,
+                                           QJsonDocument::JsonFormat format = QJsonDocument::Indented);
 
     /**
      * @brief Convert a byte array to its equivalent JSON value
@@ -36,6 +36,11 @@ class NITROSHARE_EXPORT PacketPrivate;
  *
  * Each packet includes its type and payload. Packets that convey information
  * about state often have empty payloads.
+ *
+ * Item headers may also carry a file descriptor. Transports able to pass
+ * descriptors between processes send it along with the packet and ignore it
+ * otherwise. The packet never takes ownership of the descriptor - a received
+ * descriptor is only valid until the packetReceived() signal returns.
  */
 class NITROSHARE_EXPORT Packet : public QObject
 {
@@ -57,7 +62,9 @@ public:
         /// JSON metadata
         Json,
         /// Binary data (item content)
-        Binary
+        Binary,
+        /// Sent after the last item when the number of items is not known
+        End
     };
 
     /**
@@ -80,6 +87,18 @@ public:
      */
     QByteArray content() const;
 
+    /**
+     * @brief Retrieve the descriptor sent with the packet
+     * @return descriptor or -1 if none was sent
+     */
+    int descriptor() const;
+
+    /**
+     * @brief Set the descriptor to send with the packet
+     * @param descriptor open file descriptor
+     */
+    void setDescriptor(int descriptor);
+
 private:
 
     PacketPrivate *const d;
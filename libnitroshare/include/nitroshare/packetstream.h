@@ -0,0 +1,113 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef LIBNITROSHARE_PACKETSTREAM_H
+#define LIBNITROSHARE_PACKETSTREAM_H
+
+#include <QByteArray>
+
+#include <nitroshare/config.h>
+
+class NITROSHARE_EXPORT PacketStreamPrivate;
+
+/**
+ * @brief Frame packets sent over a stream of bytes
+ *
+ * Each packet is preceded by its size (a 32-bit little-endian integer that
+ * includes the type) and its type (a single byte). The content follows
+ * immediately. Transports that send packets over a stream of bytes use the
+ * static methods to build frames and an instance to split received data back
+ * into packets.
+ *
+ * Types are passed as raw bytes so that transports can use the upper bits
+ * for flags of their own.
+ */
+class NITROSHARE_EXPORT PacketStream
+{
+public:
+
+    /// Number of bytes preceding the content of each packet
+    static const int HeaderSize = 5;
+
+    /**
+     * @brief Build the header for a packet
+     * @param type packet type
+     * @param contentSize size of the content that follows
+     * @return size and type of the packet
+     */
+    static QByteArray encodeHeader(char type, int contentSize);
+
+    /**
+     * @brief Append a complete packet to a stream
+     * @param stream data to append the packet to
+     * @param type packet type
+     * @param content packet content
+     */
+    static void encode(QByteArray &stream, char type, const QByteArray &content);
+
+    /**
+     * @brief Create an empty stream for receiving packets
+     */
+    PacketStream();
+
+    /**
+     * @brief Destroy the stream
+     */
+    ~PacketStream();
+
+    /**
+     * @brief Add received data to the stream
+     * @param data bytes received
+     */
+    void addData(const QByteArray &data);
+
+    /**
+     * @brief Read the next packet from the stream
+     * @param type pointer to the packet type
+     * @param content pointer to the packet content
+     * @return true if a complete packet was read
+     *
+     * Once this returns false, either more data is needed or hasError()
+     * indicates that the stream is invalid.
+     */
+    bool readPacket(char *type, QByteArray *content);
+
+    /**
+     * @brief Determine if an invalid packet was received
+     */
+    bool hasError() const;
+
+    /**
+     * @brief Discard all received data
+     */
+    void clear();
+
+private:
+
+    Q_DISABLE_COPY(PacketStream)
+
+    PacketStreamPrivate *const d;
+};
+
+#endif // LIBNITROSHARE_PACKETSTREAM_H
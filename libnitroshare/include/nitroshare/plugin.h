@@ -48,6 +48,7 @@ class NITROSHARE_EXPORT Plugin : public QObject
     Q_PROPERTY(QString version READ version)
     Q_PROPERTY(QString description READ description)
     Q_PROPERTY(bool isLoaded READ isLoaded)
+    Q_PROPERTY(qint64 loadTime READ loadTime)
 
 public:
 
@@ -91,6 +92,12 @@ public:
      */
     bool isLoaded() const;
 
+    /**
+     * @brief Retrieve the time taken to load and initialize the plugin
+     * @return time in microseconds
+     */
+    qint64 loadTime() const;
+
 private:
 
     PluginPrivate *const d;
@@ -43,7 +43,8 @@ public:
      * @return map of properties
      *
      * The objectName property provided by QObject is explicitly excluded from
-     * the map that is returned.
+     * the map that is returned. Dynamic properties are included, except for
+     * those reserved for internal use by Qt (prefixed with "_q_").
      */
     static QVariantMap properties(const QObject *object);
 };
@@ -0,0 +1,114 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef LIBNITROSHARE_TRACE_H
+#define LIBNITROSHARE_TRACE_H
+
+#include <QByteArray>
+
+#include <nitroshare/config.h>
+
+/**
+ * @brief Record spans of time spent in hot paths
+ *
+ * Spans are recorded into a fixed-size ring buffer owned by the thread that
+ * records them, so recording never blocks or allocates once a thread has
+ * recorded its first span. The spans can be retrieved in the Chrome
+ * trace-event format, which can be loaded by chrome://tracing or Perfetto.
+ *
+ * Spans are only compiled in when ENABLE_TRACING is defined and are only
+ * recorded after tracing is enabled at runtime with setEnabled().
+ */
+class NITROSHARE_EXPORT Trace
+{
+public:
+
+    /**
+     * @brief Determine if spans are being recorded
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Begin or stop recording spans
+     * @param enabled true to record spans
+     */
+    static void setEnabled(bool enabled);
+
+    /**
+     * @brief Retrieve the current time in nanoseconds from a monotonic clock
+     */
+    static qint64 now();
+
+    /**
+     * @brief Record a span for the current thread
+     * @param name string literal describing the span
+     * @param start time the span began
+     * @param end time the span ended
+     */
+    static void record(const char *name, qint64 start, qint64 end);
+
+    /**
+     * @brief Retrieve the recorded spans as trace-event JSON
+     *
+     * The most recent spans for each thread are included, up to the size of
+     * the ring buffer. Spans that a thread overwrites while this method runs
+     * are left out rather than reported partially, so the oldest spans of a
+     * busy thread may be missing from the output.
+     */
+    static QByteArray toJson();
+};
+
+/**
+ * @brief Record a span for the lifetime of the object
+ */
+class TraceSpan
+{
+public:
+
+    explicit TraceSpan(const char *name)
+        : mName(Trace::isEnabled() ? name : nullptr),
+          mStart(mName ? Trace::now() : 0)
+    {
+    }
+
+    ~TraceSpan()
+    {
+        if (mName) {
+            Trace::record(mName, mStart, Trace::now());
+        }
+    }
+
+private:
+
+    const char *mName;
+    qint64 mStart;
+};
+
+#ifdef ENABLE_TRACING
+#  define TRACE_SPAN(name) TraceSpan traceSpan(name)
+#else
+#  define TRACE_SPAN(name)
+#endif
+
+#endif // LIBNITROSHARE_TRACE_H
@@ -26,6 +26,7 @@
 #define LIBNITROSHARE_TRANSFER_H
 
 #include <QObject>
+#include <QVariantMap>
 
 #include <nitroshare/config.h>
 
@@ -53,7 +54,11 @@ class NITROSHARE_EXPORT Transfer : public QObject
     Q_PROPERTY(State state READ state NOTIFY stateChanged)
     Q_PROPERTY(int progress READ progress NOTIFY progressChanged)
     Q_PROPERTY(qint64 speed READ speed NOTIFY speedChanged)
+    Q_PROPERTY(qint64 instantaneousSpeed READ instantaneousSpeed NOTIFY speedChanged)
+    Q_PROPERTY(qint64 averageSpeed READ averageSpeed NOTIFY speedChanged)
+    Q_PROPERTY(qint64 timeRemaining READ timeRemaining NOTIFY speedChanged)
     Q_PROPERTY(qint64 bytesRemaining READ bytesRemaining)
+    Q_PROPERTY(QVariantMap statistics READ statistics)
     Q_PROPERTY(QString deviceName READ deviceName NOTIFY deviceNameChanged)
     Q_PROPERTY(QString error READ error NOTIFY errorChanged)
     Q_PROPERTY(bool isFinished READ isFinished)
@@ -127,12 +132,36 @@ public:
     /**
      * @brief Retrieve the speed of the transfer
      * @return speed in bytes per second
+     *
+     * This is an exponentially weighted moving average of the instantaneous
+     * speed, which smooths out short bursts and stalls.
      */
     qint64 speed() const;
 
+    /**
+     * @brief Retrieve the speed of the transfer during the last interval
+     * @return speed in bytes per second
+     */
+    qint64 instantaneousSpeed() const;
+
+    /**
+     * @brief Retrieve the average speed since the transfer began
+     * @return speed in bytes per second
+     */
+    qint64 averageSpeed() const;
+
+    /**
+     * @brief Retrieve the estimated time until the transfer completes
+     * @return seconds remaining or -1 if unknown
+     *
+     * The estimate is based on the smoothed speed and is updated each time
+     * speedChanged() is emitted.
+     */
+    qint64 timeRemaining() const;
+
     /**
      * @brief Retrieve the number of bytes remaining to be transferred
-     * @return remaining bytes
+     * @return remaining bytes or -1 if the total size is unknown
      *
      * In order to prevent unnecessary processing during transfer, there is no
      * signal for indicating changes to this property. Instead, the
@@ -140,6 +169,18 @@ public:
      */
     qint64 bytesRemaining() const;
 
+    /**
+     * @brief Retrieve detailed statistics for the transfer
+     * @return map of statistic names to values
+     *
+     * The map includes the number of packets sent and received as well as
+     * the time (in milliseconds) spent reading and writing items, waiting
+     * for the transport to send data, waiting for the peer, and processing
+     * headers. Statistics reported by the transport are included under the
+     * "transport" key. Like bytesRemaining(), there is no change signal.
+     */
+    QVariantMap statistics() const;
+
     /**
      * @brief Retrieve the name of the remote peer
      * @return device name
@@ -174,10 +215,18 @@ Q_SIGNALS:
 
     /**
      * @brief Indicate that the transfer speed has changed
-     * @param speed bytes per second
+     * @param speed smoothed bytes per second
+     *
+     * This is also emitted when the instantaneous or average speed changes.
      */
     void speedChanged(qint64 speed);
 
+    /**
+     * @brief Indicate that an item was completely sent or received
+     * @param size size of the item in bytes
+     */
+    void itemTransferred(qint64 size);
+
     /**
      * @brief Indicate that the name of the remote peer has changed
      * @param deviceName name of the remote peer
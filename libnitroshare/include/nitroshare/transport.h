@@ -26,6 +26,7 @@
 #define LIBNITROSHARE_TRANSPORT_H
 
 #include <QObject>
+#include <QVariantMap>
 
 #include <nitroshare/config.h>
 
@@ -59,6 +60,36 @@ public:
      */
     virtual void close() = 0;
 
+    /**
+     * @brief Retrieve statistics for the underlying connection
+     * @return map of statistic names to values
+     *
+     * Transports report whatever is available to them, such as the
+     * round-trip time or the number of retransmissions. The default
+     * implementation returns an empty map.
+     */
+    virtual QVariantMap statistics() const;
+
+    /**
+     * @brief Stop or resume reading packets from the peer
+     * @param paused true to stop reading
+     *
+     * This is used when received data cannot be written as quickly as it
+     * arrives. Transports that support it stop reading from the peer, which
+     * in turn slows down the sender. Packets may still be received while
+     * paused, since they must be accepted regardless. The default
+     * implementation does nothing.
+     */
+    virtual void setReceivingPaused(bool paused);
+
+    /**
+     * @brief Determine if descriptors attached to packets reach the peer
+     * @return true if descriptors are passed along with packets
+     *
+     * The default implementation returns false.
+     */
+    virtual bool canPassDescriptors() const;
+
 Q_SIGNALS:
 
     /**
@@ -22,20 +22,81 @@
  * IN THE SOFTWARE.
  */
 
+#include <algorithm>
+
 #include <nitroshare/bundle.h>
 #include <nitroshare/item.h>
+#include <nitroshare/itemprovider.h>
 
 #include "bundle_p.h"
 
+BundleSegment::BundleSegment(int start)
+    : start(start),
+      provider(nullptr)
+{
+}
+
+BundleSegment::~BundleSegment()
+{
+    qDeleteAll(items);
+    qDeleteAll(created);
+    delete provider;
+}
+
+int BundleSegment::count() const
+{
+    return provider ? provider->count() : items.count();
+}
+
 BundlePrivate::BundlePrivate(QObject *parent)
     : QObject(parent),
-      totalSize(0)
+      removed(0),
+      count(0),
+      totalSize(0),
+      complete(true),
+      streaming(false)
 {
 }
 
 BundlePrivate::~BundlePrivate()
 {
-    qDeleteAll(items);
+    qDeleteAll(segments);
+}
+
+void BundlePrivate::append(BundleSegment *segment)
+{
+    segments.append(segment);
+    count += segment->count();
+}
+
+BundleSegment *BundlePrivate::findSegment(int row) const
+{
+    // Find the last segment starting at or before the row
+    auto i = std::upper_bound(segments.constBegin(), segments.constEnd(), row,
+        [](int row, const BundleSegment *segment) {
+            return row < segment->start;
+        }
+    );
+    return *(i - 1);
+}
+
+Item *BundlePrivate::item(int row)
+{
+    int position = removed + row;
+    BundleSegment *segment = findSegment(position);
+    int index = position - segment->start;
+
+    if (!segment->provider) {
+        return segment->items.at(index);
+    }
+
+    // Create the item if this is the first time it was requested
+    Item *item = segment->created.value(index);
+    if (!item) {
+        item = segment->provider->createItem(index);
+        segment->created.insert(index, item);
+    }
+    return item;
 }
 
 Bundle::Bundle(QObject *parent)
@@ -46,8 +107,92 @@ Bundle::Bundle(QObject *parent)
 
 void Bundle::add(Item *item)
 {
-    d->items.append(item);
-    d->totalSize += item->size();
+    add(QList<Item*>{item});
+}
+
+void Bundle::add(const QList<Item*> &items)
+{
+    if (items.isEmpty()) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), d->count, d->count + items.count() - 1);
+
+    // Consecutive items share a segment
+    BundleSegment *segment = d->segments.count() ? d->segments.last() : nullptr;
+    if (segment && !segment->provider) {
+        segment->items.append(items);
+        d->count += items.count();
+    } else {
+        segment = new BundleSegment(d->removed + d->count);
+        segment->items = items;
+        d->append(segment);
+    }
+
+    foreach (Item *item, items) {
+        d->totalSize += item->size();
+    }
+    endInsertRows();
+}
+
+void Bundle::add(ItemProvider *provider)
+{
+    if (!provider->count()) {
+        delete provider;
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), d->count, d->count + provider->count() - 1);
+    BundleSegment *segment = new BundleSegment(d->removed + d->count);
+    segment->provider = provider;
+    d->append(segment);
+    d->totalSize += provider->totalSize();
+    endInsertRows();
+}
+
+void Bundle::removeFirst()
+{
+    if (!d->count) {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), 0, 0);
+
+    // The item may be in the middle of emitting a signal
+    BundleSegment *segment = d->segments.first();
+    if (segment->provider) {
+        Item *item = segment->created.take(d->removed - segment->start);
+        if (item) {
+            item->deleteLater();
+        }
+    } else {
+        segment->items.takeFirst()->deleteLater();
+        ++segment->start;
+    }
+    ++d->removed;
+    --d->count;
+
+    // Free the segment once all of its rows were removed
+    if (d->removed == segment->start + segment->count()) {
+        delete d->segments.takeFirst();
+    }
+
+    endRemoveRows();
+}
+
+void Bundle::release(int row)
+{
+    if (row < 0 || row >= d->count) {
+        return;
+    }
+
+    BundleSegment *segment = d->findSegment(d->removed + row);
+    if (segment->provider) {
+        Item *item = segment->created.take(d->removed + row - segment->start);
+        if (item) {
+            item->deleteLater();
+        }
+    }
 }
 
 qint64 Bundle::totalSize() const
@@ -55,16 +200,40 @@ qint64 Bundle::totalSize() const
     return d->totalSize;
 }
 
+bool Bundle::isComplete() const
+{
+    return d->complete;
+}
+
+void Bundle::setComplete(bool complete)
+{
+    bool wasComplete = d->complete;
+    d->complete = complete;
+    if (complete && !wasComplete) {
+        emit completed();
+    }
+}
+
+bool Bundle::isStreaming() const
+{
+    return d->streaming;
+}
+
+void Bundle::setStreaming(bool streaming)
+{
+    d->streaming = streaming;
+}
+
 int Bundle::rowCount(const QModelIndex &) const
 {
-    return d->items.count();
+    return d->count;
 }
 
 QVariant Bundle::data(const QModelIndex &index, int role) const
 {
     if (!index.isValid() || index.row() < 0 ||
-            index.row() >= d->items.count() || role != Qt::UserRole) {
+            index.row() >= d->count || role != Qt::UserRole) {
         return QVariant();
     }
-    return QVariant::fromValue(d->items.at(index.row()));
+    return QVariant::fromValue(d->item(index.row()));
 }
@@ -25,10 +25,34 @@
 #ifndef LIBNITROSHARE_BUNDLE_P_H
 #define LIBNITROSHARE_BUNDLE_P_H
 
+#include <QHash>
 #include <QList>
 #include <QObject>
 
 class Item;
+class ItemProvider;
+
+/**
+ * @brief Consecutive rows in a bundle
+ *
+ * Rows either refer to items that were added directly or to items that the
+ * provider creates on demand. Segments are numbered from the first row ever
+ * added to the bundle so that removing rows does not require renumbering.
+ */
+class BundleSegment
+{
+public:
+
+    explicit BundleSegment(int start);
+    ~BundleSegment();
+
+    int count() const;
+
+    int start;
+    QList<Item*> items;
+    ItemProvider *provider;
+    QHash<int, Item*> created;
+};
 
 class BundlePrivate : public QObject
 {
@@ -39,8 +63,16 @@ public:
     explicit BundlePrivate(QObject *parent);
     virtual ~BundlePrivate();
 
-    QList<Item*> items;
+    void append(BundleSegment *segment);
+    BundleSegment *findSegment(int row) const;
+    Item *item(int row);
+
+    QList<BundleSegment*> segments;
+    int removed;
+    int count;
     qint64 totalSize;
+    bool complete;
+    bool streaming;
 };
 
 #endif // LIBNITROSHARE_BUNDLE_P_H
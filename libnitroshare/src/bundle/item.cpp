@@ -34,11 +34,25 @@ bool Item::open(OpenMode)
     return true;
 }
 
+void Item::prefetch()
+{
+}
+
+bool Item::isReadyRead() const
+{
+    return true;
+}
+
 QByteArray Item::read()
 {
     return QByteArray();
 }
 
+bool Item::isReadyWrite() const
+{
+    return true;
+}
+
 void Item::write(const QByteArray &)
 {
 }
@@ -46,3 +60,8 @@ void Item::write(const QByteArray &)
 void Item::close()
 {
 }
+
+bool Item::isClosed() const
+{
+    return true;
+}
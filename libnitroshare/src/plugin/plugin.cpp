@@ -22,6 +22,7 @@
  * IN THE SOFTWARE.
  */
 
+#include <QElapsedTimer>
 #include <QJsonValue>
 
 #include <nitroshare/plugin.h>
@@ -32,7 +33,8 @@ PluginPrivate::PluginPrivate(QObject *parent, const QString &filename)
     : QObject(parent),
       loader(filename),
       loaded(false),
-      initialized(false)
+      initialized(false),
+      loadTime(0)
 {
 }
 
@@ -59,9 +61,12 @@ bool PluginPrivate::load()
         }
 
         // The physical plugin is not loaded; attempt to load it
+        QElapsedTimer timer;
+        timer.start();
         if (!loader.load()) {
             return false;
         }
+        loadTime += timer.nsecsElapsed();
 
         // Load the metadata from the plugin
         metadata = loader.metaData().value("MetaData").toObject();
@@ -108,3 +113,8 @@ bool Plugin::isLoaded() const
 {
     return d->initialized;
 }
+
+qint64 Plugin::loadTime() const
+{
+    return d->loadTime / 1000;
+}
@@ -51,6 +51,7 @@ public:
 
     bool loaded;
     bool initialized;
+    qint64 loadTime;
 
     QList<Plugin*> children;
 };
@@ -23,6 +23,7 @@
  */
 
 #include <QDir>
+#include <QElapsedTimer>
 #include <QLibrary>
 
 #include <nitroshare/application.h>
@@ -162,7 +163,10 @@ bool PluginModel::load(Plugin *plugin)
         if (!iplugin) {
             return false;
         }
+        QElapsedTimer timer;
+        timer.start();
         iplugin->initialize(d->application);
+        plugin->d->loadTime += timer.nsecsElapsed();
         plugin->d->initialized = true;
 
         // Emit the signal indicating the state of the plugin has changed
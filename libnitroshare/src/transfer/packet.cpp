@@ -29,7 +29,8 @@
 PacketPrivate::PacketPrivate(QObject *parent, Packet::Type type, const QByteArray &content)
     : QObject(parent),
       type(type),
-      content(content)
+      content(content),
+      descriptor(-1)
 {
 }
 
@@ -48,3 +49,13 @@ QByteArray Packet::content() const
 {
     return d->content;
 }
+
+int Packet::descriptor() const
+{
+    return d->descriptor;
+}
+
+void Packet::setDescriptor(int descriptor)
+{
+    d->descriptor = descriptor;
+}
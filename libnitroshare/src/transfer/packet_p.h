@@ -39,6 +39,7 @@ public:
 
     Packet::Type type;
     QByteArray content;
+    int descriptor;
 };
 
 #endif // LIBNITROSHARE_PACKET_P_H
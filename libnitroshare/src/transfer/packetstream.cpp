@@ -0,0 +1,140 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QtEndian>
+
+#include <nitroshare/packetstream.h>
+
+#include "packetstream_p.h"
+
+const int PacketStream::HeaderSize;
+
+PacketStreamPrivate::PacketStreamPrivate()
+    : offset(0),
+      size(0),
+      error(false)
+{
+}
+
+QByteArray PacketStream::encodeHeader(char type, int contentSize)
+{
+    QByteArray header(HeaderSize, Qt::Uninitialized);
+    qToLittleEndian<qint32>(contentSize + 1, reinterpret_cast<uchar*>(header.data()));
+    header[HeaderSize - 1] = type;
+    return header;
+}
+
+void PacketStream::encode(QByteArray &stream, char type, const QByteArray &content)
+{
+    // The header is written in place to avoid a temporary array
+    int start = stream.size();
+    stream.resize(start + HeaderSize);
+    qToLittleEndian<qint32>(content.size() + 1, reinterpret_cast<uchar*>(stream.data() + start));
+    stream[start + HeaderSize - 1] = type;
+    stream.append(content);
+}
+
+PacketStream::PacketStream()
+    : d(new PacketStreamPrivate)
+{
+}
+
+PacketStream::~PacketStream()
+{
+    delete d;
+}
+
+void PacketStream::addData(const QByteArray &data)
+{
+    // Discard what was already read before the buffer grows, which avoids
+    // moving the remaining data after every packet
+    if (d->offset) {
+        d->buffer.remove(0, d->offset);
+        d->offset = 0;
+    }
+
+    // An empty buffer can share the data instead of copying it
+    if (d->buffer.isEmpty()) {
+        d->buffer = data;
+    } else {
+        d->buffer.append(data);
+    }
+}
+
+bool PacketStream::readPacket(char *type, QByteArray *content)
+{
+    if (d->error) {
+        return false;
+    }
+
+    int available = d->buffer.size() - d->offset;
+
+    // Read the size first if it is not yet known
+    if (!d->size) {
+        if (available < static_cast<int>(sizeof(qint32))) {
+            return false;
+        }
+        d->size = qFromLittleEndian<qint32>(
+            reinterpret_cast<const uchar*>(d->buffer.constData() + d->offset));
+        d->offset += sizeof(qint32);
+        available -= sizeof(qint32);
+
+        // A packet size of zero is an error (and impossible)
+        if (d->size <= 0) {
+            d->error = true;
+            return false;
+        }
+    }
+
+    // Only continue if the buffer has the full packet
+    if (available < d->size) {
+        return false;
+    }
+
+    *type = d->buffer.at(d->offset);
+    *content = d->buffer.mid(d->offset + 1, d->size - 1);
+    d->offset += d->size;
+    d->size = 0;
+
+    // Release the buffer once everything in it was read
+    if (d->offset == d->buffer.size()) {
+        d->buffer.clear();
+        d->offset = 0;
+    }
+
+    return true;
+}
+
+bool PacketStream::hasError() const
+{
+    return d->error;
+}
+
+void PacketStream::clear()
+{
+    d->buffer.clear();
+    d->offset = 0;
+    d->size = 0;
+    d->error = false;
+}
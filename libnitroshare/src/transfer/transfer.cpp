@@ -22,9 +22,9 @@
  * IN THE SOFTWARE.
  */
 
+#include <cmath>
 #include <cstring>
 
-#include <QDateTime>
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QJsonParseError>
@@ -40,6 +40,7 @@
 #include <nitroshare/logger.h>
 #include <nitroshare/message.h>
 #include <nitroshare/packet.h>
+#include <nitroshare/trace.h>
 #include <nitroshare/transfer.h>
 #include <nitroshare/transfermodel.h>
 #include <nitroshare/transport.h>
@@ -52,6 +53,27 @@ const QString MessageTag = "transfer";
 // Interval for calculating transfer speed
 const qint64 SpeedInterval = 1000;
 
+// Time constant (in ms) for smoothing the speed - roughly how long it takes
+// for the smoothed value to follow a sudden change in the instantaneous speed
+const double SpeedTimeConstant = 5000;
+
+// Number of upcoming items prepared while the current one is sent
+const int PrefetchItems = 2;
+
+// Number of received items that may finish closing in the background before
+// reading from the peer is paused
+const int MaxClosingItems = 16;
+
+// Item property holding a descriptor sent with the item header
+const char *const DescriptorProperty = "descriptor";
+
+// Item header key with the size counted in the transfer header, which is only
+// sent if the item changed its size when it was opened
+const char *const ExpectedSizeKey = "expectedSize";
+
+// Item property set when the receiver agreed to copy items from descriptors
+const char *const CloneableProperty = "cloneable";
+
 TransferPrivate::TransferPrivate(Transfer *transfer,
                                  Application *application,
                                  Device *device,
@@ -67,6 +89,10 @@ TransferPrivate::TransferPrivate(Transfer *transfer,
       mState(device ? Transfer::Connecting : Transfer::InProgress),
       mProgress(0),
       mDeviceName(device ? device->name() : tr("[unknown]")),
+      mStreaming(bundle ? bundle->isStreaming() : false),
+      mWaitingForItems(false),
+      mCloneOffered(false),
+      mCloneAccepted(false),
       mItemIndex(0),
       mItemCount(bundle ? bundle->rowCount() : 0),
       mBytesTransferred(0),
@@ -74,12 +100,28 @@ TransferPrivate::TransferPrivate(Transfer *transfer,
       mCurrentItem(nullptr),
       mCurrentItemBytesTransferred(0),
       mCurrentItemBytesTotal(0),
+      mWaitingForData(false),
+      mReceivingPaused(false),
       mSpeed(0),
-      mLastInterval(QDateTime::currentMSecsSinceEpoch()),
-      mLastIntervalBytesTransferred(0)
+      mInstantaneousSpeed(0),
+      mAverageSpeed(0),
+      mLastInterval(0),
+      mLastIntervalBytesTransferred(0),
+      mPacketsSent(0),
+      mPacketsReceived(0),
+      mDiskTime(0),
+      mSocketTime(0),
+      mPeerTime(0),
+      mHeaderTime(0),
+      mDiskWaitStart(-1),
+      mSocketWaitStart(-1),
+      mPeerWaitStart(-1),
+      mFinishTime(-1)
 {
     connect(&mSpeedTimer, &QTimer::timeout, this, &TransferPrivate::onTimeout);
 
+    mClock.start();
+
     if (mDirection == Transfer::Send) {
 
         // Use the device to attempt to create a transport
@@ -89,11 +131,16 @@ TransferPrivate::TransferPrivate(Transfer *transfer,
             return;
         }
         connect(mTransport, &Transport::connected, this, &TransferPrivate::onConnected);
+        connect(mBundle, &Bundle::rowsInserted, this, &TransferPrivate::onBundleRowsInserted);
+        connect(mBundle, &Bundle::completed, this, &TransferPrivate::onBundleCompleted);
 
         // Ensure the bundle is freed when the transfer is destroyed
         mBundle->setParent(this);
     } else {
-        mSpeedTimer.start(SpeedInterval);
+        startSpeedTimer();
+
+        // Nothing can happen until the transfer header arrives
+        mPeerWaitStart = 0;
     }
 
     // Transport should always be valid at this point - ensure it is freed
@@ -104,40 +151,128 @@ TransferPrivate::TransferPrivate(Transfer *transfer,
     connect(mTransport, &Transport::error, this, &TransferPrivate::onError);
 }
 
+void TransferPrivate::sendPacket(Packet *packet)
+{
+    // Time is spent waiting on the socket until packetSent() is emitted
+    ++mPacketsSent;
+    mSocketWaitStart = mClock.nsecsElapsed();
+    mTransport->sendPacket(packet);
+}
+
 void TransferPrivate::sendTransferHeader()
 {
+    qint64 headerStart = mClock.nsecsElapsed();
+
     QJsonObject object{
-        { "name", mApplication->deviceName() },
-        { "count", QString::number(mBundle->rowCount(QModelIndex())) },
-        { "size", QString::number(mBundle->totalSize()) }
+        { "name", mApplication->deviceName() }
     };
 
+    if (mStreaming) {
+
+        // The number of items and their size are unknown; the receiver is
+        // instead notified when the last item was sent
+        mItemCount = -1;
+        mBytesTotal = mBundle->isComplete() ? mBundle->totalSize() : -1;
+        object.insert("streaming", true);
+    } else {
+
+        // Items may have been added to the bundle since the transfer was created
+        mItemCount = mBundle->rowCount();
+        mBytesTotal = mBundle->totalSize();
+        object.insert("count", QString::number(mItemCount));
+        object.insert("size", QString::number(mBytesTotal));
+    }
+
+    // If descriptors reach the receiver, it may copy items from them instead
+    // of having their contents sent; items are sent normally until it agrees
+    if (mTransport->canPassDescriptors()) {
+        object.insert("clone", true);
+        mCloneOffered = true;
+    }
+
     Packet packet(Packet::Json, QJsonDocument(object).toJson());
-    mTransport->sendPacket(&packet);
+    addTime(mHeaderTime, headerStart);
+    sendPacket(&packet);
 
-    // The next packet will be an item header
-    mProtocolState = ItemHeader;
+    // The next packet will be an item header unless the bundle is empty (a
+    // directory with no files, for example)
+    mProtocolState = mItemCount ? ItemHeader : Finished;
 }
 
 void TransferPrivate::sendItemHeader()
 {
-    // Grab the next item and attempt to open it
-    mCurrentItem = mBundle->index(mItemIndex, 0).data(Qt::UserRole).value<Item*>();
-    if (!mCurrentItem->open(Item::Read)) {
+    TRACE_SPAN("Transfer::sendItemHeader");
+
+    // Items are removed from streaming bundles once sent
+    int row = mStreaming ? 0 : mItemIndex;
+
+    // If a streaming bundle has no items, either the last one was sent or
+    // more are still being added
+    if (mStreaming && !mBundle->rowCount()) {
+        if (mBundle->isComplete()) {
+            Packet packet(Packet::End);
+            sendPacket(&packet);
+            mProtocolState = Finished;
+        } else {
+            mWaitingForItems = true;
+        }
+        return;
+    }
+
+    // Grab the next item and attempt to open it (noting its size, which may
+    // change once it is opened)
+    mCurrentItem = mBundle->index(row, 0).data(Qt::UserRole).value<Item*>();
+    if (mCloneAccepted) {
+        mCurrentItem->setProperty(CloneableProperty, true);
+    }
+    qint64 expectedSize = mCurrentItem->size();
+    qint64 diskStart = mClock.nsecsElapsed();
+    bool opened = mCurrentItem->open(Item::Read);
+    addTime(mDiskTime, diskStart);
+    if (!opened) {
         setError(tr("unable to open \"%1\" for reading").arg(mCurrentItem->name()), true);
         return;
     }
 
+    // Items that read asynchronously signal when data becomes available
+    connect(mCurrentItem, &Item::readyRead, this, &TransferPrivate::onItemReadyRead);
+    connect(mCurrentItem, &Item::error, this, &TransferPrivate::onError);
+
+    // Give the next items a chance to load while this one is sent
+    for (int i = row + 1; i < qMin(row + 1 + PrefetchItems, mBundle->rowCount()); ++i) {
+        mBundle->index(i, 0).data(Qt::UserRole).value<Item*>()->prefetch();
+    }
+
     // Reset transfer stats
     mCurrentItemBytesTransferred = 0;
     mCurrentItemBytesTotal = mCurrentItem->size();
+    if (mBytesTotal > 0) {
+        mBytesTotal += mCurrentItemBytesTotal - expectedSize;
+    }
 
     // Build a JSON object with all of the properties
+    qint64 headerStart = mClock.nsecsElapsed();
     QJsonObject object = JsonUtil::objectToJson(mCurrentItem);
 
+    // A descriptor provided by the item is meaningless to the receiver as a
+    // number and is instead passed by the transport (if it can)
+    QVariant descriptor = mCurrentItem->property(DescriptorProperty);
+    object.remove(DescriptorProperty);
+    object.remove(CloneableProperty);
+
+    // The receiver adjusts its total the same way (strings must be used for
+    // 64-bit numbers)
+    if (mCurrentItemBytesTotal != expectedSize) {
+        object.insert(ExpectedSizeKey, QString::number(expectedSize));
+    }
+
     // Send the item header
     Packet packet(Packet::Json, QJsonDocument(object).toJson());
-    mTransport->sendPacket(&packet);
+    if (descriptor.isValid()) {
+        packet.setDescriptor(descriptor.toInt());
+    }
+    addTime(mHeaderTime, headerStart);
+    sendPacket(&packet);
 
     // If the item has a size, switch states; otherwise send the next item
     if (mCurrentItemBytesTotal) {
@@ -149,9 +284,25 @@ void TransferPrivate::sendItemHeader()
 
 void TransferPrivate::sendItemContent()
 {
+    TRACE_SPAN("Transfer::sendItemContent");
+
+    // If the item has no data available, wait for it to emit readyRead()
+    if (!mCurrentItem->isReadyRead()) {
+        mWaitingForData = true;
+        mDiskWaitStart = mClock.nsecsElapsed();
+        return;
+    }
+
+    // Reading from the item may have triggered an error
+    qint64 diskStart = mClock.nsecsElapsed();
     QByteArray data = mCurrentItem->read();
+    addTime(mDiskTime, diskStart);
+    if (mState == Transfer::Failed) {
+        return;
+    }
+
     Packet packet(Packet::Binary, data);
-    mTransport->sendPacket(&packet);
+    sendPacket(&packet);
 
     // Increment the number of bytes written to the socket
     mBytesTransferred += data.length();
@@ -169,9 +320,23 @@ void TransferPrivate::sendItemContent()
 void TransferPrivate::sendNext()
 {
     // Close the current item and increment the index
+    qint64 diskStart = mClock.nsecsElapsed();
     mCurrentItem->close();
+    addTime(mDiskTime, diskStart);
+    disconnect(mCurrentItem, nullptr, this, nullptr);
     ++mItemIndex;
 
+    emit q->itemTransferred(mCurrentItemBytesTransferred);
+
+    // Items in a streaming bundle are no longer needed once sent; items
+    // that the bundle created on demand can be released
+    if (mStreaming) {
+        mBundle->removeFirst();
+    } else {
+        mBundle->release(mItemIndex - 1);
+    }
+    mCurrentItem = nullptr;
+
     // If all items have been sent, move to the finished state and wait for
     // the success packet; otherwise, prepare to send the next item
     if (mItemIndex == mItemCount) {
@@ -196,16 +361,49 @@ void TransferPrivate::processTransferHeader(Packet *packet)
         emit q->deviceNameChanged(mDeviceName);
     }
 
+    // Answer an offer to copy items directly, which is only possible if the
+    // descriptors for them can reach this end
+    if (object.value("clone").toBool()) {
+        QJsonObject reply{
+            { "clone", mTransport->canPassDescriptors() }
+        };
+        Packet replyPacket(Packet::Json, QJsonDocument(reply).toJson());
+        sendPacket(&replyPacket);
+    }
+
+    // When streaming, items are received until an end packet arrives
+    mStreaming = object.value("streaming").toBool();
+    if (mStreaming) {
+        mItemCount = -1;
+        mBytesTotal = -1;
+        mProtocolState = ItemHeader;
+        return;
+    }
+
     // Strings must be used for 64-bit numbers
     mItemCount = object.value("count").toString().toInt();
     mBytesTotal = object.value("size").toString().toLongLong();
 
+    // If there are no items, the transfer is complete
+    if (!mItemCount) {
+        setSuccess(true);
+        return;
+    }
+
     // Prepare to receive the first item
     mProtocolState = ItemHeader;
 }
 
 void TransferPrivate::processItemHeader(Packet *packet)
 {
+    // The end packet indicates that the last item in a stream was received
+    if (mStreaming && packet->type() == Packet::End) {
+        finishReceiving();
+        return;
+    }
+
+    qint64 headerStart = mClock.nsecsElapsed();
+
     QJsonParseError error;
     QJsonObject object = QJsonDocument::fromJson(packet->content(), &error).object();
     if (error.error != QJsonParseError::NoError) {
@@ -234,10 +432,25 @@ void TransferPrivate::processItemHeader(Packet *packet)
         return;
     }
 
+    // Pass along the descriptor sent with the header (if any) - the item must
+    // duplicate it if it needs it after being opened
+    QVariantMap properties = object.toVariantMap();
+    properties.remove(DescriptorProperty);
+    properties.remove(ExpectedSizeKey);
+    if (packet->descriptor() != -1) {
+        properties.insert(DescriptorProperty, packet->descriptor());
+    }
+
     // Use the handler to create an item and open it
-    mCurrentItem = handler->createItem(type, object.toVariantMap());
+    mCurrentItem = handler->createItem(type, properties);
     mCurrentItem->setParent(this);
-    if (!mCurrentItem->open(Item::Write)) {
+    connect(mCurrentItem, &Item::error, this, &TransferPrivate::onError);
+    connect(mCurrentItem, &Item::readyWrite, this, &TransferPrivate::onItemReadyWrite);
+    addTime(mHeaderTime, headerStart);
+    qint64 diskStart = mClock.nsecsElapsed();
+    bool opened = mCurrentItem->open(Item::Write);
+    addTime(mDiskTime, diskStart);
+    if (!opened) {
         setError(tr("unable to open \"%1\" for writing").arg(mCurrentItem->name()), true);
         return;
     }
@@ -246,6 +459,13 @@ void TransferPrivate::processItemHeader(Packet *packet)
     mCurrentItemBytesTransferred = 0;
     mCurrentItemBytesTotal = mCurrentItem->size();
 
+    // If the sender changed the size of the item when opening it, the total
+    // in the transfer header no longer matches
+    if (mBytesTotal > 0 && object.contains(ExpectedSizeKey)) {
+        mBytesTotal += mCurrentItemBytesTotal - object.value(ExpectedSizeKey).toString().toLongLong();
+        updateProgress();
+    }
+
     // If the item has a size, switch states; otherwise receive the next item
     if (mCurrentItemBytesTotal) {
         mProtocolState = ItemContent;
@@ -256,7 +476,11 @@ void TransferPrivate::processItemHeader(Packet *packet)
 
 void TransferPrivate::processItemContent(Packet *packet)
 {
+    TRACE_SPAN("Transfer::processItemContent");
+
+    qint64 diskStart = mClock.nsecsElapsed();
     mCurrentItem->write(packet->content());
+    addTime(mDiskTime, diskStart);
 
     // Add the number of bytes to the global & current item totals
     mBytesTransferred += packet->content().size();
@@ -273,23 +497,74 @@ void TransferPrivate::processItemContent(Packet *packet)
 
 void TransferPrivate::processNext()
 {
-    // Close & free the current item and increment the index
+    // Close the current item and increment the index
+    qint64 diskStart = mClock.nsecsElapsed();
     mCurrentItem->close();
-    delete mCurrentItem;
+    addTime(mDiskTime, diskStart);
     ++mItemIndex;
 
-    // If there are no more items, send the success packet
+    // Items still writing data are freed once they finish closing, which
+    // allows the next item to be received in the meantime
+    if (mCurrentItem->isClosed()) {
+        delete mCurrentItem;
+    } else {
+        disconnect(mCurrentItem, &Item::readyWrite, this, &TransferPrivate::onItemReadyWrite);
+        connect(mCurrentItem, &Item::closed, this, &TransferPrivate::onItemClosed);
+        mClosingItems.append(mCurrentItem);
+    }
+    mCurrentItem = nullptr;
+
+    // Closing the item may have failed (writing buffered data, etc.)
+    if (mState == Transfer::Failed) {
+        return;
+    }
+
+    emit q->itemTransferred(mCurrentItemBytesTransferred);
+
+    // If there are no more items, finish the transfer
     if (mItemIndex == mItemCount) {
-        setSuccess(true);
+        finishReceiving();
     } else {
         mProtocolState = ItemHeader;
     }
 }
 
+void TransferPrivate::finishReceiving()
+{
+    // The sender is only told that the transfer succeeded once all of the
+    // items were written
+    mProtocolState = Finished;
+    if (mClosingItems.isEmpty()) {
+        setSuccess(true);
+    }
+}
+
+void TransferPrivate::updateReceiving()
+{
+    // Stop reading from the peer while the current item has too much data
+    // queued or too many items are still being written
+    bool paused = mState == Transfer::InProgress && (
+        (mCurrentItem && !mCurrentItem->isReadyWrite()) ||
+        mClosingItems.count() >= MaxClosingItems
+    );
+    if (paused == mReceivingPaused) {
+        return;
+    }
+    mReceivingPaused = paused;
+    mTransport->setReceivingPaused(paused);
+
+    // Time spent paused is time spent waiting on the disk
+    if (paused) {
+        mDiskWaitStart = mClock.nsecsElapsed();
+    } else {
+        addTime(mDiskTime, mDiskWaitStart);
+    }
+}
+
 void TransferPrivate::updateProgress()
 {
     int newProgress = 0;
-    if (mBytesTotal) {
+    if (mBytesTotal > 0) {
         newProgress = static_cast<int>(100.0 *
             static_cast<double>(mBytesTransferred) /
             static_cast<double>(mBytesTotal));
@@ -301,17 +576,51 @@ void TransferPrivate::updateProgress()
     }
 }
 
+void TransferPrivate::addTime(qint64 &total, qint64 &start)
+{
+    if (start != -1) {
+        total += mClock.nsecsElapsed() - start;
+        start = -1;
+    }
+}
+
+void TransferPrivate::startSpeedTimer()
+{
+    mElapsedTimer.start();
+    mLastInterval = 0;
+    mLastIntervalBytesTransferred = 0;
+    mSpeedTimer.start(SpeedInterval);
+}
+
+void TransferPrivate::stopSpeedTimer()
+{
+    if (!mSpeedTimer.isActive()) {
+        return;
+    }
+    mSpeedTimer.stop();
+
+    // Record the final average and clear the rates, since nothing is moving
+    qint64 elapsed = mElapsedTimer.elapsed();
+    if (elapsed > 0) {
+        mAverageSpeed = static_cast<qint64>(
+            static_cast<double>(mBytesTransferred) * 1000 / elapsed
+        );
+    }
+    mInstantaneousSpeed = 0;
+    emit q->speedChanged(mSpeed = 0);
+}
+
 void TransferPrivate::setSuccess(bool send)
 {
     if (send) {
         Packet packet(Packet::Success);
-        mTransport->sendPacket(&packet);
+        sendPacket(&packet);
     }
 
+    mFinishTime = mClock.elapsed();
     emit q->stateChanged(mState = Transfer::Succeeded);
 
-    // Stop the speed timer
-    mSpeedTimer.stop();
+    stopSpeedTimer();
 
     // Both peers should be aware that the transfer succeeded at this point
     mTransport->close();
@@ -327,14 +636,14 @@ void TransferPrivate::setError(const QString &message, bool send)
 
     if (send) {
         Packet packet(Packet::Error, message.toUtf8());
-        mTransport->sendPacket(&packet);
+        sendPacket(&packet);
     }
 
+    mFinishTime = mClock.elapsed();
     emit q->errorChanged(mError = message);
     emit q->stateChanged(mState = Transfer::Failed);
 
-    // Stop the speed timer
-    mSpeedTimer.stop();
+    stopSpeedTimer();
 
     // An error on either end necessitates the transport be closed
     if (mTransport) {
@@ -348,14 +657,44 @@ void TransferPrivate::setError(const QString &message, bool send)
 void TransferPrivate::onConnected()
 {
     emit q->stateChanged(mState = Transfer::InProgress);
-    sendTransferHeader();
 
-    // Start the speed timer
-    mSpeedTimer.start(SpeedInterval);
+    // If items are still being added to the bundle, wait for them (unless
+    // the bundle is streamed, in which case they are sent as they arrive)
+    if (mStreaming || mBundle->isComplete()) {
+        sendTransferHeader();
+    }
+
+    startSpeedTimer();
+}
+
+void TransferPrivate::onBundleRowsInserted()
+{
+    if (mWaitingForItems) {
+        mWaitingForItems = false;
+        sendItemHeader();
+    }
+}
+
+void TransferPrivate::onBundleCompleted()
+{
+    if (mStreaming) {
+
+        // The total size is now known, which allows progress to be shown
+        mBytesTotal = mBundle->totalSize();
+        updateProgress();
+
+        // Send the end packet if the last item was already sent
+        onBundleRowsInserted();
+    } else if (mState == Transfer::InProgress && mProtocolState == TransferHeader) {
+        sendTransferHeader();
+    }
 }
 
 void TransferPrivate::onPacketReceived(Packet *packet)
 {
+    ++mPacketsReceived;
+    addTime(mPeerTime, mPeerWaitStart);
+
     // If an error packet is received, set the error and quit
     if (packet->type() == Packet::Error) {
         setError(packet->content());
@@ -364,8 +703,15 @@ void TransferPrivate::onPacketReceived(Packet *packet)
 
     if (mDirection == Transfer::Send) {
 
-        // The only packet expected when sending items is the success packet
-        // which indicates the receiver got all of the files
+        // The receiver answers the offer to copy items directly once
+        if (mCloneOffered && packet->type() == Packet::Json) {
+            mCloneOffered = false;
+            mCloneAccepted = QJsonDocument::fromJson(packet->content()).object().value("clone").toBool();
+            return;
+        }
+
+        // The only other packet expected when sending items is the success
+        // packet which indicates the receiver got all of the files
         if (mProtocolState == Finished && packet->type() == Packet::Success) {
             setSuccess();
             return;
@@ -374,19 +720,29 @@ void TransferPrivate::onPacketReceived(Packet *packet)
     } else {
 
         // Dispatch the packet to the appropriate method based on state
+        qint64 headerStart;
         switch (mProtocolState) {
         case TransferHeader:
+            headerStart = mClock.nsecsElapsed();
             processTransferHeader(packet);
-            return;
+            addTime(mHeaderTime, headerStart);
+            break;
         case ItemHeader:
             processItemHeader(packet);
-            return;
+            break;
         case ItemContent:
             processItemContent(packet);
-            return;
+            break;
         case Finished:
             return;
         }
+
+        // Until the next packet arrives, the transfer is waiting on the peer
+        if (mState == Transfer::InProgress) {
+            mPeerWaitStart = mClock.nsecsElapsed();
+        }
+        updateReceiving();
+        return;
     }
 
     // Any other packet was unexpected - assume this is an error
@@ -395,6 +751,8 @@ void TransferPrivate::onPacketReceived(Packet *packet)
 
 void TransferPrivate::onPacketSent()
 {
+    addTime(mSocketTime, mSocketWaitStart);
+
     // We don't care about sent packets when receiving data
     if (mDirection == Transfer::Receive) {
         return;
@@ -411,6 +769,11 @@ void TransferPrivate::onPacketSent()
         sendItemContent();
         break;
     case Finished:
+
+        // Everything was sent and the receiver must now acknowledge it
+        if (mState == Transfer::InProgress && mPeerWaitStart == -1) {
+            mPeerWaitStart = mClock.nsecsElapsed();
+        }
         break;
     }
 }
@@ -420,21 +783,72 @@ void TransferPrivate::onError(const QString &message)
     setError(message, true);
 }
 
+void TransferPrivate::onItemReadyRead()
+{
+    // Resume sending if the last attempt found no data available
+    if (mWaitingForData && mProtocolState == ItemContent) {
+        mWaitingForData = false;
+        addTime(mDiskTime, mDiskWaitStart);
+        sendItemContent();
+    }
+}
+
+void TransferPrivate::onItemReadyWrite()
+{
+    updateReceiving();
+}
+
+void TransferPrivate::onItemClosed()
+{
+    Item *item = qobject_cast<Item*>(sender());
+    mClosingItems.removeOne(item);
+    item->deleteLater();
+
+    if (mState != Transfer::InProgress) {
+        return;
+    }
+
+    // Once the last item was written, the transfer is complete
+    if (mProtocolState == Finished && mClosingItems.isEmpty()) {
+        setSuccess(true);
+    } else {
+        updateReceiving();
+    }
+}
+
 void TransferPrivate::onTimeout()
 {
-    auto curMs = QDateTime::currentMSecsSinceEpoch();
+    // A monotonic clock is used so that adjustments to the system time do
+    // not produce bogus values
+    qint64 curMs = mElapsedTimer.elapsed();
+    qint64 intervalMs = curMs - mLastInterval;
+    if (intervalMs <= 0) {
+        return;
+    }
 
-    // Use the time that has elapsed since the last interval to check the speed
-    auto newSpeed = static_cast<qint64>(
-        static_cast<double>(mLastIntervalBytesTransferred) /
-        (static_cast<double>(curMs - mLastInterval) / 1000)
+    // Calculate the speed over the interval that just ended
+    mInstantaneousSpeed = static_cast<qint64>(
+        static_cast<double>(mLastIntervalBytesTransferred) * 1000 / intervalMs
     );
 
-    // If the speed differs from the previous value, emit a signal
-    if (newSpeed != mSpeed) {
-        emit q->speedChanged(mSpeed = newSpeed);
+    // Fold it into the moving average, weighting it by the length of the
+    // interval so that late timer events do not skew the result; the first
+    // interval is used as-is to avoid ramping up from zero
+    double newSpeed = mInstantaneousSpeed;
+    if (mLastInterval) {
+        double alpha = 1.0 - std::exp(-static_cast<double>(intervalMs) / SpeedTimeConstant);
+        newSpeed = mSpeed + alpha * (mInstantaneousSpeed - mSpeed);
     }
 
+    // The average covers the entire time the transfer has been running
+    mAverageSpeed = static_cast<qint64>(
+        static_cast<double>(mBytesTransferred) * 1000 / curMs
+    );
+
+    // Emit the signal on every interval, since the other rates and the time
+    // remaining are likely to change even if the smoothed speed does not
+    emit q->speedChanged(mSpeed = static_cast<qint64>(newSpeed));
+
     // Reset the calculation variables
     mLastInterval = curMs;
     mLastIntervalBytesTransferred = 0;
@@ -472,9 +886,44 @@ qint64 Transfer::speed() const
     return d->mSpeed;
 }
 
+qint64 Transfer::instantaneousSpeed() const
+{
+    return d->mInstantaneousSpeed;
+}
+
+qint64 Transfer::averageSpeed() const
+{
+    return d->mAverageSpeed;
+}
+
+qint64 Transfer::timeRemaining() const
+{
+    qint64 remaining = bytesRemaining();
+    if (remaining < 0 || !d->mSpeed) {
+        return -1;
+    }
+    return (remaining + d->mSpeed - 1) / d->mSpeed;
+}
+
 qint64 Transfer::bytesRemaining() const
 {
-    return d->mBytesTotal - d->mBytesTransferred;
+    return d->mBytesTotal < 0 ? -1 : d->mBytesTotal - d->mBytesTransferred;
+}
+
+QVariantMap Transfer::statistics() const
+{
+    const qint64 NsecsPerMsec = 1000000;
+    return QVariantMap{
+        { "elapsedTime", d->mFinishTime == -1 ? d->mClock.elapsed() : d->mFinishTime },
+        { "bytesTransferred", d->mBytesTransferred },
+        { "packetsSent", d->mPacketsSent },
+        { "packetsReceived", d->mPacketsReceived },
+        { "diskTime", d->mDiskTime / NsecsPerMsec },
+        { "socketTime", d->mSocketTime / NsecsPerMsec },
+        { "peerTime", d->mPeerTime / NsecsPerMsec },
+        { "headerTime", d->mHeaderTime / NsecsPerMsec },
+        { "transport", d->mTransport ? d->mTransport->statistics() : QVariantMap() }
+    };
 }
 
 QString Transfer::deviceName() const
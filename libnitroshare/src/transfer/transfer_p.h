@@ -25,6 +25,8 @@
 #ifndef LIBNITROSHARE_TRANSFER_P_H
 #define LIBNITROSHARE_TRANSFER_P_H
 
+#include <QElapsedTimer>
+#include <QList>
 #include <QObject>
 #include <QTimer>
 
@@ -49,6 +51,7 @@ public:
                     Transport *mTransport,
                     Bundle *mBundle);
 
+    void sendPacket(Packet *packet);
     void sendTransferHeader();
     void sendItemHeader();
     void sendItemContent();
@@ -58,8 +61,13 @@ public:
     void processItemHeader(Packet *packet);
     void processItemContent(Packet *packet);
     void processNext();
+    void finishReceiving();
+    void updateReceiving();
 
     void updateProgress();
+    void addTime(qint64 &total, qint64 &start);
+    void startSpeedTimer();
+    void stopSpeedTimer();
 
     void setSuccess(bool send = false);
     void setError(const QString &message, bool send = false);
@@ -83,6 +91,13 @@ public:
     QString mDeviceName;
     QString mError;
 
+    bool mStreaming;
+    bool mWaitingForItems;
+
+    // Copying items directly from descriptors (once the receiver agrees)
+    bool mCloneOffered;
+    bool mCloneAccepted;
+
     qint32 mItemIndex;
     qint32 mItemCount;
     qint64 mBytesTransferred;
@@ -91,18 +106,44 @@ public:
     Item *mCurrentItem;
     qint64 mCurrentItemBytesTransferred;
     qint64 mCurrentItemBytesTotal;
+    bool mWaitingForData;
+
+    // Received items still writing data in the background
+    QList<Item*> mClosingItems;
+    bool mReceivingPaused;
 
     qint64 mSpeed;
+    qint64 mInstantaneousSpeed;
+    qint64 mAverageSpeed;
     QTimer mSpeedTimer;
+    QElapsedTimer mElapsedTimer;
     qint64 mLastInterval;
     qint64 mLastIntervalBytesTransferred;
 
+    // Detailed statistics, with times measured in nanoseconds
+    QElapsedTimer mClock;
+    qint64 mPacketsSent;
+    qint64 mPacketsReceived;
+    qint64 mDiskTime;
+    qint64 mSocketTime;
+    qint64 mPeerTime;
+    qint64 mHeaderTime;
+    qint64 mDiskWaitStart;
+    qint64 mSocketWaitStart;
+    qint64 mPeerWaitStart;
+    qint64 mFinishTime;
+
 public Q_SLOTS:
 
     void onConnected();
+    void onBundleRowsInserted();
+    void onBundleCompleted();
     void onPacketReceived(Packet *packet);
     void onPacketSent();
     void onError(const QString &message);
+    void onItemReadyRead();
+    void onItemReadyWrite();
+    void onItemClosed();
     void onTimeout();
 };
 
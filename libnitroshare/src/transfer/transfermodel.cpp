@@ -27,10 +27,19 @@
 
 #include "transfermodel_p.h"
 
+// Interval for coalescing changes to transfers into a single signal
+const int UpdateInterval = 100;
+
 TransferModelPrivate::TransferModelPrivate(TransferModel *model)
     : QObject(model),
-      q(model)
+      q(model),
+      firstChangedRow(-1),
+      lastChangedRow(-1)
 {
+    connect(&updateTimer, &QTimer::timeout, this, &TransferModelPrivate::flushDataChanged);
+
+    updateTimer.setInterval(UpdateInterval);
+    updateTimer.setSingleShot(true);
 }
 
 TransferModelPrivate::~TransferModelPrivate()
@@ -42,8 +51,31 @@ TransferModelPrivate::~TransferModelPrivate()
 
 void TransferModelPrivate::sendDataChanged()
 {
-    int row = transfers.indexOf(qobject_cast<Transfer*>(sender()));
-    emit q->dataChanged(q->index(row, 0), q->index(row, 0));
+    // Transfers emit signals far more often than a view can repaint, so the
+    // changed rows are accumulated and reported once per interval
+    int row = rows.value(qobject_cast<Transfer*>(sender()), -1);
+    if (row == -1) {
+        return;
+    }
+    if (firstChangedRow == -1) {
+        firstChangedRow = lastChangedRow = row;
+        updateTimer.start();
+    } else {
+        firstChangedRow = qMin(firstChangedRow, row);
+        lastChangedRow = qMax(lastChangedRow, row);
+    }
+}
+
+void TransferModelPrivate::flushDataChanged()
+{
+    updateTimer.stop();
+
+    if (firstChangedRow != -1) {
+        QModelIndex topLeft = q->index(firstChangedRow, 0);
+        QModelIndex bottomRight = q->index(lastChangedRow, 0);
+        firstChangedRow = lastChangedRow = -1;
+        emit q->dataChanged(topLeft, bottomRight);
+    }
 }
 
 TransferModel::TransferModel(QObject *parent)
@@ -56,10 +88,12 @@ void TransferModel::add(Transfer *transfer)
 {
     connect(transfer, &Transfer::stateChanged, d, &TransferModelPrivate::sendDataChanged);
     connect(transfer, &Transfer::progressChanged, d, &TransferModelPrivate::sendDataChanged);
+    connect(transfer, &Transfer::speedChanged, d, &TransferModelPrivate::sendDataChanged);
     connect(transfer, &Transfer::deviceNameChanged, d, &TransferModelPrivate::sendDataChanged);
     connect(transfer, &Transfer::errorChanged, d, &TransferModelPrivate::sendDataChanged);
 
     beginInsertRows(QModelIndex(), d->transfers.count(), d->transfers.count());
+    d->rows.insert(transfer, d->transfers.count());
     d->transfers.append(transfer);
     endInsertRows();
 }
@@ -69,8 +103,16 @@ void TransferModel::dismiss(int index)
     if (index >= 0 && index < d->transfers.count()) {
         Transfer *transfer = d->transfers.at(index);
         if (transfer->isFinished()) {
+
+            // Pending changes refer to row numbers that are about to shift
+            d->flushDataChanged();
+
             beginRemoveRows(QModelIndex(), index, index);
+            d->rows.remove(transfer);
             d->transfers.removeAt(index);
+            for (int i = index; i < d->transfers.count(); ++i) {
+                d->rows.insert(d->transfers.at(i), i);
+            }
             endRemoveRows();
             delete transfer;
         }
@@ -25,8 +25,10 @@
 #ifndef LIBNITROSHARE_TRANSFERMODEL_P_H
 #define LIBNITROSHARE_TRANSFERMODEL_P_H
 
+#include <QHash>
 #include <QList>
 #include <QObject>
+#include <QTimer>
 
 class Transfer;
 class TransferModel;
@@ -43,10 +45,17 @@ public:
     TransferModel *const q;
 
     QList<Transfer*> transfers;
+    QHash<Transfer*, int> rows;
+
+    // Range of rows changed since dataChanged() was last emitted
+    int firstChangedRow;
+    int lastChangedRow;
+    QTimer updateTimer;
 
 public Q_SLOTS:
 
     void sendDataChanged();
+    void flushDataChanged();
 };
 
 #endif // LIBNITROSHARE_TRANSFERMODEL_P_H
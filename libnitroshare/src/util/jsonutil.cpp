@@ -22,42 +22,218 @@
  * IN THE SOFTWARE.
  */
 
+#include <cmath>
+
+#include <QHash>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QMetaObject>
+#include <QMetaProperty>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QVariant>
+#include <QVector>
 
 #include <nitroshare/jsonutil.h>
-#include <nitroshare/qtutil.h>
+
+// Largest integer that can be stored exactly in a double
+const double MaxExactInteger = 9007199254740992.0;
+
+/**
+ * @brief Properties of a class that are included in its JSON representation
+ *
+ * Finding each property by name for every object is expensive and this is
+ * done for every item sent, so the properties are collected once per class
+ * and read directly afterwards.
+ */
+struct PropertyTable
+{
+    QByteArray className;
+    QVector<QString> names;
+    QVector<QMetaProperty> properties;
+};
+
+static QMutex propertyTablesMutex;
+static QHash<const QMetaObject*, PropertyTable> propertyTables;
+
+static PropertyTable propertyTable(const QMetaObject *metaObject)
+{
+    QMutexLocker locker(&propertyTablesMutex);
+
+    // A class from a plugin that was unloaded may share its address with a
+    // class loaded later, so the name must match as well
+    PropertyTable &table = propertyTables[metaObject];
+    if (table.className != metaObject->className()) {
+        table.className = metaObject->className();
+        table.names.clear();
+        table.properties.clear();
+
+        // The first property (objectName) is skipped
+        for (int i = 1; i < metaObject->propertyCount(); ++i) {
+            QMetaProperty property = metaObject->property(i);
+            table.names.append(QString::fromUtf8(property.name()));
+            table.properties.append(property);
+        }
+    }
+
+    // The vectors are implicitly shared, making the copy inexpensive
+    return table;
+}
+
+static QJsonValue toJsonValue(const QVariant &value)
+{
+    if (value.userType() == QMetaType::LongLong) {
+        return QString::number(value.toLongLong());
+    }
+    return QJsonValue::fromVariant(value);
+}
+
+static void appendString(QByteArray &json, const QString &string)
+{
+    QByteArray utf8 = string.toUtf8();
+    json.reserve(json.size() + utf8.size() + 2);
+    json.append('"');
+    for (int i = 0; i < utf8.size(); ++i) {
+        const char c = utf8.at(i);
+        switch (c) {
+        case '"':
+            json.append("\\\"");
+            break;
+        case '\\':
+            json.append("\\\\");
+            break;
+        case '\b':
+            json.append("\\b");
+            break;
+        case '\f':
+            json.append("\\f");
+            break;
+        case '\n':
+            json.append("\\n");
+            break;
+        case '\r':
+            json.append("\\r");
+            break;
+        case '\t':
+            json.append("\\t");
+            break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                json.append("\\u00");
+                json.append("0123456789abcdef"[c >> 4]);
+                json.append("0123456789abcdef"[c & 0xf]);
+            } else {
+                json.append(c);
+            }
+        }
+    }
+    json.append('"');
+}
+
+static bool isInteger(const QByteArray &data)
+{
+    int start = data.startsWith('-') ? 1 : 0;
+
+    // Leading zeros are not permitted and long values may lose precision
+    if (data.size() == start || data.size() - start > 15 ||
+            (data.at(start) == '0' && data.size() - start > 1)) {
+        return false;
+    }
+    for (int i = start; i < data.size(); ++i) {
+        if (data.at(i) < '0' || data.at(i) > '9') {
+            return false;
+        }
+    }
+    return true;
+}
+
+static QJsonValue parsed(const QJsonValue &value, QJsonParseError *parseError)
+{
+    if (parseError) {
+        parseError->offset = 0;
+        parseError->error = QJsonParseError::NoError;
+    }
+    return value;
+}
 
 QJsonObject JsonUtil::objectToJson(QObject *object)
 {
     QJsonObject jsonObject;
-    auto properties = QtUtil::properties(object);
-    for (auto i = properties.begin(); i != properties.end(); ++i) {
-        if (i.value().type() == QVariant::LongLong) {
-            i.value().setValue(QString::number(i.value().toLongLong()));
+    PropertyTable table = propertyTable(object->metaObject());
+    for (int i = 0; i < table.properties.count(); ++i) {
+        jsonObject.insert(table.names.at(i), toJsonValue(table.properties.at(i).read(object)));
+    }
+    foreach (const QByteArray &name, object->dynamicPropertyNames()) {
+        if (!name.startsWith("_q_")) {
+            jsonObject.insert(QString::fromUtf8(name), toJsonValue(object->property(name)));
         }
-        jsonObject.insert(i.key(), QJsonValue::fromVariant(i.value()));
     }
     return jsonObject;
 }
 
-QByteArray JsonUtil::jsonValueToByteArray(const QJsonValue &value)
+QByteArray JsonUtil::jsonValueToByteArray(const QJsonValue &value, QJsonDocument::JsonFormat format)
 {
+    // Scalars are written directly rather than as part of an array
     switch (value.type()) {
     case QJsonValue::Array:
-        return QJsonDocument(value.toArray()).toJson().trimmed();
+        return format == QJsonDocument::Compact ?
+            QJsonDocument(value.toArray()).toJson(format) :
+            QJsonDocument(value.toArray()).toJson(format).trimmed();
     case QJsonValue::Object:
-        return QJsonDocument(value.toObject()).toJson().trimmed();
-    default:
+        return format == QJsonDocument::Compact ?
+            QJsonDocument(value.toObject()).toJson(format) :
+            QJsonDocument(value.toObject()).toJson(format).trimmed();
+    case QJsonValue::Bool:
+        return value.toBool() ? "true" : "false";
+    case QJsonValue::String:
     {
-        QByteArray json = QJsonDocument(QJsonArray{value}).toJson().trimmed();
-        return json.mid(1, json.length() - 2).trimmed();
+        QByteArray json;
+        appendString(json, value.toString());
+        return json;
     }
+    case QJsonValue::Double:
+    {
+        // Only integers are written directly since formatting other numbers
+        // the same way as QJsonDocument depends on the version of Qt
+        double number = value.toDouble();
+        if (number == std::floor(number) && std::fabs(number) < MaxExactInteger) {
+            return QByteArray::number(static_cast<qint64>(number));
+        }
+        QByteArray json = QJsonDocument(QJsonArray{value}).toJson(QJsonDocument::Compact);
+        return json.mid(1, json.length() - 2);
+    }
+    default:
+        return "null";
     }
 }
 
 QJsonValue JsonUtil::byteArrayToJsonValue(const QByteArray &data, QJsonParseError *parseError)
 {
+    QByteArray trimmed = data.trimmed();
+
+    // Objects and arrays are valid documents on their own
+    if (trimmed.startsWith('{') || trimmed.startsWith('[')) {
+        QJsonDocument document = QJsonDocument::fromJson(data, parseError);
+        if (document.isObject()) {
+            return document.object();
+        }
+        if (document.isArray()) {
+            return document.array();
+        }
+        return QJsonValue(QJsonValue::Undefined);
+    }
+
+    // Literals and integers are converted directly
+    if (trimmed == "null") {
+        return parsed(QJsonValue(QJsonValue::Null), parseError);
+    }
+    if (trimmed == "true" || trimmed == "false") {
+        return parsed(QJsonValue(trimmed == "true"), parseError);
+    }
+    if (isInteger(trimmed)) {
+        return parsed(QJsonValue(static_cast<double>(trimmed.toLongLong())), parseError);
+    }
+
+    // Anything else (strings need unescaping) is parsed as an array element
     return QJsonDocument::fromJson("[" + data + "]", parseError).array().at(0);
 }
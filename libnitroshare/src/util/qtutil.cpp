@@ -32,8 +32,12 @@ QVariantMap QtUtil::properties(const QObject *object)
     QVariantMap propertyMap;
     for (int i = 1; i < object->metaObject()->propertyCount(); ++i) {
         auto property = object->metaObject()->property(i);
-        auto name = property.name();
-        propertyMap.insert(name, object->property(name));
+        propertyMap.insert(property.name(), property.read(object));
+    }
+    foreach (const QByteArray &name, object->dynamicPropertyNames()) {
+        if (!name.startsWith("_q_")) {
+            propertyMap.insert(name, object->property(name));
+        }
     }
     return propertyMap;
 }
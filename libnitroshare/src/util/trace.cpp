@@ -0,0 +1,161 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <atomic>
+#include <chrono>
+
+#include <QAtomicInteger>
+#include <QAtomicPointer>
+#include <QCoreApplication>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <nitroshare/trace.h>
+
+// Number of spans kept for each thread
+const quint64 BufferSize = 65536;
+
+// Each slot is a seqlock: the sequence is cleared while the slot is being
+// rewritten and then set to the number of the event (plus one) it holds
+struct TraceEvent
+{
+    QAtomicInteger<quint64> sequence;
+    QAtomicPointer<const char> name;
+    QAtomicInteger<qint64> start;
+    QAtomicInteger<qint64> end;
+};
+
+struct TraceBuffer
+{
+    int threadId;
+
+    // Only the owning thread writes to the buffer; the count is published
+    // after each event is written
+    QAtomicInteger<quint64> count;
+    TraceEvent events[BufferSize];
+};
+
+static QAtomicInt traceEnabled;
+
+// Buffers are kept after their thread exits so that the spans remain
+// available; the mutex is only taken when a thread records its first span
+static QMutex bufferMutex;
+static QList<TraceBuffer*> buffers;
+
+static thread_local TraceBuffer *threadBuffer = nullptr;
+
+bool Trace::isEnabled()
+{
+    return traceEnabled.load();
+}
+
+void Trace::setEnabled(bool enabled)
+{
+    traceEnabled.store(enabled);
+}
+
+qint64 Trace::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+void Trace::record(const char *name, qint64 start, qint64 end)
+{
+    if (!threadBuffer) {
+        threadBuffer = new TraceBuffer;
+        threadBuffer->count.store(0);
+
+        QMutexLocker locker(&bufferMutex);
+        threadBuffer->threadId = buffers.count() + 1;
+        buffers.append(threadBuffer);
+    }
+
+    quint64 count = threadBuffer->count.load();
+    TraceEvent &event = threadBuffer->events[count % BufferSize];
+
+    event.sequence.store(0);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name.store(name);
+    event.start.store(start);
+    event.end.store(end);
+    event.sequence.storeRelease(count + 1);
+
+    threadBuffer->count.storeRelease(count + 1);
+}
+
+QByteArray Trace::toJson()
+{
+    QByteArray pid = QByteArray::number(QCoreApplication::applicationPid());
+    QByteArray json = "{\"traceEvents\":[";
+    bool first = true;
+
+    QMutexLocker locker(&bufferMutex);
+    foreach (TraceBuffer *buffer, buffers) {
+        quint64 count = buffer->count.loadAcquire();
+        quint64 i = count > BufferSize ? count - BufferSize : 0;
+        QByteArray tid = QByteArray::number(buffer->threadId);
+        for (; i < count; ++i) {
+            const TraceEvent &event = buffer->events[i % BufferSize];
+
+            // Once the ring wraps, the owning thread may be rewriting the
+            // oldest slots - skip any that do not hold the same event before
+            // and after they are read
+            quint64 sequence = event.sequence.loadAcquire();
+            if (sequence != i + 1) {
+                continue;
+            }
+            const char *name = event.name.load();
+            qint64 start = event.start.load();
+            qint64 end = event.end.load();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (event.sequence.load() != sequence) {
+                continue;
+            }
+
+            if (!first) {
+                json.append(',');
+            }
+            first = false;
+
+            // Timestamps are in microseconds
+            json.append("{\"name\":\"");
+            json.append(name);
+            json.append("\",\"ph\":\"X\",\"ts\":");
+            json.append(QByteArray::number(start / 1000.0, 'f', 3));
+            json.append(",\"dur\":");
+            json.append(QByteArray::number((end - start) / 1000.0, 'f', 3));
+            json.append(",\"pid\":");
+            json.append(pid);
+            json.append(",\"tid\":");
+            json.append(tid);
+            json.append('}');
+        }
+    }
+
+    json.append("]}");
+    return json;
+}
@@ -22,6 +22,7 @@
  * IN THE SOFTWARE.
  */
 
+#include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonValue>
 #include <QTest>
@@ -69,8 +70,11 @@ private slots:
 
     void testObjectToJson();
     void testLongLongConversion();
+    void testDynamicProperties();
     void testJsonConversion_data();
     void testJsonConversion();
+    void testCompactConversion();
+    void testParseError();
 };
 
 void TestJsonUtil::testObjectToJson()
@@ -94,6 +98,18 @@ void TestJsonUtil::testLongLongConversion()
     QCOMPARE(object, referenceObject);
 }
 
+void TestJsonUtil::testDynamicProperties()
+{
+    Parent parent;
+    parent.setProperty("dynamic", ChildValue);
+    QJsonObject object = JsonUtil::objectToJson(&parent);
+    QJsonObject referenceObject{
+        { "parent", ParentValue },
+        { "dynamic", ChildValue }
+    };
+    QCOMPARE(object, referenceObject);
+}
+
 void TestJsonUtil::testJsonConversion_data()
 {
     QTest::addColumn<QJsonValue>("value");
@@ -103,6 +119,11 @@ void TestJsonUtil::testJsonConversion_data()
     QTest::newRow("number") << QJsonValue(1) << QByteArray("1");
     QTest::newRow("bool") << QJsonValue(false) << QByteArray("false");
     QTest::newRow("string") << QJsonValue("abc") << QByteArray("\"abc\"");
+    QTest::newRow("negative") << QJsonValue(-12) << QByteArray("-12");
+    QTest::newRow("fraction") << QJsonValue(1.5) << QByteArray("1.5");
+    QTest::newRow("escaped") << QJsonValue("a\"b\\c\n\x01") << QByteArray("\"a\\\"b\\\\c\\n\\u0001\"");
+    QTest::newRow("unicode") << QJsonValue(QString::fromUtf8("\xc3\xa9")) << QByteArray("\"\xc3\xa9\"");
+    QTest::newRow("object") << QJsonValue(QJsonObject{{ "a", 1 }}) << QByteArray("{\n    \"a\": 1\n}");
 }
 
 void TestJsonUtil::testJsonConversion()
@@ -114,5 +135,28 @@ void TestJsonUtil::testJsonConversion()
     QCOMPARE(JsonUtil::byteArrayToJsonValue(data), value);
 }
 
+void TestJsonUtil::testCompactConversion()
+{
+    QJsonValue value(QJsonArray{ 1, QJsonObject{{ "a", "b" }} });
+    QByteArray data("[1,{\"a\":\"b\"}]");
+
+    QCOMPARE(JsonUtil::jsonValueToByteArray(value, QJsonDocument::Compact), data);
+    QCOMPARE(JsonUtil::byteArrayToJsonValue(data), value);
+}
+
+void TestJsonUtil::testParseError()
+{
+    QJsonParseError parseError;
+
+    JsonUtil::byteArrayToJsonValue("{\"a\":", &parseError);
+    QVERIFY(parseError.error != QJsonParseError::NoError);
+
+    JsonUtil::byteArrayToJsonValue("01", &parseError);
+    QVERIFY(parseError.error != QJsonParseError::NoError);
+
+    JsonUtil::byteArrayToJsonValue(" 42 ", &parseError);
+    QCOMPARE(parseError.error, QJsonParseError::NoError);
+}
+
 QTEST_MAIN(TestJsonUtil)
 #include "TestJsonUtil.moc"
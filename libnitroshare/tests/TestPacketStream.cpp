@@ -0,0 +1,120 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QTest>
+
+#include <nitroshare/packet.h>
+#include <nitroshare/packetstream.h>
+
+const QByteArray TestContent = "content";
+
+class TestPacketStream : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void testEncode();
+    void testPartialData();
+    void testMultiplePackets();
+    void testInvalidSize();
+};
+
+void TestPacketStream::testEncode()
+{
+    QByteArray stream;
+    PacketStream::encode(stream, Packet::Json, TestContent);
+
+    // The header consists of the size (including the type) and the type
+    QCOMPARE(stream.size(), PacketStream::HeaderSize + TestContent.size());
+    QCOMPARE(stream.left(PacketStream::HeaderSize),
+        PacketStream::encodeHeader(Packet::Json, TestContent.size()));
+    QCOMPARE(stream.at(0), static_cast<char>(TestContent.size() + 1));
+    QCOMPARE(stream.at(4), static_cast<char>(Packet::Json));
+    QCOMPARE(stream.mid(PacketStream::HeaderSize), TestContent);
+}
+
+void TestPacketStream::testPartialData()
+{
+    QByteArray data;
+    PacketStream::encode(data, Packet::Binary, TestContent);
+
+    // Feed the packet one byte at a time
+    PacketStream stream;
+    char type;
+    QByteArray content;
+    for (int i = 0; i < data.size() - 1; ++i) {
+        stream.addData(data.mid(i, 1));
+        QVERIFY(!stream.readPacket(&type, &content));
+    }
+    stream.addData(data.right(1));
+    QVERIFY(stream.readPacket(&type, &content));
+    QCOMPARE(type, static_cast<char>(Packet::Binary));
+    QCOMPARE(content, TestContent);
+    QVERIFY(!stream.readPacket(&type, &content));
+    QVERIFY(!stream.hasError());
+}
+
+void TestPacketStream::testMultiplePackets()
+{
+    QByteArray data;
+    PacketStream::encode(data, Packet::Json, TestContent);
+    PacketStream::encode(data, Packet::Success, QByteArray());
+    PacketStream::encode(data, Packet::Binary, TestContent);
+
+    // Split the data in the middle of the last packet
+    PacketStream stream;
+    stream.addData(data.left(data.size() - 2));
+
+    char type;
+    QByteArray content;
+    QVERIFY(stream.readPacket(&type, &content));
+    QCOMPARE(type, static_cast<char>(Packet::Json));
+    QVERIFY(stream.readPacket(&type, &content));
+    QCOMPARE(type, static_cast<char>(Packet::Success));
+    QVERIFY(content.isEmpty());
+    QVERIFY(!stream.readPacket(&type, &content));
+
+    stream.addData(data.right(2));
+    QVERIFY(stream.readPacket(&type, &content));
+    QCOMPARE(type, static_cast<char>(Packet::Binary));
+    QCOMPARE(content, TestContent);
+}
+
+void TestPacketStream::testInvalidSize()
+{
+    PacketStream stream;
+    stream.addData(QByteArray(PacketStream::HeaderSize, 0));
+
+    char type;
+    QByteArray content;
+    QVERIFY(!stream.readPacket(&type, &content));
+    QVERIFY(stream.hasError());
+
+    stream.clear();
+    QVERIFY(!stream.hasError());
+}
+
+QTEST_MAIN(TestPacketStream)
+#include "TestPacketStream.moc"
@@ -37,6 +37,7 @@
 #include "mock/mockdevice.h"
 #include "mock/mockhandler.h"
 #include "mock/mockitem.h"
+#include "mock/mockitemprovider.h"
 #include "mock/mocktransport.h"
 #include "mock/mocktransportserver.h"
 
@@ -53,7 +54,17 @@ private slots:
     void initTestCase();
 
     void testSending();
+    void testSendingAsync();
+    void testPrefetch();
+    void testIncompleteBundle();
+    void testItemProvider();
+    void testDescriptor();
+    void testSendingStream();
     void testReceiving();
+    void testReceivingStream();
+    void testReceivingBackpressure();
+    void testReceivingCloneOffer();
+    void testReceivingResizedItem();
     void testAbort();
 
 private:
@@ -140,6 +151,157 @@ void TestTransfer::testSending()
     QVERIFY(transport->isClosed());
 }
 
+void TestTransfer::testSendingAsync()
+{
+    MockDevice device;
+    MockItem *item = new MockItem;
+    Bundle *bundle = new Bundle;
+    bundle->add(item);
+    Transfer transfer(mApplication.application(), &device, bundle);
+
+    // Indicate that the item has no data ready
+    item->setReadyRead(false);
+
+    MockTransport *transport = device.transport();
+    transport->emitConnected();
+
+    // Only the transfer & item headers should be sent
+    QTRY_COMPARE(transport->packets().count(), 2);
+    QTest::qWait(100);
+    QCOMPARE(transport->packets().count(), 2);
+
+    // Once data is available, the payload should be sent
+    item->emitReadyRead();
+    QTRY_COMPARE(transport->packets().count(), 3);
+    QCOMPARE(transport->packets().at(2).first, Packet::Binary);
+    QCOMPARE(transport->packets().at(2).second, MockItem::Data);
+    QCOMPARE(transfer.progress(), 100);
+}
+
+void TestTransfer::testPrefetch()
+{
+    MockDevice device;
+    MockItem *item1 = new MockItem;
+    MockItem *item2 = new MockItem;
+    Bundle *bundle = new Bundle;
+    bundle->add(item1);
+    bundle->add(item2);
+    Transfer transfer(mApplication.application(), &device, bundle);
+
+    // Prevent the first item from completing
+    item1->setReadyRead(false);
+
+    MockTransport *transport = device.transport();
+    transport->emitConnected();
+
+    // Once the first item is being sent, the second should be prefetched
+    QTRY_COMPARE(transport->packets().count(), 2);
+    QVERIFY(!item1->isPrefetched());
+    QVERIFY(item2->isPrefetched());
+}
+
+void TestTransfer::testIncompleteBundle()
+{
+    MockDevice device;
+    Bundle *bundle = new Bundle;
+    bundle->setComplete(false);
+    Transfer transfer(mApplication.application(), &device, bundle);
+
+    MockTransport *transport = device.transport();
+    transport->emitConnected();
+
+    // Nothing should be sent until the bundle is complete
+    QTest::qWait(100);
+    QCOMPARE(transport->packets().count(), 0);
+
+    // Add an item and complete the bundle
+    bundle->add(new MockItem);
+    bundle->setComplete(true);
+
+    // The transfer header should include the item added
+    QTRY_COMPARE(transport->packets().count(), 3);
+    QJsonObject transferHeader = QJsonDocument::fromJson(transport->packets().at(0).second).object();
+    QCOMPARE(transferHeader.value("count").toString(), QString::number(1));
+    QCOMPARE(transferHeader.value("size").toString(), QString::number(MockItem::Data.size()));
+}
+
+void TestTransfer::testItemProvider()
+{
+    MockDevice device;
+    MockItemProvider *provider = new MockItemProvider(2);
+    Bundle *bundle = new Bundle;
+    bundle->add(provider);
+    Transfer transfer(mApplication.application(), &device, bundle);
+
+    // Items should not be created until they are needed
+    QCOMPARE(bundle->rowCount(), 2);
+    QCOMPARE(bundle->totalSize(), static_cast<qint64>(2 * MockItem::Data.size()));
+    QCOMPARE(provider->itemsCreated(), 0);
+
+    MockTransport *transport = device.transport();
+    transport->emitConnected();
+
+    // Both items should be sent and released afterwards
+    QTRY_COMPARE(transport->packets().count(), 5);
+    QCOMPARE(provider->itemsCreated(), 2);
+    QTRY_COMPARE(provider->itemsAlive(), 0);
+    QCOMPARE(transfer.progress(), 100);
+}
+
+void TestTransfer::testDescriptor()
+{
+    MockDevice device;
+    MockItem *item = new MockItem;
+    item->setProperty("descriptor", 42);
+    Bundle *bundle = new Bundle;
+    bundle->add(item);
+    Transfer transfer(mApplication.application(), &device, bundle);
+
+    MockTransport *transport = device.transport();
+    transport->emitConnected();
+
+    // The descriptor should accompany the item header instead of being in it
+    QTRY_COMPARE(transport->packets().count(), 3);
+    QJsonObject itemHeader = QJsonDocument::fromJson(transport->packets().at(1).second).object();
+    QVERIFY(!itemHeader.contains("descriptor"));
+    QCOMPARE(transport->descriptors().at(0), -1);
+    QCOMPARE(transport->descriptors().at(1), 42);
+    QCOMPARE(transport->descriptors().at(2), -1);
+}
+
+void TestTransfer::testSendingStream()
+{
+    MockDevice device;
+    Bundle *bundle = new Bundle;
+    bundle->setStreaming(true);
+    bundle->setComplete(false);
+    bundle->add(new MockItem);
+    Transfer transfer(mApplication.application(), &device, bundle);
+
+    MockTransport *transport = device.transport();
+    transport->emitConnected();
+
+    // The item should be sent even though the bundle is incomplete
+    QTRY_COMPARE(transport->packets().count(), 3);
+    QJsonObject transferHeader = QJsonDocument::fromJson(transport->packets().at(0).second).object();
+    QVERIFY(transferHeader.value("streaming").toBool());
+    QVERIFY(!transferHeader.contains("count"));
+    QCOMPARE(transfer.bytesRemaining(), static_cast<qint64>(-1));
+    QCOMPARE(transfer.timeRemaining(), static_cast<qint64>(-1));
+
+    // The item should be removed from the bundle once sent
+    QCOMPARE(bundle->rowCount(), 0);
+
+    // Completing the bundle should send the end packet
+    bundle->setComplete(true);
+    QTRY_COMPARE(transport->packets().count(), 4);
+    QCOMPARE(transport->packets().at(3).first, Packet::End);
+    QCOMPARE(transfer.progress(), 100);
+
+    transport->sendData(Packet::Success);
+    QCOMPARE(transfer.state(), Transfer::Succeeded);
+}
+
 void TestTransfer::testReceiving()
 {
     MockTransport *transport = new MockTransport;
@@ -190,6 +352,134 @@ void TestTransfer::testReceiving()
     QCOMPARE(transport->packets().count(), 1);
     QCOMPARE(transport->packets().at(0).first, Packet::Success);
     QVERIFY(transport->isClosed());
+
+    // Ensure the packets were counted
+    QVariantMap statistics = transfer.statistics();
+    QCOMPARE(statistics.value("packetsReceived").toLongLong(), static_cast<qint64>(3));
+    QCOMPARE(statistics.value("packetsSent").toLongLong(), static_cast<qint64>(1));
+    QCOMPARE(statistics.value("bytesTransferred").toLongLong(), static_cast<qint64>(MockItem::Data.size()));
+}
+
+void TestTransfer::testReceivingStream()
+{
+    MockTransport *transport = new MockTransport;
+    Transfer transfer(mApplication.application(), transport);
+
+    // Send a transfer header without a count or size
+    QJsonObject transferHeader{
+        { "name", MockDevice::Name },
+        { "streaming", true }
+    };
+    transport->sendData(Packet::Json, QJsonDocument(transferHeader).toJson());
+
+    // Send two items
+    QJsonObject itemHeader{
+        { "name", MockItem::Name },
+        { "type", MockItem::Type },
+        { "size", QString::number(MockItem::Data.size()) }
+    };
+    for (int i = 0; i < 2; ++i) {
+        transport->sendData(Packet::Json, QJsonDocument(itemHeader).toJson());
+        transport->sendData(Packet::Binary, MockItem::Data);
+    }
+
+    QCOMPARE(transfer.state(), Transfer::InProgress);
+    QCOMPARE(transfer.bytesRemaining(), static_cast<qint64>(-1));
+    QCOMPARE(transfer.timeRemaining(), static_cast<qint64>(-1));
+
+    // The end packet should complete the transfer
+    transport->sendData(Packet::End);
+    QCOMPARE(transfer.state(), Transfer::Succeeded);
+    QCOMPARE(transport->packets().count(), 1);
+    QCOMPARE(transport->packets().at(0).first, Packet::Success);
+}
+
+void TestTransfer::testReceivingBackpressure()
+{
+    MockTransport *transport = new MockTransport;
+    Transfer transfer(mApplication.application(), transport);
+
+    // Send a single item that arrives in two packets
+    QJsonObject transferHeader{
+        { "name", MockDevice::Name },
+        { "size", QString::number(2 * MockItem::Data.size()) },
+        { "count", QString::number(1) }
+    };
+    transport->sendData(Packet::Json, QJsonDocument(transferHeader).toJson());
+    QJsonObject itemHeader{
+        { "name", MockItem::Name },
+        { "type", MockItem::Type },
+        { "size", QString::number(2 * MockItem::Data.size()) }
+    };
+    transport->sendData(Packet::Json, QJsonDocument(itemHeader).toJson());
+
+    // Have the item fall behind and finish closing in the background
+    MockItem *item = mHandler.lastItem();
+    item->setReadyWrite(false);
+    item->setClosed(false);
+
+    // Reading from the peer should pause until the item catches up
+    transport->sendData(Packet::Binary, MockItem::Data);
+    QVERIFY(transport->isReceivingPaused());
+    item->emitReadyWrite();
+    QVERIFY(!transport->isReceivingPaused());
+
+    // The transfer should not succeed until the item is closed
+    transport->sendData(Packet::Binary, MockItem::Data);
+    QCOMPARE(transfer.state(), Transfer::InProgress);
+    QCOMPARE(transport->packets().count(), 0);
+    item->emitClosed();
+    QCOMPARE(transfer.state(), Transfer::Succeeded);
+    QCOMPARE(transport->packets().count(), 1);
+    QCOMPARE(transport->packets().at(0).first, Packet::Success);
+}
+
+void TestTransfer::testReceivingCloneOffer()
+{
+    MockTransport *transport = new MockTransport;
+    Transfer transfer(mApplication.application(), transport);
+
+    // Offer to copy items directly
+    QJsonObject transferHeader{
+        { "name", MockDevice::Name },
+        { "size", QString::number(MockItem::Data.size()) },
+        { "count", QString::number(1) },
+        { "clone", true }
+    };
+    transport->sendData(Packet::Json, QJsonDocument(transferHeader).toJson());
+
+    // The mock transport cannot pass descriptors, so the offer is declined
+    QCOMPARE(transport->packets().count(), 1);
+    QCOMPARE(transport->packets().at(0).first, Packet::Json);
+    QJsonObject reply = QJsonDocument::fromJson(transport->packets().at(0).second).object();
+    QCOMPARE(reply.value("clone").toBool(), false);
+    QCOMPARE(transfer.state(), Transfer::InProgress);
+}
+
+void TestTransfer::testReceivingResizedItem()
+{
+    MockTransport *transport = new MockTransport;
+    Transfer transfer(mApplication.application(), transport);
+
+    // The transfer header counts the item before it shrank
+    QJsonObject transferHeader{
+        { "name", MockDevice::Name },
+        { "size", QString::number(2 * MockItem::Data.size()) },
+        { "count", QString::number(1) }
+    };
+    transport->sendData(Packet::Json, QJsonDocument(transferHeader).toJson());
+    QJsonObject itemHeader{
+        { "name", MockItem::Name },
+        { "type", MockItem::Type },
+        { "size", QString::number(MockItem::Data.size()) },
+        { "expectedSize", QString::number(2 * MockItem::Data.size()) }
+    };
+    transport->sendData(Packet::Json, QJsonDocument(itemHeader).toJson());
+    QCOMPARE(transfer.bytesRemaining(), static_cast<qint64>(MockItem::Data.size()));
+
+    transport->sendData(Packet::Binary, MockItem::Data);
+    QCOMPARE(transfer.progress(), 100);
+    QCOMPARE(transfer.state(), Transfer::Succeeded);
 }
 
 void TestTransfer::testAbort()
@@ -0,0 +1,107 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QList>
+#include <QSignalSpy>
+#include <QTest>
+
+#include <nitroshare/transfer.h>
+#include <nitroshare/transfermodel.h>
+
+#include "mock/mockapplication.h"
+#include "mock/mocktransport.h"
+
+// Number of transfers used for measuring signal dispatch
+const int TransferCount = 1000;
+
+class TestTransferModel : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void init();
+    void cleanup();
+
+    void testBatching();
+    void testDispatch();
+
+private:
+
+    MockApplication mApplication;
+    TransferModel *mModel;
+    QList<Transfer*> mTransfers;
+};
+
+void TestTransferModel::init()
+{
+    mModel = new TransferModel;
+    for (int i = 0; i < TransferCount; ++i) {
+        Transfer *transfer = new Transfer(mApplication.application(), new MockTransport);
+        mModel->add(transfer);
+        mTransfers.append(transfer);
+    }
+}
+
+void TestTransferModel::cleanup()
+{
+    delete mModel;
+    mTransfers.clear();
+}
+
+void TestTransferModel::testBatching()
+{
+    QSignalSpy dataChangedSpy(mModel, &TransferModel::dataChanged);
+
+    // Changes to every transfer should not result in an immediate signal
+    foreach (Transfer *transfer, mTransfers) {
+        emit transfer->progressChanged(1);
+    }
+    QCOMPARE(dataChangedSpy.count(), 0);
+
+    // A single signal should be emitted that covers all of the rows
+    QTRY_COMPARE(dataChangedSpy.count(), 1);
+    QCOMPARE(dataChangedSpy.at(0).at(0).toModelIndex().row(), 0);
+    QCOMPARE(dataChangedSpy.at(0).at(1).toModelIndex().row(), TransferCount - 1);
+
+    // Changes to a single transfer should only include its row
+    emit mTransfers.at(TransferCount / 2)->progressChanged(2);
+    QTRY_COMPARE(dataChangedSpy.count(), 2);
+    QCOMPARE(dataChangedSpy.at(1).at(0).toModelIndex().row(), TransferCount / 2);
+    QCOMPARE(dataChangedSpy.at(1).at(1).toModelIndex().row(), TransferCount / 2);
+}
+
+void TestTransferModel::testDispatch()
+{
+    // Measure the cost of a progress update from every transfer reaching
+    // the model, which must not grow with the number of rows
+    QBENCHMARK {
+        foreach (Transfer *transfer, mTransfers) {
+            emit transfer->progressChanged(1);
+        }
+    }
+}
+
+QTEST_MAIN(TestTransferModel)
+#include "TestTransferModel.moc"
@@ -25,6 +25,11 @@
 #include "mockhandler.h"
 #include "mockitem.h"
 
+MockHandler::MockHandler()
+    : mLastItem(nullptr)
+{
+}
+
 QString MockHandler::name() const
 {
     return MockItem::Type;
@@ -32,5 +37,10 @@ QString MockHandler::name() const
 
 Item *MockHandler::createItem(const QString &, const QVariantMap &params)
 {
-    return new MockItem(params);
+    return mLastItem = new MockItem(params);
+}
+
+MockItem *MockHandler::lastItem() const
+{
+    return mLastItem;
 }
@@ -29,14 +29,24 @@
 
 #include "config.h"
 
+class MockItem;
+
 class MOCK_EXPORT MockHandler : public Handler
 {
     Q_OBJECT
 
 public:
 
+    MockHandler();
+
     virtual QString name() const;
     virtual Item *createItem(const QString &type, const QVariantMap &params);
+
+    MockItem *lastItem() const;
+
+private:
+
+    MockItem *mLastItem;
 };
 
 #endif // MOCKHANDLER_H
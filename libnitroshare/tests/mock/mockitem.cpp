@@ -31,13 +31,21 @@ const QByteArray MockItem::Data = "data";
 MockItem::MockItem()
     : mName(Name),
       mSize(Data.size()),
-      mData(Data)
+      mData(Data),
+      mReadyRead(true),
+      mReadyWrite(true),
+      mClosed(true),
+      mPrefetched(false)
 {
 }
 
 MockItem::MockItem(const QVariantMap &params)
     : mName(params.value("name").toString()),
-      mSize(params.value("size").toString().toLongLong())
+      mSize(params.value("size").toString().toLongLong()),
+      mReadyRead(true),
+      mReadyWrite(true),
+      mClosed(true),
+      mPrefetched(false)
 {
 }
 
@@ -56,7 +64,65 @@ qint64 MockItem::size() const
     return mSize;
 }
 
+void MockItem::prefetch()
+{
+    mPrefetched = true;
+}
+
+bool MockItem::isReadyRead() const
+{
+    return mReadyRead;
+}
+
 QByteArray MockItem::read()
 {
     return mData;
 }
+
+bool MockItem::isReadyWrite() const
+{
+    return mReadyWrite;
+}
+
+bool MockItem::isClosed() const
+{
+    return mClosed;
+}
+
+bool MockItem::isPrefetched() const
+{
+    return mPrefetched;
+}
+
+void MockItem::setReadyRead(bool readyRead)
+{
+    mReadyRead = readyRead;
+}
+
+void MockItem::emitReadyRead()
+{
+    mReadyRead = true;
+    emit readyRead();
+}
+
+void MockItem::setReadyWrite(bool readyWrite)
+{
+    mReadyWrite = readyWrite;
+}
+
+void MockItem::emitReadyWrite()
+{
+    mReadyWrite = true;
+    emit readyWrite();
+}
+
+void MockItem::setClosed(bool closed)
+{
+    mClosed = closed;
+}
+
+void MockItem::emitClosed()
+{
+    mClosed = true;
+    emit closed();
+}
@@ -47,13 +47,32 @@ public:
     virtual QString type() const;
     virtual QString name() const;
     virtual qint64 size() const;
+    virtual void prefetch();
+    virtual bool isReadyRead() const;
     virtual QByteArray read();
+    virtual bool isReadyWrite() const;
+    virtual bool isClosed() const;
+
+    bool isPrefetched() const;
+
+    void setReadyRead(bool readyRead);
+    void emitReadyRead();
+
+    void setReadyWrite(bool readyWrite);
+    void emitReadyWrite();
+
+    void setClosed(bool closed);
+    void emitClosed();
 
 private:
 
     QString mName;
     qint64 mSize;
     QByteArray mData;
+    bool mReadyRead;
+    bool mReadyWrite;
+    bool mClosed;
+    bool mPrefetched;
 };
 
 #endif // MOCKITEM_H
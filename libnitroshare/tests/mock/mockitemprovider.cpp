@@ -0,0 +1,64 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "mockitem.h"
+#include "mockitemprovider.h"
+
+MockItemProvider::MockItemProvider(int count)
+    : mCount(count)
+{
+}
+
+int MockItemProvider::count() const
+{
+    return mCount;
+}
+
+qint64 MockItemProvider::totalSize() const
+{
+    return mCount * MockItem::Data.size();
+}
+
+Item *MockItemProvider::createItem(int)
+{
+    Item *item = new MockItem;
+    mItems.append(item);
+    return item;
+}
+
+int MockItemProvider::itemsCreated() const
+{
+    return mItems.count();
+}
+
+int MockItemProvider::itemsAlive() const
+{
+    int alive = 0;
+    foreach (const QPointer<Item> &item, mItems) {
+        if (item) {
+            ++alive;
+        }
+    }
+    return alive;
+}
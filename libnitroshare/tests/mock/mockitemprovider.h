@@ -0,0 +1,55 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef MOCKITEMPROVIDER_H
+#define MOCKITEMPROVIDER_H
+
+#include <QList>
+#include <QPointer>
+
+#include <nitroshare/item.h>
+#include <nitroshare/itemprovider.h>
+
+#include "config.h"
+
+class MOCK_EXPORT MockItemProvider : public ItemProvider
+{
+public:
+
+    explicit MockItemProvider(int count);
+
+    virtual int count() const;
+    virtual qint64 totalSize() const;
+    virtual Item *createItem(int index);
+
+    int itemsCreated() const;
+    int itemsAlive() const;
+
+private:
+
+    int mCount;
+    QList<QPointer<Item>> mItems;
+};
+
+#endif // MOCKITEMPROVIDER_H
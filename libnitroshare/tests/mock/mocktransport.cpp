@@ -27,13 +27,15 @@
 #include "mocktransport.h"
 
 MockTransport::MockTransport()
-    : mClosed(false)
+    : mClosed(false),
+      mReceivingPaused(false)
 {
 }
 
 void MockTransport::sendPacket(Packet *packet)
 {
     mPackets.append({ packet->type(), packet->content() });
+    mDescriptors.append(packet->descriptor());
     QMetaObject::invokeMethod(this, "packetSent", Qt::QueuedConnection);
 }
 
@@ -42,16 +44,31 @@ void MockTransport::close()
     mClosed = true;
 }
 
+void MockTransport::setReceivingPaused(bool paused)
+{
+    mReceivingPaused = paused;
+}
+
 const MockTransport::PacketList &MockTransport::packets() const
 {
     return mPackets;
 }
 
+const QList<int> &MockTransport::descriptors() const
+{
+    return mDescriptors;
+}
+
 bool MockTransport::isClosed() const
 {
     return mClosed;
 }
 
+bool MockTransport::isReceivingPaused() const
+{
+    return mReceivingPaused;
+}
+
 void MockTransport::emitConnected()
 {
     emit connected();
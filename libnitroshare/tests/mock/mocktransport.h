@@ -45,9 +45,12 @@ public:
 
     virtual void sendPacket(Packet *packet);
     virtual void close();
+    virtual void setReceivingPaused(bool paused);
 
     const PacketList &packets() const;
+    const QList<int> &descriptors() const;
     bool isClosed() const;
+    bool isReceivingPaused() const;
 
     void emitConnected();
     void sendData(Packet::Type type, const QByteArray &data = QByteArray());
@@ -55,7 +58,9 @@ public:
 private:
 
     PacketList mPackets;
+    QList<int> mDescriptors;
     bool mClosed;
+    bool mReceivingPaused;
 };
 
 #endif // MOCKTRANSPORT_H
@@ -60,17 +60,21 @@ void ActionHandler::process(QHttpEngine::Socket *socket, const QString &path)
             return;
         }
 
-        // Convert the parameters from JSON to a QVariantMap
+        // Convert the parameters from JSON to a QVariantMap; actions that
+        // are polled frequently are usually invoked without any
         QVariantMap params;
-        QJsonDocument document;
-        if (!socket->readJson(document)) {
-            return;
+        if (socket->bytesAvailable()) {
+            QJsonDocument document;
+            if (!socket->readJson(document)) {
+                return;
+            }
+            params = document.object().toVariantMap();
         }
-        params = document.object().toVariantMap();
 
-        // Convert the response to JSON
+        // Convert the response to JSON without any whitespace
         QByteArray json = JsonUtil::jsonValueToByteArray(
-            QJsonValue::fromVariant(action->invoke(params))
+            QJsonValue::fromVariant(action->invoke(params)),
+            QJsonDocument::Compact
         );
 
         // Write the response to the socket
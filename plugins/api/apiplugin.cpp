@@ -29,6 +29,10 @@
 #include "apiplugin.h"
 #include "apiserver.h"
 #include "quitaction.h"
+#ifdef ENABLE_TRACING
+#  include "traceaction.h"
+#endif
+#include "transferstatisticsaction.h"
 #include "versionaction.h"
 
 void ApiPlugin::initialize(Application *application)
@@ -37,10 +41,18 @@ void ApiPlugin::initialize(Application *application)
 
     mActionsAction = new ActionsAction(application);
     mQuitAction = new QuitAction;
+#ifdef ENABLE_TRACING
+    mTraceAction = new TraceAction(application);
+#endif
+    mTransferStatisticsAction = new TransferStatisticsAction(application);
     mVersionAction = new VersionAction;
 
     application->actionRegistry()->add(mActionsAction);
     application->actionRegistry()->add(mQuitAction);
+#ifdef ENABLE_TRACING
+    application->actionRegistry()->add(mTraceAction);
+#endif
+    application->actionRegistry()->add(mTransferStatisticsAction);
     application->actionRegistry()->add(mVersionAction);
 }
 
@@ -48,10 +60,18 @@ void ApiPlugin::cleanup(Application *application)
 {
     application->actionRegistry()->remove(mActionsAction);
     application->actionRegistry()->remove(mQuitAction);
+#ifdef ENABLE_TRACING
+    application->actionRegistry()->remove(mTraceAction);
+#endif
+    application->actionRegistry()->remove(mTransferStatisticsAction);
     application->actionRegistry()->remove(mVersionAction);
 
     delete mActionsAction;
     delete mQuitAction;
+#ifdef ENABLE_TRACING
+    delete mTraceAction;
+#endif
+    delete mTransferStatisticsAction;
     delete mVersionAction;
 
     delete mServer;
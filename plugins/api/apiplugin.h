@@ -25,11 +25,14 @@
 #ifndef APIPLUGIN_H
 #define APIPLUGIN_H
 
+#include <nitroshare/config.h>
 #include <nitroshare/iplugin.h>
 
 class ActionsAction;
 class ApiServer;
 class QuitAction;
+class TraceAction;
+class TransferStatisticsAction;
 class VersionAction;
 
 class Q_DECL_EXPORT ApiPlugin : public IPlugin
@@ -48,6 +51,10 @@ private:
 
     ActionsAction *mActionsAction;
     QuitAction *mQuitAction;
+#ifdef ENABLE_TRACING
+    TraceAction *mTraceAction;
+#endif
+    TransferStatisticsAction *mTransferStatisticsAction;
     VersionAction *mVersionAction;
 };
 
@@ -41,6 +41,7 @@ ApiServer::ApiServer(Application *application)
       mFileHandler(":/api"),
       mServer(&mFileHandler),
       mActionHandler(application),
+      mMetricsHandler(application),
       mApiEnabled({
           { Setting::TypeKey, Setting::Boolean },
           { Setting::NameKey, ApiEnabled },
@@ -50,7 +51,12 @@ ApiServer::ApiServer(Application *application)
 {
     mFileHandler.addRedirect(QRegExp("^$"), "index.html");
     mFileHandler.addSubHandler(QRegExp("^api/"), &mActionHandler);
+    mFileHandler.addSubHandler(QRegExp("^metrics"), &mMetricsHandler);
+
+    // Metrics include device names and log tags, so they require the same
+    // token as the actions
     mActionHandler.addMiddleware(&mAuth);
+    mMetricsHandler.addMiddleware(&mAuth);
 
     // Add the setting for enabling the API and watch for it changing
     mApplication->settingsRegistry()->addSetting(&mApiEnabled);
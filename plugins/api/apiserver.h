@@ -35,6 +35,7 @@
 #include <qhttpengine/server.h>
 
 #include "actionhandler.h"
+#include "metricshandler.h"
 
 class Application;
 
@@ -63,6 +64,7 @@ private:
     QHttpEngine::LocalAuthMiddleware mAuth;
 
     ActionHandler mActionHandler;
+    MetricsHandler mMetricsHandler;
 
     Setting mApiEnabled;
 };
@@ -0,0 +1,279 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QVariantMap>
+
+#include <nitroshare/application.h>
+#include <nitroshare/devicemodel.h>
+#include <nitroshare/logger.h>
+#include <nitroshare/message.h>
+#include <nitroshare/plugin.h>
+#include <nitroshare/pluginmodel.h>
+#include <nitroshare/transfer.h>
+#include <nitroshare/transfermodel.h>
+
+#include "metrics.h"
+
+// Escape a value for use in a label
+static QByteArray label(const QString &value)
+{
+    QByteArray escaped = value.toUtf8();
+    escaped.replace('\\', "\\\\");
+    escaped.replace('"', "\\\"");
+    escaped.replace('\n', "\\n");
+    return '"' + escaped + '"';
+}
+
+// Write the metadata for a metric family
+static void family(QByteArray &output, const QByteArray &name, const QByteArray &type, const QByteArray &help)
+{
+    output.append("# TYPE " + name + " " + type + "\n");
+    output.append("# HELP " + name + " " + help + "\n");
+}
+
+static const char *directionName(int direction)
+{
+    return direction == Transfer::Send ? "send" : "receive";
+}
+
+static const char *levelName(int type)
+{
+    switch (type) {
+    case Message::Debug:
+        return "debug";
+    case Message::Info:
+        return "info";
+    case Message::Warning:
+        return "warning";
+    default:
+        return "error";
+    }
+}
+
+Histogram::Histogram(const QList<double> &bounds)
+    : mBounds(bounds),
+      mCounts(bounds.count()),
+      mCount(0),
+      mSum(0)
+{
+}
+
+void Histogram::observe(double value)
+{
+    for (int i = 0; i < mBounds.count(); ++i) {
+        if (value <= mBounds.at(i)) {
+            ++mCounts[i];
+            break;
+        }
+    }
+    ++mCount;
+    mSum += value;
+}
+
+void Histogram::render(QByteArray &output, const QByteArray &name, const QByteArray &help) const
+{
+    family(output, name, "histogram", help);
+
+    // Buckets are cumulative
+    quint64 cumulative = 0;
+    for (int i = 0; i < mBounds.count(); ++i) {
+        cumulative += mCounts.at(i);
+        output.append(name + "_bucket{le=\"" + QByteArray::number(mBounds.at(i), 'g', 15) +
+                      "\"} " + QByteArray::number(cumulative) + "\n");
+    }
+    output.append(name + "_bucket{le=\"+Inf\"} " + QByteArray::number(mCount) + "\n");
+    output.append(name + "_count " + QByteArray::number(mCount) + "\n");
+    output.append(name + "_sum " + QByteArray::number(mSum, 'g', 15) + "\n");
+}
+
+Metrics::Metrics(Application *application)
+    : mApplication(application),
+      mBytes(),
+      mSucceeded(),
+      mFailed(),
+      mDevicesAdded(0),
+      mDevicesRemoved(0),
+      mTransferDuration({ 1, 5, 15, 60, 300, 900, 3600 }),
+      mItemSize({ 4096, 65536, 1048576, 16777216, 268435456, 4294967296 })
+{
+    connect(mApplication->transferModel(), &TransferModel::rowsInserted, this, &Metrics::onTransfersInserted);
+    connect(mApplication->deviceModel(), &DeviceModel::rowsInserted, this, &Metrics::onDevicesInserted);
+    connect(mApplication->deviceModel(), &DeviceModel::rowsRemoved, this, &Metrics::onDevicesRemoved);
+    connect(mApplication->logger(), &Logger::messageLogged, this, &Metrics::onMessageLogged);
+
+    // Watch transfers that were created before the plugin was loaded
+    int rowCount = mApplication->transferModel()->rowCount();
+    if (rowCount) {
+        onTransfersInserted(QModelIndex(), 0, rowCount - 1);
+    }
+}
+
+QByteArray Metrics::render() const
+{
+    TransferModel *transferModel = mApplication->transferModel();
+
+    // Bytes for transfers in progress are read from the transfers themselves
+    quint64 bytes[2] = { mBytes[0], mBytes[1] };
+    quint64 active[2] = { 0, 0 };
+    QHash<QString, quint64> deviceBytes = mDeviceBytes;
+    QHash<QString, qint64> deviceTime = mDeviceTime;
+    for (int i = 0; i < transferModel->rowCount(); ++i) {
+        Transfer *transfer = transferModel->data(transferModel->index(i, 0), Qt::UserRole).value<Transfer*>();
+        if (!transfer->isFinished()) {
+            QVariantMap statistics = transfer->statistics();
+            quint64 transferred = statistics.value("bytesTransferred").toULongLong();
+            bytes[transfer->direction()] += transferred;
+            ++active[transfer->direction()];
+            deviceBytes[transfer->deviceName()] += transferred;
+            deviceTime[transfer->deviceName()] += statistics.value("elapsedTime").toLongLong();
+        }
+    }
+
+    QByteArray output;
+
+    family(output, "nitroshare_transfer_bytes", "counter", "Bytes sent and received by transfers.");
+    for (int i = 0; i < 2; ++i) {
+        output.append("nitroshare_transfer_bytes_total{direction=\"" + QByteArray(directionName(i)) +
+                      "\"} " + QByteArray::number(bytes[i]) + "\n");
+    }
+
+    family(output, "nitroshare_transfers_active", "gauge", "Transfers currently in progress.");
+    for (int i = 0; i < 2; ++i) {
+        output.append("nitroshare_transfers_active{direction=\"" + QByteArray(directionName(i)) +
+                      "\"} " + QByteArray::number(active[i]) + "\n");
+    }
+
+    family(output, "nitroshare_transfers", "counter", "Transfers that have finished.");
+    for (int i = 0; i < 2; ++i) {
+        output.append("nitroshare_transfers_total{direction=\"" + QByteArray(directionName(i)) +
+                      "\",result=\"succeeded\"} " + QByteArray::number(mSucceeded[i]) + "\n");
+        output.append("nitroshare_transfers_total{direction=\"" + QByteArray(directionName(i)) +
+                      "\",result=\"failed\"} " + QByteArray::number(mFailed[i]) + "\n");
+    }
+
+    mTransferDuration.render(output, "nitroshare_transfer_duration_seconds",
+                             "Time taken by transfers that have finished.");
+    mItemSize.render(output, "nitroshare_item_size_bytes",
+                     "Size of items that were sent or received.");
+
+    // Throughput for each device is the rate of the first divided by the
+    // rate of the second
+    family(output, "nitroshare_device_transfer_bytes", "counter", "Bytes transferred with each device.");
+    for (auto i = deviceBytes.constBegin(); i != deviceBytes.constEnd(); ++i) {
+        output.append("nitroshare_device_transfer_bytes_total{device=" + label(i.key()) +
+                      "} " + QByteArray::number(i.value()) + "\n");
+    }
+    family(output, "nitroshare_device_transfer_seconds", "counter", "Time spent transferring with each device.");
+    for (auto i = deviceTime.constBegin(); i != deviceTime.constEnd(); ++i) {
+        output.append("nitroshare_device_transfer_seconds_total{device=" + label(i.key()) +
+                      "} " + QByteArray::number(i.value() / 1000.0, 'g', 15) + "\n");
+    }
+
+    family(output, "nitroshare_devices", "gauge", "Devices currently discovered.");
+    output.append("nitroshare_devices " +
+                  QByteArray::number(mApplication->deviceModel()->rowCount()) + "\n");
+    family(output, "nitroshare_discovery_events", "counter", "Devices that were discovered or lost.");
+    output.append("nitroshare_discovery_events_total{event=\"added\"} " +
+                  QByteArray::number(mDevicesAdded) + "\n");
+    output.append("nitroshare_discovery_events_total{event=\"removed\"} " +
+                  QByteArray::number(mDevicesRemoved) + "\n");
+
+    family(output, "nitroshare_log_messages", "counter", "Messages logged by level and tag.");
+    for (auto i = mMessages.constBegin(); i != mMessages.constEnd(); ++i) {
+        output.append("nitroshare_log_messages_total{level=\"" + QByteArray(levelName(i.key().first)) +
+                      "\",tag=" + label(i.key().second) + "} " + QByteArray::number(i.value()) + "\n");
+    }
+
+    PluginModel *pluginModel = mApplication->pluginModel();
+    family(output, "nitroshare_plugin_load_seconds", "gauge", "Time taken to load and initialize each plugin.");
+    for (int i = 0; i < pluginModel->rowCount(); ++i) {
+        Plugin *plugin = pluginModel->data(pluginModel->index(i, 0), Qt::UserRole).value<Plugin*>();
+        if (plugin->isLoaded()) {
+            output.append("nitroshare_plugin_load_seconds{plugin=" + label(plugin->name()) +
+                          "} " + QByteArray::number(plugin->loadTime() / 1000000.0, 'g', 15) + "\n");
+        }
+    }
+
+    output.append("# EOF\n");
+    return output;
+}
+
+void Metrics::onTransfersInserted(const QModelIndex &, int first, int last)
+{
+    TransferModel *model = mApplication->transferModel();
+    for (int i = first; i <= last; ++i) {
+        Transfer *transfer = model->data(model->index(i, 0), Qt::UserRole).value<Transfer*>();
+
+        // A transfer may fail before it is even added to the model
+        if (transfer->isFinished()) {
+            recordTransfer(transfer);
+            continue;
+        }
+
+        connect(transfer, &Transfer::itemTransferred, this, [this](qint64 size) {
+            mItemSize.observe(size);
+        });
+        connect(transfer, &Transfer::stateChanged, this, [this, transfer]() {
+            if (transfer->isFinished()) {
+                recordTransfer(transfer);
+            }
+        });
+    }
+}
+
+void Metrics::onDevicesInserted(const QModelIndex &, int first, int last)
+{
+    mDevicesAdded += last - first + 1;
+}
+
+void Metrics::onDevicesRemoved(const QModelIndex &, int first, int last)
+{
+    mDevicesRemoved += last - first + 1;
+}
+
+void Metrics::onMessageLogged(const Message *message)
+{
+    ++mMessages[qMakePair(static_cast<int>(message->type()), message->tag())];
+}
+
+void Metrics::recordTransfer(Transfer *transfer)
+{
+    // Only the first transition to a finished state counts
+    disconnect(transfer, nullptr, this, nullptr);
+
+    QVariantMap statistics = transfer->statistics();
+    quint64 transferred = statistics.value("bytesTransferred").toULongLong();
+    qint64 elapsed = statistics.value("elapsedTime").toLongLong();
+
+    mBytes[transfer->direction()] += transferred;
+    if (transfer->state() == Transfer::Succeeded) {
+        ++mSucceeded[transfer->direction()];
+    } else {
+        ++mFailed[transfer->direction()];
+    }
+
+    mTransferDuration.observe(elapsed / 1000.0);
+    mDeviceBytes[transfer->deviceName()] += transferred;
+    mDeviceTime[transfer->deviceName()] += elapsed;
+}
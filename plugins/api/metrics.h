@@ -0,0 +1,108 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QModelIndex>
+#include <QObject>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+class Application;
+class Message;
+class Transfer;
+
+/**
+ * @brief Histogram with fixed bucket boundaries
+ */
+class Histogram
+{
+public:
+
+    explicit Histogram(const QList<double> &bounds);
+
+    void observe(double value);
+    void render(QByteArray &output, const QByteArray &name, const QByteArray &help) const;
+
+private:
+
+    QList<double> mBounds;
+    QVector<quint64> mCounts;
+    quint64 mCount;
+    double mSum;
+};
+
+/**
+ * @brief Collect metrics for the application in OpenMetrics format
+ *
+ * Counters are updated as transfers, devices, and log messages come and go.
+ * Values that are already tracked elsewhere (such as the number of bytes a
+ * transfer has sent) are read when the metrics are rendered, so nothing is
+ * added to the path that sends and receives data.
+ */
+class Metrics : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit Metrics(Application *application);
+
+    QByteArray render() const;
+
+private slots:
+
+    void onTransfersInserted(const QModelIndex &parent, int first, int last);
+    void onDevicesInserted(const QModelIndex &parent, int first, int last);
+    void onDevicesRemoved(const QModelIndex &parent, int first, int last);
+    void onMessageLogged(const Message *message);
+
+private:
+
+    void recordTransfer(Transfer *transfer);
+
+    Application *mApplication;
+
+    // Indexed by Transfer::Direction
+    quint64 mBytes[2];
+    quint64 mSucceeded[2];
+    quint64 mFailed[2];
+
+    quint64 mDevicesAdded;
+    quint64 mDevicesRemoved;
+
+    QHash<QString, quint64> mDeviceBytes;
+    QHash<QString, qint64> mDeviceTime;
+    QHash<QPair<int, QString>, quint64> mMessages;
+
+    Histogram mTransferDuration;
+    Histogram mItemSize;
+};
+
+#endif // METRICS_H
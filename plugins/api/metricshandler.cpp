@@ -0,0 +1,54 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <qhttpengine/socket.h>
+
+#include "metricshandler.h"
+
+MetricsHandler::MetricsHandler(Application *application)
+    : mMetrics(application)
+{
+}
+
+void MetricsHandler::process(QHttpEngine::Socket *socket, const QString &path)
+{
+    if (!path.isEmpty()) {
+        socket->writeError(QHttpEngine::Socket::NotFound);
+        return;
+    }
+
+    // Metrics are only ever read
+    if (socket->method() != QHttpEngine::Socket::GET) {
+        socket->writeError(QHttpEngine::Socket::MethodNotAllowed);
+        return;
+    }
+
+    QByteArray output = mMetrics.render();
+
+    socket->setStatusCode(QHttpEngine::Socket::OK);
+    socket->setHeader("Content-Length", QByteArray::number(output.length()));
+    socket->setHeader("Content-Type", "application/openmetrics-text; version=1.0.0; charset=utf-8");
+    socket->write(output);
+    socket->close();
+}
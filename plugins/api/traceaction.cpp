@@ -0,0 +1,157 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QtGlobal>
+
+#ifdef Q_OS_UNIX
+#  include <signal.h>
+#  include <sys/socket.h>
+#  include <unistd.h>
+#endif
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSocketNotifier>
+#include <QStandardPaths>
+
+#include <nitroshare/application.h>
+#include <nitroshare/logger.h>
+#include <nitroshare/message.h>
+#include <nitroshare/trace.h>
+
+#include "traceaction.h"
+
+const QString MessageTag = "trace";
+
+#ifdef Q_OS_UNIX
+// Socket pair used to forward SIGUSR1 to the event loop
+static int signalSockets[2] = { -1, -1 };
+
+static void signalHandler(int)
+{
+    char c = 0;
+    ssize_t ret = write(signalSockets[0], &c, sizeof(c));
+    Q_UNUSED(ret)
+}
+#endif
+
+TraceAction::TraceAction(Application *application)
+    : mApplication(application)
+{
+#ifdef Q_OS_UNIX
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, signalSockets) == 0) {
+        struct sigaction action = {};
+        action.sa_handler = signalHandler;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        if (sigaction(SIGUSR1, &action, 0) == 0) {
+            connect(
+                new QSocketNotifier(signalSockets[1], QSocketNotifier::Read, this),
+                &QSocketNotifier::activated,
+                this,
+                &TraceAction::onSignal
+            );
+        }
+    }
+#endif
+}
+
+TraceAction::~TraceAction()
+{
+#ifdef Q_OS_UNIX
+    signal(SIGUSR1, SIG_DFL);
+    if (signalSockets[0] != -1) {
+        ::close(signalSockets[0]);
+        ::close(signalSockets[1]);
+        signalSockets[0] = signalSockets[1] = -1;
+    }
+#endif
+}
+
+QString TraceAction::name() const
+{
+    return "trace";
+}
+
+bool TraceAction::api() const
+{
+    return true;
+}
+
+QString TraceAction::description() const
+{
+    return tr(
+        "Control tracing and retrieve the recorded spans. "
+        "This action takes an optional \"enabled\" parameter (bool) to start "
+        "or stop recording spans and returns the recorded spans in the Chrome "
+        "trace-event format, which can be loaded in Perfetto."
+    );
+}
+
+QVariant TraceAction::invoke(const QVariantMap &params)
+{
+    if (params.contains("enabled")) {
+        Trace::setEnabled(params.value("enabled").toBool());
+    }
+    return QJsonDocument::fromJson(Trace::toJson()).object().toVariantMap();
+}
+
+void TraceAction::onSignal()
+{
+#ifdef Q_OS_UNIX
+    char c;
+    ssize_t ret = read(signalSockets[1], &c, sizeof(c));
+    Q_UNUSED(ret)
+#endif
+
+    // The shared temporary directory is avoided since anyone could plant a
+    // symlink there; QSaveFile also creates the file itself and renames it
+    // into place rather than writing through whatever is at the path
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation));
+    QString filename = dir.absoluteFilePath(
+        QString("trace-%1.json").arg(QCoreApplication::applicationPid())
+    );
+
+    QSaveFile file(filename);
+    if (!dir.mkpath(".") ||
+            !file.open(QIODevice::WriteOnly) ||
+            file.write(Trace::toJson()) == -1 ||
+            !file.commit()) {
+        mApplication->logger()->log(new Message(
+            Message::Error,
+            MessageTag,
+            QString("unable to write %1: %2").arg(filename).arg(file.errorString())
+        ));
+        return;
+    }
+
+    mApplication->logger()->log(new Message(
+        Message::Info,
+        MessageTag,
+        QString("trace written to %1").arg(filename)
+    ));
+}
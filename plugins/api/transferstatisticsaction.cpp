@@ -0,0 +1,111 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QModelIndex>
+#include <QVariantList>
+
+#include <nitroshare/application.h>
+#include <nitroshare/transfer.h>
+#include <nitroshare/transfermodel.h>
+
+#include "transferstatisticsaction.h"
+
+TransferStatisticsAction::TransferStatisticsAction(Application *application)
+    : mApplication(application)
+{
+}
+
+QString TransferStatisticsAction::name() const
+{
+    return "transferstatistics";
+}
+
+bool TransferStatisticsAction::api() const
+{
+    return true;
+}
+
+QString TransferStatisticsAction::description() const
+{
+    return tr(
+        "Retrieve detailed statistics for transfers. "
+        "This action takes an optional \"index\" parameter (int) and returns "
+        "an array of transfer objects, or only the transfer at the index if "
+        "one was provided. Each transfer object includes the speed and time "
+        "remaining as well as a \"statistics\" object with packet counts, "
+        "time spent waiting on disk, socket, and peer, and transport details."
+    );
+}
+
+QVariant TransferStatisticsAction::invoke(const QVariantMap &params)
+{
+    TransferModel *model = mApplication->transferModel();
+
+    int first = 0;
+    int last = model->rowCount() - 1;
+    if (params.contains("index")) {
+        first = last = params.value("index").toInt();
+        if (first < 0 || first >= model->rowCount()) {
+            return false;
+        }
+    }
+
+    QVariantList transfers;
+    for (int i = first; i <= last; ++i) {
+        Transfer *transfer = model->data(model->index(i, 0), Qt::UserRole).value<Transfer*>();
+
+        QString state;
+        switch (transfer->state()) {
+        case Transfer::Connecting:
+            state = "connecting";
+            break;
+        case Transfer::InProgress:
+            state = "inprogress";
+            break;
+        case Transfer::Failed:
+            state = "failed";
+            break;
+        case Transfer::Succeeded:
+            state = "succeeded";
+            break;
+        }
+
+        transfers.append(QVariantMap{
+            { "index", i },
+            { "direction", transfer->direction() == Transfer::Send ? "send" : "receive" },
+            { "state", state },
+            { "deviceName", transfer->deviceName() },
+            { "error", transfer->error() },
+            { "progress", transfer->progress() },
+            { "speed", transfer->speed() },
+            { "instantaneousSpeed", transfer->instantaneousSpeed() },
+            { "averageSpeed", transfer->averageSpeed() },
+            { "bytesRemaining", transfer->bytesRemaining() },
+            { "timeRemaining", transfer->timeRemaining() },
+            { "statistics", transfer->statistics() }
+        });
+    }
+
+    return transfers;
+}
@@ -54,10 +54,38 @@ quint16 BroadcastDevice::port() const
     return mObject.value("port").toInt();
 }
 
-void BroadcastDevice::update(qint64 curMs, const QHostAddress &address, const QJsonObject &object)
+quint16 BroadcastDevice::multicastPort() const
+{
+    return mObject.value("multicastPort").toInt();
+}
+
+QString BroadcastDevice::subnet() const
+{
+    return mSubnet;
+}
+
+QString BroadcastDevice::interfaceName() const
+{
+    return mInterfaceName;
+}
+
+quint16 BroadcastDevice::swarmPort() const
+{
+    return mObject.value("swarmPort").toInt();
+}
+
+QVariantMap BroadcastDevice::swarms() const
+{
+    return mObject.value("swarms").toObject().toVariantMap();
+}
+
+void BroadcastDevice::update(qint64 curMs, const QHostAddress &address, const QJsonObject &object,
+                             const QString &subnet, const QString &interfaceName)
 {
     mAddresses.insert(address.toString());
     mObject = object;
+    mSubnet = subnet;
+    mInterfaceName = interfaceName;
     mLastUpdate = curMs;
 }
 
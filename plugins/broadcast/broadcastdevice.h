@@ -28,6 +28,7 @@
 #include <QHostAddress>
 #include <QJsonObject>
 #include <QSet>
+#include <QVariantMap>
 
 #include <nitroshare/device.h>
 
@@ -36,6 +37,11 @@ class BroadcastDevice : public Device
     Q_OBJECT
     Q_PROPERTY(QStringList addresses READ addresses)
     Q_PROPERTY(quint16 port READ port)
+    Q_PROPERTY(quint16 multicastPort READ multicastPort)
+    Q_PROPERTY(QString subnet READ subnet)
+    Q_PROPERTY(QString interfaceName READ interfaceName)
+    Q_PROPERTY(quint16 swarmPort READ swarmPort)
+    Q_PROPERTY(QVariantMap swarms READ swarms)
 
 public:
 
@@ -47,14 +53,22 @@ public:
 
     QStringList addresses() const;
     quint16 port() const;
+    quint16 multicastPort() const;
+    QString subnet() const;
+    QString interfaceName() const;
+    quint16 swarmPort() const;
+    QVariantMap swarms() const;
 
-    void update(qint64 curMs, const QHostAddress &address, const QJsonObject &object);
+    void update(qint64 curMs, const QHostAddress &address, const QJsonObject &object,
+                const QString &subnet, const QString &interfaceName);
     bool isExpired(qint64 curMs, int timeoutMs) const;
 
 private:
 
     QSet<QString> mAddresses;
     QJsonObject mObject;
+    QString mSubnet;
+    QString mInterfaceName;
     qint64 mLastUpdate;
 };
 
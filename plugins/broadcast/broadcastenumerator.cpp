@@ -29,7 +29,10 @@
 #include <QNetworkAddressEntry>
 #include <QNetworkInterface>
 #include <QSet>
+#include <QVariant>
 
+#include <nitroshare/action.h>
+#include <nitroshare/actionregistry.h>
 #include <nitroshare/application.h>
 #include <nitroshare/category.h>
 #include <nitroshare/logger.h>
@@ -47,6 +50,8 @@ const QString BroadcastExpiry = "BroadcastExpiry";
 const QString BroadcastPort = "BroadcastPort";
 
 const QString TransferPort = "TransferPort";
+const QString MulticastPort = "MulticastPort";
+const QString SwarmPort = "SwarmPort";
 
 BroadcastEnumerator::BroadcastEnumerator(Application *application)
     : mApplication(application),
@@ -113,14 +118,34 @@ void BroadcastEnumerator::onBroadcastTimeout()
         { "name", mApplication->deviceName() },
         { "port", mApplication->settingsRegistry()->value(TransferPort).toInt() }
     };
+
+    // Advertise support for receiving multicast sessions if it is available
+    QVariant multicastPort = mApplication->settingsRegistry()->value(MulticastPort);
+    if (multicastPort.isValid()) {
+        object.insert("multicastPort", multicastPort.toInt());
+    }
+
+    // Advertise the swarms this device is a member of and the chunks it has
+    QVariant swarmPort = mApplication->settingsRegistry()->value(SwarmPort);
+    Action *swarmsAction = mApplication->actionRegistry()->find("swarms");
+    if (swarmPort.isValid() && swarmsAction) {
+        object.insert("swarmPort", swarmPort.toInt());
+        QVariantMap swarms = swarmsAction->invoke().toMap();
+        if (!swarms.isEmpty()) {
+            object.insert("swarms", QJsonObject::fromVariantMap(swarms));
+        }
+    }
+
     QByteArray data = QJsonDocument(object).toJson(QJsonDocument::Compact);
 
-    // Broadcast the packet
+    // Broadcast the packet, remembering the subnets it was sent to
+    mEntries.clear();
     foreach (QNetworkInterface interface, QNetworkInterface::allInterfaces()) {
         if (interface.flags() & QNetworkInterface::CanBroadcast) {
             foreach (QNetworkAddressEntry entry, interface.addressEntries()) {
                 if (!entry.broadcast().isNull()) {
                     mSocket.writeDatagram(data, entry.broadcast(), mSocket.localPort());
+                    mEntries.append(qMakePair(interface.name(), entry));
                 }
             }
         }
@@ -180,8 +205,22 @@ void BroadcastEnumerator::onReadyRead()
             device = new BroadcastDevice;
         }
 
+        // Find the subnet the device is on
+        QString subnet;
+        QString interfaceName;
+        QHostAddress ipv4Address(address.toIPv4Address());
+        foreach (const auto &entry, mEntries) {
+            if (ipv4Address.isInSubnet(entry.second.ip(), entry.second.prefixLength())) {
+                QHostAddress network(entry.second.ip().toIPv4Address() &
+                                     entry.second.netmask().toIPv4Address());
+                subnet = QString("%1/%2").arg(network.toString()).arg(entry.second.prefixLength());
+                interfaceName = entry.first;
+                break;
+            }
+        }
+
         // Update the device
-        device->update(curMs, address, object);
+        device->update(curMs, address, object, subnet, interfaceName);
 
         // Indicate that a new device was discovered
         if (!deviceExisted) {
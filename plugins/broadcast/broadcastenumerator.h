@@ -26,6 +26,8 @@
 #define BROADCASTENUMERATOR_H
 
 #include <QList>
+#include <QNetworkAddressEntry>
+#include <QPair>
 #include <QTimer>
 #include <QUdpSocket>
 
@@ -65,6 +67,9 @@ private:
 
     QList<BroadcastDevice*> mDevices;
 
+    // Subnets the device is on and the interfaces they belong to
+    QList<QPair<QString, QNetworkAddressEntry>> mEntries;
+
     Category mBroadcastCategory;
     Setting mBroadcastInterval;
     Setting mBroadcastExpiry;
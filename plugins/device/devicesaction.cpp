@@ -22,6 +22,8 @@
  * IN THE SOFTWARE.
  */
 
+#include <QJsonArray>
+
 #include <nitroshare/application.h>
 #include <nitroshare/device.h>
 #include <nitroshare/devicemodel.h>
@@ -50,7 +52,8 @@ QString DevicesAction::description() const
 
 QVariant DevicesAction::invoke(const QVariantMap &)
 {
-    QVariantList devices;
+    // The array is passed through to the API without any conversion
+    QJsonArray devices;
     DeviceModel *model = mApplication->deviceModel();
     for (int i = 0; i < model->rowCount(); ++i) {
         Device *device = model->data(model->index(i, 0), Qt::UserRole).value<Device*>();
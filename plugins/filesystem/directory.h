@@ -0,0 +1,62 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef DIRECTORY_H
+#define DIRECTORY_H
+
+#include <QVariantMap>
+
+#include <nitroshare/item.h>
+
+class DirectoryCache;
+
+/**
+ * @brief Item for directories in the local filesystem
+ *
+ * Directories are sent ahead of the files they contain so that they only
+ * need to be created once and so that empty directories are preserved.
+ */
+class Directory : public Item
+{
+    Q_OBJECT
+
+public:
+
+    Directory(DirectoryCache *cache, const QString &root, const QVariantMap &properties);
+    Directory(const QString &absolutePath, const QString &relativePath);
+
+    // Reimplemented virtual methods
+    virtual QString type() const;
+    virtual QString name() const;
+
+    virtual bool open(OpenMode openMode);
+
+private:
+
+    DirectoryCache *mCache;
+    QString mAbsolutePath;
+    QString mRelativePath;
+};
+
+#endif // DIRECTORY_H
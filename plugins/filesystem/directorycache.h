@@ -0,0 +1,68 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef DIRECTORYCACHE_H
+#define DIRECTORYCACHE_H
+
+#include <QSet>
+#include <QString>
+
+/**
+ * @brief Remember directories that were created for received items
+ *
+ * Received files frequently share a parent directory, so creating it once
+ * avoids a series of redundant checks for every file. Cached directories are
+ * trusted without checking them; a directory removed in the meantime is
+ * invalidated and created again once opening a file inside it fails.
+ */
+class DirectoryCache
+{
+public:
+
+    /**
+     * @brief Ensure that a directory exists
+     * @param path absolute path to the directory
+     * @return true if the directory exists
+     */
+    bool create(const QString &path);
+
+    /**
+     * @brief Determine if a directory was created
+     * @param path absolute path to the directory
+     * @return true if the directory is in the cache
+     */
+    bool contains(const QString &path) const;
+
+    /**
+     * @brief Remove a directory from the cache
+     * @param path absolute path to the directory
+     */
+    void invalidate(const QString &path);
+
+private:
+
+    QSet<QString> mDirectories;
+};
+
+#endif // DIRECTORYCACHE_H
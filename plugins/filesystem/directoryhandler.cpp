@@ -0,0 +1,52 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <nitroshare/application.h>
+#include <nitroshare/settingsregistry.h>
+
+#include "directory.h"
+#include "directoryhandler.h"
+
+// Registered by the file handler
+const QString TransferDirectory = "TransferDirectory";
+
+DirectoryHandler::DirectoryHandler(Application *application, DirectoryCache *cache)
+    : mApplication(application),
+      mCache(cache)
+{
+}
+
+QString DirectoryHandler::name() const
+{
+    return "directory";
+}
+
+Item *DirectoryHandler::createItem(const QString &, const QVariantMap &properties)
+{
+    return new Directory(
+        mCache,
+        mApplication->settingsRegistry()->value(TransferDirectory).toString(),
+        properties
+    );
+}
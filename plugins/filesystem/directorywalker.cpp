@@ -0,0 +1,406 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QtGlobal>
+
+#ifdef Q_OS_UNIX
+#  include <cerrno>
+#  include <cstring>
+#  include <dirent.h>
+#  include <fcntl.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#  include <sys/syscall.h>
+#endif
+
+#include <QDateTime>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QRunnable>
+
+#include "directorywalker.h"
+#include "filetable.h"
+
+// Number of files to collect before handing them to the event loop
+const int BatchSize = 1000;
+
+#ifdef Q_OS_LINUX
+
+// Size of the buffer passed to getdents64(); large enough that most
+// directories can be read with a single call
+const int DirentBufferSize = 32768;
+
+// Record returned by getdents64(), which glibc does not declare
+struct LinuxDirent64
+{
+    quint64 d_ino;
+    qint64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+#endif
+
+class DirectoryWalkerTask : public QRunnable
+{
+public:
+
+    DirectoryWalkerTask(DirectoryWalker *walker, const QString &absolutePath, const QString &relativePath)
+        : mWalker(walker),
+          mAbsolutePath(absolutePath),
+          mRelativePath(relativePath)
+    {
+    }
+
+    virtual void run()
+    {
+        mWalker->walk(mAbsolutePath, mRelativePath);
+        mWalker->finishTask();
+    }
+
+private:
+
+    DirectoryWalker *mWalker;
+    QString mAbsolutePath;
+    QString mRelativePath;
+};
+
+static QString joinPath(const QString &path, const QString &name)
+{
+    return path.isEmpty() ? name : path + "/" + name;
+}
+
+static void addFromInfo(FileTable *table, int directory, const QFileInfo &info)
+{
+    table->addFile(
+        directory,
+        FileTable::encodeName(info.fileName()),
+        info.size(),
+        !info.isWritable(),
+        info.isExecutable(),
+        info.created().toMSecsSinceEpoch(),
+        info.lastRead().toMSecsSinceEpoch(),
+        info.lastModified().toMSecsSinceEpoch()
+    );
+}
+
+#ifdef Q_OS_UNIX
+
+static qint64 toMSecs(const struct timespec &time)
+{
+    return static_cast<qint64>(time.tv_sec) * 1000 + time.tv_nsec / 1000000;
+}
+
+static void addFromStat(FileTable *table, int directory, const char *name, const struct stat &st)
+{
+#ifdef Q_OS_DARWIN
+    const struct timespec &created = st.st_birthtimespec;
+    const struct timespec &lastRead = st.st_atimespec;
+    const struct timespec &lastModified = st.st_mtimespec;
+#else
+    const struct timespec &created = st.st_ctim;
+    const struct timespec &lastRead = st.st_atim;
+    const struct timespec &lastModified = st.st_mtim;
+#endif
+
+    // The name is stored exactly as the filesystem returned it
+    table->addFile(
+        directory,
+        QByteArray::fromRawData(name, static_cast<int>(strlen(name))),
+        st.st_size,
+        !(st.st_mode & S_IWUSR),
+        static_cast<bool>(st.st_mode & S_IXUSR),
+        toMSecs(created),
+        toMSecs(lastRead),
+        toMSecs(lastModified)
+    );
+}
+
+#endif
+
+DirectoryWalker::DirectoryWalker(QObject *parent)
+    : QObject(parent),
+      mPendingTasks(0),
+      mCanceled(0),
+      mQueued(0),
+      mLimit(0),
+      mOutstanding(0),
+      mDeliveryScheduled(false),
+      mFinished(false)
+{
+}
+
+DirectoryWalker::~DirectoryWalker()
+{
+    {
+        QMutexLocker locker(&mMutex);
+        mCanceled.store(1);
+        mCondition.wakeAll();
+    }
+    mPool.waitForDone();
+    qDeleteAll(mTables);
+}
+
+void DirectoryWalker::start(const QStringList &paths)
+{
+    // Prevent the walk from finishing before all paths have been started
+    mPendingTasks.ref();
+
+    // Files are grouped by their parent directory
+    FileTable *table = new FileTable;
+    QHash<QString, int> directories;
+    foreach (const QString &path, paths) {
+        QFileInfo info(path);
+        if (info.isFile()) {
+            QString absolutePath = info.absolutePath();
+            if (!directories.contains(absolutePath)) {
+                directories.insert(absolutePath, table->addDirectory(absolutePath, QString()));
+            }
+            addFromInfo(table, directories.value(absolutePath), info);
+        } else if (info.isDir()) {
+
+            // Names include the directory itself
+            startTask(info.absoluteFilePath(), info.fileName());
+        }
+    }
+    addTable(table);
+
+    finishTask();
+}
+
+void DirectoryWalker::setLimit(int limit)
+{
+    mLimit = limit;
+}
+
+void DirectoryWalker::release(int count)
+{
+    QMutexLocker locker(&mMutex);
+    mOutstanding -= count;
+    if (mTables.count() || mFinished) {
+        scheduleDelivery();
+    }
+}
+
+void DirectoryWalker::walk(const QString &absolutePath, const QString &relativePath)
+{
+    FileTable *table = new FileTable;
+    int directory = table->addDirectory(absolutePath, relativePath);
+
+    // The directory itself is sent ahead of its contents
+    table->addDirectoryItem(directory);
+
+    // Hand over the table once it is full and continue with a new one
+    auto checkTable = [&]() {
+        if (table->count() >= BatchSize) {
+            addTable(table);
+            table = new FileTable;
+            directory = table->addDirectory(absolutePath, relativePath);
+        }
+    };
+
+#ifdef Q_OS_UNIX
+
+    int fd;
+    do {
+        fd = open(QFile::encodeName(absolutePath).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    } while (fd == -1 && errno == EINTR);
+    if (fd == -1) {
+        delete table;
+        return;
+    }
+
+    auto processEntry = [&](const char *name, unsigned char type) {
+        if (!strcmp(name, ".") || !strcmp(name, "..") || type == DT_LNK) {
+            return;
+        }
+
+        // Names are only decoded for directories; files keep their
+        // encoded name until an item is created for them
+        auto startDirectory = [&]() {
+            QString decodedName = QFile::decodeName(name);
+            startTask(absolutePath + "/" + decodedName, joinPath(relativePath, decodedName));
+        };
+
+        if (type == DT_DIR) {
+            startDirectory();
+            return;
+        }
+
+        struct stat st;
+        if (fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW)) {
+            return;
+        }
+
+        // The type may not have been known until now
+        if (S_ISDIR(st.st_mode)) {
+            startDirectory();
+        } else if (S_ISREG(st.st_mode)) {
+            addFromStat(table, directory, name, st);
+            checkTable();
+        }
+    };
+
+#  ifdef Q_OS_LINUX
+
+    // Read the directory in large batches without the overhead of readdir()
+    char buffer[DirentBufferSize];
+    while (!mCanceled.load()) {
+        long ret = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+        if (ret <= 0) {
+            break;
+        }
+        for (long offset = 0; offset < ret && !mCanceled.load();) {
+            LinuxDirent64 *dirent = reinterpret_cast<LinuxDirent64*>(buffer + offset);
+            processEntry(dirent->d_name, dirent->d_type);
+            offset += dirent->d_reclen;
+        }
+    }
+    close(fd);
+
+#  else
+
+    DIR *dir = fdopendir(fd);
+    if (!dir) {
+        close(fd);
+        delete table;
+        return;
+    }
+    struct dirent *dirent;
+    while (!mCanceled.load() && (dirent = readdir(dir))) {
+        processEntry(dirent->d_name, dirent->d_type);
+    }
+    closedir(dir);
+
+#  endif
+
+#else
+
+    QDirIterator iterator(absolutePath,
+        QDir::Dirs | QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+    while (!mCanceled.load() && iterator.hasNext()) {
+        iterator.next();
+        QFileInfo info = iterator.fileInfo();
+        if (info.isDir()) {
+            startTask(info.absoluteFilePath(), joinPath(relativePath, info.fileName()));
+        } else {
+            addFromInfo(table, directory, info);
+            checkTable();
+        }
+    }
+
+#endif
+
+    addTable(table);
+}
+
+void DirectoryWalker::addTable(FileTable *table)
+{
+    if (!table->count()) {
+        delete table;
+        return;
+    }
+
+    QMutexLocker locker(&mMutex);
+
+    // Wait for the consumer to catch up if too many files are queued
+    while (mLimit && mQueued >= mLimit && !mCanceled.load()) {
+        mCondition.wait(&mMutex);
+    }
+
+    mTables.append(table);
+    mQueued += table->count();
+    scheduleDelivery();
+}
+
+void DirectoryWalker::finishTask()
+{
+    if (!mPendingTasks.deref()) {
+        QMutexLocker locker(&mMutex);
+        mFinished = true;
+        scheduleDelivery();
+    }
+}
+
+void DirectoryWalker::deliver()
+{
+    QList<FileTable*> tables;
+    bool finished;
+    {
+        QMutexLocker locker(&mMutex);
+        mDeliveryScheduled = false;
+
+        // Deliver as many tables as the limit allows (at least one must be
+        // delivered when none are outstanding or the walk would stall)
+        if (mLimit) {
+            while (mTables.count() && (!mOutstanding ||
+                    mOutstanding + mTables.first()->count() <= mLimit)) {
+                FileTable *table = mTables.takeFirst();
+                mQueued -= table->count();
+                mOutstanding += table->count();
+                tables.append(table);
+            }
+            mCondition.wakeAll();
+        } else {
+            tables.swap(mTables);
+            mQueued = 0;
+        }
+
+        finished = mFinished && mTables.isEmpty();
+        if (finished) {
+            mFinished = false;
+        }
+    }
+
+    foreach (FileTable *table, tables) {
+        emit tableFound(table);
+    }
+    if (finished) {
+        emit finished();
+    }
+}
+
+void DirectoryWalker::startTask(const QString &absolutePath, const QString &relativePath)
+{
+    mPendingTasks.ref();
+    mPool.start(new DirectoryWalkerTask(this, absolutePath, relativePath));
+}
+
+void DirectoryWalker::scheduleDelivery()
+{
+    // Only a single invocation is needed to deliver all pending tables; the
+    // mutex must be held by the caller
+    if (!mDeliveryScheduled) {
+        mDeliveryScheduled = true;
+        QMetaObject::invokeMethod(this, "deliver", Qt::QueuedConnection);
+    }
+}
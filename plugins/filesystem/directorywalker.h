@@ -0,0 +1,122 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef DIRECTORYWALKER_H
+#define DIRECTORYWALKER_H
+
+#include <QAtomicInt>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+class FileTable;
+
+/**
+ * @brief Enumerate files in directory trees in parallel
+ *
+ * Each directory is read by a separate task on a thread pool and the files
+ * found are reported in tables as the walk progresses. Each directory is
+ * reported ahead of the files it contains. Symbolic links are not followed.
+ */
+class DirectoryWalker : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit DirectoryWalker(QObject *parent = nullptr);
+    virtual ~DirectoryWalker();
+
+    /**
+     * @brief Begin enumerating files
+     * @param paths absolute paths to files and directories
+     *
+     * Paths to files are reported directly. Files in directories are reported
+     * relative to the parent of the directory.
+     */
+    void start(const QStringList &paths);
+
+    /**
+     * @brief Limit the number of files reported but not yet released
+     * @param limit maximum number of files or 0 for no limit
+     *
+     * When the limit is reached, the walk pauses until release() is called.
+     * This must be set before the walk is started.
+     */
+    void setLimit(int limit);
+
+    /**
+     * @brief Indicate that files reported earlier are no longer in use
+     * @param count number of files
+     */
+    void release(int count);
+
+    // Used by the tasks on the thread pool
+    void walk(const QString &absolutePath, const QString &relativePath);
+    void addTable(FileTable *table);
+    void finishTask();
+
+signals:
+
+    /**
+     * @brief Indicate that files were found
+     * @param table files that were found
+     *
+     * The receiver assumes ownership of the table.
+     */
+    void tableFound(FileTable *table);
+
+    /**
+     * @brief Indicate that all files were found
+     */
+    void finished();
+
+private slots:
+
+    void deliver();
+
+private:
+
+    void startTask(const QString &absolutePath, const QString &relativePath);
+    void scheduleDelivery();
+
+    QThreadPool mPool;
+    QAtomicInt mPendingTasks;
+    QAtomicInt mCanceled;
+
+    QMutex mMutex;
+    QWaitCondition mCondition;
+    QList<FileTable*> mTables;
+    int mQueued;
+    int mLimit;
+    int mOutstanding;
+    bool mDeliveryScheduled;
+    bool mFinished;
+};
+
+#endif // DIRECTORYWALKER_H
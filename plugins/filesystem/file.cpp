@@ -27,15 +27,81 @@
 #if defined(Q_OS_WIN32)
 #  include <windows.h>
 #elif defined(Q_OS_UNIX)
+#  include <cerrno>
+#  include <fcntl.h>
 #  include <sys/stat.h>
-#  include <utime.h>
+#  include <unistd.h>
 #endif
 
-#include <QDateTime>
+#include <algorithm>
 
+#include <QPointer>
+#include <QStringList>
+
+#include <nitroshare/trace.h>
+
+#include "directorycache.h"
 #include "file.h"
+#include "filecloner.h"
+
+#ifdef Q_OS_UNIX
+#  include "mappedreader.h"
+#  include "metadatawriter.h"
+#endif
+
+// Maximum number of blocks read ahead of the transfer
+const int ReadAhead = 4;
+
+// Number of blocks loaded for a file that has not been opened yet
+const int PrefetchBlocks = 2;
+
+// Maximum number of writes in flight before the transfer is asked to wait
+const int MaxPendingWrites = 8;
+
+// Amount of received data written back and dropped from the cache at once
+const qint64 ReleaseInterval = 8 * 1024 * 1024;
 
-File::File(const QString &root, const QVariantMap &properties)
+// Files smaller than this are not worth mapping
+const qint64 MappedThreshold = 64 * 1024 * 1024;
+
+/**
+ * Determine if a file could not be opened because its directory is missing
+ *
+ * This must be called immediately after the failure since errno is used.
+ */
+static bool isDirectoryMissing(const QString &directory)
+{
+#ifdef Q_OS_UNIX
+    Q_UNUSED(directory)
+    return errno == ENOENT;
+#else
+    return !QFileInfo::exists(directory);
+#endif
+}
+
+File::File(IoEngine *engine, MetadataWriter *metadataWriter, DirectoryCache *directoryCache,
+           const QString &root, const QVariantMap &properties, bool uncached)
+    : mBlockSize(0),
+      mOpenMode(Read),
+      mOpen(false),
+      mEngine(engine),
+      mReadOffset(0),
+      mSubmitOffset(0),
+      mPendingReads(0),
+      mWriteOffset(0),
+      mClosing(false),
+      mUncached(uncached),
+      mReleaseWrites(false),
+      mReleaseOffset(0),
+      mPendingReleases(0),
+      mMapped(false),
+      mReader(nullptr),
+      mMetadataWriter(metadataWriter),
+      mDirectoryCache(directoryCache),
+      mSparse(false),
+      mExtentsChecked(true),
+      mClone(false),
+      mCloner(nullptr)
 {
     mRelativeFilename = properties.value("name").toString();
 
@@ -44,6 +110,33 @@ File::File(const QString &root, const QVariantMap &properties)
 
     mSize = properties.value("size").toLongLong();
 
+    // Files may be copied directly from a descriptor passed by the sender
+    mCloneSource = properties.value("clone").toString();
+
+#ifdef Q_OS_UNIX
+    // The descriptor is only valid while the header is processed
+    int descriptor = properties.value("descriptor", -1).toInt();
+    if (descriptor != -1) {
+        int fd = fcntl(descriptor, F_DUPFD_CLOEXEC, 0);
+        if (fd != -1) {
+            mCloneHandle = IoHandlePtr(new IoHandle(fd));
+        }
+    }
+#endif
+
+    // Sparse files only include the data extents; the remainder of the file
+    // is left as holes
+    mLength = properties.value("length", mSize).toLongLong();
+    if (mLength > mSize) {
+        QStringList extents = properties.value("extents").toStringList();
+        qint64 position = 0;
+        for (int i = 0; i + 1 < extents.count(); i += 2) {
+            FileExtent extent{extents.at(i).toLongLong(), extents.at(i + 1).toLongLong(), position};
+            mExtents.append(extent);
+            position += extent.length;
+        }
+    }
+
     mReadOnly = properties.value("readOnly").toBool();
     mExecutable = properties.value("executable").toBool();
 
@@ -57,20 +150,51 @@ File::File(const QString &root, const QVariantMap &properties)
         properties.value("last_modified").toLongLong()).toLongLong();
 }
 
-File::File(const QDir &root, const QFileInfo &info, int blockSize)
+File::File(IoEngine *engine, const FileEntry &entry, int blockSize, bool mapped, bool sparse, bool clone)
+    : mBlockSize(blockSize),
+      mOpenMode(Read),
+      mOpen(false),
+      mEngine(engine),
+      mReadOffset(0),
+      mSubmitOffset(0),
+      mPendingReads(0),
+      mWriteOffset(0),
+      mClosing(false),
+      mUncached(false),
+      mReleaseWrites(false),
+      mReleaseOffset(0),
+      mPendingReleases(0),
+      mMapped(mapped),
+      mReader(nullptr),
+      mMetadataWriter(nullptr),
+      mDirectoryCache(nullptr),
+      mSparse(sparse),
+      mExtentsChecked(false),
+      mClone(clone),
+      mCloner(nullptr)
 {
-    mFile.setFileName(info.absoluteFilePath());
-    mBlockSize = blockSize;
+    mFile.setFileName(entry.absolutePath);
 
-    mRelativeFilename = root.relativeFilePath(info.absoluteFilePath());
+    mRelativeFilename = entry.relativePath;
 
-    mSize = info.size();
-    mReadOnly = !info.isWritable();
-    mExecutable = info.isExecutable();
+    mSize = entry.size;
+    mLength = entry.size;
+    mReadOnly = entry.readOnly;
+    mExecutable = entry.executable;
+
+    mCreated = entry.created;
+    mLastRead = entry.lastRead;
+    mLastModified = entry.lastModified;
+}
 
-    mCreated = info.created().toMSecsSinceEpoch();
-    mLastRead = info.lastRead().toMSecsSinceEpoch();
-    mLastModified = info.lastModified().toMSecsSinceEpoch();
+File::~File()
+{
+    // The copy must finish before the destination is closed
+    delete mCloner;
+
+#ifdef Q_OS_UNIX
+    delete mReader;
+#endif
 }
 
 bool File::readOnly() const
@@ -123,16 +247,153 @@ qint64 File::size() const
     return mSize;
 }
 
+void File::prefetch()
+{
+    // Mapped files are read ahead by the kernel once they are opened and
+    // cloned files are not read at all
+    if (!mEngine || mHandle || useMapping() || useClone()) {
+        return;
+    }
+
+    // Errors are ignored here and reported when the file is opened
+    mHandle = IoEngine::open(mFile.fileName(), Read);
+    if (mHandle) {
+        IoEngine::adviseSequential(mHandle, ReadAhead * mBlockSize);
+        submitReads(PrefetchBlocks);
+    }
+}
+
 bool File::open(OpenMode openMode)
 {
-    if (openMode == Write && !QDir(QFileInfo(mFile.fileName()).absolutePath()).mkpath(".")) {
+    mOpenMode = openMode;
+
+    // Instead of sending the contents, the receiver is told where to find
+    // them and the size is adjusted so that no data is sent
+    if (openMode == Read && useClone()) {
+
+        // The transport hands the open file to the receiver, which works even
+        // if the path is not visible to it
+        resetReads();
+        mHandle = IoEngine::open(mFile.fileName(), Read);
+        if (!mHandle) {
+            return false;
+        }
+        setProperty("descriptor", mHandle->fd());
+        setProperty("clone", mFile.fileName());
+        setProperty("length", mLength);
+        mSize = 0;
+        return mOpen = true;
+    }
+
+    // The file may already be open if it was prefetched; if it turns out
+    // to have holes, the data was read from the wrong offsets
+    if (openMode == Read && mHandle) {
+        if (!findHoles(mHandle->fd())) {
+            mOpen = true;
+            submitReads(ReadAhead);
+            return true;
+        }
+        resetReads();
+    }
+
+    // The parent directory is usually created by an earlier item
+    QString directory = QFileInfo(mFile.fileName()).absolutePath();
+    if (openMode == Write && !mDirectoryCache->create(directory)) {
         return false;
     }
-    return mFile.open(openMode == Read ? QIODevice::ReadOnly : QIODevice::WriteOnly);
+
+#ifdef Q_OS_UNIX
+    if (openMode == Read && useMapping() && MappedReader::installHandler()) {
+        IoHandlePtr handle = IoEngine::open(mFile.fileName(), Read);
+        if (!handle) {
+            return false;
+        }
+        findHoles(handle->fd());
+        mReader = new MappedReader(handle, mLength);
+        mReadOffset = 0;
+        return mOpen = true;
+    }
+#endif
+
+    // The cached directory may have been removed since it was created, in
+    // which case it is created again
+    if (!openFile(openMode)) {
+        if (openMode == Read || !isDirectoryMissing(directory)) {
+            return false;
+        }
+        mDirectoryCache->invalidate(directory);
+        if (!mDirectoryCache->create(directory) || !openFile(openMode)) {
+            return false;
+        }
+    }
+
+    if (openMode == Write && !mCloneSource.isNull()) {
+        return cloneSource();
+    }
+
+    // Without an engine, synchronous I/O with QFile is used
+    if (!mEngine) {
+        return true;
+    }
+
+    // Where the cache cannot be disabled outright, data is dropped from it
+    // periodically as writes complete (this assumes contiguous writes, so
+    // sparse files are not released)
+    if (openMode == Write && mUncached) {
+        mReleaseWrites = !IoEngine::disableCache(mHandle) && mLength == mSize;
+    }
+
+    // Begin reading immediately so that data is ready for the first packet
+    if (openMode == Read) {
+        findHoles(mHandle->fd());
+        IoEngine::adviseSequential(mHandle, ReadAhead * mBlockSize);
+        submitReads(ReadAhead);
+    }
+
+    return true;
+}
+
+bool File::openFile(OpenMode openMode)
+{
+    if (mEngine) {
+        mHandle = IoEngine::open(mFile.fileName(), openMode);
+        mOpen = !mHandle.isNull();
+    } else {
+        mOpen = mFile.open(openMode == Read ? QIODevice::ReadOnly : QIODevice::WriteOnly);
+    }
+    return mOpen;
+}
+
+bool File::isReadyRead() const
+{
+    return !mHandle || mBlocks.contains(mReadOffset);
 }
 
 QByteArray File::read()
 {
+    TRACE_SPAN("File::read");
+
+#ifdef Q_OS_UNIX
+    if (mReader) {
+        QString errorMessage;
+        qint64 available;
+        qint64 offset = mapOffset(mReadOffset, &available);
+        QByteArray data = mReader->read(offset, static_cast<int>(qMin<qint64>(mBlockSize, available)), &errorMessage);
+        if (data.isEmpty()) {
+            emit error(errorMessage.isEmpty() ? tr("unexpected end of file \"%1\"").arg(mRelativeFilename) : errorMessage);
+        }
+        mReadOffset += data.size();
+        return data;
+    }
+#endif
+
+    if (mHandle) {
+        QByteArray data = mBlocks.take(mReadOffset);
+        mReadOffset += data.size();
+        submitReads(ReadAhead);
+        return data;
+    }
+
     // Allocate a full block and then resize to actual data length
     QByteArray data;
     data.resize(mBlockSize);
@@ -146,13 +407,306 @@ QByteArray File::read()
     return data;
 }
 
+bool File::isReadyWrite() const
+{
+    return mPendingWrites.count() < MaxPendingWrites;
+}
+
 void File::write(const QByteArray &data)
 {
-    if (mFile.write(data) == -1) {
+    TRACE_SPAN("File::write");
+
+    // Data for sparse files is split where each extent ends
+    int written = 0;
+    while (written < data.size()) {
+        qint64 available;
+        qint64 offset = mapOffset(mWriteOffset, &available);
+        if (available <= 0) {
+            emit error(tr("too much data received for \"%1\"").arg(mRelativeFilename));
+            return;
+        }
+        int size = static_cast<int>(qMin<qint64>(data.size() - written, available));
+        writeBlock(offset, written || size < data.size() ? data.mid(written, size) : data);
+        written += size;
+        mWriteOffset += size;
+    }
+}
+
+void File::writeBlock(qint64 offset, const QByteArray &data)
+{
+    if (mHandle) {
+        QPointer<File> file(this);
+        int size = data.size();
+        mPendingWrites.insert(offset, size);
+        mEngine->write(mHandle, offset, data, [file, offset, size](qint64 result, const QByteArray &) {
+            if (file) {
+                file->onWriteCompleted(offset, size, result);
+            }
+        });
+        return;
+    }
+
+    if ((mLength > mSize && !mFile.seek(offset)) || mFile.write(data) == -1) {
         emit error(mFile.errorString());
     }
 }
 
+void File::submitReads(int maxBlocks)
+{
+    // Keep a limited number of blocks buffered or in flight
+    QPointer<File> file(this);
+    IoHandle *handle = mHandle.data();
+    while (mSubmitOffset < mSize && mPendingReads + mBlocks.count() < maxBlocks) {
+        qint64 offset = mSubmitOffset;
+        qint64 available;
+        qint64 fileOffset = mapOffset(offset, &available);
+        int size = static_cast<int>(qMin<qint64>(mBlockSize, available));
+        ++mPendingReads;
+        mEngine->read(mHandle, fileOffset, size, [file, handle, offset, size](qint64 result, const QByteArray &data) {
+            if (file) {
+                file->onReadCompleted(handle, offset, size, result, data);
+            }
+        });
+        mSubmitOffset += size;
+    }
+}
+
+void File::onReadCompleted(IoHandle *handle, qint64 offset, int size, qint64 result, const QByteArray &data)
+{
+    // The file may have been closed while the read was in flight (the request
+    // holds a reference to the handle, so the pointer cannot be reused)
+    if (handle != mHandle.data()) {
+        return;
+    }
+
+    --mPendingReads;
+
+    // Failures while prefetching are discarded; the file is read again once
+    // it is opened, at which point errors can be reported
+    if ((result < 0 || result < size) && !mOpen) {
+        resetReads();
+        return;
+    }
+
+    if (result < 0) {
+        emit error(IoEngine::errorString(result));
+        return;
+    }
+
+    // The file shrank after the transfer began
+    if (result < size) {
+        emit error(tr("unexpected end of file \"%1\"").arg(mRelativeFilename));
+        return;
+    }
+
+    mBlocks.insert(offset, data);
+    if (offset == mReadOffset) {
+        emit readyRead();
+    }
+}
+
+bool File::useClone() const
+{
+    return mClone && property("cloneable").toBool();
+}
+
+bool File::cloneSource()
+{
+    // Only a descriptor passed by the sender is ever read from; the path is
+    // never opened, since any file could be named there
+    IoHandlePtr source = mCloneHandle;
+    mCloneHandle.clear();
+    if (!source) {
+        return false;
+    }
+
+#ifdef Q_OS_UNIX
+    // If the path is visible here, it must refer to the same file
+    struct stat sourceStats;
+    struct stat pathStats;
+    if (fstat(source->fd(), &sourceStats) == 0 &&
+            stat(QFile::encodeName(mCloneSource).constData(), &pathStats) == 0 &&
+            (sourceStats.st_dev != pathStats.st_dev || sourceStats.st_ino != pathStats.st_ino)) {
+        return false;
+    }
+#endif
+
+    // Copying may take a while if the file cannot be cloned, so it happens
+    // in the background and the file is not closed until it completes
+    mCloner = new FileCloner(source, mHandle ? mHandle->fd() : mFile.handle(), mLength, this);
+    connect(mCloner, &FileCloner::finished, this, &File::onCloneFinished);
+    mCloner->start();
+    return true;
+}
+
+void File::onCloneFinished(const QString &message)
+{
+    mCloner->deleteLater();
+    mCloner = nullptr;
+
+    if (!message.isNull()) {
+        emit error(tr("unable to copy \"%1\": %2").arg(mRelativeFilename).arg(message));
+    }
+
+    // Finish closing the file if that was deferred
+    if (mClosing) {
+        close();
+    }
+}
+
+bool File::findHoles(int fd)
+{
+    if (!mSparse || mExtentsChecked) {
+        return false;
+    }
+    mExtentsChecked = true;
+
+#if defined(Q_OS_UNIX) && defined(SEEK_DATA) && defined(SEEK_HOLE)
+
+    // Filesystems without support for holes report the whole file as data
+    QVector<FileExtent> extents;
+    qint64 position = 0;
+    qint64 offset = 0;
+    while (offset < mLength) {
+        off_t start = lseek(fd, offset, SEEK_DATA);
+        if (start == -1) {
+            if (errno == ENXIO) {
+                break;
+            }
+            return false;
+        }
+        off_t end = lseek(fd, start, SEEK_HOLE);
+        if (end == -1) {
+            return false;
+        }
+        end = qMin<qint64>(end, mLength);
+        extents.append(FileExtent{start, end - start, position});
+        position += end - start;
+        offset = end;
+    }
+
+    if (position >= mLength) {
+        return false;
+    }
+
+    // Only the data is sent; the receiver recreates the holes
+    mExtents = extents;
+    mSize = position;
+
+    QStringList extentList;
+    foreach (const FileExtent &extent, mExtents) {
+        extentList.append(QString::number(extent.offset));
+        extentList.append(QString::number(extent.length));
+    }
+    setProperty("length", mLength);
+    setProperty("extents", extentList);
+
+    return true;
+
+#else
+    Q_UNUSED(fd)
+    return false;
+#endif
+}
+
+qint64 File::mapOffset(qint64 position, qint64 *available) const
+{
+    if (mLength == mSize) {
+        *available = mSize - position;
+        return position;
+    }
+
+    // Find the last extent that begins at or before the position
+    auto i = std::upper_bound(mExtents.constBegin(), mExtents.constEnd(), position,
+        [](qint64 position, const FileExtent &extent) {
+            return position < extent.position;
+        }
+    );
+    if (i == mExtents.constBegin()) {
+        *available = 0;
+        return 0;
+    }
+    --i;
+
+    *available = i->position + i->length - position;
+    return i->offset + position - i->position;
+}
+
+bool File::useMapping() const
+{
+#ifdef Q_OS_UNIX
+    return mMapped && mSize >= MappedThreshold;
+#else
+    return false;
+#endif
+}
+
+void File::resetReads()
+{
+    mHandle.clear();
+    mBlocks.clear();
+    mReadOffset = 0;
+    mSubmitOffset = 0;
+    mPendingReads = 0;
+}
+
+void File::onWriteCompleted(qint64 offset, int size, qint64 result)
+{
+    mPendingWrites.remove(offset);
+
+    if (result < 0) {
+        emit error(IoEngine::errorString(result));
+    } else if (result < size) {
+        emit error(tr("unable to write to \"%1\"").arg(mRelativeFilename));
+    } else if (mReleaseWrites) {
+        releaseWritten(false);
+    }
+
+    // Once the last write completes, a file being closed can be finished
+    if (mClosing) {
+        if (mPendingWrites.isEmpty()) {
+            finishWrites();
+        }
+    } else if (mPendingWrites.count() == MaxPendingWrites - 1) {
+        emit readyWrite();
+    }
+}
+
+void File::releaseWritten(bool all)
+{
+    // Writes may complete out of order, so only the data before the oldest
+    // write still in flight is known to be in the cache
+    qint64 written = mPendingWrites.isEmpty() ? mWriteOffset : mPendingWrites.firstKey();
+
+    QPointer<File> file(this);
+    while (written > mReleaseOffset) {
+        qint64 length = qMin(written - mReleaseOffset, ReleaseInterval);
+        if (!all && length < ReleaseInterval) {
+            break;
+        }
+        ++mPendingReleases;
+        mEngine->release(mHandle, mReleaseOffset, length, [file](qint64 result, const QByteArray &) {
+            if (file) {
+                file->onReleaseCompleted(result);
+            }
+        });
+        mReleaseOffset += length;
+    }
+}
+
+void File::onReleaseCompleted(qint64 result)
+{
+    --mPendingReleases;
+
+    if (result < 0) {
+        emit error(IoEngine::errorString(result));
+    }
+
+    if (mClosing && mPendingWrites.isEmpty() && !mPendingReleases) {
+        finishClose(mHandle);
+    }
+}
+
 #ifdef Q_OS_WIN32
 
 // Adapted from https://support.microsoft.com/en-us/help/167296
@@ -170,8 +724,118 @@ void unixTimestampMsToFiletime(qint64 timestampMs, LPFILETIME pft)
 
 void File::close()
 {
-    mFile.close();
+    TRACE_SPAN("File::close");
+
+    // The file is closed once the copy completes
+    if (mCloner) {
+        mClosing = true;
+        return;
+    }
+
+    if (mHandle && mOpenMode == Write) {
+
+        // Writes still in flight are completed in the background and
+        // closed() is emitted once they finish
+        mClosing = true;
+        if (mPendingWrites.isEmpty()) {
+            finishWrites();
+        }
+        return;
+    }
+
+    // The descriptor is kept open for applying metadata to received files
+    IoHandlePtr handle = mHandle;
+
+    if (mHandle) {
+
+        // The descriptor passed to the receiver is no longer valid
+        if (mClone) {
+            setProperty("descriptor", QVariant());
+        }
+    } else {
+        if (mOpenMode == Write && mLength > mSize && mFile.isOpen() && !mFile.resize(mLength)) {
+            emit error(mFile.errorString());
+        }
+#ifdef Q_OS_UNIX
+        if (mOpenMode == Write && mMetadataWriter && mFile.isOpen()) {
+            int fd = fcntl(mFile.handle(), F_DUPFD_CLOEXEC, 0);
+            if (fd != -1) {
+                handle = IoHandlePtr(new IoHandle(fd));
+            }
+        }
+#endif
+        mFile.close();
+    }
+
+    finishClose(handle);
+}
+
+bool File::isClosed() const
+{
+    return !mClosing;
+}
+
+void File::finishWrites()
+{
+#ifdef Q_OS_UNIX
+    // Holes at the end of a sparse file are created by extending it
+    if (mLength > mSize && ftruncate(mHandle->fd(), mLength)) {
+        emit error(IoEngine::errorString(-errno));
+    }
+#endif
+
+    // Drop the remainder of the file from the cache
+    if (mReleaseWrites) {
+        releaseWritten(true);
+        mReleaseWrites = false;
+    }
+
+    // The file is finished once the last release completes
+    if (!mPendingReleases) {
+        finishClose(mHandle);
+    }
+}
+
+void File::finishClose(IoHandlePtr handle)
+{
+    resetReads();
+
+#ifdef Q_OS_UNIX
+    delete mReader;
+    mReader = nullptr;
+#endif
 
+    mOpen = false;
+
+    // Metadata is only applied to files that were received; where possible,
+    // this happens in the background so that the next item is not delayed
+    if (mOpenMode == Write) {
+#ifdef Q_OS_UNIX
+        if (mMetadataWriter && handle) {
+            mMetadataWriter->add(FileMetadata{
+                handle,
+                mRelativeFilename,
+                mReadOnly,
+                mExecutable,
+                mLastRead,
+                mLastModified
+            });
+        } else {
+            applyMetadata();
+        }
+#else
+        applyMetadata();
+#endif
+    }
+
+    if (mClosing) {
+        mClosing = false;
+        emit closed();
+    }
+}
+
+void File::applyMetadata()
+{
 #if defined(Q_OS_WIN32)
 
     if (mReadOnly) {
@@ -226,9 +890,12 @@ void File::close()
 
 #elif defined(Q_OS_UNIX)
 
+    // Convert the filename only once
+    QByteArray filename = QFile::encodeName(mFile.fileName());
+
     // Retrieve existing statistics
     struct stat oldStats;
-    if (stat(mFile.fileName().toUtf8().constData(), &oldStats)) {
+    if (stat(filename.constData(), &oldStats)) {
         emit error("unable to read file stats");
         return;
     }
@@ -248,27 +915,19 @@ void File::close()
 
     // If the value has changed, update the file
     if (oldStats.st_mode != fileMode &&
-            chmod(mFile.fileName().toUtf8().constData(), fileMode)) {
+            chmod(filename.constData(), fileMode)) {
         emit error("unable to execute chmod");
         return;
     }
 
-    // Create the struct with the new values
-    struct utimbuf newTimes;
-
-#ifdef Q_OS_DARWIN
-    time_t st_atim = oldStats.st_atimespec.tv_sec;
-    time_t st_mtim = oldStats.st_mtimespec.tv_sec;
-#else
-    time_t st_atim = oldStats.st_atim.tv_sec;
-    time_t st_mtim = oldStats.st_mtim.tv_sec;
-#endif
-
-    newTimes.actime = mLastRead ? mLastRead / 1000 : st_atim;
-    newTimes.modtime = mLastModified ? mLastModified / 1000 : st_mtim;
+    // Set the new values, leaving those that were not provided unchanged
+    struct timespec newTimes[2];
+    newTimes[0].tv_sec = mLastRead / 1000;
+    newTimes[0].tv_nsec = mLastRead ? (mLastRead % 1000) * 1000000 : UTIME_OMIT;
+    newTimes[1].tv_sec = mLastModified / 1000;
+    newTimes[1].tv_nsec = mLastModified ? (mLastModified % 1000) * 1000000 : UTIME_OMIT;
 
-    // Set the new values
-    if (utime(mFile.fileName().toUtf8(), &newTimes)) {
+    if (utimensat(AT_FDCWD, filename.constData(), newTimes, 0)) {
         emit error("unable to set file times");
     }
 
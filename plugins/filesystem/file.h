@@ -28,12 +28,44 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QMap>
 #include <QVariantMap>
+#include <QVector>
 
 #include <nitroshare/item.h>
 
+#include "filetable.h"
+#include "ioengine.h"
+
+class DirectoryCache;
+class FileCloner;
+class MappedReader;
+class MetadataWriter;
+
+/**
+ * @brief Range of a sparse file that contains data
+ */
+struct FileExtent
+{
+    qint64 offset;
+    qint64 length;
+
+    // Position of the data among all extents
+    qint64 position;
+};
+
 /**
  * @brief Item for reading and writing files in the local filesystem
+ *
+ * When enabled, holes in sparse files are detected when they are opened for
+ * reading. Only the data is sent and the "length" and "extents" properties
+ * describe where it belongs, allowing the receiver to recreate the holes.
+ *
+ * When enabled, files are not read at all if the transfer marks them as
+ * "cloneable" (the receiver agreed to it and the transport can pass
+ * descriptors). The open file is passed to the receiver, which copies it
+ * directly. The "clone" property provides the path to the file, which must
+ * refer to the same file as the descriptor if the receiver can see it.
  */
 class File : public Item
 {
@@ -50,8 +82,10 @@ class File : public Item
 
 public:
 
-    File(const QString &root, const QVariantMap &properties);
-    File(const QDir &root, const QFileInfo &info, int blockSize);
+    File(IoEngine *engine, MetadataWriter *metadataWriter, DirectoryCache *directoryCache,
+         const QString &root, const QVariantMap &properties, bool uncached);
+    File(IoEngine *engine, const FileEntry &entry, int blockSize, bool mapped, bool sparse, bool clone);
+    virtual ~File();
 
     bool readOnly() const;
     bool executable() const;
@@ -67,15 +101,80 @@ public:
     virtual QString name() const;
     virtual qint64 size() const;
 
+    virtual void prefetch();
     virtual bool open(OpenMode openMode);
+    virtual bool isReadyRead() const;
     virtual QByteArray read();
+    virtual bool isReadyWrite() const;
     virtual void write(const QByteArray &data);
     virtual void close();
+    virtual bool isClosed() const;
 
 private:
 
+    bool openFile(OpenMode openMode);
+    void writeBlock(qint64 offset, const QByteArray &data);
+    bool useClone() const;
+    bool cloneSource();
+    bool findHoles(int fd);
+    qint64 mapOffset(qint64 position, qint64 *available) const;
+    void submitReads(int maxBlocks);
+    void onReadCompleted(IoHandle *handle, qint64 offset, int size, qint64 result, const QByteArray &data);
+    void resetReads();
+    bool useMapping() const;
+    void onWriteCompleted(qint64 offset, int size, qint64 result);
+    void releaseWritten(bool all);
+    void onReleaseCompleted(qint64 result);
+    void onCloneFinished(const QString &message);
+    void finishWrites();
+    void finishClose(IoHandlePtr handle);
+
+    void applyMetadata();
+
     QFile mFile;
     int mBlockSize;
+    OpenMode mOpenMode;
+    bool mOpen;
+
+    // Asynchronous I/O (only used when an engine is available)
+    IoEngine *mEngine;
+    IoHandlePtr mHandle;
+    QMap<qint64, QByteArray> mBlocks;
+    qint64 mReadOffset;
+    qint64 mSubmitOffset;
+    int mPendingReads;
+    qint64 mWriteOffset;
+    QMap<qint64, int> mPendingWrites;
+    bool mClosing;
+
+    // Dropping received data from the page cache
+    bool mUncached;
+    bool mReleaseWrites;
+    qint64 mReleaseOffset;
+    int mPendingReleases;
+
+    // Memory-mapped reads (large files only)
+    bool mMapped;
+    MappedReader *mReader;
+
+    // Applies metadata to received files in the background
+    MetadataWriter *mMetadataWriter;
+
+    // Directories already created for received files
+    DirectoryCache *mDirectoryCache;
+
+    // Data extents for sparse files (mSize is the amount of data and
+    // mLength the length of the file, including holes)
+    bool mSparse;
+    bool mExtentsChecked;
+    QVector<FileExtent> mExtents;
+    qint64 mLength;
+
+    // Copying files directly on the same host
+    bool mClone;
+    QString mCloneSource;
+    IoHandlePtr mCloneHandle;
+    FileCloner *mCloner;
 
     QString mRelativeFilename;
 
@@ -0,0 +1,165 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QtGlobal>
+
+#ifdef Q_OS_UNIX
+#  include <cerrno>
+#  include <unistd.h>
+#endif
+
+#ifdef Q_OS_LINUX
+#  include <linux/fs.h>
+#  include <sys/ioctl.h>
+#  include <sys/syscall.h>
+#endif
+
+#include <QMetaObject>
+#include <QRunnable>
+
+#include "filecloner.h"
+
+// Size of the buffer used when the kernel cannot copy the file itself
+const int CopyBufferSize = 1024 * 1024;
+
+// Amount the kernel is asked to copy at once, so that a copy can be abandoned
+const qint64 CopyChunkSize = 64 * 1024 * 1024;
+
+class FileClonerTask : public QRunnable
+{
+public:
+
+    explicit FileClonerTask(FileCloner *cloner)
+        : mCloner(cloner)
+    {
+    }
+
+    virtual void run()
+    {
+        mCloner->run();
+    }
+
+private:
+
+    FileCloner *mCloner;
+};
+
+FileCloner::FileCloner(const IoHandlePtr &source, int destination, qint64 length, QObject *parent)
+    : QObject(parent),
+      mSource(source),
+      mDestination(destination),
+      mLength(length)
+{
+    mPool.setMaxThreadCount(1);
+}
+
+FileCloner::~FileCloner()
+{
+    mCancelled.store(1);
+    mPool.waitForDone();
+}
+
+void FileCloner::start()
+{
+    mPool.start(new FileClonerTask(this));
+}
+
+void FileCloner::run()
+{
+    QString error;
+    clone(mSource->fd(), mDestination, mLength, &error, &mCancelled);
+    QMetaObject::invokeMethod(this, "finished", Qt::QueuedConnection, Q_ARG(QString, error));
+}
+
+bool FileCloner::clone(int source, int destination, qint64 length, QString *error,
+                       const QAtomicInt *cancelled)
+{
+#ifdef Q_OS_UNIX
+
+#  if defined(Q_OS_LINUX) && defined(FICLONE)
+    // Share the extents of the source file where the filesystem allows it
+    if (ioctl(destination, FICLONE, source) == 0) {
+        return true;
+    }
+#  endif
+
+    qint64 offset = 0;
+
+#  if defined(Q_OS_LINUX) && defined(SYS_copy_file_range)
+    // Have the kernel copy the data without passing it through userspace
+    while (offset < length && !(cancelled && cancelled->load())) {
+        qint64 sourceOffset = offset;
+        qint64 destinationOffset = offset;
+        long ret = syscall(SYS_copy_file_range, source, &sourceOffset,
+            destination, &destinationOffset, static_cast<size_t>(qMin(length - offset, CopyChunkSize)), 0);
+        if (ret == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            break;
+        }
+        offset += ret;
+    }
+#  endif
+
+    // Copy whatever remains the traditional way
+    QByteArray buffer(CopyBufferSize, Qt::Uninitialized);
+    while (offset < length) {
+        if (cancelled && cancelled->load()) {
+            *error = "copy was abandoned";
+            return false;
+        }
+        ssize_t bytesRead = pread(source, buffer.data(), buffer.size(), offset);
+        if (bytesRead == -1 && errno == EINTR) {
+            continue;
+        }
+        if (bytesRead <= 0) {
+            *error = bytesRead ? IoEngine::errorString(-errno) : QString("unexpected end of file");
+            return false;
+        }
+        for (ssize_t written = 0; written < bytesRead;) {
+            ssize_t ret = pwrite(destination, buffer.constData() + written, bytesRead - written, offset + written);
+            if (ret == -1 && errno == EINTR) {
+                continue;
+            }
+            if (ret <= 0) {
+                *error = IoEngine::errorString(-errno);
+                return false;
+            }
+            written += ret;
+        }
+        offset += bytesRead;
+    }
+
+    return true;
+
+#else
+    Q_UNUSED(source)
+    Q_UNUSED(destination)
+    Q_UNUSED(length)
+    Q_UNUSED(cancelled)
+    *error = "cloning files is not supported";
+    return false;
+#endif
+}
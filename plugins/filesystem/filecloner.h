@@ -0,0 +1,104 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef FILECLONER_H
+#define FILECLONER_H
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+#include "ioengine.h"
+
+/**
+ * @brief Copy files directly when sender and receiver share a host
+ *
+ * When a transfer is sent over a transport that can pass descriptors (which
+ * implies the receiver is on the same host), files are not sent over the
+ * transport at all. Instead, the receiver is given a descriptor for the file
+ * and creates a copy-on-write clone of it where the filesystem supports it,
+ * falling back to an in-kernel copy or reading and writing the data
+ * otherwise.
+ *
+ * Since the fallbacks copy the entire file, the copy is made on a background
+ * thread and finished() is emitted once it completes. The destination must
+ * remain open until then; destroying the cloner abandons the copy and waits
+ * for the thread to stop.
+ */
+class FileCloner : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Create a cloner for a file
+     * @param source file to copy
+     * @param destination descriptor for the new file
+     * @param length number of bytes to copy
+     * @param parent QObject
+     */
+    FileCloner(const IoHandlePtr &source, int destination, qint64 length, QObject *parent = nullptr);
+    virtual ~FileCloner();
+
+    /**
+     * @brief Begin copying the file in the background
+     */
+    void start();
+
+    /**
+     * @brief Copy the contents of one file to another
+     * @param source descriptor for the file to copy
+     * @param destination descriptor for the new file
+     * @param length number of bytes to copy
+     * @param error pointer to a string that will contain an error description
+     * @param cancelled set to abandon the copy from another thread
+     * @return true if the file was copied
+     */
+    static bool clone(int source, int destination, qint64 length, QString *error,
+                      const QAtomicInt *cancelled = nullptr);
+
+    // Used by the task on the thread pool
+    void run();
+
+signals:
+
+    /**
+     * @brief Indicate that the copy completed
+     * @param error description of the error or a null string on success
+     */
+    void finished(const QString &error);
+
+private:
+
+    IoHandlePtr mSource;
+    int mDestination;
+    qint64 mLength;
+
+    QAtomicInt mCancelled;
+    QThreadPool mPool;
+};
+
+#endif // FILECLONER_H
@@ -30,23 +30,45 @@
 #include "file.h"
 #include "filehandler.h"
 
+#ifdef Q_OS_UNIX
+#  include "metadatawriter.h"
+#endif
+
 const QString TransferDirectory = "TransferDirectory";
 
-FileHandler::FileHandler(Application *application)
+// True to keep received files out of the page cache
+const QString UncachedWrites = "UncachedWrites";
+
+FileHandler::FileHandler(Application *application, IoEngine *engine, DirectoryCache *directoryCache)
     : mApplication(application),
+      mEngine(engine),
+#ifdef Q_OS_UNIX
+      mMetadataWriter(new MetadataWriter(application, this)),
+#else
+      mMetadataWriter(nullptr),
+#endif
+      mDirectoryCache(directoryCache),
       mTransferDirectory({
           { Setting::TypeKey, Setting::DirectoryPath },
           { Setting::NameKey, TransferDirectory },
           { Setting::TitleKey, tr("Transfer Directory") },
           { Setting::DefaultValueKey, QStandardPaths::writableLocation(QStandardPaths::DownloadLocation) }
+      }),
+      mUncachedWrites({
+          { Setting::TypeKey, Setting::Boolean },
+          { Setting::NameKey, UncachedWrites },
+          { Setting::TitleKey, tr("Bypass Cache for Received Files") },
+          { Setting::DefaultValueKey, false }
       })
 {
     mApplication->settingsRegistry()->addSetting(&mTransferDirectory);
+    mApplication->settingsRegistry()->addSetting(&mUncachedWrites);
 }
 
 FileHandler::~FileHandler()
 {
     mApplication->settingsRegistry()->removeSetting(&mTransferDirectory);
+    mApplication->settingsRegistry()->removeSetting(&mUncachedWrites);
 }
 
 QString FileHandler::name() const
@@ -57,7 +79,11 @@ QString FileHandler::name() const
 Item *FileHandler::createItem(const QString &, const QVariantMap &properties)
 {
     return new File(
+        mEngine,
+        mMetadataWriter,
+        mDirectoryCache,
         mApplication->settingsRegistry()->value(TransferDirectory).toString(),
-        properties
+        properties,
+        mApplication->settingsRegistry()->value(UncachedWrites).toBool()
     );
 }
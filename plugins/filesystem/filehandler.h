@@ -29,6 +29,9 @@
 #include <nitroshare/setting.h>
 
 class Application;
+class DirectoryCache;
+class IoEngine;
+class MetadataWriter;
 
 /**
  * @brief Handler for files on the local filesystem
@@ -39,7 +42,7 @@ class FileHandler : public Handler
 
 public:
 
-    explicit FileHandler(Application *application);
+    FileHandler(Application *application, IoEngine *engine, DirectoryCache *directoryCache);
     virtual ~FileHandler();
 
     virtual QString name() const;
@@ -48,8 +51,12 @@ public:
 private:
 
     Application *mApplication;
+    IoEngine *mEngine;
+    MetadataWriter *mMetadataWriter;
+    DirectoryCache *mDirectoryCache;
 
     Setting mTransferDirectory;
+    Setting mUncachedWrites;
 };
 
 #endif // FILEHANDLER_H
@@ -25,26 +25,58 @@
 #include <nitroshare/actionregistry.h>
 #include <nitroshare/application.h>
 #include <nitroshare/handlerregistry.h>
+#include <nitroshare/logger.h>
+#include <nitroshare/message.h>
 
+#include "directorycache.h"
+#include "directoryhandler.h"
 #include "file.h"
 #include "filehandler.h"
 #include "filesystemplugin.h"
+#include "ioengine.h"
 #include "senditemsaction.h"
 
+#ifdef Q_OS_UNIX
+#  include "mappedreader.h"
+#endif
+
+const QString MessageTag = "filesystem";
+
 void FilesystemPlugin::initialize(Application *application)
 {
-    mFileHandler = new FileHandler(application);
-    mAction = new SendItemsAction(application);
+    // Files are read and written asynchronously when the platform allows it
+    mEngine = IoEngine::create();
+    application->logger()->log(new Message(
+        Message::Info,
+        MessageTag,
+        QString("using %1 for file I/O").arg(mEngine ? mEngine->name() : QString("QFile"))
+    ));
 
+    // Directories created for received items are shared by both handlers
+    mDirectoryCache = new DirectoryCache;
+    mDirectoryHandler = new DirectoryHandler(application, mDirectoryCache);
+    mFileHandler = new FileHandler(application, mEngine, mDirectoryCache);
+    mAction = new SendItemsAction(application, mEngine);
+
+    application->handlerRegistry()->add(mDirectoryHandler);
     application->handlerRegistry()->add(mFileHandler);
     application->actionRegistry()->add(mAction);
 }
 
 void FilesystemPlugin::cleanup(Application *application)
 {
+    application->handlerRegistry()->remove(mDirectoryHandler);
     application->handlerRegistry()->remove(mFileHandler);
     application->actionRegistry()->remove(mAction);
 
+    delete mDirectoryHandler;
     delete mFileHandler;
     delete mAction;
+    delete mDirectoryCache;
+    delete mEngine;
+
+#ifdef Q_OS_UNIX
+    // The handler is only installed if a file was mapped
+    MappedReader::removeHandler();
+#endif
 }
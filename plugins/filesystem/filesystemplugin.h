@@ -27,7 +27,10 @@
 
 #include <nitroshare/iplugin.h>
 
+class DirectoryCache;
+class DirectoryHandler;
 class FileHandler;
+class IoEngine;
 class SendItemsAction;
 
 class Q_DECL_EXPORT FilesystemPlugin : public IPlugin
@@ -42,6 +45,9 @@ public:
 
 private:
 
+    IoEngine *mEngine;
+    DirectoryCache *mDirectoryCache;
+    DirectoryHandler *mDirectoryHandler;
     FileHandler *mFileHandler;
     SendItemsAction *mAction;
 };
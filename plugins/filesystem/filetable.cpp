@@ -0,0 +1,142 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QFile>
+
+#include "directory.h"
+#include "file.h"
+#include "filetable.h"
+
+FileTable::FileTable()
+    : mEngine(nullptr),
+      mBlockSize(0),
+      mMapped(false),
+      mSparse(false),
+      mClone(false),
+      mTotalSize(0)
+{
+    mNameOffsets.append(0);
+}
+
+int FileTable::addDirectory(const QString &absolutePath, const QString &relativePath)
+{
+    mAbsoluteDirectories.append(absolutePath);
+    mRelativeDirectories.append(relativePath);
+    return mAbsoluteDirectories.count() - 1;
+}
+
+void FileTable::addDirectoryItem(int directory)
+{
+    mNameOffsets.append(mNames.size());
+    mDirectories.append(directory);
+    mSizes.append(0);
+    mFlags.append(IsDirectory);
+    mCreated.append(0);
+    mLastRead.append(0);
+    mLastModified.append(0);
+}
+
+void FileTable::addFile(int directory, const QByteArray &name, qint64 size, bool readOnly,
+                        bool executable, qint64 created, qint64 lastRead, qint64 lastModified)
+{
+    mNames.append(name);
+    mNameOffsets.append(mNames.size());
+    mDirectories.append(directory);
+    mSizes.append(size);
+    mFlags.append((readOnly ? ReadOnly : 0) | (executable ? Executable : 0));
+    mCreated.append(created);
+    mLastRead.append(lastRead);
+    mLastModified.append(lastModified);
+
+    mTotalSize += size;
+}
+
+void FileTable::setOptions(IoEngine *engine, int blockSize, bool mapped, bool sparse, bool clone)
+{
+    mEngine = engine;
+    mBlockSize = blockSize;
+    mMapped = mapped;
+    mSparse = sparse;
+    mClone = clone;
+}
+
+FileEntry FileTable::entry(int index) const
+{
+    int offset = mNameOffsets.at(index);
+    QByteArray encodedName = QByteArray::fromRawData(
+        mNames.constData() + offset,
+        mNameOffsets.at(index + 1) - offset
+    );
+#ifdef Q_OS_UNIX
+    QString name = QFile::decodeName(encodedName);
+#else
+    QString name = QString::fromUtf8(encodedName);
+#endif
+
+    int directory = mDirectories.at(index);
+    const QString &relativeDirectory = mRelativeDirectories.at(directory);
+
+    return FileEntry{
+        mAbsoluteDirectories.at(directory) + "/" + name,
+        relativeDirectory.isEmpty() ? name : relativeDirectory + "/" + name,
+        mSizes.at(index),
+        static_cast<bool>(mFlags.at(index) & ReadOnly),
+        static_cast<bool>(mFlags.at(index) & Executable),
+        mCreated.at(index),
+        mLastRead.at(index),
+        mLastModified.at(index)
+    };
+}
+
+QByteArray FileTable::encodeName(const QString &name)
+{
+    // Names are kept in the form returned by the filesystem where possible
+#ifdef Q_OS_UNIX
+    return QFile::encodeName(name);
+#else
+    return name.toUtf8();
+#endif
+}
+
+int FileTable::count() const
+{
+    return mDirectories.count();
+}
+
+qint64 FileTable::totalSize() const
+{
+    return mTotalSize;
+}
+
+Item *FileTable::createItem(int index)
+{
+    if (mFlags.at(index) & IsDirectory) {
+        int directory = mDirectories.at(index);
+        return new Directory(
+            mAbsoluteDirectories.at(directory),
+            mRelativeDirectories.at(directory)
+        );
+    }
+    return new File(mEngine, entry(index), mBlockSize, mMapped, mSparse, mClone);
+}
@@ -0,0 +1,142 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef FILETABLE_H
+#define FILETABLE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <nitroshare/itemprovider.h>
+
+class IoEngine;
+
+/**
+ * @brief Metadata for a file found while walking a directory
+ */
+struct FileEntry
+{
+    QString absolutePath;
+    QString relativePath;
+    qint64 size;
+    bool readOnly;
+    bool executable;
+    qint64 created;
+    qint64 lastRead;
+    qint64 lastModified;
+};
+
+/**
+ * @brief Compact table of files to send
+ *
+ * Metadata is stored in one array per field rather than one object per file.
+ * Files refer to their parent directory by index so that the path is stored
+ * once per directory and names are packed into a single buffer in their
+ * encoded form. A File (or Directory) is only created when the bundle
+ * requests it.
+ */
+class FileTable : public ItemProvider
+{
+public:
+
+    FileTable();
+
+    /**
+     * @brief Add a directory that files can be added to
+     * @param absolutePath absolute path to the directory
+     * @param relativePath path to the directory relative to the transfer root
+     * @return index of the directory
+     */
+    int addDirectory(const QString &absolutePath, const QString &relativePath);
+
+    /**
+     * @brief Add an item for a directory to the table
+     * @param directory index of the directory
+     *
+     * The item should be added before any files in the directory so that the
+     * directory is created ahead of them.
+     */
+    void addDirectoryItem(int directory);
+
+    /**
+     * @brief Add a file to the table
+     * @param directory index of the parent directory
+     * @param name filename encoded with encodeName()
+     */
+    void addFile(int directory, const QByteArray &name, qint64 size, bool readOnly,
+                 bool executable, qint64 created, qint64 lastRead, qint64 lastModified);
+
+    /**
+     * @brief Set the parameters used for creating files
+     */
+    void setOptions(IoEngine *engine, int blockSize, bool mapped, bool sparse, bool clone);
+
+    /**
+     * @brief Retrieve the metadata for a file
+     * @param index position of the file in the table
+     */
+    FileEntry entry(int index) const;
+
+    /**
+     * @brief Encode a filename for storage in the table
+     */
+    static QByteArray encodeName(const QString &name);
+
+    // Reimplemented virtual methods
+    virtual int count() const;
+    virtual qint64 totalSize() const;
+    virtual Item *createItem(int index);
+
+private:
+
+    enum {
+        ReadOnly = 1,
+        Executable = 2,
+        IsDirectory = 4
+    };
+
+    IoEngine *mEngine;
+    int mBlockSize;
+    bool mMapped;
+    bool mSparse;
+    bool mClone;
+
+    QStringList mAbsoluteDirectories;
+    QStringList mRelativeDirectories;
+
+    QByteArray mNames;
+    QVector<int> mNameOffsets;
+    QVector<int> mDirectories;
+    QVector<qint64> mSizes;
+    QVector<quint8> mFlags;
+    QVector<qint64> mCreated;
+    QVector<qint64> mLastRead;
+    QVector<qint64> mLastModified;
+
+    qint64 mTotalSize;
+};
+
+#endif // FILETABLE_H
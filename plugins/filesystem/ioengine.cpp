@@ -0,0 +1,184 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "filesystemconfig.h"
+
+#include <cerrno>
+#include <climits>
+
+#include <QtGlobal>
+
+#ifdef Q_OS_UNIX
+#  include <fcntl.h>
+#  include <unistd.h>
+#endif
+
+#include <QFile>
+
+#include "ioengine.h"
+
+#ifdef Q_OS_UNIX
+#  include "threadioengine.h"
+#endif
+
+#ifdef HAVE_IO_URING
+#  include "uringioengine.h"
+#endif
+
+IoHandle::IoHandle(int fd)
+    : mFd(fd)
+{
+}
+
+IoHandle::~IoHandle()
+{
+#ifdef Q_OS_UNIX
+    ::close(mFd);
+#endif
+}
+
+int IoHandle::fd() const
+{
+    return mFd;
+}
+
+IoEngine *IoEngine::create(QObject *parent)
+{
+#ifdef HAVE_IO_URING
+    // io_uring may be unavailable (old kernel, seccomp, etc.) even when the
+    // headers are present, in which case the thread pool is used instead
+    IoEngine *engine = UringIoEngine::create(parent);
+    if (engine) {
+        return engine;
+    }
+#endif
+
+#ifdef Q_OS_UNIX
+    return new ThreadIoEngine(parent);
+#else
+    Q_UNUSED(parent)
+    return nullptr;
+#endif
+}
+
+IoHandlePtr IoEngine::open(const QString &filename, Item::OpenMode openMode, QString *error)
+{
+#ifdef Q_OS_UNIX
+    int flags = O_CLOEXEC | (openMode == Item::Read ?
+        O_RDONLY : O_WRONLY | O_CREAT | O_TRUNC);
+
+    int fd;
+    do {
+        fd = ::open(QFile::encodeName(filename).constData(), flags, 0666);
+    } while (fd == -1 && errno == EINTR);
+
+    if (fd == -1) {
+        if (error) {
+            *error = errorString(-errno);
+        }
+        return IoHandlePtr();
+    }
+
+    return IoHandlePtr(new IoHandle(fd));
+#else
+    Q_UNUSED(filename)
+    Q_UNUSED(openMode)
+    if (error) {
+        *error = tr("asynchronous I/O is not supported");
+    }
+    return IoHandlePtr();
+#endif
+}
+
+void IoEngine::adviseSequential(const IoHandlePtr &handle, qint64 length)
+{
+#if defined(Q_OS_LINUX) || defined(Q_OS_FREEBSD)
+    posix_fadvise(handle->fd(), 0, 0, POSIX_FADV_SEQUENTIAL);
+    posix_fadvise(handle->fd(), 0, length, POSIX_FADV_WILLNEED);
+#elif defined(Q_OS_DARWIN)
+    struct radvisory advisory;
+    advisory.ra_offset = 0;
+    advisory.ra_count = static_cast<int>(qMin<qint64>(length, INT_MAX));
+    fcntl(handle->fd(), F_RDADVISE, &advisory);
+#else
+    Q_UNUSED(handle)
+    Q_UNUSED(length)
+#endif
+}
+
+bool IoEngine::disableCache(const IoHandlePtr &handle)
+{
+#ifdef Q_OS_DARWIN
+    return fcntl(handle->fd(), F_NOCACHE, 1) == 0;
+#else
+    Q_UNUSED(handle)
+    return false;
+#endif
+}
+
+qint64 IoEngine::releaseRange(int fd, qint64 offset, qint64 length)
+{
+#if defined(Q_OS_LINUX)
+    // Unlike fdatasync(), this only waits for the range in question
+    int ret;
+    do {
+        ret = sync_file_range(fd, offset, length,
+            SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+    } while (ret == -1 && errno == EINTR);
+    if (ret == -1) {
+        return -errno;
+    }
+    return -posix_fadvise(fd, offset, length, POSIX_FADV_DONTNEED);
+#elif defined(Q_OS_UNIX)
+    int ret;
+    do {
+        ret = fsync(fd);
+    } while (ret == -1 && errno == EINTR);
+    if (ret == -1) {
+        return -errno;
+    }
+#  ifdef POSIX_FADV_DONTNEED
+    return -posix_fadvise(fd, offset, length, POSIX_FADV_DONTNEED);
+#  else
+    Q_UNUSED(offset)
+    Q_UNUSED(length)
+    return 0;
+#  endif
+#else
+    Q_UNUSED(fd)
+    Q_UNUSED(offset)
+    Q_UNUSED(length)
+    return 0;
+#endif
+}
+
+QString IoEngine::errorString(qint64 result)
+{
+    return qt_error_string(static_cast<int>(-result));
+}
+
+IoEngine::IoEngine(QObject *parent)
+    : QObject(parent)
+{
+}
@@ -0,0 +1,169 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef IOENGINE_H
+#define IOENGINE_H
+
+#include <functional>
+
+#include <QByteArray>
+#include <QObject>
+#include <QSharedPointer>
+#include <QString>
+
+#include <nitroshare/item.h>
+
+/**
+ * @brief Descriptor for a file opened by the engine
+ *
+ * The descriptor is closed when the last reference to the handle is released,
+ * ensuring that it remains valid while requests using it are in flight.
+ */
+class IoHandle
+{
+public:
+
+    explicit IoHandle(int fd);
+    ~IoHandle();
+
+    int fd() const;
+
+private:
+
+    Q_DISABLE_COPY(IoHandle)
+
+    int mFd;
+};
+
+typedef QSharedPointer<IoHandle> IoHandlePtr;
+
+/**
+ * @brief Engine for performing file I/O without blocking the event loop
+ *
+ * Reads and writes are submitted to the engine and complete asynchronously.
+ * The callback for each request is always invoked on the thread that owns the
+ * engine and receives the number of bytes transferred or a negative error
+ * code (-errno) if the request failed.
+ */
+class IoEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    typedef std::function<void(qint64 result, const QByteArray &data)> Callback;
+
+    /**
+     * @brief Create the best engine available on this platform
+     * @param parent QObject
+     * @return pointer to IoEngine or nullptr if asynchronous I/O is unsupported
+     */
+    static IoEngine *create(QObject *parent = nullptr);
+
+    /**
+     * @brief Open a file for use with the engine
+     * @param filename absolute path to the file
+     * @param openMode mode used for opening the file
+     * @param error pointer to a string that will contain an error description
+     * @return handle or null if the file could not be opened
+     */
+    static IoHandlePtr open(const QString &filename, Item::OpenMode openMode, QString *error = nullptr);
+
+    /**
+     * @brief Indicate that a file will be read sequentially
+     * @param handle file that will be read
+     * @param length number of bytes at the start of the file needed soon
+     *
+     * The kernel is asked to begin reading the start of the file into the
+     * page cache without waiting for it to complete.
+     */
+    static void adviseSequential(const IoHandlePtr &handle, qint64 length);
+
+    /**
+     * @brief Disable caching of file data where the platform supports it
+     * @param handle file to disable caching for
+     * @return true if caching was disabled for the whole file
+     *
+     * When this returns false, release() must be used to drop data from the
+     * page cache once it was written.
+     */
+    static bool disableCache(const IoHandlePtr &handle);
+
+    /**
+     * @brief Write back a range of a file and drop it from the page cache
+     * @param fd descriptor for the file
+     * @param offset start of the range
+     * @param length number of bytes in the range
+     * @return 0 on success or -errno on failure
+     *
+     * This call blocks until the data is on disk.
+     */
+    static qint64 releaseRange(int fd, qint64 offset, qint64 length);
+
+    /**
+     * @brief Retrieve a description of an error code passed to a callback
+     */
+    static QString errorString(qint64 result);
+
+    /**
+     * @brief Retrieve a name describing the engine implementation
+     */
+    virtual QString name() const = 0;
+
+    /**
+     * @brief Read a block of data from a file
+     * @param handle file to read from
+     * @param offset position in the file
+     * @param size number of bytes to read
+     * @param callback invoked with the data that was read
+     */
+    virtual void read(const IoHandlePtr &handle, qint64 offset, int size, Callback callback) = 0;
+
+    /**
+     * @brief Write a block of data to a file
+     * @param handle file to write to
+     * @param offset position in the file
+     * @param data bytes to write
+     * @param callback invoked once the data was written
+     */
+    virtual void write(const IoHandlePtr &handle, qint64 offset, const QByteArray &data, Callback callback) = 0;
+
+    /**
+     * @brief Write back a range of a file and drop it from the page cache
+     * @param handle file containing the range
+     * @param offset start of the range
+     * @param length number of bytes in the range
+     * @param callback invoked once the range was released
+     *
+     * Only data that was written before the request is submitted is
+     * guaranteed to be released.
+     */
+    virtual void release(const IoHandlePtr &handle, qint64 offset, qint64 length, Callback callback) = 0;
+
+protected:
+
+    explicit IoEngine(QObject *parent);
+};
+
+#endif // IOENGINE_H
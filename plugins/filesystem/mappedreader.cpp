@@ -0,0 +1,332 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <atomic>
+#include <cerrno>
+#include <csetjmp>
+#include <csignal>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <QObject>
+
+#include "mappedreader.h"
+
+// Size of a huge page on most platforms; windows are a multiple of this so
+// that transparent huge pages can be used for the mapping
+const qint64 HugePageSize = 2 * 1024 * 1024;
+
+// Amount of the file mapped at once
+const qint64 WindowSize = 4 * HugePageSize;
+
+// Maximum number of windows mapped at once by all readers
+const int MaxWindows = 1024;
+
+// Jump target for the thread currently touching mapped pages (if any)
+static thread_local sigjmp_buf *currentGuard = nullptr;
+
+// State of the SIGBUS handler; once it is lost to a fault outside of the
+// mappings it is never installed again
+enum HandlerState {
+    HandlerMissing,
+    HandlerInstalled,
+    HandlerLost
+};
+
+static struct sigaction previousAction;
+static volatile sig_atomic_t handlerState = HandlerMissing;
+static quintptr pageSize = 4096;
+
+// Address ranges of the mapped windows, which the handler uses to recognize
+// faults in blocks that were already handed out
+struct MappedRange
+{
+    std::atomic<quintptr> start;
+    std::atomic<quintptr> end;
+    std::atomic<bool> faulted;
+};
+
+static MappedRange mappedRanges[MaxWindows];
+
+// Windows whose reader was destroyed while their blocks were still in use
+static QList<MappedReader::Window> orphanedWindows;
+
+static void onSigBus(int signal, siginfo_t *info, void *context)
+{
+    if (currentGuard) {
+        siglongjmp(*currentGuard, 1);
+    }
+
+    // A block that was handed out is being read after the file was truncated;
+    // the missing page is replaced with zeros so that the access can complete
+    // and the reader reports the truncation instead
+    quintptr address = reinterpret_cast<quintptr>(info->si_addr);
+    for (int i = 0; i < MaxWindows; ++i) {
+        if (address >= mappedRanges[i].start && address < mappedRanges[i].end) {
+            void *page = reinterpret_cast<void*>(address & ~(pageSize - 1));
+            if (mmap(page, pageSize, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED, -1, 0) != MAP_FAILED) {
+                mappedRanges[i].faulted = true;
+                return;
+            }
+        }
+    }
+
+    // The fault did not occur in a mapping; restore the previous handler so
+    // that it runs when the faulting instruction is retried
+    Q_UNUSED(signal)
+    Q_UNUSED(context)
+    sigaction(SIGBUS, &previousAction, nullptr);
+    handlerState = HandlerLost;
+}
+
+// Touch every page in the range, returning false if any of them are beyond
+// the end of the file
+static bool touchPages(const char *data, size_t length)
+{
+    sigjmp_buf guard;
+    if (sigsetjmp(guard, 0)) {
+        currentGuard = nullptr;
+        return false;
+    }
+
+    currentGuard = &guard;
+    quintptr start = reinterpret_cast<quintptr>(data);
+    quintptr end = start + length;
+    char value = *reinterpret_cast<const volatile char*>(start);
+    for (quintptr page = (start | (pageSize - 1)) + 1; page < end; page += pageSize) {
+        value = *reinterpret_cast<const volatile char*>(page);
+    }
+    Q_UNUSED(value)
+    currentGuard = nullptr;
+
+    return true;
+}
+
+// Unmap a window unless blocks served from it are still in use elsewhere
+static bool unmapWindow(MappedReader::Window &window)
+{
+    foreach (const QByteArray &block, window.blocks) {
+        if (!block.isDetached()) {
+            return false;
+        }
+    }
+
+    mappedRanges[window.range].start = 0;
+    mappedRanges[window.range].end = 0;
+    mappedRanges[window.range].faulted = false;
+    munmap(window.data, window.length);
+    return true;
+}
+
+// Unmap orphaned windows that are no longer in use
+static void releaseOrphans()
+{
+    for (auto i = orphanedWindows.begin(); i != orphanedWindows.end();) {
+        if (unmapWindow(*i)) {
+            i = orphanedWindows.erase(i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+MappedReader::MappedReader(const IoHandlePtr &handle, qint64 size)
+    : mHandle(handle),
+      mSize(size)
+{
+}
+
+MappedReader::~MappedReader()
+{
+    // Windows cannot be unmapped while blocks served from them are in use,
+    // so those are kept until they are released
+    foreach (const Window &window, mWindows) {
+        orphanedWindows.append(window);
+    }
+    releaseOrphans();
+}
+
+QByteArray MappedReader::read(qint64 offset, int maxSize, QString *error)
+{
+    // Without the handler, touching a truncated page would kill the process
+    if (handlerState != HandlerInstalled) {
+        return readDirect(offset, maxSize, error);
+    }
+
+    releaseOrphans();
+
+    qint64 index = offset / WindowSize;
+
+    // Map the next window ahead of time so that the kernel begins reading it
+    if ((index + 1) * WindowSize < mSize) {
+        map(index + 1, nullptr);
+    }
+
+    Window *window = map(index, error);
+    if (!window) {
+        return QByteArray();
+    }
+
+    // Earlier windows are unmapped once their blocks are no longer in use
+    unmapBefore(index);
+
+    // A block that was already handed out may have been served with zeros
+    foreach (const Window &mapped, mWindows) {
+        if (mappedRanges[mapped.range].faulted) {
+            *error = QObject::tr("file was truncated while being read");
+            return QByteArray();
+        }
+    }
+
+    qint64 windowOffset = offset - index * WindowSize;
+    size_t length = qMin<qint64>(maxSize, window->length - windowOffset);
+
+    if (!length) {
+        return QByteArray();
+    }
+
+    // The pages are touched under the guard so that truncation is detected
+    // before the block is handed out rather than wherever it is used
+    const char *data = window->data + windowOffset;
+    if (!touchPages(data, length)) {
+        *error = QObject::tr("file was truncated while being read");
+        return QByteArray();
+    }
+
+    // The block refers directly to the mapping; a copy is kept so that the
+    // window remains mapped for as long as the block is in use
+    QByteArray block = QByteArray::fromRawData(data, static_cast<int>(length));
+    window->blocks.append(block);
+    return block;
+}
+
+bool MappedReader::installHandler()
+{
+    if (handlerState != HandlerMissing) {
+        return handlerState == HandlerInstalled;
+    }
+
+    pageSize = static_cast<quintptr>(sysconf(_SC_PAGESIZE));
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = onSigBus;
+    action.sa_flags = SA_SIGINFO | SA_NODEFER;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGBUS, &action, &previousAction) == 0) {
+        handlerState = HandlerInstalled;
+    }
+    return handlerState == HandlerInstalled;
+}
+
+void MappedReader::removeHandler()
+{
+    // Windows still in use at this point are left mapped
+    releaseOrphans();
+
+    if (handlerState == HandlerInstalled) {
+        sigaction(SIGBUS, &previousAction, nullptr);
+    }
+    handlerState = HandlerMissing;
+}
+
+QByteArray MappedReader::readDirect(qint64 offset, int maxSize, QString *error)
+{
+    int size = static_cast<int>(qMin<qint64>(maxSize, mSize - offset));
+    if (size <= 0) {
+        return QByteArray();
+    }
+
+    QByteArray data(size, Qt::Uninitialized);
+    ssize_t ret;
+    do {
+        ret = pread(mHandle->fd(), data.data(), size, offset);
+    } while (ret == -1 && errno == EINTR);
+
+    if (ret <= 0) {
+        if (ret == -1) {
+            *error = IoEngine::errorString(-errno);
+        }
+        return QByteArray();
+    }
+
+    data.resize(static_cast<int>(ret));
+    return data;
+}
+
+MappedReader::Window *MappedReader::map(qint64 index, QString *error)
+{
+    for (auto i = mWindows.begin(); i != mWindows.end(); ++i) {
+        if (i->index == index) {
+            return &*i;
+        }
+    }
+
+    // Find a free slot for the address range
+    int range = 0;
+    while (range < MaxWindows && mappedRanges[range].end) {
+        ++range;
+    }
+    if (range == MaxWindows) {
+        if (error) {
+            *error = QObject::tr("too many blocks of mapped files are in use");
+        }
+        return nullptr;
+    }
+
+    size_t length = qMin(WindowSize, mSize - index * WindowSize);
+    void *data = mmap(nullptr, length, PROT_READ, MAP_SHARED, mHandle->fd(), index * WindowSize);
+    if (data == MAP_FAILED) {
+        if (error) {
+            *error = IoEngine::errorString(-errno);
+        }
+        return nullptr;
+    }
+
+    madvise(data, length, MADV_SEQUENTIAL);
+    madvise(data, length, MADV_WILLNEED);
+#ifdef MADV_HUGEPAGE
+    madvise(data, length, MADV_HUGEPAGE);
+#endif
+
+    mappedRanges[range].faulted = false;
+    mappedRanges[range].start = reinterpret_cast<quintptr>(data);
+    mappedRanges[range].end = reinterpret_cast<quintptr>(data) + length;
+
+    mWindows.append({ index, static_cast<char*>(data), length, range, {} });
+    return &mWindows.last();
+}
+
+void MappedReader::unmapBefore(qint64 index)
+{
+    for (auto i = mWindows.begin(); i != mWindows.end();) {
+        if (i->index < index && unmapWindow(*i)) {
+            i = mWindows.erase(i);
+        } else {
+            ++i;
+        }
+    }
+}
@@ -0,0 +1,106 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef MAPPEDREADER_H
+#define MAPPEDREADER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+#include "ioengine.h"
+
+/**
+ * @brief Serve blocks of a file directly from a memory mapping
+ *
+ * The file is mapped in windows aligned to the size of a huge page. Blocks
+ * returned by read() refer directly to the mapping without being copied, and
+ * each window stays mapped for as long as any of its blocks are in use, even
+ * after the reader is destroyed.
+ *
+ * If the file is truncated while it is being read, accessing the missing pages
+ * would raise SIGBUS. The pages of each block are touched under a signal guard
+ * before it is returned so that truncation is reported as an error instead;
+ * pages that disappear after that are replaced with zeros by the handler and
+ * reported by the next read. The handler must be installed with
+ * installHandler() before a reader is created and removed again with
+ * removeHandler() before the plugin is unloaded. Should the handler ever be
+ * lost, blocks are read with pread().
+ */
+class MappedReader
+{
+public:
+
+    MappedReader(const IoHandlePtr &handle, qint64 size);
+    ~MappedReader();
+
+    /**
+     * @brief Retrieve a block of the file
+     * @param offset position in the file
+     * @param maxSize maximum number of bytes to return
+     * @param error pointer to a string that will contain an error description
+     * @return block of data or an empty array if an error occurred
+     */
+    QByteArray read(qint64 offset, int maxSize, QString *error);
+
+    /**
+     * @brief Install the SIGBUS handler used to guard reads
+     * @return true if the handler is installed
+     *
+     * The handler is process-wide, so it is only installed once a file is
+     * actually mapped.
+     */
+    static bool installHandler();
+
+    /**
+     * @brief Restore the SIGBUS handler that was replaced
+     */
+    static void removeHandler();
+
+    /**
+     * @brief Part of the file that is mapped
+     */
+    struct Window
+    {
+        qint64 index;
+        char *data;
+        size_t length;
+        int range;
+        QList<QByteArray> blocks;
+    };
+
+private:
+
+    Q_DISABLE_COPY(MappedReader)
+
+    QByteArray readDirect(qint64 offset, int maxSize, QString *error);
+    Window *map(qint64 index, QString *error);
+    void unmapBefore(qint64 index);
+
+    IoHandlePtr mHandle;
+    qint64 mSize;
+    QList<Window> mWindows;
+};
+
+#endif // MAPPEDREADER_H
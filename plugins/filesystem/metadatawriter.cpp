@@ -0,0 +1,198 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cerrno>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QRunnable>
+
+#include <nitroshare/application.h>
+#include <nitroshare/logger.h>
+#include <nitroshare/message.h>
+
+#include "metadatawriter.h"
+
+const QString MessageTag = "metadatawriter";
+
+// Maximum number of files (and therefore descriptors) waiting for metadata
+const int MaxPending = 256;
+
+class MetadataWriterTask : public QRunnable
+{
+public:
+
+    explicit MetadataWriterTask(MetadataWriter *writer)
+        : mWriter(writer)
+    {
+    }
+
+    virtual void run()
+    {
+        mWriter->process();
+    }
+
+private:
+
+    MetadataWriter *mWriter;
+};
+
+static struct timespec toTimespec(qint64 timestampMs)
+{
+    struct timespec time;
+    if (timestampMs) {
+        time.tv_sec = timestampMs / 1000;
+        time.tv_nsec = (timestampMs % 1000) * 1000000;
+    } else {
+        time.tv_sec = 0;
+        time.tv_nsec = UTIME_OMIT;
+    }
+    return time;
+}
+
+MetadataWriter::MetadataWriter(Application *application, QObject *parent)
+    : QObject(parent),
+      mApplication(application),
+      mPending(0),
+      mRunning(false)
+{
+    mPool.setMaxThreadCount(1);
+}
+
+MetadataWriter::~MetadataWriter()
+{
+    waitForDone();
+}
+
+void MetadataWriter::add(const FileMetadata &metadata)
+{
+    {
+        QMutexLocker locker(&mMutex);
+        if (mPending < MaxPending) {
+            mQueue.append(metadata);
+            ++mPending;
+
+            // A single task processes everything queued while it runs
+            if (!mRunning) {
+                mRunning = true;
+                mPool.start(new MetadataWriterTask(this));
+            }
+            return;
+        }
+    }
+
+    // The background thread is too far behind; apply the metadata now rather
+    // than holding on to yet another descriptor
+    QString message = apply(metadata);
+    if (!message.isNull()) {
+        reportError(QString("%1: %2").arg(metadata.name).arg(message));
+    }
+}
+
+void MetadataWriter::waitForDone()
+{
+    mPool.waitForDone();
+}
+
+void MetadataWriter::process()
+{
+    int applied = 0;
+    forever {
+        QList<FileMetadata> batch;
+        {
+            QMutexLocker locker(&mMutex);
+            mPending -= applied;
+            if (mQueue.isEmpty()) {
+                mRunning = false;
+                return;
+            }
+            batch.swap(mQueue);
+        }
+
+        // Releasing the handles (once the batch goes out of scope) closes
+        // the descriptors
+        foreach (const FileMetadata &metadata, batch) {
+            QString message = apply(metadata);
+            if (!message.isNull()) {
+                QMetaObject::invokeMethod(this, "reportError", Qt::QueuedConnection,
+                    Q_ARG(QString, QString("%1: %2").arg(metadata.name).arg(message)));
+            }
+        }
+        applied = batch.count();
+    }
+}
+
+void MetadataWriter::reportError(const QString &message)
+{
+    mApplication->logger()->log(new Message(
+        Message::Error,
+        MessageTag,
+        message
+    ));
+}
+
+QString MetadataWriter::apply(const FileMetadata &metadata)
+{
+    int fd = metadata.handle->fd();
+
+    // Only adjust the mode if it needs to change
+    if (metadata.readOnly || metadata.executable) {
+        struct stat st;
+        if (fstat(fd, &st)) {
+            return IoEngine::errorString(-errno);
+        }
+
+        mode_t fileMode = st.st_mode & 07777;
+
+        // If the file is marked as read-only, remove the write bits
+        if (metadata.readOnly) {
+            fileMode &= ~(S_IWUSR | S_IWGRP | S_IWOTH);
+        }
+
+        // If the file is marked as executable, add the executable bits
+        if (metadata.executable) {
+            fileMode |= (S_IXUSR | S_IXGRP | S_IXOTH);
+        }
+
+        if ((st.st_mode & 07777) != fileMode && fchmod(fd, fileMode)) {
+            return IoEngine::errorString(-errno);
+        }
+    }
+
+    // Timestamps that were not provided are left unchanged
+    if (metadata.lastRead || metadata.lastModified) {
+        struct timespec times[2] = {
+            toTimespec(metadata.lastRead),
+            toTimespec(metadata.lastModified)
+        };
+        if (futimens(fd, times)) {
+            return IoEngine::errorString(-errno);
+        }
+    }
+
+    return QString();
+}
@@ -0,0 +1,101 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef METADATAWRITER_H
+#define METADATAWRITER_H
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+
+#include "ioengine.h"
+
+class Application;
+
+/**
+ * @brief Permissions and timestamps for a received file
+ */
+struct FileMetadata
+{
+    IoHandlePtr handle;
+    QString name;
+    bool readOnly;
+    bool executable;
+    qint64 lastRead;
+    qint64 lastModified;
+};
+
+/**
+ * @brief Apply metadata to received files in the background
+ *
+ * Metadata is applied using the descriptor of the file that was written, so
+ * paths do not need to be converted or resolved again. Files are processed
+ * in batches by a single background thread so that the transfer can move on
+ * to the next item immediately. The descriptor is closed once the metadata
+ * was applied. Since each file waiting holds a descriptor, metadata is
+ * applied immediately instead once too many are waiting.
+ */
+class MetadataWriter : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    explicit MetadataWriter(Application *application, QObject *parent = nullptr);
+    virtual ~MetadataWriter();
+
+    /**
+     * @brief Queue metadata to be applied to a file
+     * @param metadata file and metadata to apply
+     */
+    void add(const FileMetadata &metadata);
+
+    /**
+     * @brief Block until all queued metadata was applied
+     */
+    void waitForDone();
+
+    // Used by the task on the thread pool
+    void process();
+
+private slots:
+
+    void reportError(const QString &message);
+
+private:
+
+    static QString apply(const FileMetadata &metadata);
+
+    Application *mApplication;
+    QThreadPool mPool;
+
+    QMutex mMutex;
+    QList<FileMetadata> mQueue;
+    int mPending;
+    bool mRunning;
+};
+
+#endif // METADATAWRITER_H
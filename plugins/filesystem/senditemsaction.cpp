@@ -22,27 +22,66 @@
  * IN THE SOFTWARE.
  */
 
-#include <QDir>
-#include <QFileInfo>
-#include <QStack>
-
 #include <nitroshare/application.h>
 #include <nitroshare/bundle.h>
 #include <nitroshare/device.h>
 #include <nitroshare/devicemodel.h>
+#include <nitroshare/settingsregistry.h>
 #include <nitroshare/transfer.h>
 #include <nitroshare/transfermodel.h>
 
-#include "file.h"
+#include "directorywalker.h"
+#include "filetable.h"
 #include "senditemsaction.h"
 
 // TODO: make this a configurable setting
 
 const int BlockSize = 65536;
 
-SendItemsAction::SendItemsAction(Application *application)
-    : mApplication(application)
+// Maximum number of items waiting in a streaming bundle
+const int StreamLimit = 1000;
+
+// True to serve large files from a memory mapping
+const QString MappedReads = "MappedReads";
+
+// True to send only the data in sparse files
+const QString SparseFiles = "SparseFiles";
+
+// True to have devices on the same host copy files directly (if they agree)
+const QString CloneLocalFiles = "CloneLocalFiles";
+
+SendItemsAction::SendItemsAction(Application *application, IoEngine *engine)
+    : mApplication(application),
+      mEngine(engine),
+      mMappedReads({
+          { Setting::TypeKey, Setting::Boolean },
+          { Setting::NameKey, MappedReads },
+          { Setting::TitleKey, tr("Memory-Map Large Files") },
+          { Setting::DefaultValueKey, false }
+      }),
+      mSparseFiles({
+          { Setting::TypeKey, Setting::Boolean },
+          { Setting::NameKey, SparseFiles },
+          { Setting::TitleKey, tr("Skip Holes in Sparse Files") },
+          { Setting::DefaultValueKey, false }
+      }),
+      mCloneLocalFiles({
+          { Setting::TypeKey, Setting::Boolean },
+          { Setting::NameKey, CloneLocalFiles },
+          { Setting::TitleKey, tr("Copy Files Directly on the Same Host") },
+          { Setting::DefaultValueKey, false }
+      })
 {
+    mApplication->settingsRegistry()->addSetting(&mMappedReads);
+    mApplication->settingsRegistry()->addSetting(&mSparseFiles);
+    mApplication->settingsRegistry()->addSetting(&mCloneLocalFiles);
+}
+
+SendItemsAction::~SendItemsAction()
+{
+    mApplication->settingsRegistry()->removeSetting(&mMappedReads);
+    mApplication->settingsRegistry()->removeSetting(&mSparseFiles);
+    mApplication->settingsRegistry()->removeSetting(&mCloneLocalFiles);
 }
 
 QString SendItemsAction::name() const
@@ -70,6 +109,10 @@ QString SendItemsAction::description() const
         "- \"enumerator\" (string) name of the enumerator for the device\n"
         "- \"items\" (array of strings) absolute paths for the items to send\n"
         "\n"
+        "The optional \"streaming\" (boolean) parameter begins sending items "
+        "before all of them have been enumerated, which keeps memory usage "
+        "constant for very large directories.\n"
+        "\n"
         "The return value will be a boolean indicating if the transfer was created."
     );
 }
@@ -85,8 +128,16 @@ QVariant SendItemsAction::invoke(const QVariantMap &params)
         return false;
     }
 
+    // Files may be copied directly by the device, which is only possible if
+    // the transport can pass descriptors and the device agrees to it
+    bool clone = mApplication->settingsRegistry()->value(CloneLocalFiles).toBool();
+
     // Create a new bundle with the items that were provided
-    Bundle *bundle = createBundle(params.value("items").toStringList());
+    Bundle *bundle = createBundle(
+        params.value("items").toStringList(),
+        params.value("streaming").toBool(),
+        clone
+    );
 
     // Create the transfer
     mApplication->transferModel()->add(
@@ -96,43 +147,39 @@ QVariant SendItemsAction::invoke(const QVariantMap &params)
     return true;
 }
 
-Bundle *SendItemsAction::createBundle(const QStringList &items)
+Bundle *SendItemsAction::createBundle(const QStringList &items, bool streaming, bool clone)
 {
     Bundle *bundle = new Bundle;
-
-    foreach (const QString &item, items) {
-        QFileInfo info(item);
-        if (info.isFile()) {
-
-            // Add the file directly
-            bundle->add(new File(info.absolutePath(), info, BlockSize));
-
-        } else if (info.isDir()) {
-
-            // Use a stack to enumerate the content of the directory in a loop
-            QDir root(item);
-            QStack<QString> stack;
-
-            // Push the root path on the stack and then go up one level so that
-            // the relative filenames will include the name of the directory
-            stack.push(root.absolutePath());
-            root.cdUp();
-
-            // Continue to add items as long as there are items in the stack
-            while (stack.count()) {
-                auto infoList = QDir(stack.pop()).entryInfoList(
-                    QDir::Dirs | QDir::Files | QDir::Hidden | QDir::NoDotAndDotDot | QDir::NoSymLinks
-                );
-                foreach (auto &info, infoList) {
-                    if (info.isDir()) {
-                        stack.push(info.absolutePath());
-                    } else {
-                        bundle->add(new File(root, info, BlockSize));
-                    }
-                }
-            }
-        }
+    bundle->setStreaming(streaming);
+    IoEngine *engine = mEngine;
+    bool mapped = mApplication->settingsRegistry()->value(MappedReads).toBool();
+    bool sparse = mApplication->settingsRegistry()->value(SparseFiles).toBool();
+
+    // Enumerate the items in the background, adding files to the bundle as
+    // they are found; unless streaming, the transfer waits for the bundle to
+    // be completed
+    bundle->setComplete(false);
+    DirectoryWalker *walker = new DirectoryWalker(bundle);
+
+    // Items are removed from a streaming bundle once sent; only enumerate
+    // further when there is room for more
+    if (streaming) {
+        walker->setLimit(StreamLimit);
+        connect(bundle, &Bundle::rowsRemoved, walker, [walker](const QModelIndex &, int first, int last) {
+            walker->release(last - first + 1);
+        });
     }
 
+    // Files are only created for the items being transferred
+    connect(walker, &DirectoryWalker::tableFound, bundle, [bundle, engine, mapped, sparse, clone](FileTable *table) {
+        table->setOptions(engine, BlockSize, mapped, sparse, clone);
+        bundle->add(table);
+    });
+    connect(walker, &DirectoryWalker::finished, bundle, [bundle, walker]() {
+        bundle->setComplete(true);
+        walker->deleteLater();
+    });
+    walker->start(items);
+
     return bundle;
 }
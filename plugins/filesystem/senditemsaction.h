@@ -26,9 +26,11 @@
 #define SENDITEMSACTION_H
 
 #include <nitroshare/action.h>
+#include <nitroshare/setting.h>
 
 class Application;
 class Bundle;
+class IoEngine;
 
 /**
  * @brief Send a list of files or directories to another device
@@ -42,7 +44,8 @@ class SendItemsAction : public Action
 
 public:
 
-    explicit SendItemsAction(Application *application);
+    SendItemsAction(Application *application, IoEngine *engine);
+    virtual ~SendItemsAction();
 
     virtual QString name() const;
 
@@ -56,9 +59,14 @@ public slots:
 
 private:
 
-    Bundle *createBundle(const QStringList &items);
+    Bundle *createBundle(const QStringList &items, bool streaming, bool clone);
 
     Application *mApplication;
+    IoEngine *mEngine;
+
+    Setting mMappedReads;
+    Setting mSparseFiles;
+    Setting mCloneLocalFiles;
 };
 
 #endif // SENDITEMSACTION_H
@@ -0,0 +1,207 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cerrno>
+
+#include <unistd.h>
+
+#include <QMetaObject>
+#include <QMutexLocker>
+#include <QRunnable>
+
+#include "threadioengine.h"
+
+// Number of requests that may block on the disk at the same time
+const int ThreadCount = 4;
+
+struct ThreadIoEngine::Request
+{
+    enum Type {
+        Read,
+        Write,
+        Release
+    };
+
+    Type type;
+    IoHandlePtr handle;
+    qint64 offset;
+    qint64 length;
+    QByteArray buffer;
+    qint64 result;
+    Callback callback;
+};
+
+class ThreadIoTask : public QRunnable
+{
+public:
+
+    ThreadIoTask(ThreadIoEngine *engine, ThreadIoEngine::Request *request)
+        : mEngine(engine),
+          mRequest(request)
+    {
+    }
+
+    virtual void run()
+    {
+        int fd = mRequest->handle->fd();
+        qint64 size = mRequest->buffer.size();
+
+        switch (mRequest->type) {
+        case ThreadIoEngine::Request::Read:
+        {
+            // The buffer was allocated for this request and is not shared
+            char *data = mRequest->buffer.data();
+            ssize_t ret;
+            do {
+                ret = pread(fd, data, size, mRequest->offset);
+            } while (ret == -1 && errno == EINTR);
+            mRequest->result = ret == -1 ? -errno : ret;
+            break;
+        }
+        case ThreadIoEngine::Request::Write:
+        {
+
+            // Keep writing until all of the data has been written
+            const char *data = mRequest->buffer.constData();
+            qint64 written = 0;
+            while (written < size) {
+                ssize_t ret = pwrite(fd, data + written, size - written, mRequest->offset + written);
+                if (ret == -1) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    written = -errno;
+                    break;
+                }
+                written += ret;
+            }
+            mRequest->result = written;
+            break;
+        }
+        case ThreadIoEngine::Request::Release:
+            mRequest->result = IoEngine::releaseRange(fd, mRequest->offset, mRequest->length);
+            break;
+        }
+
+        mEngine->complete(mRequest);
+    }
+
+private:
+
+    ThreadIoEngine *mEngine;
+    ThreadIoEngine::Request *mRequest;
+};
+
+ThreadIoEngine::ThreadIoEngine(QObject *parent)
+    : IoEngine(parent)
+{
+    mPool.setMaxThreadCount(ThreadCount);
+}
+
+ThreadIoEngine::~ThreadIoEngine()
+{
+    mPool.waitForDone();
+    qDeleteAll(mCompleted);
+}
+
+QString ThreadIoEngine::name() const
+{
+    return "threads";
+}
+
+void ThreadIoEngine::read(const IoHandlePtr &handle, qint64 offset, int size, Callback callback)
+{
+    submit(new Request{
+        Request::Read,
+        handle,
+        offset,
+        size,
+        QByteArray(size, Qt::Uninitialized),
+        0,
+        callback
+    });
+}
+
+void ThreadIoEngine::write(const IoHandlePtr &handle, qint64 offset, const QByteArray &data, Callback callback)
+{
+    submit(new Request{
+        Request::Write,
+        handle,
+        offset,
+        data.size(),
+        data,
+        0,
+        callback
+    });
+}
+
+void ThreadIoEngine::release(const IoHandlePtr &handle, qint64 offset, qint64 length, Callback callback)
+{
+    submit(new Request{
+        Request::Release,
+        handle,
+        offset,
+        length,
+        QByteArray(),
+        0,
+        callback
+    });
+}
+
+void ThreadIoEngine::complete(Request *request)
+{
+    bool wasEmpty;
+    {
+        QMutexLocker locker(&mMutex);
+        wasEmpty = mCompleted.isEmpty();
+        mCompleted.append(request);
+    }
+
+    // Only a single invocation is needed to reap all completed requests
+    if (wasEmpty) {
+        QMetaObject::invokeMethod(this, "reap", Qt::QueuedConnection);
+    }
+}
+
+void ThreadIoEngine::reap()
+{
+    QList<Request*> completed;
+    {
+        QMutexLocker locker(&mMutex);
+        completed.swap(mCompleted);
+    }
+
+    foreach (Request *request, completed) {
+        if (request->type == Request::Read && request->result >= 0) {
+            request->buffer.resize(request->result);
+        }
+        request->callback(request->result, request->buffer);
+        delete request;
+    }
+}
+
+void ThreadIoEngine::submit(Request *request)
+{
+    mPool.start(new ThreadIoTask(this, request));
+}
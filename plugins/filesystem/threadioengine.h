@@ -0,0 +1,73 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef THREADIOENGINE_H
+#define THREADIOENGINE_H
+
+#include <QList>
+#include <QMutex>
+#include <QThreadPool>
+
+#include "ioengine.h"
+
+/**
+ * @brief I/O engine that performs blocking calls on a pool of threads
+ *
+ * This engine is available on all Unix platforms and is used whenever a
+ * native asynchronous interface is unavailable.
+ */
+class ThreadIoEngine : public IoEngine
+{
+    Q_OBJECT
+
+public:
+
+    explicit ThreadIoEngine(QObject *parent = nullptr);
+    virtual ~ThreadIoEngine();
+
+    virtual QString name() const;
+
+    virtual void read(const IoHandlePtr &handle, qint64 offset, int size, Callback callback);
+    virtual void write(const IoHandlePtr &handle, qint64 offset, const QByteArray &data, Callback callback);
+    virtual void release(const IoHandlePtr &handle, qint64 offset, qint64 length, Callback callback);
+
+    struct Request;
+
+    void complete(Request *request);
+
+private slots:
+
+    void reap();
+
+private:
+
+    void submit(Request *request);
+
+    QThreadPool mPool;
+
+    QMutex mMutex;
+    QList<Request*> mCompleted;
+};
+
+#endif // THREADIOENGINE_H
@@ -0,0 +1,374 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <QSocketNotifier>
+
+#include "threadioengine.h"
+#include "uringioengine.h"
+
+// Number of entries requested for the submission ring
+const unsigned QueueDepth = 64;
+
+struct UringIoEngine::Request
+{
+    quint8 opcode;
+    IoHandlePtr handle;
+    qint64 offset;
+    qint64 length;
+    QByteArray buffer;
+    struct iovec iov;
+    Callback callback;
+};
+
+// glibc does not provide wrappers for the io_uring system calls
+
+static int ioUringSetup(unsigned entries, io_uring_params *params)
+{
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int ioUringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+static int ioUringRegister(int fd, unsigned opcode, void *arg, unsigned nrArgs)
+{
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, nrArgs));
+}
+
+UringIoEngine *UringIoEngine::create(QObject *parent)
+{
+    UringIoEngine *engine = new UringIoEngine(parent);
+    if (!engine->initialize()) {
+        delete engine;
+        return nullptr;
+    }
+    return engine;
+}
+
+UringIoEngine::~UringIoEngine()
+{
+    // The kernel may still be using buffers owned by requests in flight
+    while (mInFlight && waitForCompletion());
+
+    qDeleteAll(mQueue);
+
+    if (mSqes) {
+        munmap(mSqes, mSqesSize);
+    }
+    if (mCqRing && mCqRing != mSqRing) {
+        munmap(mCqRing, mCqRingSize);
+    }
+    if (mSqRing) {
+        munmap(mSqRing, mSqRingSize);
+    }
+    if (mEventFd != -1) {
+        ::close(mEventFd);
+    }
+    if (mRingFd != -1) {
+        ::close(mRingFd);
+    }
+}
+
+QString UringIoEngine::name() const
+{
+    return "io_uring";
+}
+
+void UringIoEngine::read(const IoHandlePtr &handle, qint64 offset, int size, Callback callback)
+{
+    submit(new Request{
+        IORING_OP_READV,
+        handle,
+        offset,
+        size,
+        QByteArray(size, Qt::Uninitialized),
+        {},
+        callback
+    });
+}
+
+void UringIoEngine::write(const IoHandlePtr &handle, qint64 offset, const QByteArray &data, Callback callback)
+{
+    submit(new Request{
+        IORING_OP_WRITEV,
+        handle,
+        offset,
+        data.size(),
+        data,
+        {},
+        callback
+    });
+}
+
+void UringIoEngine::release(const IoHandlePtr &handle, qint64 offset, qint64 length, Callback callback)
+{
+    if (mReleaseEngine) {
+        mReleaseEngine->release(handle, offset, length, callback);
+        return;
+    }
+
+    submit(new Request{
+        IORING_OP_SYNC_FILE_RANGE,
+        handle,
+        offset,
+        length,
+        QByteArray(),
+        {},
+        callback
+    });
+}
+
+bool UringIoEngine::waitForCompletion()
+{
+    flush();
+    if (!mInFlight) {
+        return false;
+    }
+
+    int ret = ioUringEnter(mRingFd, 0, 1, IORING_ENTER_GETEVENTS);
+    if (ret == -1 && errno != EINTR) {
+        return false;
+    }
+
+    reap();
+    return true;
+}
+
+void UringIoEngine::onActivated()
+{
+    eventfd_t value;
+    eventfd_read(mEventFd, &value);
+    reap();
+}
+
+UringIoEngine::UringIoEngine(QObject *parent)
+    : IoEngine(parent),
+      mRingFd(-1),
+      mEventFd(-1),
+      mNotifier(nullptr),
+      mSqRing(nullptr),
+      mSqRingSize(0),
+      mCqRing(nullptr),
+      mCqRingSize(0),
+      mSqes(nullptr),
+      mSqesSize(0),
+      mInFlight(0),
+      mReleaseEngine(nullptr)
+{
+}
+
+bool UringIoEngine::initialize()
+{
+    io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    mRingFd = ioUringSetup(QueueDepth, &params);
+    if (mRingFd == -1) {
+        return false;
+    }
+
+    mSqEntries = params.sq_entries;
+    mCqEntries = params.cq_entries;
+
+    // Determine the size of each ring; newer kernels map both at once
+    mSqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    mCqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMmap = false;
+#ifdef IORING_FEAT_SINGLE_MMAP
+    singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+#endif
+    if (singleMmap) {
+        mSqRingSize = mCqRingSize = qMax(mSqRingSize, mCqRingSize);
+    }
+
+    void *ptr = mmap(nullptr, mSqRingSize, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, mRingFd, IORING_OFF_SQ_RING);
+    if (ptr == MAP_FAILED) {
+        return false;
+    }
+    mSqRing = ptr;
+
+    if (singleMmap) {
+        mCqRing = mSqRing;
+    } else {
+        ptr = mmap(nullptr, mCqRingSize, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, mRingFd, IORING_OFF_CQ_RING);
+        if (ptr == MAP_FAILED) {
+            return false;
+        }
+        mCqRing = ptr;
+    }
+
+    mSqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    ptr = mmap(nullptr, mSqesSize, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, mRingFd, IORING_OFF_SQES);
+    if (ptr == MAP_FAILED) {
+        return false;
+    }
+    mSqes = static_cast<io_uring_sqe*>(ptr);
+
+    char *sq = static_cast<char*>(mSqRing);
+    mSqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+    mSqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    mSqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    mSqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+    char *cq = static_cast<char*>(mCqRing);
+    mCqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    mCqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    mCqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    mCqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    // Have the kernel signal an eventfd whenever a request completes
+    mEventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (mEventFd == -1 ||
+            ioUringRegister(mRingFd, IORING_REGISTER_EVENTFD, &mEventFd, 1) == -1) {
+        return false;
+    }
+
+    mNotifier = new QSocketNotifier(mEventFd, QSocketNotifier::Read, this);
+    connect(mNotifier, &QSocketNotifier::activated, this, &UringIoEngine::onActivated);
+
+    return true;
+}
+
+void UringIoEngine::submit(Request *request)
+{
+    // Ranges are limited to 32 bits by the submission entry
+    Q_ASSERT(request->length <= 0xffffffff);
+
+    request->iov.iov_base = request->opcode == IORING_OP_READV ?
+        request->buffer.data() : const_cast<char*>(request->buffer.constData());
+    request->iov.iov_len = request->buffer.size();
+
+    mQueue.enqueue(request);
+    flush();
+}
+
+void UringIoEngine::flush()
+{
+    unsigned head = __atomic_load_n(mSqHead, __ATOMIC_ACQUIRE);
+    unsigned tail = *mSqTail;
+
+    // Fill the submission ring without exceeding the size of the completion
+    // ring, which would otherwise overflow
+    bool added = false;
+    while (mQueue.count() && tail - head < mSqEntries && mInFlight < mCqEntries) {
+        Request *request = mQueue.dequeue();
+
+        unsigned index = tail & *mSqMask;
+        io_uring_sqe *sqe = &mSqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = request->opcode;
+        sqe->fd = request->handle->fd();
+        sqe->off = request->offset;
+        if (request->opcode == IORING_OP_SYNC_FILE_RANGE) {
+            sqe->len = static_cast<quint32>(request->length);
+            sqe->sync_range_flags = SYNC_FILE_RANGE_WAIT_BEFORE |
+                SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER;
+        } else {
+            sqe->addr = reinterpret_cast<quint64>(&request->iov);
+            sqe->len = 1;
+        }
+        sqe->user_data = reinterpret_cast<quint64>(request);
+        mSqArray[index] = index;
+
+        ++tail;
+        ++mInFlight;
+        added = true;
+    }
+
+    if (!added && tail == head) {
+        return;
+    }
+
+    __atomic_store_n(mSqTail, tail, __ATOMIC_RELEASE);
+
+    // Entries not consumed by the kernel remain in the ring and are
+    // submitted on the next call
+    ioUringEnter(mRingFd, tail - head, 0, 0);
+}
+
+void UringIoEngine::reap()
+{
+    unsigned head = *mCqHead;
+    unsigned tail = __atomic_load_n(mCqTail, __ATOMIC_ACQUIRE);
+
+    QList<QPair<Request*, int>> completed;
+    while (head != tail) {
+        io_uring_cqe *cqe = &mCqes[head & *mCqMask];
+        completed.append({ reinterpret_cast<Request*>(cqe->user_data), cqe->res });
+        ++head;
+    }
+
+    __atomic_store_n(mCqHead, head, __ATOMIC_RELEASE);
+    mInFlight -= completed.count();
+
+    // Space is now available for any queued requests
+    flush();
+
+    for (auto i = completed.constBegin(); i != completed.constEnd(); ++i) {
+        Request *request = i->first;
+        qint64 result = i->second;
+        switch (request->opcode) {
+        case IORING_OP_READV:
+            if (result >= 0) {
+                request->buffer.resize(result);
+            }
+            break;
+        case IORING_OP_SYNC_FILE_RANGE:
+            if (result == -EINVAL) {
+                // Kernels before 5.2 do not support the operation; rather than
+                // blocking here, this and all later ranges are released by
+                // the thread pool engine instead
+                if (!mReleaseEngine) {
+                    mReleaseEngine = new ThreadIoEngine(this);
+                }
+                mReleaseEngine->release(request->handle, request->offset, request->length, request->callback);
+                delete request;
+                continue;
+            } else if (result >= 0) {
+                // Dropping clean pages does not block
+                result = -posix_fadvise(request->handle->fd(), request->offset,
+                    request->length, POSIX_FADV_DONTNEED);
+            }
+            break;
+        }
+        request->callback(result, request->buffer);
+        delete request;
+    }
+}
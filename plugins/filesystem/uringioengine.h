@@ -0,0 +1,112 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef URINGIOENGINE_H
+#define URINGIOENGINE_H
+
+#include <QQueue>
+
+#include "ioengine.h"
+
+class QSocketNotifier;
+
+class ThreadIoEngine;
+
+struct io_uring_cqe;
+struct io_uring_sqe;
+
+/**
+ * @brief I/O engine built on the Linux io_uring interface
+ *
+ * Requests are placed in the submission ring and completions are signalled
+ * through an eventfd, which integrates with the event loop.
+ */
+class UringIoEngine : public IoEngine
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Attempt to create an engine
+     * @param parent QObject
+     * @return pointer to UringIoEngine or nullptr if io_uring is unavailable
+     */
+    static UringIoEngine *create(QObject *parent = nullptr);
+
+    virtual ~UringIoEngine();
+
+    virtual QString name() const;
+
+    virtual void read(const IoHandlePtr &handle, qint64 offset, int size, Callback callback);
+    virtual void write(const IoHandlePtr &handle, qint64 offset, const QByteArray &data, Callback callback);
+    virtual void release(const IoHandlePtr &handle, qint64 offset, qint64 length, Callback callback);
+
+private slots:
+
+    void onActivated();
+
+private:
+
+    struct Request;
+
+    explicit UringIoEngine(QObject *parent);
+
+    bool initialize();
+    void submit(Request *request);
+    void flush();
+    void reap();
+    bool waitForCompletion();
+
+    int mRingFd;
+    int mEventFd;
+    QSocketNotifier *mNotifier;
+
+    void *mSqRing;
+    size_t mSqRingSize;
+    void *mCqRing;
+    size_t mCqRingSize;
+    io_uring_sqe *mSqes;
+    size_t mSqesSize;
+
+    unsigned *mSqHead;
+    unsigned *mSqTail;
+    unsigned *mSqMask;
+    unsigned *mSqArray;
+    unsigned mSqEntries;
+
+    unsigned *mCqHead;
+    unsigned *mCqTail;
+    unsigned *mCqMask;
+    io_uring_cqe *mCqes;
+    unsigned mCqEntries;
+
+    QQueue<Request*> mQueue;
+    unsigned mInFlight;
+
+    // Used to release ranges when the kernel cannot
+    ThreadIoEngine *mReleaseEngine;
+};
+
+#endif // URINGIOENGINE_H
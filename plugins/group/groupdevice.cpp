@@ -0,0 +1,73 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QStringList>
+
+#include "groupdevice.h"
+#include "groupsession.h"
+
+GroupDevice::GroupDevice(GroupSession *session, const QString &id, const QList<Device*> &devices)
+    : mSession(session),
+      mUuid(id),
+      mReceiver(-1)
+{
+    QStringList names;
+    foreach (Device *device, devices) {
+        names.append(device->name());
+    }
+    mName = names.join(", ");
+}
+
+GroupDevice::GroupDevice(GroupSession *session, Device *device, int receiver)
+    : mSession(session),
+      mUuid(device->uuid()),
+      mName(device->name()),
+      mReceiver(receiver)
+{
+}
+
+QString GroupDevice::uuid() const
+{
+    return mUuid;
+}
+
+QString GroupDevice::name() const
+{
+    return tr("%1 [%2]").arg(mName).arg(transportName());
+}
+
+QString GroupDevice::transportName() const
+{
+    return mSession->transportName();
+}
+
+GroupSession *GroupDevice::session() const
+{
+    return mSession;
+}
+
+int GroupDevice::receiver() const
+{
+    return mReceiver;
+}
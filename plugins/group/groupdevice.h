@@ -0,0 +1,83 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef GROUPDEVICE_H
+#define GROUPDEVICE_H
+
+#include <QList>
+
+#include <nitroshare/device.h>
+
+class GroupSession;
+
+/**
+ * @brief Receivers of a group session
+ *
+ * A device is created for each session so that a single transfer can be
+ * created for all of its receivers using the "senditems" action. A device is
+ * also created for each receiver so that it can be shown as a transfer with
+ * its own state.
+ */
+class GroupDevice : public Device
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Create a device for a session
+     * @param session session to create the device for
+     * @param id unique ID of the session
+     * @param devices devices that were discovered for the receivers
+     */
+    GroupDevice(GroupSession *session, const QString &id, const QList<Device*> &devices);
+
+    /**
+     * @brief Create a device for a receiver of a session
+     * @param session session the receiver belongs to
+     * @param device device that was discovered for the receiver
+     * @param receiver index of the receiver in the session
+     */
+    GroupDevice(GroupSession *session, Device *device, int receiver);
+
+    virtual QString uuid() const;
+    virtual QString name() const;
+    virtual QString transportName() const;
+
+    GroupSession *session() const;
+
+    /**
+     * @brief Retrieve the index of the receiver (-1 for the whole session)
+     */
+    int receiver() const;
+
+private:
+
+    GroupSession *mSession;
+    QString mUuid;
+    QString mName;
+    int mReceiver;
+};
+
+#endif // GROUPDEVICE_H
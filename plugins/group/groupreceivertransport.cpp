@@ -0,0 +1,74 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <nitroshare/packet.h>
+
+#include "groupreceivertransport.h"
+#include "groupsession.h"
+
+GroupReceiverTransport::GroupReceiverTransport(GroupSession *session, int receiver)
+    : mSession(session),
+      mReceiver(receiver),
+      mClosed(false)
+{
+}
+
+void GroupReceiverTransport::setConnected()
+{
+    if (!mClosed) {
+        emit connected();
+    }
+}
+
+void GroupReceiverTransport::succeed()
+{
+    if (!mClosed) {
+        Packet packet(Packet::Success);
+        emit packetReceived(&packet);
+    }
+}
+
+void GroupReceiverTransport::fail(const QString &message)
+{
+    if (!mClosed) {
+        mClosed = true;
+        emit error(message);
+    }
+}
+
+void GroupReceiverTransport::sendPacket(Packet *)
+{
+    // Nothing is sent to the receiver by this transfer
+    if (!mClosed) {
+        QMetaObject::invokeMethod(this, "packetSent", Qt::QueuedConnection);
+    }
+}
+
+void GroupReceiverTransport::close()
+{
+    if (!mClosed) {
+        mClosed = true;
+        mSession->cancelReceiver(mReceiver);
+    }
+}
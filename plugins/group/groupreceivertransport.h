@@ -0,0 +1,74 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef GROUPRECEIVERTRANSPORT_H
+#define GROUPRECEIVERTRANSPORT_H
+
+#include <nitroshare/transport.h>
+
+class GroupSession;
+class Packet;
+
+/**
+ * @brief Transport for showing one receiver of a group session
+ *
+ * The transfer using this transport sends no items (they are sent by the
+ * transfer for the whole session) and only reflects whether the receiver
+ * joined, succeeded or failed. Closing the transport before then gives up on
+ * the receiver.
+ */
+class GroupReceiverTransport : public Transport
+{
+    Q_OBJECT
+
+public:
+
+    GroupReceiverTransport(GroupSession *session, int receiver);
+
+    /**
+     * @brief Indicate that the receiver joined the session
+     */
+    void setConnected();
+
+    /**
+     * @brief Indicate that the receiver got all of the items
+     */
+    void succeed();
+
+    /**
+     * @brief Fail the transfer for the receiver
+     */
+    void fail(const QString &message);
+
+    virtual void sendPacket(Packet *packet);
+    virtual void close();
+
+private:
+
+    GroupSession *mSession;
+    int mReceiver;
+    bool mClosed;
+};
+
+#endif // GROUPRECEIVERTRANSPORT_H
@@ -0,0 +1,303 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <nitroshare/action.h>
+#include <nitroshare/actionregistry.h>
+#include <nitroshare/application.h>
+#include <nitroshare/bundle.h>
+#include <nitroshare/logger.h>
+#include <nitroshare/message.h>
+#include <nitroshare/packet.h>
+#include <nitroshare/packetstream.h>
+#include <nitroshare/transfer.h>
+#include <nitroshare/transfermodel.h>
+
+#include "groupdevice.h"
+#include "groupenumerator.h"
+#include "groupreceivertransport.h"
+#include "groupsession.h"
+#include "grouptransport.h"
+
+GroupSession::GroupSession(qint64 window, int joinTimeout)
+    : mWindow(window),
+      mConnected(false),
+      mRemaining(0),
+      mFailed(0),
+      mStreamEnd(0)
+{
+    connect(&mJoinTimer, &QTimer::timeout, this, &GroupSession::onJoinTimeout);
+
+    mJoinTimer.setSingleShot(true);
+    mJoinTimer.setInterval(joinTimeout);
+}
+
+bool GroupSession::start(Application *application, GroupEnumerator *enumerator,
+                         const QList<Device*> &devices, const QVariantMap &params)
+{
+    Action *sendItems = application->actionRegistry()->find("senditems");
+    if (!sendItems) {
+        deleteLater();
+        return false;
+    }
+
+    application->logger()->log(new Message(
+        Message::Info,
+        transportName(),
+        QString("starting session %1 with %2 receiver(s)")
+            .arg(sessionId())
+            .arg(devices.count())
+    ));
+
+    // A single transfer sends the items to all of the receivers
+    GroupDevice *device = new GroupDevice(this, sessionId(), devices);
+    enumerator->addDevice(device);
+
+    // Remove the device and the session once the transfer is gone
+    auto cleanup = [this, device, enumerator]() {
+        enumerator->removeDevice(device);
+        delete device;
+        deleteLater();
+    };
+    if (!sendItems->invoke({
+        { "device", device->uuid() },
+        { "enumerator", enumerator->name() },
+        { "items", params.value("items") },
+        { "streaming", params.value("streaming") }
+    }).toBool()) {
+        cleanup();
+        return false;
+    }
+    connect(this, &GroupSession::finished, enumerator, cleanup);
+
+    // Each receiver is shown with its own state - the devices are only
+    // needed to create the transfers
+    for (int i = 0; i < devices.count(); ++i) {
+        GroupDevice receiverDevice(this, devices.at(i), i);
+        application->transferModel()->add(
+            new Transfer(application, &receiverDevice, new Bundle)
+        );
+    }
+
+    invite();
+    mJoinTimer.start();
+
+    return true;
+}
+
+Transport *GroupSession::createTransport(GroupDevice *device)
+{
+    int receiver = device->receiver();
+    if (receiver != -1) {
+        if (receiver >= mResults.count() || mReceiverTransports.at(receiver)) {
+            return nullptr;
+        }
+
+        GroupReceiverTransport *transport = new GroupReceiverTransport(this, receiver);
+        mReceiverTransports[receiver] = transport;
+        return transport;
+    }
+
+    if (mTransport) {
+        return nullptr;
+    }
+
+    GroupTransport *transport = new GroupTransport(this);
+    mTransport = transport;
+
+    // The session is finished once the transfer is destroyed
+    connect(transport, &QObject::destroyed, this, [this]() {
+        stop();
+        closeSession();
+        emit finished();
+    });
+
+    return transport;
+}
+
+qint64 GroupSession::addPacket(Packet *packet)
+{
+    PacketStream::encode(mPending, packet->type(), packet->content());
+    mStreamEnd += PacketStream::HeaderSize + packet->content().size();
+
+    processPending();
+
+    return mStreamEnd;
+}
+
+bool GroupSession::canContinue(qint64 position) const
+{
+    // The stream cannot get too far ahead of the slowest receiver
+    return !isBacklogged() && position <= minimumDelivered() + mWindow;
+}
+
+void GroupSession::stop()
+{
+    for (int i = 0; i < mResults.count(); ++i) {
+        finish(i, Failed, tr("transfer stopped"));
+    }
+}
+
+void GroupSession::cancelReceiver(int receiver)
+{
+    finish(receiver, Failed, tr("transfer cancelled"));
+}
+
+int GroupSession::registerReceiver()
+{
+    mReceiverTransports.append(nullptr);
+    mJoined.append(false);
+    mResults.append(Pending);
+    ++mRemaining;
+    return mResults.count() - 1;
+}
+
+bool GroupSession::isReceiverFinished(int receiver) const
+{
+    return mResults.at(receiver) != Pending;
+}
+
+void GroupSession::processReply(int receiver, Packet *packet)
+{
+    switch (packet->type()) {
+    case Packet::Success:
+        finish(receiver, Succeeded);
+        break;
+    case Packet::Error:
+        failReceiver(receiver, QString::fromUtf8(packet->content()));
+        break;
+    default:
+        break;
+    }
+}
+
+void GroupSession::setJoined(int receiver)
+{
+    if (mJoined.at(receiver) || mResults.at(receiver) != Pending) {
+        return;
+    }
+    mJoined[receiver] = true;
+    if (mReceiverTransports.at(receiver)) {
+        mReceiverTransports.at(receiver)->setConnected();
+    }
+    connectReceivers(false);
+}
+
+bool GroupSession::isReceiverJoined(int receiver) const
+{
+    return mJoined.at(receiver);
+}
+
+bool GroupSession::isConnected() const
+{
+    return mConnected;
+}
+
+void GroupSession::failReceiver(int receiver, const QString &message)
+{
+    finish(receiver, Failed, message);
+}
+
+qint64 GroupSession::streamEnd() const
+{
+    return mStreamEnd;
+}
+
+bool GroupSession::isBacklogged() const
+{
+    return false;
+}
+
+void GroupSession::closeSession()
+{
+}
+
+void GroupSession::onJoinTimeout()
+{
+    connectReceivers(true);
+}
+
+void GroupSession::finish(int receiver, Result result, const QString &message)
+{
+    if (mResults.at(receiver) != Pending) {
+        return;
+    }
+    mResults[receiver] = result;
+    if (result == Failed) {
+        ++mFailed;
+    }
+    --mRemaining;
+
+    finishReceiver(receiver);
+
+    // The transfer for the receiver shows how it finished
+    GroupReceiverTransport *receiverTransport = mReceiverTransports.at(receiver);
+    if (receiverTransport) {
+        if (result == Succeeded) {
+            receiverTransport->succeed();
+        } else {
+            receiverTransport->fail(message);
+        }
+    }
+
+    // The errors of the receivers are shown by their own transfers - this
+    // transfer only fails if none of them got the items
+    if (!mRemaining && mTransport) {
+        if (mFailed == mResults.count()) {
+            mTransport->fail(tr("none of the receivers got the items"));
+        } else {
+            Packet packet(Packet::Success);
+            mTransport->deliver(&packet);
+        }
+    }
+}
+
+void GroupSession::connectReceivers(bool timedOut)
+{
+    if (mConnected) {
+        return;
+    }
+
+    // Wait until all receivers joined or the time to do so is up
+    if (!timedOut) {
+        for (int i = 0; i < mResults.count(); ++i) {
+            if (!mJoined.at(i) && mResults.at(i) == Pending) {
+                return;
+            }
+        }
+    }
+
+    mConnected = true;
+    mJoinTimer.stop();
+
+    for (int i = 0; i < mResults.count(); ++i) {
+        if (!mJoined.at(i)) {
+            failReceiver(i, tr("receiver did not join the session"));
+        }
+    }
+
+    // The transfer fails (once the last receiver failed) if none joined
+    if (mTransport && mRemaining) {
+        mTransport->setConnected();
+    }
+}
@@ -0,0 +1,252 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef GROUPSESSION_H
+#define GROUPSESSION_H
+
+#include <QByteArray>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <QVariantMap>
+#include <QVector>
+
+class Application;
+class Device;
+class GroupDevice;
+class GroupEnumerator;
+class GroupReceiverTransport;
+class GroupTransport;
+class Packet;
+class Transport;
+
+/**
+ * @brief Sender side of a session with a group of receivers
+ *
+ * A single transfer (using a GroupTransport) reads the items once and its
+ * packets form the stream that the session delivers to all of the receivers.
+ * The transfer is paced by the slowest receiver and succeeds once every
+ * receiver has finished, provided that at least one of them received all of
+ * the items. Each receiver is also shown as a transfer of its own (using a
+ * GroupReceiverTransport) that succeeds or fails with the receiver.
+ *
+ * Subclasses invite the receivers, report when each of them joined, deliver
+ * the stream to them and report how much of it they have.
+ */
+class GroupSession : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Create a session
+     * @param window amount of the stream that may be sent beyond what the
+     *        slowest receiver has
+     * @param joinTimeout time (in milliseconds) for receivers to join
+     */
+    GroupSession(qint64 window, int joinTimeout);
+
+    /**
+     * @brief Retrieve a unique ID for the session
+     */
+    virtual QString sessionId() const = 0;
+
+    /**
+     * @brief Retrieve the name of the transport used for the session
+     */
+    virtual QString transportName() const = 0;
+
+    /**
+     * @brief Send items to the receivers and invite them
+     * @param application pointer to Application
+     * @param enumerator enumerator for the device of the session
+     * @param devices devices that were discovered for the receivers
+     * @param params parameters for the "senditems" action
+     * @return true if the transfer was created
+     *
+     * The session deletes itself once the transfer is gone (or immediately
+     * if it could not be created).
+     */
+    bool start(Application *application, GroupEnumerator *enumerator,
+               const QList<Device*> &devices, const QVariantMap &params);
+
+    /**
+     * @brief Create the transport for a transfer
+     * @param device device for the session or one of its receivers
+     *
+     * The transport is owned by the caller. Once the session is gone, it
+     * is closed and no longer refers to the session.
+     */
+    Transport *createTransport(GroupDevice *device);
+
+    /**
+     * @brief Add a packet to the stream
+     * @return position in the stream after the packet
+     */
+    qint64 addPacket(Packet *packet);
+
+    /**
+     * @brief Determine if the transfer may send more packets
+     * @param position position of the transfer in the stream
+     */
+    bool canContinue(qint64 position) const;
+
+    /**
+     * @brief Stop sending to the receivers that have not finished
+     */
+    void stop();
+
+    /**
+     * @brief Give up on a receiver whose transfer was closed
+     */
+    void cancelReceiver(int receiver);
+
+signals:
+
+    /**
+     * @brief Indicate that receivers made progress or more data may be sent
+     */
+    void progress();
+
+    /**
+     * @brief Indicate that the transport was destroyed
+     */
+    void finished();
+
+protected:
+
+    /**
+     * @brief Add a receiver to the session
+     * @return index of the receiver
+     */
+    int registerReceiver();
+
+    /**
+     * @brief Determine if a receiver has finished (or failed)
+     */
+    bool isReceiverFinished(int receiver) const;
+
+    /**
+     * @brief Indicate that a receiver joined the session
+     *
+     * The transfer begins once all of the receivers joined or the time to do
+     * so is up, at which point the others are failed.
+     */
+    void setJoined(int receiver);
+
+    /**
+     * @brief Determine if a receiver joined the session
+     */
+    bool isReceiverJoined(int receiver) const;
+
+    /**
+     * @brief Determine if the receivers are ready for the stream
+     */
+    bool isConnected() const;
+
+    /**
+     * @brief Process a packet sent by a receiver
+     *
+     * Success and error packets finish the receiver; anything else is
+     * ignored since the transfer only expects a reply to the whole stream.
+     */
+    void processReply(int receiver, Packet *packet);
+
+    /**
+     * @brief Give up on a receiver
+     */
+    void failReceiver(int receiver, const QString &message);
+
+    /**
+     * @brief Retrieve the position of the end of the stream
+     */
+    qint64 streamEnd() const;
+
+    /**
+     * @brief Invite the receivers to join
+     */
+    virtual void invite() = 0;
+
+    /**
+     * @brief Retrieve the amount of the stream the slowest receiver has
+     */
+    virtual qint64 minimumDelivered() const = 0;
+
+    /**
+     * @brief Determine if data waiting to be sent should pause the stream
+     */
+    virtual bool isBacklogged() const;
+
+    /**
+     * @brief Send the data that was added to mPending
+     */
+    virtual void processPending() = 0;
+
+    /**
+     * @brief Stop sending to a receiver once it finished (or failed)
+     */
+    virtual void finishReceiver(int receiver) = 0;
+
+    /**
+     * @brief Finish the session once the transport was destroyed
+     */
+    virtual void closeSession();
+
+    /// Data added to the stream that was not sent yet
+    QByteArray mPending;
+
+private slots:
+
+    void onJoinTimeout();
+
+private:
+
+    enum Result {
+        Pending,
+        Succeeded,
+        Failed
+    };
+
+    void finish(int receiver, Result result, const QString &message = QString());
+    void connectReceivers(bool timedOut);
+
+    qint64 mWindow;
+    QPointer<GroupTransport> mTransport;
+    QVector<QPointer<GroupReceiverTransport>> mReceiverTransports;
+
+    QVector<bool> mJoined;
+    bool mConnected;
+    QTimer mJoinTimer;
+
+    QVector<Result> mResults;
+    int mRemaining;
+    int mFailed;
+
+    qint64 mStreamEnd;
+};
+
+#endif // GROUPSESSION_H
@@ -0,0 +1,90 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <nitroshare/packet.h>
+
+#include "groupsession.h"
+#include "grouptransport.h"
+
+GroupTransport::GroupTransport(GroupSession *session)
+    : mSession(session),
+      mPosition(0),
+      mWaiting(false),
+      mClosed(false)
+{
+    connect(mSession, &GroupSession::progress, this, &GroupTransport::onProgress);
+}
+
+void GroupTransport::setConnected()
+{
+    if (!mClosed) {
+        emit connected();
+    }
+}
+
+void GroupTransport::deliver(Packet *packet)
+{
+    if (!mClosed) {
+        emit packetReceived(packet);
+    }
+}
+
+void GroupTransport::fail(const QString &message)
+{
+    if (!mClosed) {
+        close();
+        emit error(message);
+    }
+}
+
+void GroupTransport::sendPacket(Packet *packet)
+{
+    if (mClosed) {
+        return;
+    }
+
+    mPosition = mSession->addPacket(packet);
+
+    if (mSession->canContinue(mPosition)) {
+        QMetaObject::invokeMethod(this, "packetSent", Qt::QueuedConnection);
+    } else {
+        mWaiting = true;
+    }
+}
+
+void GroupTransport::close()
+{
+    if (!mClosed) {
+        mClosed = true;
+        mSession->stop();
+    }
+}
+
+void GroupTransport::onProgress()
+{
+    if (mWaiting && !mClosed && mSession->canContinue(mPosition)) {
+        mWaiting = false;
+        emit packetSent();
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef GROUPTRANSPORT_H
+#define GROUPTRANSPORT_H
+
+#include <nitroshare/transport.h>
+
+class GroupSession;
+class Packet;
+
+/**
+ * @brief Transport for sending to the receivers of a group session
+ *
+ * Packets sent by the transfer are added to the stream of the session and
+ * the replies of the receivers are combined into a single reply.
+ */
+class GroupTransport : public Transport
+{
+    Q_OBJECT
+
+public:
+
+    explicit GroupTransport(GroupSession *session);
+
+    /**
+     * @brief Indicate that the receivers joined the session
+     */
+    void setConnected();
+
+    /**
+     * @brief Pass a reply for the receivers to the transfer
+     */
+    void deliver(Packet *packet);
+
+    /**
+     * @brief Fail the transfer
+     */
+    void fail(const QString &message);
+
+    virtual void sendPacket(Packet *packet);
+    virtual void close();
+
+private slots:
+
+    void onProgress();
+
+private:
+
+    GroupSession *mSession;
+
+    qint64 mPosition;
+    bool mWaiting;
+    bool mClosed;
+};
+
+#endif // GROUPTRANSPORT_H
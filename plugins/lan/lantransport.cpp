@@ -22,14 +22,24 @@
  * IN THE SOFTWARE.
  */
 
-#include <cstring>
+#include <QtGlobal>
 
-#include <QtEndian>
+#ifdef Q_OS_LINUX
+#  include <netinet/in.h>
+#  include <netinet/tcp.h>
+#  include <sys/socket.h>
+#endif
+
+#include <QMetaObject>
 
 #include <nitroshare/packet.h>
+#include <nitroshare/trace.h>
 
 #include "lantransport.h"
 
+// Amount of data buffered by the socket while receiving is paused
+const qint64 PausedBufferSize = 64 * 1024;
+
 LanTransport::LanTransport(
     const QHostAddress &address
   , quint16 port
@@ -69,14 +79,11 @@ LanTransport::LanTransport(
 
 void LanTransport::sendPacket(Packet *packet)
 {
-    // Build the parts of the packet
-    QByteArray content = packet->content();
-    qint32 packetSize = qToLittleEndian(content.size() + 1);
-    qint8 packetType = packet->type();
+    TRACE_SPAN("LanTransport::sendPacket");
 
     // Send the length and type of the packet
-    mSocket->write(reinterpret_cast<const char*>(&packetSize), sizeof(packetSize));
-    mSocket->write(reinterpret_cast<const char*>(&packetType), sizeof(packetType));
+    QByteArray content = packet->content();
+    mSocket->write(PacketStream::encodeHeader(packet->type(), content.size()));
 
     // If the packet includes content, send it too
     if (content.length()) {
@@ -84,6 +91,48 @@ void LanTransport::sendPacket(Packet *packet)
     }
 }
 
+QVariantMap LanTransport::statistics() const
+{
+    QVariantMap statistics{
+        { "bytesToWrite", mSocket->bytesToWrite() }
+    };
+
+#ifdef Q_OS_LINUX
+    // Sample the kernel's view of the connection (times are in microseconds)
+    struct tcp_info info;
+    socklen_t length = sizeof(info);
+    qintptr socketDescriptor = mSocket->socketDescriptor();
+    if (socketDescriptor != -1 && getsockopt(socketDescriptor, IPPROTO_TCP,
+            TCP_INFO, &info, &length) == 0) {
+        statistics.insert("rtt", static_cast<uint>(info.tcpi_rtt));
+        statistics.insert("rttVariance", static_cast<uint>(info.tcpi_rttvar));
+        statistics.insert("congestionWindow", static_cast<uint>(info.tcpi_snd_cwnd));
+        statistics.insert("maxSegmentSize", static_cast<uint>(info.tcpi_snd_mss));
+        statistics.insert("retransmits", static_cast<uint>(info.tcpi_total_retrans));
+        statistics.insert("lost", static_cast<uint>(info.tcpi_lost));
+    }
+#endif
+
+    return statistics;
+}
+
+void LanTransport::setReceivingPaused(bool paused)
+{
+    if (paused == mPaused) {
+        return;
+    }
+    mPaused = paused;
+
+    // Once the socket's buffer fills up, it stops reading and the kernel's
+    // receive window closes, which slows down the sender
+    if (paused) {
+        mSocket->setReadBufferSize(PausedBufferSize);
+    } else {
+        mSocket->setReadBufferSize(0);
+        QMetaObject::invokeMethod(this, "onReadyRead", Qt::QueuedConnection);
+    }
+}
+
 void LanTransport::close()
 {
     mSocket->close();
@@ -104,44 +153,26 @@ void LanTransport::onConnected()
 
 void LanTransport::onReadyRead()
 {
-    mBuffer.append(mSocket->readAll());
-
-    // Continue to emit packets as they are read
-    while (mBuffer.size()) {
-        if (mBufferSize) {
-
-            // Only continue if the buffer has the full packet
-            if (mBuffer.size() < mBufferSize) {
-                break;
-            }
-
-            // Grab the type and data
-            const char type = mBuffer.at(0);
-            QByteArray data = mBuffer.mid(1, mBufferSize - 1);
-            mBuffer.remove(0, mBufferSize);
-
-            // Emit the new packet and reset the size
-            emit packetReceived(new Packet(static_cast<Packet::Type>(type), data));
-            mBufferSize = 0;
-
-        } else {
-
-            // Only continue if the buffer has enough data for the size
-            if (mBuffer.size() < sizeof(mBufferSize)) {
-                break;
-            }
-
-            // memcpy must be used in order to avoid alignment issues
-            memcpy(&mBufferSize, mBuffer.constData(), sizeof(mBufferSize));
-            mBufferSize = qFromLittleEndian(mBufferSize);
-            mBuffer.remove(0, sizeof(mBufferSize));
-
-            // A packet size of zero is an error (and impossible)
-            if (!mBufferSize) {
-                emit error(tr("invalid packet received"));
-                break;
-            }
-        }
+    TRACE_SPAN("LanTransport::onReadyRead");
+
+    // Data is left in the socket while paused
+    if (mPaused) {
+        return;
+    }
+
+    mStream.addData(mSocket->readAll());
+
+    // Continue to emit packets as they are read (the transfer may pause
+    // receiving in response to any one of them)
+    char type;
+    QByteArray data;
+    while (!mPaused && mStream.readPacket(&type, &data)) {
+        Packet packet(static_cast<Packet::Type>(type), data);
+        emit packetReceived(&packet);
+    }
+
+    if (mStream.hasError()) {
+        emit error(tr("invalid packet received"));
     }
 }
 
@@ -182,7 +213,7 @@ LanTransport::LanTransport(
 #ifdef ENABLE_TLS
     , mSslSocket(nullptr)
 #endif
-    , mBufferSize(0)
+    , mPaused(false)
 {
 #ifdef ENABLE_TLS
     if (!sslConf.isNull()) {
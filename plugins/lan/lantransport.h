@@ -25,7 +25,7 @@
 #ifndef LANTRANSPORT_H
 #define LANTRANSPORT_H
 
-#include "config.h"
+#include "lanconfig.h"
 
 #include <QHostAddress>
 #include <QTcpSocket>
@@ -35,6 +35,7 @@
 #  include <QSslSocket>
 #endif
 
+#include <nitroshare/packetstream.h>
 #include <nitroshare/transport.h>
 
 class Packet;
@@ -68,6 +69,8 @@ public:
 
     virtual void sendPacket(Packet *packet);
     virtual void close();
+    virtual QVariantMap statistics() const;
+    virtual void setReceivingPaused(bool paused);
 
 private slots:
 
@@ -94,8 +97,8 @@ private:
     QSslSocket *mSslSocket;
 #endif
 
-    QByteArray mBuffer;
-    qint32 mBufferSize;
+    PacketStream mStream;
+    bool mPaused;
 };
 
 #endif // LANTRANSPORT_H
@@ -22,7 +22,7 @@
  * IN THE SOFTWARE.
  */
 
-#include "config.h"
+#include "lanconfig.h"
 
 #include <QHostAddress>
 
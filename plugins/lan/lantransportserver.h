@@ -25,7 +25,7 @@
 #ifndef LANTRANSPORTSERVER_H
 #define LANTRANSPORTSERVER_H
 
-#include "config.h"
+#include "lanconfig.h"
 
 #include <QStringList>
 
@@ -0,0 +1,67 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QDir>
+
+#include "localdevice.h"
+
+LocalDevice::LocalDevice(const QString &directory, const QJsonObject &object)
+    : mDirectory(directory),
+      mObject(object)
+{
+}
+
+QString LocalDevice::uuid() const
+{
+    return mObject.value("uuid").toString();
+}
+
+QString LocalDevice::name() const
+{
+    return tr("%1 [local]").arg(mObject.value("name").toString());
+}
+
+QString LocalDevice::transportName() const
+{
+    return "local";
+}
+
+QString LocalDevice::path() const
+{
+    return QDir(mDirectory).absoluteFilePath(uuid() + ".sock");
+}
+
+QString LocalDevice::sharedMemoryPath() const
+{
+    // Only devices that enabled the experimental transport listen for it
+    if (!mObject.value("sharedMemory").toBool()) {
+        return QString();
+    }
+    return QDir(mDirectory).absoluteFilePath(uuid() + ".shm");
+}
+
+QJsonObject LocalDevice::object() const
+{
+    return mObject;
+}
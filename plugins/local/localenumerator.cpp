@@ -0,0 +1,152 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSet>
+
+#include <nitroshare/application.h>
+#include <nitroshare/settingsregistry.h>
+
+#include "localdevice.h"
+#include "localenumerator.h"
+
+const QString LocalDirectory = "LocalDirectory";
+
+// Interval between scans of the directory
+const int ScanInterval = 5000;
+
+LocalEnumerator::LocalEnumerator(Application *application)
+    : mApplication(application)
+{
+    connect(&mWatcher, &QFileSystemWatcher::directoryChanged, this, &LocalEnumerator::onScan);
+    connect(&mTimer, &QTimer::timeout, this, &LocalEnumerator::onScan);
+    connect(mApplication->settingsRegistry(), &SettingsRegistry::settingsChanged, this, &LocalEnumerator::onSettingsChanged);
+
+    mTimer.start(ScanInterval);
+
+    // Load the initial settings
+    QTimer::singleShot(0, this, [this]() {
+        onSettingsChanged({LocalDirectory});
+    });
+}
+
+LocalEnumerator::~LocalEnumerator()
+{
+    qDeleteAll(mDevices);
+}
+
+QString LocalEnumerator::name() const
+{
+    return "local";
+}
+
+void LocalEnumerator::onSettingsChanged(const QStringList &keys)
+{
+    if (keys.contains(LocalDirectory)) {
+        if (!mDirectory.isNull()) {
+            mWatcher.removePath(mDirectory);
+        }
+        mDirectory = mApplication->settingsRegistry()->value(LocalDirectory).toString();
+        mWatcher.addPath(mDirectory);
+        onScan();
+    }
+}
+
+void LocalEnumerator::onScan()
+{
+    QDir directory(mDirectory);
+    QSet<QString> uuids;
+
+    foreach (QString filename, directory.entryList({"*.json"}, QDir::Files)) {
+        QString uuid = QFileInfo(filename).completeBaseName();
+        if (uuid == mApplication->deviceUuid()) {
+            continue;
+        }
+
+        QJsonObject object;
+        if (!readAnnouncement(directory.absoluteFilePath(filename), &object)) {
+            continue;
+        }
+        uuids.insert(uuid);
+
+        // Devices are replaced if their announcement changed (a new name)
+        LocalDevice *device = mDevices.value(uuid);
+        if (device) {
+            if (device->object() == object) {
+                continue;
+            }
+            emit deviceRemoved(device);
+            delete device;
+        }
+
+        device = new LocalDevice(mDirectory, object);
+        mDevices.insert(uuid, device);
+        emit deviceAdded(device);
+    }
+
+    // Remove devices that are no longer announced
+    for (auto i = mDevices.begin(); i != mDevices.end();) {
+        if (!uuids.contains(i.key())) {
+            Device *device = i.value();
+            emit deviceRemoved(device);
+            i = mDevices.erase(i);
+            delete device;
+        } else {
+            ++i;
+        }
+    }
+}
+
+bool LocalEnumerator::readAnnouncement(const QString &filename, QJsonObject *object) const
+{
+    int fd = ::open(QFile::encodeName(filename).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+
+    // If nothing holds an exclusive lock on the file, the process that wrote
+    // it is no longer running
+    if (flock(fd, LOCK_SH | LOCK_NB) == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    QFile file;
+    if (!file.open(fd, QIODevice::ReadOnly, QFileDevice::AutoCloseHandle)) {
+        ::close(fd);
+        return false;
+    }
+
+    QJsonParseError error;
+    *object = QJsonDocument::fromJson(file.readAll(), &error).object();
+    return error.error == QJsonParseError::NoError &&
+        object->value("uuid").toString() == QFileInfo(filename).completeBaseName();
+}
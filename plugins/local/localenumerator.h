@@ -0,0 +1,76 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef LOCALENUMERATOR_H
+#define LOCALENUMERATOR_H
+
+#include <QFileSystemWatcher>
+#include <QJsonObject>
+#include <QMap>
+#include <QStringList>
+#include <QTimer>
+
+#include <nitroshare/deviceenumerator.h>
+
+class Application;
+
+class LocalDevice;
+
+/**
+ * @brief Find devices announced in the local socket directory
+ *
+ * The directory is watched for changes and also scanned periodically since
+ * announcements left behind by processes that did not exit cleanly only
+ * become stale when their lock is released.
+ */
+class LocalEnumerator : public DeviceEnumerator
+{
+    Q_OBJECT
+
+public:
+
+    explicit LocalEnumerator(Application *application);
+    virtual ~LocalEnumerator();
+
+    virtual QString name() const;
+
+private slots:
+
+    void onSettingsChanged(const QStringList &keys);
+    void onScan();
+
+private:
+
+    bool readAnnouncement(const QString &filename, QJsonObject *object) const;
+
+    Application *mApplication;
+
+    QString mDirectory;
+    QFileSystemWatcher mWatcher;
+    QTimer mTimer;
+
+    QMap<QString, LocalDevice*> mDevices;
+};
+
+#endif // LOCALENUMERATOR_H
@@ -0,0 +1,50 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <nitroshare/application.h>
+#include <nitroshare/devicemodel.h>
+#include <nitroshare/transportserverregistry.h>
+
+#include "localenumerator.h"
+#include "localplugin.h"
+#include "localtransportserver.h"
+
+void LocalPlugin::initialize(Application *application)
+{
+    // The server registers the setting used by the enumerator
+    mServer = new LocalTransportServer(application);
+    application->transportServerRegistry()->add(mServer);
+
+    mEnumerator = new LocalEnumerator(application);
+    application->deviceModel()->addDeviceEnumerator(mEnumerator);
+}
+
+void LocalPlugin::cleanup(Application *application)
+{
+    application->deviceModel()->removeDeviceEnumerator(mEnumerator);
+    delete mEnumerator;
+
+    application->transportServerRegistry()->remove(mServer);
+    delete mServer;
+}
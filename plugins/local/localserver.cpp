@@ -0,0 +1,138 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <QFile>
+#include <QSocketNotifier>
+
+#include "localserver.h"
+
+LocalServer::LocalServer()
+    : mSocket(-1),
+      mNotifier(nullptr)
+{
+}
+
+LocalServer::~LocalServer()
+{
+    close();
+}
+
+bool LocalServer::socketAddress(const QString &path, sockaddr_un *address)
+{
+    QByteArray encodedPath = QFile::encodeName(path);
+    if (static_cast<size_t>(encodedPath.size()) >= sizeof(address->sun_path)) {
+        return false;
+    }
+
+    memset(address, 0, sizeof(sockaddr_un));
+    address->sun_family = AF_UNIX;
+    memcpy(address->sun_path, encodedPath.constData(), encodedPath.size());
+    return true;
+}
+
+bool LocalServer::listen(const QString &path)
+{
+    sockaddr_un address;
+    if (!socketAddress(path, &address)) {
+        mErrorString = tr("socket path \"%1\" is too long").arg(path);
+        return false;
+    }
+
+    mSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (mSocket == -1) {
+        mErrorString = qt_error_string(errno);
+        return false;
+    }
+    fcntl(mSocket, F_SETFD, FD_CLOEXEC);
+    fcntl(mSocket, F_SETFL, fcntl(mSocket, F_GETFL) | O_NONBLOCK);
+
+    // A socket left behind by an instance that did not exit cleanly would
+    // otherwise prevent binding to the path
+    unlink(address.sun_path);
+
+    if (bind(mSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == -1 ||
+            ::listen(mSocket, SOMAXCONN) == -1) {
+        mErrorString = qt_error_string(errno);
+        ::close(mSocket);
+        mSocket = -1;
+        return false;
+    }
+
+    mNotifier = new QSocketNotifier(mSocket, QSocketNotifier::Read, this);
+    connect(mNotifier, &QSocketNotifier::activated, this, &LocalServer::onActivated);
+
+    mPath = path;
+    return true;
+}
+
+void LocalServer::close()
+{
+    if (mSocket == -1) {
+        return;
+    }
+
+    delete mNotifier;
+    mNotifier = nullptr;
+
+    ::close(mSocket);
+    mSocket = -1;
+
+    // Removing the socket prevents other processes from finding it
+    unlink(QFile::encodeName(mPath).constData());
+    mPath.clear();
+}
+
+bool LocalServer::isListening() const
+{
+    return mSocket != -1;
+}
+
+QString LocalServer::errorString() const
+{
+    return mErrorString;
+}
+
+void LocalServer::onActivated()
+{
+    // Accept all pending connections (the socket is non-blocking)
+    forever {
+        int socketDescriptor = accept(mSocket, nullptr, nullptr);
+        if (socketDescriptor == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        fcntl(socketDescriptor, F_SETFD, FD_CLOEXEC);
+        emit newSocketDescriptor(socketDescriptor);
+    }
+}
@@ -0,0 +1,81 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef LOCALSERVER_H
+#define LOCALSERVER_H
+
+#include <QObject>
+#include <QString>
+
+class QSocketNotifier;
+
+struct sockaddr_un;
+
+/**
+ * @brief Listen for connections on a Unix domain socket
+ *
+ * QLocalServer cannot be used since the connections must be able to pass
+ * descriptors, which requires access to the underlying socket.
+ */
+class LocalServer : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    LocalServer();
+    virtual ~LocalServer();
+
+    /**
+     * @brief Fill in the address for a socket path
+     * @param path location of the socket in the filesystem
+     * @param address structure to fill in
+     * @return false if the path is too long
+     */
+    static bool socketAddress(const QString &path, sockaddr_un *address);
+
+    bool listen(const QString &path);
+    void close();
+
+    bool isListening() const;
+    QString errorString() const;
+
+signals:
+
+    void newSocketDescriptor(int socketDescriptor);
+
+private slots:
+
+    void onActivated();
+
+private:
+
+    int mSocket;
+    QSocketNotifier *mNotifier;
+
+    QString mPath;
+    QString mErrorString;
+};
+
+#endif // LOCALSERVER_H
@@ -0,0 +1,398 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <QMetaObject>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include <nitroshare/packet.h>
+
+#include "localserver.h"
+#include "localtransport.h"
+
+// Set in the type of packets that were sent with a descriptor
+const char DescriptorFlag = 0x40;
+
+// Maximum amount of data read from the socket at once
+const int ReadSize = 256 * 1024;
+
+// Maximum number of descriptors accepted in a single read
+const int MaxDescriptors = 16;
+
+#ifdef MSG_NOSIGNAL
+const int SendFlags = MSG_NOSIGNAL;
+#else
+const int SendFlags = 0;
+#endif
+
+#ifdef MSG_CMSG_CLOEXEC
+const int ReceiveFlags = MSG_CMSG_CLOEXEC;
+#else
+const int ReceiveFlags = 0;
+#endif
+
+LocalTransport::LocalTransport(const QString &path)
+    : mSocket(-1),
+      mReadNotifier(nullptr),
+      mWriteNotifier(nullptr),
+      mClosing(false)
+{
+    sockaddr_un address;
+    if (!LocalServer::socketAddress(path, &address)) {
+        reportError(tr("socket path \"%1\" is too long").arg(path));
+        return;
+    }
+
+    int socketDescriptor = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socketDescriptor == -1) {
+        reportError(qt_error_string(errno));
+        return;
+    }
+
+    // Connecting to a Unix domain socket completes immediately unless the
+    // backlog is full, so there is little point in doing this asynchronously
+    int ret;
+    do {
+        ret = ::connect(socketDescriptor, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    } while (ret == -1 && errno == EINTR);
+    if (ret == -1) {
+        reportError(qt_error_string(errno));
+        ::close(socketDescriptor);
+        return;
+    }
+
+    init(socketDescriptor);
+
+    // Signals cannot be connected until the constructor returns
+    QMetaObject::invokeMethod(this, "connected", Qt::QueuedConnection);
+}
+
+LocalTransport::LocalTransport(int socketDescriptor)
+    : mSocket(-1),
+      mReadNotifier(nullptr),
+      mWriteNotifier(nullptr),
+      mClosing(false)
+{
+    init(socketDescriptor);
+}
+
+LocalTransport::~LocalTransport()
+{
+    closeSocket();
+}
+
+void LocalTransport::sendPacket(Packet *packet)
+{
+    if (mSocket == -1) {
+        return;
+    }
+
+    Chunk chunk{QByteArray(), packet->content(), 0, -1};
+
+    // The descriptor must remain open until it was sent, so a copy is made
+    qint8 packetType = packet->type();
+    if (packet->descriptor() != -1) {
+        chunk.descriptor = fcntl(packet->descriptor(), F_DUPFD_CLOEXEC, 0);
+        if (chunk.descriptor == -1) {
+            reportError(qt_error_string(errno));
+            return;
+        }
+        packetType |= DescriptorFlag;
+    }
+
+    // The header is written separately so that the content is not copied
+    chunk.header = PacketStream::encodeHeader(packetType, chunk.content.size());
+
+    mWriteQueue.enqueue(chunk);
+
+    // If the packet could not be written immediately, the write notifier
+    // indicates when it was
+    if (flush()) {
+        QMetaObject::invokeMethod(this, "packetSent", Qt::QueuedConnection);
+    }
+}
+
+void LocalTransport::close()
+{
+    if (mSocket == -1) {
+        return;
+    }
+
+    // Packets that were queued (the success packet, for example) are still
+    // written before the socket is closed
+    mReadNotifier->setEnabled(false);
+    if (mWriteQueue.isEmpty()) {
+        closeSocket();
+    } else {
+        mClosing = true;
+    }
+}
+
+bool LocalTransport::canPassDescriptors() const
+{
+    return true;
+}
+
+void LocalTransport::onReadActivated()
+{
+    iovec iov;
+    iov.iov_base = mReadBuffer.data();
+    iov.iov_len = mReadBuffer.size();
+
+    union {
+        char buffer[CMSG_SPACE(MaxDescriptors * sizeof(int))];
+        cmsghdr align;
+    } control;
+
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+
+    ssize_t result;
+    do {
+        result = recvmsg(mSocket, &msg, ReceiveFlags);
+    } while (result == -1 && errno == EINTR);
+
+    if (result == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            reportError(qt_error_string(errno));
+        }
+        return;
+    }
+
+    // Descriptors arrive no later than the first byte of the packet they
+    // were sent with, so they can be matched to packets in order
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+            int count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (int i = 0; i < count; ++i) {
+                int descriptor;
+                memcpy(&descriptor, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+                mDescriptors.enqueue(descriptor);
+            }
+        }
+    }
+
+    if (msg.msg_flags & MSG_CTRUNC) {
+        reportError(tr("too many descriptors received"));
+        return;
+    }
+
+    if (!result) {
+        reportError(tr("connection closed by peer"));
+        return;
+    }
+
+    mStream.addData(QByteArray(mReadBuffer.constData(), result));
+    processBuffer();
+}
+
+void LocalTransport::onWriteActivated()
+{
+    if (!flush()) {
+        return;
+    }
+
+    if (mClosing) {
+        closeSocket();
+    } else {
+        emit packetSent();
+    }
+}
+
+void LocalTransport::init(int socketDescriptor)
+{
+    mSocket = socketDescriptor;
+    fcntl(mSocket, F_SETFL, fcntl(mSocket, F_GETFL) | O_NONBLOCK);
+
+#ifdef SO_NOSIGPIPE
+    int value = 1;
+    setsockopt(mSocket, SOL_SOCKET, SO_NOSIGPIPE, &value, sizeof(value));
+#endif
+
+    mReadBuffer.resize(ReadSize);
+
+    mReadNotifier = new QSocketNotifier(mSocket, QSocketNotifier::Read, this);
+    mWriteNotifier = new QSocketNotifier(mSocket, QSocketNotifier::Write, this);
+    mWriteNotifier->setEnabled(false);
+
+    connect(mReadNotifier, &QSocketNotifier::activated, this, &LocalTransport::onReadActivated);
+    connect(mWriteNotifier, &QSocketNotifier::activated, this, &LocalTransport::onWriteActivated);
+}
+
+bool LocalTransport::flush()
+{
+    while (!mWriteQueue.isEmpty()) {
+        Chunk &chunk = mWriteQueue.head();
+
+        // Skip whatever part of the header and content was already written
+        iovec iov[2];
+        int iovCount = 0;
+        if (chunk.written < chunk.header.size()) {
+            iov[iovCount].iov_base = chunk.header.data() + chunk.written;
+            iov[iovCount].iov_len = chunk.header.size() - chunk.written;
+            ++iovCount;
+        }
+        int contentOffset = qMax(0, chunk.written - chunk.header.size());
+        if (contentOffset < chunk.content.size()) {
+            iov[iovCount].iov_base = chunk.content.data() + contentOffset;
+            iov[iovCount].iov_len = chunk.content.size() - contentOffset;
+            ++iovCount;
+        }
+
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = iovCount;
+
+        union {
+            char buffer[CMSG_SPACE(sizeof(int))];
+            cmsghdr align;
+        } control;
+
+        // The descriptor is attached to the first byte of the packet
+        if (chunk.descriptor != -1) {
+            msg.msg_control = control.buffer;
+            msg.msg_controllen = sizeof(control.buffer);
+            cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(cmsg), &chunk.descriptor, sizeof(int));
+        }
+
+        ssize_t result = sendmsg(mSocket, &msg, SendFlags);
+        if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                mWriteNotifier->setEnabled(true);
+            } else {
+                reportError(qt_error_string(errno));
+            }
+            return false;
+        }
+
+        if (chunk.descriptor != -1) {
+            ::close(chunk.descriptor);
+            chunk.descriptor = -1;
+        }
+
+        chunk.written += result;
+        if (chunk.written == chunk.header.size() + chunk.content.size()) {
+            mWriteQueue.dequeue();
+        }
+    }
+
+    mWriteNotifier->setEnabled(false);
+    return true;
+}
+
+void LocalTransport::processBuffer()
+{
+    // Continue to emit packets as they are read
+    char type;
+    QByteArray data;
+    while (mStream.readPacket(&type, &data)) {
+
+        // Match the packet with its descriptor
+        int descriptor = -1;
+        if (type & DescriptorFlag) {
+            if (mDescriptors.isEmpty()) {
+                reportError(tr("descriptor missing from packet"));
+                return;
+            }
+            descriptor = mDescriptors.dequeue();
+            type &= ~DescriptorFlag;
+        }
+
+        // The descriptor only remains valid while the packet is processed
+        Packet packet(static_cast<Packet::Type>(type), data);
+        packet.setDescriptor(descriptor);
+        emit packetReceived(&packet);
+        if (descriptor != -1) {
+            ::close(descriptor);
+        }
+
+        // Processing the packet may have closed the transport
+        if (mSocket == -1 || mClosing) {
+            return;
+        }
+    }
+
+    if (mStream.hasError()) {
+        reportError(tr("invalid packet received"));
+    }
+}
+
+void LocalTransport::reportError(const QString &message)
+{
+    closeSocket();
+
+    // Errors may occur before the signals are connected
+    QTimer::singleShot(0, this, [this, message]() {
+        emit error(message);
+    });
+}
+
+void LocalTransport::closeSocket()
+{
+    if (mSocket == -1) {
+        return;
+    }
+
+    delete mReadNotifier;
+    delete mWriteNotifier;
+    mReadNotifier = nullptr;
+    mWriteNotifier = nullptr;
+
+    ::close(mSocket);
+    mSocket = -1;
+
+    mClosing = false;
+
+    // Close descriptors that will never be sent or matched to a packet
+    foreach (const Chunk &chunk, mWriteQueue) {
+        if (chunk.descriptor != -1) {
+            ::close(chunk.descriptor);
+        }
+    }
+    mWriteQueue.clear();
+    while (!mDescriptors.isEmpty()) {
+        ::close(mDescriptors.dequeue());
+    }
+}
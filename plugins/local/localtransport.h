@@ -0,0 +1,96 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef LOCALTRANSPORT_H
+#define LOCALTRANSPORT_H
+
+#include <QByteArray>
+#include <QQueue>
+#include <QString>
+
+#include <nitroshare/packetstream.h>
+#include <nitroshare/transport.h>
+
+class QSocketNotifier;
+
+class Packet;
+
+/**
+ * @brief Transport between processes on the same host
+ *
+ * Packets are framed the same way as the LAN transport but are sent over a
+ * Unix domain socket. Descriptors attached to packets are passed to the peer
+ * (SCM_RIGHTS), which allows files to be handed over without their contents
+ * being sent.
+ */
+class LocalTransport : public Transport
+{
+    Q_OBJECT
+
+public:
+
+    explicit LocalTransport(const QString &path);
+    explicit LocalTransport(int socketDescriptor);
+    virtual ~LocalTransport();
+
+    virtual void sendPacket(Packet *packet);
+    virtual void close();
+    virtual bool canPassDescriptors() const;
+
+private slots:
+
+    void onReadActivated();
+    void onWriteActivated();
+
+private:
+
+    struct Chunk
+    {
+        QByteArray header;
+        QByteArray content;
+        int written;
+        int descriptor;
+    };
+
+    void init(int socketDescriptor);
+    bool flush();
+    void processBuffer();
+    void reportError(const QString &message);
+    void closeSocket();
+
+    int mSocket;
+    QSocketNotifier *mReadNotifier;
+    QSocketNotifier *mWriteNotifier;
+    bool mClosing;
+
+    QQueue<Chunk> mWriteQueue;
+
+    QByteArray mReadBuffer;
+    PacketStream mStream;
+
+    // Descriptors received but not yet matched to a packet
+    QQueue<int> mDescriptors;
+};
+
+#endif // LOCALTRANSPORT_H
@@ -0,0 +1,280 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+#include <nitroshare/application.h>
+#include <nitroshare/device.h>
+#include <nitroshare/logger.h>
+#include <nitroshare/message.h>
+#include <nitroshare/settingsregistry.h>
+
+#include "localtransport.h"
+#include "localtransportserver.h"
+
+#ifdef HAVE_MEMFD_CREATE
+#  include "sharedmemorytransport.h"
+#endif
+
+const QString MessageTag = "localtransportserver";
+
+const QString LocalCategory = "local";
+const QString LocalDirectory = "LocalDirectory";
+#ifdef HAVE_MEMFD_CREATE
+const QString SharedMemory = "SharedMemory";
+#endif
+
+LocalTransportServer::LocalTransportServer(Application *application)
+    : mApplication(application),
+      mAnnouncement(-1),
+      mLocalCategory({
+          { Category::NameKey, LocalCategory },
+          { Category::TitleKey, tr("Local") }
+      }),
+      mLocalDirectory({
+          { Setting::TypeKey, Setting::DirectoryPath },
+          { Setting::NameKey, LocalDirectory },
+          { Setting::TitleKey, tr("Socket Directory") },
+          { Setting::CategoryKey, LocalCategory },
+          { Setting::DefaultValueKey, QDir(QDir::tempPath()).absoluteFilePath("nitroshare") }
+      })
+#ifdef HAVE_MEMFD_CREATE
+    , mSharedMemory({
+          { Setting::TypeKey, Setting::Boolean },
+          { Setting::NameKey, SharedMemory },
+          { Setting::TitleKey, tr("Use Shared Memory (Experimental)") },
+          { Setting::CategoryKey, LocalCategory },
+          { Setting::DefaultValueKey, false }
+      })
+#endif
+{
+    connect(&mServer, &LocalServer::newSocketDescriptor, this, &LocalTransportServer::onNewSocketDescriptor);
+#ifdef HAVE_MEMFD_CREATE
+    connect(&mSharedMemoryServer, &LocalServer::newSocketDescriptor, this, &LocalTransportServer::onNewSharedMemoryDescriptor);
+#endif
+    connect(mApplication->settingsRegistry(), &SettingsRegistry::settingsChanged, this, &LocalTransportServer::onSettingsChanged);
+
+    mApplication->settingsRegistry()->addCategory(&mLocalCategory);
+    mApplication->settingsRegistry()->addSetting(&mLocalDirectory);
+#ifdef HAVE_MEMFD_CREATE
+    mApplication->settingsRegistry()->addSetting(&mSharedMemory);
+#endif
+
+    start();
+}
+
+LocalTransportServer::~LocalTransportServer()
+{
+    stop();
+
+    mApplication->settingsRegistry()->removeSetting(&mLocalDirectory);
+#ifdef HAVE_MEMFD_CREATE
+    mApplication->settingsRegistry()->removeSetting(&mSharedMemory);
+#endif
+    mApplication->settingsRegistry()->removeCategory(&mLocalCategory);
+}
+
+QString LocalTransportServer::name() const
+{
+    return "local";
+}
+
+Transport *LocalTransportServer::createTransport(Device *device)
+{
+    QString path = device->property("path").toString();
+    if (path.isEmpty()) {
+        mApplication->logger()->log(new Message(
+            Message::Error,
+            MessageTag,
+            "device is missing socket path"
+        ));
+        return nullptr;
+    }
+
+#ifdef HAVE_MEMFD_CREATE
+    // Both ends must have enabled the experimental transport
+    QString sharedMemoryPath = device->property("sharedMemoryPath").toString();
+    if (mApplication->settingsRegistry()->value(SharedMemory).toBool() &&
+            !sharedMemoryPath.isEmpty()) {
+        mApplication->logger()->log(new Message(
+            Message::Info,
+            MessageTag,
+            QString("creating shared memory transport for %1").arg(sharedMemoryPath)
+        ));
+
+        return new SharedMemoryTransport(sharedMemoryPath);
+    }
+#endif
+
+    mApplication->logger()->log(new Message(
+        Message::Info,
+        MessageTag,
+        QString("creating transport for %1").arg(path)
+    ));
+
+    return new LocalTransport(path);
+}
+
+void LocalTransportServer::onNewSocketDescriptor(int socketDescriptor)
+{
+    mApplication->logger()->log(new Message(
+        Message::Debug,
+        MessageTag,
+        "socket descriptor for incoming connection received"
+    ));
+
+    emit transportReceived(new LocalTransport(socketDescriptor));
+}
+
+#ifdef HAVE_MEMFD_CREATE
+
+void LocalTransportServer::onNewSharedMemoryDescriptor(int socketDescriptor)
+{
+    mApplication->logger()->log(new Message(
+        Message::Debug,
+        MessageTag,
+        "socket descriptor for incoming shared memory connection received"
+    ));
+
+    emit transportReceived(new SharedMemoryTransport(socketDescriptor));
+}
+
+#endif
+
+void LocalTransportServer::onSettingsChanged(const QStringList &keys)
+{
+    if (keys.contains(LocalDirectory) ||
+#ifdef HAVE_MEMFD_CREATE
+            keys.contains(SharedMemory) ||
+#endif
+            keys.contains(Application::DeviceUuidSettingName)) {
+        stop();
+        start();
+    } else if (keys.contains(Application::DeviceNameSettingName)) {
+        announce();
+    }
+}
+
+void LocalTransportServer::start()
+{
+    QDir directory(mApplication->settingsRegistry()->value(LocalDirectory).toString());
+    if (!directory.mkpath(".")) {
+        mApplication->logger()->log(new Message(
+            Message::Error,
+            MessageTag,
+            QString("unable to create %1").arg(directory.absolutePath())
+        ));
+        return;
+    }
+
+    QString uuid = mApplication->deviceUuid();
+    if (!mServer.listen(directory.absoluteFilePath(uuid + ".sock"))) {
+        mApplication->logger()->log(new Message(
+            Message::Error,
+            MessageTag,
+            mServer.errorString()
+        ));
+        return;
+    }
+
+#ifdef HAVE_MEMFD_CREATE
+    if (mApplication->settingsRegistry()->value(SharedMemory).toBool() &&
+            !mSharedMemoryServer.listen(directory.absoluteFilePath(uuid + ".shm"))) {
+        mApplication->logger()->log(new Message(
+            Message::Error,
+            MessageTag,
+            mSharedMemoryServer.errorString()
+        ));
+    }
+#endif
+
+    mAnnouncementPath = directory.absoluteFilePath(uuid + ".json");
+    announce();
+}
+
+void LocalTransportServer::stop()
+{
+    mServer.close();
+#ifdef HAVE_MEMFD_CREATE
+    mSharedMemoryServer.close();
+#endif
+
+    if (!mAnnouncementPath.isNull()) {
+        QFile::remove(mAnnouncementPath);
+        mAnnouncementPath.clear();
+    }
+
+    if (mAnnouncement != -1) {
+        ::close(mAnnouncement);
+        mAnnouncement = -1;
+    }
+}
+
+void LocalTransportServer::announce()
+{
+    if (mAnnouncementPath.isNull()) {
+        return;
+    }
+
+    QJsonObject object{
+        { "uuid", mApplication->deviceUuid() },
+        { "name", mApplication->deviceName() }
+    };
+#ifdef HAVE_MEMFD_CREATE
+    if (mSharedMemoryServer.isListening()) {
+        object.insert("sharedMemory", true);
+    }
+#endif
+
+    // The file is replaced atomically so that it is never read partially
+    QSaveFile file(mAnnouncementPath);
+    if (!file.open(QIODevice::WriteOnly) ||
+            file.write(QJsonDocument(object).toJson()) == -1 ||
+            !file.commit()) {
+        mApplication->logger()->log(new Message(
+            Message::Error,
+            MessageTag,
+            file.errorString()
+        ));
+        return;
+    }
+
+    // A lock is held on the file for as long as the server is running so that
+    // files left behind by processes that did not exit cleanly are ignored
+    if (mAnnouncement != -1) {
+        ::close(mAnnouncement);
+    }
+    mAnnouncement = ::open(QFile::encodeName(mAnnouncementPath).constData(), O_RDONLY | O_CLOEXEC);
+    if (mAnnouncement != -1) {
+        flock(mAnnouncement, LOCK_EX | LOCK_NB);
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef LOCALTRANSPORTSERVER_H
+#define LOCALTRANSPORTSERVER_H
+
+#include "localconfig.h"
+
+#include <QStringList>
+
+#include <nitroshare/category.h>
+#include <nitroshare/setting.h>
+#include <nitroshare/transportserver.h>
+
+#include "localserver.h"
+
+class Application;
+
+/**
+ * @brief Accept transfers from other processes on the same host
+ *
+ * The server listens on a socket named after the device UUID in a well-known
+ * directory and announces itself with a JSON file alongside it. The directory
+ * can be shared with containers to allow transfers between them.
+ */
+class LocalTransportServer : public TransportServer
+{
+    Q_OBJECT
+
+public:
+
+    explicit LocalTransportServer(Application *application);
+    virtual ~LocalTransportServer();
+
+    virtual QString name() const;
+    virtual Transport *createTransport(Device *device);
+
+private slots:
+
+    void onNewSocketDescriptor(int socketDescriptor);
+#ifdef HAVE_MEMFD_CREATE
+    void onNewSharedMemoryDescriptor(int socketDescriptor);
+#endif
+    void onSettingsChanged(const QStringList &keys);
+
+private:
+
+    void start();
+    void stop();
+    void announce();
+
+    Application *mApplication;
+    LocalServer mServer;
+#ifdef HAVE_MEMFD_CREATE
+    LocalServer mSharedMemoryServer;
+#endif
+
+    QString mAnnouncementPath;
+    int mAnnouncement;
+
+    Category mLocalCategory;
+    Setting mLocalDirectory;
+#ifdef HAVE_MEMFD_CREATE
+    Setting mSharedMemory;
+#endif
+};
+
+#endif // LOCALTRANSPORTSERVER_H
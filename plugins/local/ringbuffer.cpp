@@ -0,0 +1,127 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cstring>
+
+#include "ringbuffer.h"
+
+struct RingBuffer::Header
+{
+    // Positions are kept on separate cache lines since each is written by a
+    // different process
+    quint32 head;
+    char headPadding[60];
+    quint32 tail;
+    char tailPadding[60];
+
+    quint32 readerWaiting;
+    quint32 writerWaiting;
+};
+
+RingBuffer::RingBuffer(char *memory, quint32 capacity)
+    : mHeader(reinterpret_cast<Header*>(memory)),
+      mData(memory + HeaderSize),
+      mCapacity(capacity)
+{
+    static_assert(sizeof(Header) <= HeaderSize, "ring header is too large");
+}
+
+void RingBuffer::reset()
+{
+    memset(mHeader, 0, sizeof(Header));
+}
+
+qint64 RingBuffer::write(const char *data, quint32 size)
+{
+    quint32 head = __atomic_load_n(&mHeader->head, __ATOMIC_RELAXED);
+    quint32 tail = __atomic_load_n(&mHeader->tail, __ATOMIC_ACQUIRE);
+    if (head - tail > mCapacity) {
+        return -1;
+    }
+
+    size = qMin(size, mCapacity - (head - tail));
+    if (!size) {
+        return 0;
+    }
+
+    // The data may wrap around the end of the ring
+    quint32 offset = head & (mCapacity - 1);
+    quint32 first = qMin(size, mCapacity - offset);
+    memcpy(mData + offset, data, first);
+    memcpy(mData, data + first, size - first);
+
+    __atomic_store_n(&mHeader->head, head + size, __ATOMIC_RELEASE);
+    return size;
+}
+
+qint64 RingBuffer::read(QByteArray *buffer)
+{
+    quint32 tail = __atomic_load_n(&mHeader->tail, __ATOMIC_RELAXED);
+    quint32 head = __atomic_load_n(&mHeader->head, __ATOMIC_ACQUIRE);
+    quint32 size = head - tail;
+    if (size > mCapacity) {
+        return -1;
+    }
+    if (!size) {
+        return 0;
+    }
+
+    quint32 offset = tail & (mCapacity - 1);
+    quint32 first = qMin(size, mCapacity - offset);
+    buffer->append(mData + offset, first);
+    buffer->append(mData, size - first);
+
+    __atomic_store_n(&mHeader->tail, tail + size, __ATOMIC_RELEASE);
+    return size;
+}
+
+bool RingBuffer::prepareRead()
+{
+    // The flag must be visible before the position is checked again, or a
+    // write in between would go unnoticed
+    __atomic_store_n(&mHeader->readerWaiting, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return __atomic_load_n(&mHeader->head, __ATOMIC_SEQ_CST) !=
+        __atomic_load_n(&mHeader->tail, __ATOMIC_RELAXED);
+}
+
+bool RingBuffer::prepareWrite()
+{
+    __atomic_store_n(&mHeader->writerWaiting, 1, __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return __atomic_load_n(&mHeader->head, __ATOMIC_RELAXED) -
+        __atomic_load_n(&mHeader->tail, __ATOMIC_SEQ_CST) < mCapacity;
+}
+
+bool RingBuffer::wakeReader()
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return __atomic_exchange_n(&mHeader->readerWaiting, 0, __ATOMIC_SEQ_CST);
+}
+
+bool RingBuffer::wakeWriter()
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    return __atomic_exchange_n(&mHeader->writerWaiting, 0, __ATOMIC_SEQ_CST);
+}
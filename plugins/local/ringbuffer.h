@@ -0,0 +1,106 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+/**
+ * @brief Single-producer, single-consumer byte ring in shared memory
+ *
+ * The ring consists of a header followed by the data. Both positions are
+ * free-running counters, which allows a full ring to be distinguished from an
+ * empty one. Since the memory is shared with another process, positions are
+ * validated before use.
+ *
+ * Each side sets a flag before it waits for the other so that notifications
+ * are only needed when someone is actually waiting.
+ */
+class RingBuffer
+{
+public:
+
+    /// Bytes reserved for the header at the start of the ring
+    static const int HeaderSize = 256;
+
+    /**
+     * @brief Create a ring in existing memory
+     * @param memory start of HeaderSize + capacity bytes
+     * @param capacity size of the data area (a power of two)
+     */
+    RingBuffer(char *memory, quint32 capacity);
+
+    /**
+     * @brief Initialize the header of a newly created ring
+     */
+    void reset();
+
+    /**
+     * @brief Write as much data to the ring as will fit
+     * @return number of bytes written or -1 if the ring is corrupt
+     */
+    qint64 write(const char *data, quint32 size);
+
+    /**
+     * @brief Append all data in the ring to a buffer
+     * @return number of bytes read or -1 if the ring is corrupt
+     */
+    qint64 read(QByteArray *buffer);
+
+    /**
+     * @brief Indicate that the consumer is about to wait for data
+     * @return true if data became available in the meantime
+     */
+    bool prepareRead();
+
+    /**
+     * @brief Indicate that the producer is about to wait for space
+     * @return true if space became available in the meantime
+     */
+    bool prepareWrite();
+
+    /**
+     * @brief Clear the consumer's wait flag after writing
+     * @return true if the consumer must be notified
+     */
+    bool wakeReader();
+
+    /**
+     * @brief Clear the producer's wait flag after reading
+     * @return true if the producer must be notified
+     */
+    bool wakeWriter();
+
+private:
+
+    struct Header;
+
+    Header *mHeader;
+    char *mData;
+    quint32 mCapacity;
+};
+
+#endif // RINGBUFFER_H
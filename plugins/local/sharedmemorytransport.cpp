@@ -0,0 +1,584 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <QMetaObject>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#include <nitroshare/packet.h>
+
+#include "localserver.h"
+#include "ringbuffer.h"
+#include "sharedmemorytransport.h"
+
+// Set in the type of packets that were sent with a descriptor
+const char DescriptorFlag = 0x40;
+
+// Size of the ring in each direction
+const quint32 RingCapacity = 4 * 1024 * 1024;
+
+// Size of the shared memory (a ring for each direction)
+const size_t MemorySize = 2 * (RingBuffer::HeaderSize + RingCapacity);
+
+// Sent by the connecting side along with the descriptors
+const char HandshakeVersion = 1;
+
+// Shared memory, server event, and client event
+const int HandshakeDescriptors = 3;
+
+// Maximum number of descriptors accepted in a single read
+const int MaxDescriptors = 16;
+
+SharedMemoryTransport::SharedMemoryTransport(const QString &path)
+    : mSocket(-1),
+      mSocketNotifier(nullptr),
+      mServer(false),
+      mMemory(nullptr),
+      mSendRing(nullptr),
+      mReceiveRing(nullptr),
+      mLocalEvent(-1),
+      mRemoteEvent(-1),
+      mEventNotifier(nullptr),
+      mWaitingForSpace(false),
+      mClosing(false)
+{
+    sockaddr_un address;
+    if (!LocalServer::socketAddress(path, &address)) {
+        reportError(tr("socket path \"%1\" is too long").arg(path));
+        return;
+    }
+
+    mSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (mSocket == -1) {
+        reportError(qt_error_string(errno));
+        return;
+    }
+    fcntl(mSocket, F_SETFD, FD_CLOEXEC);
+
+    int ret;
+    do {
+        ret = ::connect(mSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    } while (ret == -1 && errno == EINTR);
+    if (ret == -1 || !create()) {
+        reportError(qt_error_string(errno));
+        return;
+    }
+
+    start();
+
+    // Signals cannot be connected until the constructor returns
+    QMetaObject::invokeMethod(this, "connected", Qt::QueuedConnection);
+}
+
+SharedMemoryTransport::SharedMemoryTransport(int socketDescriptor)
+    : mSocket(socketDescriptor),
+      mSocketNotifier(nullptr),
+      mServer(true),
+      mMemory(nullptr),
+      mSendRing(nullptr),
+      mReceiveRing(nullptr),
+      mLocalEvent(-1),
+      mRemoteEvent(-1),
+      mEventNotifier(nullptr),
+      mWaitingForSpace(false),
+      mClosing(false)
+{
+    // Nothing can be done until the handshake arrives
+    fcntl(mSocket, F_SETFL, fcntl(mSocket, F_GETFL) | O_NONBLOCK);
+    mSocketNotifier = new QSocketNotifier(mSocket, QSocketNotifier::Read, this);
+    connect(mSocketNotifier, &QSocketNotifier::activated, this, &SharedMemoryTransport::onSocketActivated);
+}
+
+SharedMemoryTransport::~SharedMemoryTransport()
+{
+    closeAll();
+}
+
+void SharedMemoryTransport::sendPacket(Packet *packet)
+{
+    if (!mSendRing) {
+        return;
+    }
+
+    // The descriptor is sent over the socket before the packet is written
+    // to the ring, ensuring that it has arrived by the time it is needed
+    qint8 packetType = packet->type();
+    if (packet->descriptor() != -1) {
+        char data = 0;
+        iovec iov{&data, sizeof(data)};
+
+        union {
+            char buffer[CMSG_SPACE(sizeof(int))];
+            cmsghdr align;
+        } control;
+
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buffer;
+        msg.msg_controllen = sizeof(control.buffer);
+
+        int descriptor = packet->descriptor();
+        cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+        memcpy(CMSG_DATA(cmsg), &descriptor, sizeof(int));
+
+        ssize_t result;
+        do {
+            result = sendmsg(mSocket, &msg, MSG_NOSIGNAL);
+        } while (result == -1 && errno == EINTR);
+        if (result == -1) {
+            reportError(qt_error_string(errno));
+            return;
+        }
+
+        packetType |= DescriptorFlag;
+    }
+
+    // Build the frame, which is identical to that of the other transports
+    PacketStream::encode(mPending, packetType, packet->content());
+
+    // If the ring is full, the peer signals once it has made room
+    if (flush()) {
+        QMetaObject::invokeMethod(this, "packetSent", Qt::QueuedConnection);
+    } else {
+        mWaitingForSpace = true;
+    }
+}
+
+void SharedMemoryTransport::close()
+{
+    if (mSocket == -1) {
+        return;
+    }
+
+    // Packets still waiting for space in the ring are written first
+    if (mPending.isEmpty()) {
+        closeAll();
+    } else {
+        mClosing = true;
+    }
+}
+
+bool SharedMemoryTransport::canPassDescriptors() const
+{
+    return true;
+}
+
+void SharedMemoryTransport::onSocketActivated()
+{
+    if (!mReceiveRing) {
+        if (receiveHandshake()) {
+            start();
+        }
+        return;
+    }
+
+    // Whatever the peer wrote before going away must be processed first
+    if (!readSocket()) {
+        receive();
+        if (mSocket != -1) {
+            reportError(tr("connection closed by peer"));
+        }
+    }
+}
+
+void SharedMemoryTransport::onEventActivated()
+{
+    quint64 value;
+    while (read(mLocalEvent, &value, sizeof(value)) == -1 && errno == EINTR);
+
+    // The peer either wrote data or made room in the ring
+    if (mWaitingForSpace && flush()) {
+        mWaitingForSpace = false;
+        if (mClosing) {
+            closeAll();
+            return;
+        }
+        emit packetSent();
+    }
+
+    receive();
+}
+
+bool SharedMemoryTransport::create()
+{
+    int memoryDescriptor = memfd_create("nitroshare", MFD_CLOEXEC);
+    if (memoryDescriptor == -1) {
+        return false;
+    }
+
+    int serverEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    int clientEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (serverEvent == -1 || clientEvent == -1 ||
+            ftruncate(memoryDescriptor, MemorySize) == -1 ||
+            !map(memoryDescriptor)) {
+        int error = errno;
+        if (serverEvent != -1) {
+            ::close(serverEvent);
+        }
+        if (clientEvent != -1) {
+            ::close(clientEvent);
+        }
+        ::close(memoryDescriptor);
+        errno = error;
+        return false;
+    }
+
+    mSendRing->reset();
+    mReceiveRing->reset();
+
+    mLocalEvent = clientEvent;
+    mRemoteEvent = serverEvent;
+
+    // Pass everything to the server
+    char data = HandshakeVersion;
+    iovec iov{&data, sizeof(data)};
+
+    union {
+        char buffer[CMSG_SPACE(HandshakeDescriptors * sizeof(int))];
+        cmsghdr align;
+    } control;
+
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+
+    int descriptors[HandshakeDescriptors] = { memoryDescriptor, serverEvent, clientEvent };
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(descriptors));
+    memcpy(CMSG_DATA(cmsg), descriptors, sizeof(descriptors));
+
+    ssize_t result;
+    do {
+        result = sendmsg(mSocket, &msg, MSG_NOSIGNAL);
+    } while (result == -1 && errno == EINTR);
+
+    // The mapping keeps the memory alive
+    int error = errno;
+    ::close(memoryDescriptor);
+    errno = error;
+
+    return result != -1;
+}
+
+bool SharedMemoryTransport::map(int memoryDescriptor)
+{
+    void *memory = mmap(nullptr, MemorySize, PROT_READ | PROT_WRITE, MAP_SHARED, memoryDescriptor, 0);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+    mMemory = static_cast<char*>(memory);
+
+    // The first ring carries data from the client to the server
+    RingBuffer *clientRing = new RingBuffer(mMemory, RingCapacity);
+    RingBuffer *serverRing = new RingBuffer(mMemory + RingBuffer::HeaderSize + RingCapacity, RingCapacity);
+    mSendRing = mServer ? serverRing : clientRing;
+    mReceiveRing = mServer ? clientRing : serverRing;
+
+    return true;
+}
+
+bool SharedMemoryTransport::receiveHandshake()
+{
+    char data;
+    iovec iov{&data, sizeof(data)};
+
+    union {
+        char buffer[CMSG_SPACE(HandshakeDescriptors * sizeof(int))];
+        cmsghdr align;
+    } control;
+
+    msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buffer;
+    msg.msg_controllen = sizeof(control.buffer);
+
+    ssize_t result;
+    do {
+        result = recvmsg(mSocket, &msg, MSG_CMSG_CLOEXEC);
+    } while (result == -1 && errno == EINTR);
+    if (result == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        return false;
+    }
+
+    // Collect the descriptors first so that they are closed on failure
+    int descriptors[HandshakeDescriptors] = { -1, -1, -1 };
+    cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+    bool valid = result == 1 && data == HandshakeVersion && !(msg.msg_flags & MSG_CTRUNC) &&
+        cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS &&
+        cmsg->cmsg_len == CMSG_LEN(sizeof(descriptors));
+    if (cmsg && cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+        memcpy(descriptors, CMSG_DATA(cmsg),
+            qMin(sizeof(descriptors), static_cast<size_t>(cmsg->cmsg_len - CMSG_LEN(0))));
+    }
+
+    // The memory must be exactly the size expected or accessing it could fault
+    struct stat info;
+    valid = valid && fstat(descriptors[0], &info) == 0 &&
+        static_cast<size_t>(info.st_size) == MemorySize &&
+        map(descriptors[0]);
+
+    if (descriptors[0] != -1) {
+        ::close(descriptors[0]);
+    }
+
+    if (!valid) {
+        for (int i = 1; i < HandshakeDescriptors; ++i) {
+            if (descriptors[i] != -1) {
+                ::close(descriptors[i]);
+            }
+        }
+        reportError(tr("invalid handshake received"));
+        return false;
+    }
+
+    mLocalEvent = descriptors[1];
+    mRemoteEvent = descriptors[2];
+    return true;
+}
+
+void SharedMemoryTransport::start()
+{
+    fcntl(mSocket, F_SETFL, fcntl(mSocket, F_GETFL) | O_NONBLOCK);
+
+    if (!mSocketNotifier) {
+        mSocketNotifier = new QSocketNotifier(mSocket, QSocketNotifier::Read, this);
+        connect(mSocketNotifier, &QSocketNotifier::activated, this, &SharedMemoryTransport::onSocketActivated);
+    }
+
+    mEventNotifier = new QSocketNotifier(mLocalEvent, QSocketNotifier::Read, this);
+    connect(mEventNotifier, &QSocketNotifier::activated, this, &SharedMemoryTransport::onEventActivated);
+
+    // Process anything the peer wrote before the notifier was created (this
+    // also indicates to the peer that a notification is needed)
+    receive();
+}
+
+bool SharedMemoryTransport::readSocket()
+{
+    forever {
+        char data[64];
+        iovec iov{data, sizeof(data)};
+
+        union {
+            char buffer[CMSG_SPACE(MaxDescriptors * sizeof(int))];
+            cmsghdr align;
+        } control;
+
+        msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control.buffer;
+        msg.msg_controllen = sizeof(control.buffer);
+
+        ssize_t result = recvmsg(mSocket, &msg, MSG_CMSG_CLOEXEC);
+        if (result == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+
+        for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_RIGHTS) {
+                int count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+                for (int i = 0; i < count; ++i) {
+                    int descriptor;
+                    memcpy(&descriptor, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+                    mDescriptors.enqueue(descriptor);
+                }
+            }
+        }
+
+        if (!result) {
+            return false;
+        }
+    }
+}
+
+bool SharedMemoryTransport::flush()
+{
+    while (!mPending.isEmpty()) {
+        qint64 result = mSendRing->write(mPending.constData(), mPending.size());
+        if (result == -1) {
+            reportError(tr("shared memory is corrupt"));
+            return false;
+        }
+        if (result) {
+            mPending.remove(0, result);
+            if (mSendRing->wakeReader()) {
+                notifyPeer();
+            }
+            continue;
+        }
+
+        // The ring is full - wait for the peer unless it made room already
+        if (!mSendRing->prepareWrite()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void SharedMemoryTransport::receive()
+{
+    while (mReceiveRing && !mClosing) {
+        QByteArray data;
+        qint64 result = mReceiveRing->read(&data);
+        if (result == -1) {
+            reportError(tr("shared memory is corrupt"));
+            return;
+        }
+        if (result) {
+            mStream.addData(data);
+            if (mReceiveRing->wakeWriter()) {
+                notifyPeer();
+            }
+            processBuffer();
+            continue;
+        }
+
+        // The ring is empty - wait for the peer unless it wrote more already
+        if (!mReceiveRing->prepareRead()) {
+            return;
+        }
+    }
+}
+
+void SharedMemoryTransport::processBuffer()
+{
+    // Continue to emit packets as they are read
+    char type;
+    QByteArray data;
+    while (mStream.readPacket(&type, &data)) {
+
+        // The descriptor was sent over the socket before the packet
+        int descriptor = -1;
+        if (type & DescriptorFlag) {
+            if (mDescriptors.isEmpty()) {
+                readSocket();
+            }
+            if (mDescriptors.isEmpty()) {
+                reportError(tr("descriptor missing from packet"));
+                return;
+            }
+            descriptor = mDescriptors.dequeue();
+            type &= ~DescriptorFlag;
+        }
+
+        // The descriptor only remains valid while the packet is processed
+        Packet packet(static_cast<Packet::Type>(type), data);
+        packet.setDescriptor(descriptor);
+        emit packetReceived(&packet);
+        if (descriptor != -1) {
+            ::close(descriptor);
+        }
+
+        // Processing the packet may have closed the transport
+        if (!mReceiveRing || mClosing) {
+            return;
+        }
+    }
+
+    if (mStream.hasError()) {
+        reportError(tr("invalid packet received"));
+    }
+}
+
+void SharedMemoryTransport::notifyPeer()
+{
+    quint64 value = 1;
+    while (write(mRemoteEvent, &value, sizeof(value)) == -1 && errno == EINTR);
+}
+
+void SharedMemoryTransport::reportError(const QString &message)
+{
+    closeAll();
+
+    // Errors may occur before the signals are connected
+    QTimer::singleShot(0, this, [this, message]() {
+        emit error(message);
+    });
+}
+
+void SharedMemoryTransport::closeAll()
+{
+    delete mSocketNotifier;
+    delete mEventNotifier;
+    mSocketNotifier = nullptr;
+    mEventNotifier = nullptr;
+
+    if (mSocket != -1) {
+        ::close(mSocket);
+        mSocket = -1;
+    }
+    if (mLocalEvent != -1) {
+        ::close(mLocalEvent);
+        mLocalEvent = -1;
+    }
+    if (mRemoteEvent != -1) {
+        ::close(mRemoteEvent);
+        mRemoteEvent = -1;
+    }
+
+    // Both rings share the same mapping
+    if (mMemory) {
+        delete mSendRing;
+        delete mReceiveRing;
+        mSendRing = nullptr;
+        mReceiveRing = nullptr;
+        munmap(mMemory, MemorySize);
+        mMemory = nullptr;
+    }
+
+    mPending.clear();
+    mClosing = false;
+    while (!mDescriptors.isEmpty()) {
+        ::close(mDescriptors.dequeue());
+    }
+}
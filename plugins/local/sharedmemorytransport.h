@@ -0,0 +1,106 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SHAREDMEMORYTRANSPORT_H
+#define SHAREDMEMORYTRANSPORT_H
+
+#include <QByteArray>
+#include <QQueue>
+#include <QString>
+
+#include <nitroshare/packetstream.h>
+#include <nitroshare/transport.h>
+
+class QSocketNotifier;
+
+class Packet;
+class RingBuffer;
+
+/**
+ * @brief Experimental transport using shared memory
+ *
+ * The connecting side creates a memfd containing a ring for each direction
+ * and an eventfd for each side and passes them over a Unix domain socket.
+ * Packets are then framed the same way as the other transports but copied
+ * through the rings, avoiding a system call per packet while both sides are
+ * busy. The socket remains open to detect the peer going away and to pass
+ * descriptors attached to packets.
+ */
+class SharedMemoryTransport : public Transport
+{
+    Q_OBJECT
+
+public:
+
+    explicit SharedMemoryTransport(const QString &path);
+    explicit SharedMemoryTransport(int socketDescriptor);
+    virtual ~SharedMemoryTransport();
+
+    virtual void sendPacket(Packet *packet);
+    virtual void close();
+    virtual bool canPassDescriptors() const;
+
+private slots:
+
+    void onSocketActivated();
+    void onEventActivated();
+
+private:
+
+    bool create();
+    bool map(int memoryDescriptor);
+    bool receiveHandshake();
+    void start();
+
+    bool readSocket();
+    bool flush();
+    void receive();
+    void processBuffer();
+    void notifyPeer();
+    void reportError(const QString &message);
+    void closeAll();
+
+    int mSocket;
+    QSocketNotifier *mSocketNotifier;
+    bool mServer;
+
+    char *mMemory;
+    RingBuffer *mSendRing;
+    RingBuffer *mReceiveRing;
+
+    // Eventfd signalled by the peer and eventfd signalled for the peer
+    int mLocalEvent;
+    int mRemoteEvent;
+    QSocketNotifier *mEventNotifier;
+
+    QByteArray mPending;
+    bool mWaitingForSpace;
+    bool mClosing;
+
+    PacketStream mStream;
+
+    QQueue<int> mDescriptors;
+};
+
+#endif // SHAREDMEMORYTRANSPORT_H
@@ -0,0 +1,181 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <vector>
+
+#include "erasurecode.h"
+
+namespace {
+
+/**
+ * Logarithm, exponent and multiplication tables for GF(2^8) using the
+ * polynomial x^8 + x^4 + x^3 + x^2 + 1
+ */
+struct Tables
+{
+    Tables()
+    {
+        int x = 1;
+        for (int i = 0; i < 255; ++i) {
+            exp[i] = exp[i + 255] = static_cast<unsigned char>(x);
+            log[x] = static_cast<unsigned char>(i);
+            x <<= 1;
+            if (x & 0x100) {
+                x ^= 0x11d;
+            }
+        }
+        log[0] = 0;
+
+        for (int a = 0; a < 256; ++a) {
+            for (int b = 0; b < 256; ++b) {
+                mul[a][b] = a && b ? exp[log[a] + log[b]] : 0;
+            }
+        }
+    }
+
+    unsigned char exp[510];
+    unsigned char log[256];
+    unsigned char mul[256][256];
+};
+
+const Tables &tables()
+{
+    static const Tables t;
+    return t;
+}
+
+unsigned char inverse(unsigned char a)
+{
+    return tables().exp[255 - tables().log[a]];
+}
+
+unsigned char coefficient(int index, int i)
+{
+    return inverse(static_cast<unsigned char>(index ^ i));
+}
+
+// out += c * in
+void addScaled(char *out, const char *in, unsigned char c, int size)
+{
+    if (!c) {
+        return;
+    }
+    const unsigned char *row = tables().mul[c];
+    unsigned char *o = reinterpret_cast<unsigned char*>(out);
+    const unsigned char *n = reinterpret_cast<const unsigned char*>(in);
+    for (int i = 0; i < size; ++i) {
+        o[i] ^= row[n[i]];
+    }
+}
+
+}
+
+const int ErasureCode::MaxSymbols;
+
+void ErasureCode::encode(const char *const *data, int count, int size, int index, char *parity)
+{
+    memset(parity, 0, size);
+    for (int i = 0; i < count; ++i) {
+        addScaled(parity, data[i], coefficient(index, i), size);
+    }
+}
+
+bool ErasureCode::decode(char *const *data, const bool *present, int count, int size,
+                         const char *const *parity, const int *indices, int parityCount)
+{
+    std::vector<int> missing;
+    for (int i = 0; i < count; ++i) {
+        if (!present[i]) {
+            missing.push_back(i);
+        }
+    }
+
+    int n = static_cast<int>(missing.size());
+    if (!n) {
+        return true;
+    }
+    if (parityCount < n) {
+        return false;
+    }
+
+    // Remove the contribution of the data symbols that were received from
+    // each parity symbol, leaving only that of the missing ones
+    std::vector<std::vector<char>> remainders(n, std::vector<char>(size));
+    for (int r = 0; r < n; ++r) {
+        memcpy(remainders[r].data(), parity[r], size);
+        for (int i = 0; i < count; ++i) {
+            if (present[i]) {
+                addScaled(remainders[r].data(), data[i], coefficient(indices[r], i), size);
+            }
+        }
+    }
+
+    // Invert the matrix of coefficients for the missing symbols using
+    // Gauss-Jordan elimination
+    std::vector<std::vector<unsigned char>> matrix(n, std::vector<unsigned char>(2 * n, 0));
+    for (int r = 0; r < n; ++r) {
+        for (int c = 0; c < n; ++c) {
+            matrix[r][c] = coefficient(indices[r], missing[c]);
+        }
+        matrix[r][n + r] = 1;
+    }
+
+    const Tables &t = tables();
+    for (int c = 0; c < n; ++c) {
+        int pivot = c;
+        while (pivot < n && !matrix[pivot][c]) {
+            ++pivot;
+        }
+        if (pivot == n) {
+            return false;
+        }
+        std::swap(matrix[c], matrix[pivot]);
+
+        unsigned char scale = inverse(matrix[c][c]);
+        for (int k = 0; k < 2 * n; ++k) {
+            matrix[c][k] = t.mul[scale][matrix[c][k]];
+        }
+
+        for (int r = 0; r < n; ++r) {
+            unsigned char factor = matrix[r][c];
+            if (r != c && factor) {
+                for (int k = 0; k < 2 * n; ++k) {
+                    matrix[r][k] ^= t.mul[factor][matrix[c][k]];
+                }
+            }
+        }
+    }
+
+    // Each missing symbol is a combination of the remainders
+    for (int c = 0; c < n; ++c) {
+        char *out = data[missing[c]];
+        memset(out, 0, size);
+        for (int r = 0; r < n; ++r) {
+            addScaled(out, remainders[r].data(), matrix[c][n + r], size);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,76 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef ERASURECODE_H
+#define ERASURECODE_H
+
+/**
+ * @brief Reed-Solomon erasure code over GF(2^8)
+ *
+ * A block of data is split into a number of equally sized data symbols and
+ * any number of parity symbols may be computed for it, up to MaxSymbols in
+ * total. The data can be recovered from any combination of data and parity
+ * symbols as long as there are as many of them as there were data symbols.
+ *
+ * The code is systematic (data symbols are sent unchanged) and uses a Cauchy
+ * matrix, where the coefficient for data symbol i in parity symbol j is
+ * 1 / (i XOR j). Every square submatrix of a Cauchy matrix is invertible,
+ * which is what allows any combination of symbols to be used.
+ */
+class ErasureCode
+{
+public:
+
+    /**
+     * @brief Maximum number of data and parity symbols in a block
+     */
+    static const int MaxSymbols = 256;
+
+    /**
+     * @brief Compute a parity symbol
+     * @param data pointers to the data symbols
+     * @param count number of data symbols
+     * @param size size of each symbol in bytes
+     * @param index index of the parity symbol (count to MaxSymbols - 1)
+     * @param parity buffer that receives the parity symbol
+     */
+    static void encode(const char *const *data, int count, int size, int index, char *parity);
+
+    /**
+     * @brief Recover missing data symbols
+     * @param data pointers to the data symbols, where those that are missing
+     *        point to buffers that receive the recovered symbols
+     * @param present indicates which data symbols were received
+     * @param count number of data symbols
+     * @param size size of each symbol in bytes
+     * @param parity pointers to the parity symbols that were received
+     * @param indices index of each parity symbol
+     * @param parityCount number of parity symbols
+     * @return false if there are fewer parity symbols than missing ones
+     */
+    static bool decode(char *const *data, const bool *present, int count, int size,
+                       const char *const *parity, const int *indices, int parityCount);
+};
+
+#endif // ERASURECODE_H
@@ -0,0 +1,55 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <nitroshare/actionregistry.h>
+#include <nitroshare/application.h>
+#include <nitroshare/devicemodel.h>
+#include <nitroshare/transportserverregistry.h>
+
+#include "groupenumerator.h"
+#include "multicastplugin.h"
+#include "multicasttransportserver.h"
+#include "sendmulticastaction.h"
+
+void MulticastPlugin::initialize(Application *application)
+{
+    mServer = new MulticastTransportServer(application);
+    mEnumerator = new GroupEnumerator("multicast");
+    mAction = new SendMulticastAction(application, mEnumerator);
+
+    application->transportServerRegistry()->add(mServer);
+    application->deviceModel()->addDeviceEnumerator(mEnumerator);
+    application->actionRegistry()->add(mAction);
+}
+
+void MulticastPlugin::cleanup(Application *application)
+{
+    application->actionRegistry()->remove(mAction);
+    application->deviceModel()->removeDeviceEnumerator(mEnumerator);
+    application->transportServerRegistry()->remove(mServer);
+
+    delete mAction;
+    delete mEnumerator;
+    delete mServer;
+}
@@ -0,0 +1,102 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef MULTICASTPROTOCOL_H
+#define MULTICASTPROTOCOL_H
+
+#include <cstring>
+
+#include <QByteArray>
+#include <QtEndian>
+
+/**
+ * @brief Definitions shared by the sender and receivers of a multicast session
+ *
+ * The sender serializes packets into a stream (using the same framing as the
+ * LAN transport) and splits it into blocks of up to BlockSymbols symbols.
+ * Each block is multicast along with ParitySymbols parity symbols computed by
+ * ErasureCode, allowing receivers to recover from a few lost datagrams per
+ * block without asking for anything. Receivers report blocks they cannot
+ * recover (NACKs) in periodic status datagrams sent to the sender, which
+ * multicasts additional parity symbols for them.
+ *
+ * Every datagram begins with the type and the ID of the session.
+ */
+namespace MulticastProtocol
+{
+    enum Type {
+        /// Sender asks a receiver to join the session (unicast)
+        Invite = 1,
+        /// Receiver accepts an invitation (unicast)
+        Join,
+        /// Symbol of a block (multicast)
+        Data,
+        /// Number of blocks sent so far (multicast)
+        Heartbeat,
+        /// Progress, NACKs and replies from a receiver (unicast)
+        Status,
+        /// Sender is finished with a receiver (unicast)
+        Close
+    };
+
+    const int HeaderSize = 5;
+
+    const int SymbolSize = 1200;
+    const int BlockSymbols = 32;
+    const int BlockSize = SymbolSize * BlockSymbols;
+    const int ParitySymbols = 4;
+
+    // Data datagrams include the block, symbol index, number of data symbols
+    // in the block and the size of the last one
+    const int DataHeaderSize = HeaderSize + 8;
+
+    // Amount of the stream that may be sent beyond what receivers confirmed
+    const qint64 Window = 16 * 1024 * 1024;
+
+    template<typename T>
+    void append(QByteArray &data, T value)
+    {
+        value = qToLittleEndian(value);
+        data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template<typename T>
+    T read(const char *data)
+    {
+        // memcpy must be used in order to avoid alignment issues
+        T value;
+        memcpy(&value, data, sizeof(value));
+        return qFromLittleEndian(value);
+    }
+
+    inline QByteArray createDatagram(Type type, quint32 sessionId)
+    {
+        QByteArray datagram;
+        append<quint8>(datagram, type);
+        append<quint32>(datagram, sessionId);
+        return datagram;
+    }
+}
+
+#endif // MULTICASTPROTOCOL_H
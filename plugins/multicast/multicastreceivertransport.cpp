@@ -0,0 +1,342 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QList>
+#include <QPair>
+#include <QUdpSocket>
+#include <QVector>
+
+#include <nitroshare/packet.h>
+#include <nitroshare/packetstream.h>
+
+#include "erasurecode.h"
+#include "multicastprotocol.h"
+#include "multicastreceivertransport.h"
+
+using namespace MulticastProtocol;
+
+// Intervals (in milliseconds) for checking for lost blocks and for sending
+// status datagrams when nothing else prompts one
+const int TickInterval = 20;
+const qint64 StatusInterval = 100;
+
+// A block is only reported once it had time to arrive and then only as often
+// as repairs can reasonably be expected to arrive (in milliseconds)
+const qint64 NackDelay = 50;
+const qint64 NackInterval = 200;
+const int MaxNacks = 100;
+
+// Times (in milliseconds) after which the sender is assumed to be gone
+const qint64 SenderTimeout = 15000;
+const qint64 CloseTimeout = 10000;
+
+// Blocks beyond the next one expected that are kept, which is a little more
+// than the sender can have in flight
+const quint32 MaxBlocksAhead = Window / BlockSize + 64;
+
+MulticastReceiverTransport::Block::Block()
+    : count(-1),
+      tail(0),
+      decoded(false),
+      firstSeen(0),
+      lastNack(0)
+{
+}
+
+MulticastReceiverTransport::MulticastReceiverTransport(QUdpSocket *socket, const QHostAddress &sender,
+                                                       quint16 senderPort, quint32 sessionId)
+    : mSocket(socket),
+      mSender(sender),
+      mSenderPort(senderPort),
+      mSessionId(sessionId),
+      mLastReceived(0),
+      mLastData(0),
+      mLastStatus(0),
+      mCloseTime(0),
+      mProgressed(false),
+      mClosing(false),
+      mClosed(false),
+      mNextBlock(0),
+      mBlockCount(0),
+      mReplyCount(0)
+{
+    connect(&mTimer, &QTimer::timeout, this, &MulticastReceiverTransport::onTimeout);
+
+    mClock.start();
+    mTimer.start(TickInterval);
+
+    sendJoin();
+}
+
+void MulticastReceiverTransport::sendJoin()
+{
+    mSocket->writeDatagram(createDatagram(Join, mSessionId), mSender, mSenderPort);
+}
+
+void MulticastReceiverTransport::processDatagram(const QByteArray &datagram)
+{
+    if (mClosed) {
+        return;
+    }
+
+    qint64 now = mClock.elapsed();
+    mLastReceived = now;
+
+    switch (datagram.at(0)) {
+    case Data:
+        processData(datagram, now);
+        break;
+    case Heartbeat:
+        if (datagram.size() >= HeaderSize + 4) {
+            updateBlockCount(read<quint32>(datagram.constData() + HeaderSize), now);
+        }
+        break;
+    case Close:
+        // Both ends close the transport once they are finished with it
+        if (mClosing) {
+            shutdown();
+        } else {
+            reportError(tr("sender closed the session"));
+        }
+        break;
+    }
+}
+
+void MulticastReceiverTransport::sendPacket(Packet *packet)
+{
+    if (mClosing || mClosed) {
+        return;
+    }
+
+    // Packets sent by the transfer (success or error) are small and repeated
+    // in every status until the sender closes the session
+    PacketStream::encode(mReplies, packet->type(), packet->content());
+    ++mReplyCount;
+
+    sendStatus();
+}
+
+void MulticastReceiverTransport::close()
+{
+    if (!mClosing && !mClosed) {
+        mClosing = true;
+        mCloseTime = mClock.elapsed();
+        sendStatus();
+    }
+}
+
+void MulticastReceiverTransport::onTimeout()
+{
+    qint64 now = mClock.elapsed();
+
+    if (mClosing && now - mCloseTime >= CloseTimeout) {
+        shutdown();
+        return;
+    }
+
+    if (now - mLastReceived >= SenderTimeout) {
+        if (mClosing) {
+            shutdown();
+        } else {
+            reportError(tr("sender stopped responding"));
+        }
+        return;
+    }
+
+    // Blocks that could not be recovered in time are reported so that the
+    // sender can send more parity symbols for them - if no data arrived for
+    // a while, the sender finished sending and all of them are overdue
+    bool idle = now - mLastData >= NackDelay;
+    QList<QPair<quint32, int>> nacks;
+    for (QMap<quint32, Block>::iterator i = mBlocks.begin();
+            i != mBlocks.end() && nacks.count() < MaxNacks; ++i) {
+        Block &block = i.value();
+        if (block.decoded || now - block.firstSeen < NackDelay ||
+                now - block.lastNack < NackInterval) {
+            continue;
+        }
+        if (i.key() + 1 < mBlockCount || idle) {
+            int missing = block.count < 0 ? 255 : block.count - block.symbols.count();
+            nacks.append(qMakePair(i.key(), missing));
+            block.lastNack = now;
+        }
+    }
+
+    if (!nacks.isEmpty() || mProgressed || now - mLastStatus >= StatusInterval) {
+        sendStatus(nacks);
+    }
+}
+
+void MulticastReceiverTransport::processData(const QByteArray &datagram, qint64 now)
+{
+    if (datagram.size() < DataHeaderSize) {
+        return;
+    }
+
+    const char *data = datagram.constData() + HeaderSize;
+    quint32 number = read<quint32>(data);
+    int symbol = static_cast<quint8>(data[4]);
+    int count = static_cast<quint8>(data[5]);
+    int tail = read<quint16>(data + 6);
+    if (count < 1 || count > BlockSymbols || tail < 1 || tail > SymbolSize) {
+        return;
+    }
+
+    mLastData = now;
+    updateBlockCount(number + 1, now);
+
+    QMap<quint32, Block>::iterator i = mBlocks.find(number);
+    if (i == mBlocks.end() || i->decoded) {
+        return;
+    }
+
+    Block &block = i.value();
+    block.count = count;
+    block.tail = tail;
+    if (!block.symbols.contains(symbol)) {
+        block.symbols.insert(symbol, datagram.mid(DataHeaderSize));
+    }
+
+    if (block.symbols.count() >= block.count && decode(block) && number == mNextBlock) {
+        deliverBlocks();
+    }
+}
+
+void MulticastReceiverTransport::updateBlockCount(quint32 blockCount, qint64 now)
+{
+    // Blocks are tracked as soon as they are known to exist so that they are
+    // reported even if none of their datagrams arrive
+    quint32 first = qMax(mBlockCount, mNextBlock);
+    quint32 last = qMin(blockCount, mNextBlock + MaxBlocksAhead);
+    for (quint32 number = first; number < last; ++number) {
+        mBlocks[number].firstSeen = now;
+    }
+    mBlockCount = qMax(mBlockCount, last);
+}
+
+bool MulticastReceiverTransport::decode(Block &block)
+{
+    QVector<QByteArray> data(block.count);
+    char *dataPointers[BlockSymbols];
+    bool present[BlockSymbols];
+    const char *parityPointers[ErasureCode::MaxSymbols];
+    int indices[ErasureCode::MaxSymbols];
+    int parityCount = 0;
+
+    for (QMap<int, QByteArray>::const_iterator i = block.symbols.constBegin();
+            i != block.symbols.constEnd(); ++i) {
+        if (i.key() >= block.count) {
+            if (i.value().size() == SymbolSize) {
+                parityPointers[parityCount] = i.value().constData();
+                indices[parityCount++] = i.key();
+            }
+        } else {
+            data[i.key()] = i.value();
+        }
+    }
+
+    // Missing symbols are recovered into zeroed buffers and the last symbol
+    // is padded to the full size for decoding
+    for (int i = 0; i < block.count; ++i) {
+        present[i] = !data.at(i).isNull();
+        if (data.at(i).size() < SymbolSize) {
+            data[i].append(QByteArray(SymbolSize - data.at(i).size(), 0));
+        }
+        dataPointers[i] = data[i].data();
+    }
+
+    if (!ErasureCode::decode(dataPointers, present, block.count, SymbolSize,
+            parityPointers, indices, parityCount)) {
+        return false;
+    }
+
+    block.data.reserve((block.count - 1) * SymbolSize + block.tail);
+    for (int i = 0; i < block.count; ++i) {
+        block.data.append(data.at(i).constData(), i == block.count - 1 ? block.tail : SymbolSize);
+    }
+    block.symbols.clear();
+    block.decoded = true;
+
+    return true;
+}
+
+void MulticastReceiverTransport::deliverBlocks()
+{
+    QMap<quint32, Block>::iterator i = mBlocks.begin();
+    while (i != mBlocks.end() && i.key() == mNextBlock && i->decoded) {
+        mStream.addData(i->data);
+        i = mBlocks.erase(i);
+        ++mNextBlock;
+    }
+
+    mProgressed = true;
+    processBuffer();
+}
+
+void MulticastReceiverTransport::processBuffer()
+{
+    char type;
+    QByteArray data;
+    while (!mClosed && mStream.readPacket(&type, &data)) {
+        Packet packet(static_cast<Packet::Type>(type), data);
+        emit packetReceived(&packet);
+    }
+
+    if (!mClosed && mStream.hasError()) {
+        reportError(tr("invalid packet received"));
+    }
+}
+
+void MulticastReceiverTransport::sendStatus(const QList<QPair<quint32, int>> &nacks)
+{
+    QByteArray datagram = createDatagram(Status, mSessionId);
+    append<quint32>(datagram, mNextBlock);
+    append<quint16>(datagram, mReplyCount);
+    append<quint16>(datagram, nacks.count());
+    foreach (const auto &nack, nacks) {
+        append<quint32>(datagram, nack.first);
+        append<quint8>(datagram, nack.second);
+    }
+    datagram.append(mReplies);
+
+    mSocket->writeDatagram(datagram, mSender, mSenderPort);
+
+    mLastStatus = mClock.elapsed();
+    mProgressed = false;
+}
+
+void MulticastReceiverTransport::reportError(const QString &message)
+{
+    shutdown();
+    emit error(message);
+}
+
+void MulticastReceiverTransport::shutdown()
+{
+    mClosed = true;
+    mTimer.stop();
+
+    mBlocks.clear();
+    mStream.clear();
+}
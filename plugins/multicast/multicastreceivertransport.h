@@ -0,0 +1,133 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef MULTICASTRECEIVERTRANSPORT_H
+#define MULTICASTRECEIVERTRANSPORT_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QList>
+#include <QMap>
+#include <QPair>
+#include <QTimer>
+
+#include <nitroshare/packetstream.h>
+#include <nitroshare/transport.h>
+
+class Packet;
+class QUdpSocket;
+
+/**
+ * @brief Transport for receiving items sent to a multicast session
+ *
+ * Blocks are recovered from the symbols received (using parity symbols in
+ * place of lost ones) and the stream is passed on in order. Progress, blocks
+ * that could not be recovered and packets sent by the transfer are reported
+ * to the sender in periodic status datagrams.
+ */
+class MulticastReceiverTransport : public Transport
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Create a transport for a session
+     * @param socket socket used for sending datagrams to the sender
+     * @param sender address of the sender
+     * @param senderPort port of the sender
+     * @param sessionId ID of the session
+     */
+    MulticastReceiverTransport(QUdpSocket *socket, const QHostAddress &sender,
+                               quint16 senderPort, quint32 sessionId);
+
+    /**
+     * @brief Accept the invitation to the session
+     */
+    void sendJoin();
+
+    /**
+     * @brief Process a datagram for the session
+     */
+    void processDatagram(const QByteArray &datagram);
+
+    virtual void sendPacket(Packet *packet);
+    virtual void close();
+
+private slots:
+
+    void onTimeout();
+
+private:
+
+    struct Block
+    {
+        Block();
+
+        int count;
+        int tail;
+        QMap<int, QByteArray> symbols;
+        QByteArray data;
+        bool decoded;
+        qint64 firstSeen;
+        qint64 lastNack;
+    };
+
+    void processData(const QByteArray &datagram, qint64 now);
+    void updateBlockCount(quint32 blockCount, qint64 now);
+    bool decode(Block &block);
+    void deliverBlocks();
+    void processBuffer();
+    void sendStatus(const QList<QPair<quint32, int>> &nacks = QList<QPair<quint32, int>>());
+
+    void reportError(const QString &message);
+    void shutdown();
+
+    QUdpSocket *mSocket;
+    QHostAddress mSender;
+    quint16 mSenderPort;
+    quint32 mSessionId;
+
+    QElapsedTimer mClock;
+    QTimer mTimer;
+    qint64 mLastReceived;
+    qint64 mLastData;
+    qint64 mLastStatus;
+    qint64 mCloseTime;
+    bool mProgressed;
+    bool mClosing;
+    bool mClosed;
+
+    QMap<quint32, Block> mBlocks;
+    quint32 mNextBlock;
+    quint32 mBlockCount;
+
+    PacketStream mStream;
+
+    QByteArray mReplies;
+    int mReplyCount;
+};
+
+#endif // MULTICASTRECEIVERTRANSPORT_H
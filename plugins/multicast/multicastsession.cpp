@@ -0,0 +1,445 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <random>
+
+#include <nitroshare/packet.h>
+
+#include "erasurecode.h"
+#include "multicastprotocol.h"
+#include "multicastsession.h"
+
+using namespace MulticastProtocol;
+
+// Interval for sending datagrams and for control tasks (in milliseconds)
+const int TickInterval = 1;
+const int ControlInterval = 100;
+
+// Times (in milliseconds) for inviting receivers and giving up on them
+const qint64 InviteInterval = 500;
+const int JoinTimeout = 5000;
+const qint64 ReceiverTimeout = 15000;
+
+// NACKs for a block that was just repaired are ignored for this long (in
+// milliseconds) since they were likely sent before the repair arrived
+const qint64 RepairInterval = 100;
+
+// A partial block is sent once no more data was added for this long (in
+// milliseconds)
+const qint64 FlushDelay = 5;
+
+// Largest burst of datagrams sent at once (in microseconds at the rate)
+const qint64 MaxBurst = 2000;
+
+// Datagrams waiting to be sent before transfers are paused
+const qint64 QueueLimit = 2 * 1024 * 1024;
+
+const int SocketBufferSize = 4 * 1024 * 1024;
+
+MulticastSession::MulticastSession(const QHostAddress &group, quint16 port,
+                                   const QNetworkInterface &interface, qint64 rate)
+    : GroupSession(Window, JoinTimeout),
+      mGroup(group),
+      mPort(port),
+      mRate(rate),
+      mId(std::random_device()()),
+      mLastInvite(0),
+      mFlushTime(0),
+      mBlockCount(0),
+      mQueueBytes(0),
+      mBudget(0),
+      mLastPaced(0)
+{
+    connect(&mSocket, &QUdpSocket::readyRead, this, &MulticastSession::onReadyRead);
+    connect(&mTimer, &QTimer::timeout, this, &MulticastSession::onTimeout);
+    connect(&mControlTimer, &QTimer::timeout, this, &MulticastSession::onControlTimeout);
+
+    // Datagrams are sent from an ephemeral port, which is also where the
+    // receivers send their replies
+    mSocket.bind(QHostAddress::AnyIPv4);
+    mSocket.setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, SocketBufferSize);
+    mSocket.setSocketOption(QAbstractSocket::MulticastTtlOption, 1);
+    if (interface.isValid()) {
+        mSocket.setMulticastInterface(interface);
+    }
+
+    mTimer.setTimerType(Qt::PreciseTimer);
+    mTimer.setInterval(TickInterval);
+    mControlTimer.setInterval(ControlInterval);
+
+    mClock.start();
+}
+
+quint32 MulticastSession::id() const
+{
+    return mId;
+}
+
+int MulticastSession::addReceiver(const QHostAddress &address)
+{
+    Receiver receiver;
+    receiver.address = address;
+    receiver.finished = false;
+    receiver.nextBlock = 0;
+    receiver.acknowledged = 0;
+    receiver.replies = 0;
+    receiver.lastStatus = 0;
+    mReceivers.append(receiver);
+    return registerReceiver();
+}
+
+QString MulticastSession::sessionId() const
+{
+    return QString::number(mId);
+}
+
+QString MulticastSession::transportName() const
+{
+    return "multicast";
+}
+
+void MulticastSession::invite()
+{
+    mControlTimer.start();
+    onControlTimeout();
+}
+
+void MulticastSession::finishReceiver(int receiver)
+{
+    Receiver &r = mReceivers[receiver];
+    if (r.finished) {
+        return;
+    }
+    r.finished = true;
+
+    sendControl(Close, receiver);
+
+    // The receiver no longer holds back the others
+    trim();
+    emit progress();
+}
+
+void MulticastSession::onReadyRead()
+{
+    while (mSocket.hasPendingDatagrams()) {
+        QByteArray datagram(qMax<qint64>(mSocket.pendingDatagramSize(), 0), 0);
+        QHostAddress address;
+        qint64 size = mSocket.readDatagram(datagram.data(), datagram.size(), &address);
+        if (size < HeaderSize || read<quint32>(datagram.constData() + 1) != mId) {
+            continue;
+        }
+        datagram.resize(size);
+
+        int receiver = -1;
+        for (int i = 0; i < mReceivers.count(); ++i) {
+            if (mReceivers.at(i).address.toIPv4Address() == address.toIPv4Address()) {
+                receiver = i;
+                break;
+            }
+        }
+        if (receiver == -1) {
+            continue;
+        }
+
+        Receiver &r = mReceivers[receiver];
+        r.lastStatus = mClock.elapsed();
+
+        switch (datagram.at(0)) {
+        case Join:
+            setJoined(receiver);
+            break;
+        case Status:
+            processStatus(receiver, datagram);
+            break;
+        }
+    }
+}
+
+void MulticastSession::onTimeout()
+{
+    qint64 now = mClock.nsecsElapsed() / 1000;
+    bool wasFull = mQueueBytes >= QueueLimit;
+
+    // Send partial blocks once no more data is being added
+    if (mPending.size() && mClock.elapsed() >= mFlushTime) {
+        cutBlock(mPending.size());
+    }
+
+    double burst = qMax<double>(2 * SymbolSize, mRate * MaxBurst / 1000000.0);
+    mBudget = qMin(burst, mBudget + mRate * (now - mLastPaced) / 1000000.0);
+    mLastPaced = now;
+
+    while (mBudget > 0 && !mQueue.empty()) {
+        const QByteArray &datagram = mQueue.front();
+        mSocket.writeDatagram(datagram, mGroup, mPort);
+        mBudget -= datagram.size();
+        mQueueBytes -= datagram.size();
+        mQueue.pop_front();
+    }
+
+    if (mQueue.empty() && mPending.isEmpty()) {
+        mTimer.stop();
+    }
+
+    if (wasFull && mQueueBytes < QueueLimit) {
+        emit progress();
+    }
+}
+
+void MulticastSession::onControlTimeout()
+{
+    qint64 now = mClock.elapsed();
+
+    // Keep inviting receivers that have not joined
+    if (!isConnected() && now - mLastInvite >= InviteInterval) {
+        QByteArray payload;
+        append<quint32>(payload, mGroup.toIPv4Address());
+        for (int i = 0; i < mReceivers.count(); ++i) {
+            if (!isReceiverJoined(i)) {
+                sendControl(Invite, i, payload);
+            }
+        }
+        mLastInvite = now;
+    }
+
+    // Let receivers know how many blocks were sent so that they notice if the
+    // last ones were lost (this also shows them that the sender is alive)
+    if (isConnected()) {
+        QByteArray datagram = createDatagram(Heartbeat, mId);
+        append<quint32>(datagram, mBlockCount);
+        mSocket.writeDatagram(datagram, mGroup, mPort);
+    }
+
+    // Give up on receivers that stopped responding
+    for (int i = 0; i < mReceivers.count(); ++i) {
+        Receiver &r = mReceivers[i];
+        if (isReceiverJoined(i) && !r.finished && now - r.lastStatus >= ReceiverTimeout) {
+            failReceiver(i, tr("receiver stopped responding"));
+        }
+    }
+}
+
+bool MulticastSession::isBacklogged() const
+{
+    return mQueueBytes >= QueueLimit;
+}
+
+void MulticastSession::processPending()
+{
+    while (mPending.size() >= BlockSize) {
+        cutBlock(BlockSize);
+    }
+    if (mPending.size()) {
+        mFlushTime = mClock.elapsed() + FlushDelay;
+    }
+
+    schedule();
+}
+
+void MulticastSession::schedule()
+{
+    if (!mTimer.isActive()) {
+        mLastPaced = mClock.nsecsElapsed() / 1000;
+        mTimer.start();
+    }
+}
+
+void MulticastSession::cutBlock(int length)
+{
+    Block block;
+    block.count = (length + SymbolSize - 1) / SymbolSize;
+    block.tail = length - (block.count - 1) * SymbolSize;
+    block.nextParity = block.count;
+    block.lastRepair = 0;
+    block.lastRepairCount = 0;
+
+    // The last symbol is padded since parity symbols are computed using
+    // symbols of equal size
+    block.data = mPending.left(length);
+    block.data.append(QByteArray(block.count * SymbolSize - length, 0));
+    mPending.remove(0, length);
+
+    quint32 number = mBlockCount++;
+    mBlockEnds.append((mBlockEnds.isEmpty() ? 0 : mBlockEnds.last()) + length);
+
+    for (int i = 0; i < block.count + ParitySymbols; ++i) {
+        queue(createSymbol(number, block, i));
+    }
+    block.nextParity += ParitySymbols;
+
+    mBlocks.insert(number, block);
+}
+
+QByteArray MulticastSession::createSymbol(quint32 number, const Block &block, int symbol) const
+{
+    QByteArray datagram = createDatagram(Data, mId);
+    datagram.reserve(DataHeaderSize + SymbolSize);
+    append<quint32>(datagram, number);
+    append<quint8>(datagram, symbol);
+    append<quint8>(datagram, block.count);
+    append<quint16>(datagram, block.tail);
+
+    if (symbol < block.count) {
+        datagram.append(
+            block.data.constData() + symbol * SymbolSize,
+            symbol == block.count - 1 ? block.tail : SymbolSize
+        );
+    } else {
+        const char *data[BlockSymbols];
+        for (int i = 0; i < block.count; ++i) {
+            data[i] = block.data.constData() + i * SymbolSize;
+        }
+        datagram.resize(DataHeaderSize + SymbolSize);
+        ErasureCode::encode(data, block.count, SymbolSize, symbol, datagram.data() + DataHeaderSize);
+    }
+
+    return datagram;
+}
+
+void MulticastSession::queue(const QByteArray &datagram, bool urgent)
+{
+    if (urgent) {
+        mQueue.push_front(datagram);
+    } else {
+        mQueue.push_back(datagram);
+    }
+    mQueueBytes += datagram.size();
+    schedule();
+}
+
+void MulticastSession::sendControl(int type, int receiver, const QByteArray &payload)
+{
+    QByteArray datagram = createDatagram(static_cast<Type>(type), mId);
+    datagram.append(payload);
+    mSocket.writeDatagram(datagram, mReceivers.at(receiver).address, mPort);
+}
+
+void MulticastSession::processStatus(int receiver, const QByteArray &datagram)
+{
+    // A receiver that was finished missed the datagram closing it
+    if (mReceivers.at(receiver).finished) {
+        sendControl(Close, receiver);
+        return;
+    }
+
+    if (datagram.size() < HeaderSize + 8) {
+        return;
+    }
+    const char *data = datagram.constData() + HeaderSize;
+    const char *end = datagram.constData() + datagram.size();
+    quint32 nextBlock = read<quint32>(data);
+    int replyCount = read<quint16>(data + 4);
+    int nackCount = read<quint16>(data + 6);
+    data += 8;
+    if (end - data < nackCount * 5) {
+        return;
+    }
+
+    // Send more parity symbols for blocks the receiver could not recover
+    for (int i = 0; i < nackCount; ++i, data += 5) {
+        repair(read<quint32>(data), static_cast<quint8>(data[4]));
+    }
+
+    Receiver &r = mReceivers[receiver];
+    if (nextBlock > r.nextBlock && nextBlock <= mBlockCount) {
+        r.nextBlock = nextBlock;
+        r.acknowledged = mBlockEnds.at(nextBlock - 1);
+        trim();
+        emit progress();
+    }
+
+    // Replies are repeated in each status until the receiver is closed, so
+    // only new ones are processed
+    PacketStream replies;
+    replies.addData(QByteArray(data, end - data));
+    char type;
+    QByteArray content;
+    for (int i = 0; i < replyCount && replies.readPacket(&type, &content); ++i) {
+        if (i >= mReceivers.at(receiver).replies) {
+            mReceivers[receiver].replies = i + 1;
+            Packet packet(static_cast<Packet::Type>(type), content);
+            processReply(receiver, &packet);
+        }
+    }
+}
+
+void MulticastSession::repair(quint32 number, int missing)
+{
+    QMap<quint32, Block>::iterator i = mBlocks.find(number);
+    if (i == mBlocks.end()) {
+        return;
+    }
+    Block &block = i.value();
+
+    // Receivers that saw nothing at all of a block need as many symbols as
+    // there are data symbols
+    missing = qMin(missing, block.count);
+
+    // Several receivers often lose the same datagrams, so the symbols sent
+    // for one of them are likely enough for the others as well
+    qint64 now = mClock.elapsed();
+    if (now - block.lastRepair < RepairInterval && missing <= block.lastRepairCount) {
+        return;
+    }
+    block.lastRepair = now;
+    block.lastRepairCount = missing;
+
+    for (int j = 0; j < missing; ++j) {
+
+        // Once all parity symbols were used, start over with the data
+        if (block.nextParity >= ErasureCode::MaxSymbols) {
+            block.nextParity = 0;
+        }
+        queue(createSymbol(number, block, block.nextParity++), true);
+    }
+}
+
+void MulticastSession::trim()
+{
+    // Blocks are kept until every receiver recovered them
+    quint32 minimum = mBlockCount;
+    for (int i = 0; i < mReceivers.count(); ++i) {
+        const Receiver &r = mReceivers.at(i);
+        if (isReceiverJoined(i) && !r.finished && r.nextBlock < minimum) {
+            minimum = r.nextBlock;
+        }
+    }
+
+    QMap<quint32, Block>::iterator i = mBlocks.begin();
+    while (i != mBlocks.end() && i.key() < minimum) {
+        i = mBlocks.erase(i);
+    }
+}
+
+qint64 MulticastSession::minimumDelivered() const
+{
+    qint64 minimum = streamEnd();
+    for (int i = 0; i < mReceivers.count(); ++i) {
+        const Receiver &r = mReceivers.at(i);
+        if (isReceiverJoined(i) && !r.finished && r.acknowledged < minimum) {
+            minimum = r.acknowledged;
+        }
+    }
+    return minimum;
+}
@@ -0,0 +1,149 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef MULTICASTSESSION_H
+#define MULTICASTSESSION_H
+
+#include <deque>
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QMap>
+#include <QNetworkInterface>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QVector>
+
+#include "groupsession.h"
+
+/**
+ * @brief Sender side of a multicast session
+ *
+ * A session sends the same items to a group of receivers on one subnet. Each
+ * part of the stream is only multicast once, no matter how many receivers
+ * there are.
+ */
+class MulticastSession : public GroupSession
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Create a session
+     * @param group multicast group to send to
+     * @param port port the receivers listen on
+     * @param interface network interface for the subnet of the receivers
+     * @param rate rate at which datagrams are sent in bytes per second
+     */
+    MulticastSession(const QHostAddress &group, quint16 port,
+                     const QNetworkInterface &interface, qint64 rate);
+
+    /**
+     * @brief Retrieve the random ID of the session
+     */
+    quint32 id() const;
+
+    /**
+     * @brief Add a receiver to the session
+     * @return index of the receiver
+     */
+    int addReceiver(const QHostAddress &address);
+
+    virtual QString sessionId() const;
+    virtual QString transportName() const;
+
+protected:
+
+    virtual void invite();
+    virtual qint64 minimumDelivered() const;
+    virtual bool isBacklogged() const;
+    virtual void processPending();
+    virtual void finishReceiver(int receiver);
+
+private slots:
+
+    void onReadyRead();
+    void onTimeout();
+    void onControlTimeout();
+
+private:
+
+    struct Receiver
+    {
+        QHostAddress address;
+        bool finished;
+        quint32 nextBlock;
+        qint64 acknowledged;
+        int replies;
+        qint64 lastStatus;
+    };
+
+    struct Block
+    {
+        QByteArray data;
+        int count;
+        int tail;
+        int nextParity;
+        qint64 lastRepair;
+        int lastRepairCount;
+    };
+
+    void schedule();
+    void cutBlock(int length);
+    QByteArray createSymbol(quint32 number, const Block &block, int symbol) const;
+    void queue(const QByteArray &datagram, bool urgent = false);
+    void sendControl(int type, int receiver, const QByteArray &payload = QByteArray());
+
+    void processStatus(int receiver, const QByteArray &datagram);
+    void repair(quint32 number, int missing);
+    void trim();
+
+    QHostAddress mGroup;
+    quint16 mPort;
+    qint64 mRate;
+    quint32 mId;
+
+    QUdpSocket mSocket;
+    QElapsedTimer mClock;
+    QTimer mTimer;
+    QTimer mControlTimer;
+
+    QVector<Receiver> mReceivers;
+    qint64 mLastInvite;
+
+    qint64 mFlushTime;
+
+    QMap<quint32, Block> mBlocks;
+    QVector<qint64> mBlockEnds;
+    quint32 mBlockCount;
+
+    std::deque<QByteArray> mQueue;
+    qint64 mQueueBytes;
+    double mBudget;
+    qint64 mLastPaced;
+};
+
+#endif // MULTICASTSESSION_H
@@ -0,0 +1,262 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QNetworkAddressEntry>
+#include <QNetworkInterface>
+
+#include <nitroshare/application.h>
+#include <nitroshare/category.h>
+#include <nitroshare/logger.h>
+#include <nitroshare/message.h>
+#include <nitroshare/settingsregistry.h>
+
+#include "groupdevice.h"
+#include "groupsession.h"
+#include "multicastprotocol.h"
+#include "multicastreceivertransport.h"
+#include "multicasttransportserver.h"
+
+using namespace MulticastProtocol;
+
+const QString MessageTag = "multicasttransportserver";
+
+const QString MulticastCategory = "multicast";
+const QString MulticastPort = "MulticastPort";
+const QString MulticastGroup = "MulticastGroup";
+const QString MulticastRate = "MulticastRate";
+
+const int SocketBufferSize = 8 * 1024 * 1024;
+
+MulticastTransportServer::MulticastTransportServer(Application *application)
+    : mApplication(application)
+    , mMulticastCategory({
+          { Category::NameKey, MulticastCategory },
+          { Category::TitleKey, tr("Multicast") }
+      })
+    , mMulticastPort({
+          { Setting::TypeKey, Setting::Integer },
+          { Setting::NameKey, MulticastPort },
+          { Setting::TitleKey, tr("Multicast Port") },
+          { Setting::CategoryKey, MulticastCategory },
+          { Setting::DefaultValueKey, 40820 }
+      })
+    , mMulticastGroup({
+          { Setting::TypeKey, Setting::String },
+          { Setting::NameKey, MulticastGroup },
+          { Setting::TitleKey, tr("Multicast Group") },
+          { Setting::CategoryKey, MulticastCategory },
+          { Setting::DefaultValueKey, "239.255.78.83" }
+      })
+    , mMulticastRate({
+          { Setting::TypeKey, Setting::Integer },
+          { Setting::NameKey, MulticastRate },
+          { Setting::TitleKey, tr("Multicast Rate (Mbit/s)") },
+          { Setting::CategoryKey, MulticastCategory },
+          { Setting::DefaultValueKey, 100 }
+      })
+{
+    connect(&mSocket, &QUdpSocket::readyRead, this, &MulticastTransportServer::onReadyRead);
+    connect(mApplication->settingsRegistry(), &SettingsRegistry::settingsChanged, this, &MulticastTransportServer::onSettingsChanged);
+
+    mApplication->settingsRegistry()->addCategory(&mMulticastCategory);
+    mApplication->settingsRegistry()->addSetting(&mMulticastPort);
+    mApplication->settingsRegistry()->addSetting(&mMulticastGroup);
+    mApplication->settingsRegistry()->addSetting(&mMulticastRate);
+
+    // Trigger loading the initial settings
+    onSettingsChanged({ MulticastPort });
+}
+
+MulticastTransportServer::~MulticastTransportServer()
+{
+    mApplication->settingsRegistry()->removeSetting(&mMulticastPort);
+    mApplication->settingsRegistry()->removeSetting(&mMulticastGroup);
+    mApplication->settingsRegistry()->removeSetting(&mMulticastRate);
+    mApplication->settingsRegistry()->removeCategory(&mMulticastCategory);
+}
+
+QString MulticastTransportServer::name() const
+{
+    return "multicast";
+}
+
+Transport *MulticastTransportServer::createTransport(Device *device)
+{
+    GroupDevice *groupDevice = qobject_cast<GroupDevice*>(device);
+    if (!groupDevice || groupDevice->transportName() != name()) {
+        mApplication->logger()->log(new Message(
+            Message::Error,
+            MessageTag,
+            QString("%1 is not part of a multicast session").arg(device->uuid())
+        ));
+        return nullptr;
+    }
+
+    return groupDevice->session()->createTransport(groupDevice);
+}
+
+void MulticastTransportServer::onReadyRead()
+{
+    while (mSocket.hasPendingDatagrams()) {
+        QByteArray datagram(qMax<qint64>(mSocket.pendingDatagramSize(), 0), 0);
+        QHostAddress address;
+        quint16 port;
+        qint64 size = mSocket.readDatagram(datagram.data(), datagram.size(), &address, &port);
+        if (size < HeaderSize) {
+            continue;
+        }
+        datagram.resize(size);
+
+        if (datagram.at(0) == Invite) {
+            processInvite(datagram, address, port);
+            continue;
+        }
+
+        // Everything else is for the transport of the session
+        MulticastReceiverTransport *transport = mTransports.value(
+            read<quint32>(datagram.constData() + 1));
+        if (transport) {
+            transport->processDatagram(datagram);
+        }
+    }
+}
+
+void MulticastTransportServer::onSettingsChanged(const QStringList &keys)
+{
+    if (keys.contains(MulticastPort)) {
+
+        // Groups are joined again when the senders repeat their invitations
+        mSocket.close();
+        mMemberships.clear();
+        if (!mSocket.bind(QHostAddress::AnyIPv4,
+                mApplication->settingsRegistry()->value(MulticastPort).toInt(),
+                QUdpSocket::ShareAddress | QUdpSocket::ReuseAddressHint)) {
+            mApplication->logger()->log(new Message(
+                Message::Error,
+                MessageTag,
+                mSocket.errorString()
+            ));
+            return;
+        }
+        mSocket.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, SocketBufferSize);
+    }
+}
+
+void MulticastTransportServer::processInvite(const QByteArray &datagram, const QHostAddress &address, quint16 port)
+{
+    quint32 sessionId = read<quint32>(datagram.constData() + 1);
+
+    // The sender repeats the invitation until it receives the reply
+    MulticastReceiverTransport *transport = mTransports.value(sessionId);
+    if (transport) {
+        transport->sendJoin();
+        return;
+    }
+
+    if (datagram.size() < HeaderSize + 4) {
+        return;
+    }
+    QHostAddress group(read<quint32>(datagram.constData() + HeaderSize));
+    if (!group.isMulticast()) {
+        return;
+    }
+
+    QString membership = joinGroup(group, address);
+    if (membership.isNull()) {
+        return;
+    }
+
+    mApplication->logger()->log(new Message(
+        Message::Info,
+        MessageTag,
+        QString("joining session %1 from %2 on %3")
+            .arg(sessionId)
+            .arg(address.toString())
+            .arg(group.toString())
+    ));
+
+    transport = new MulticastReceiverTransport(&mSocket, address, port, sessionId);
+    mTransports.insert(sessionId, transport);
+    connect(transport, &QObject::destroyed, this, [this, sessionId, membership]() {
+        mTransports.remove(sessionId);
+        leaveGroup(membership);
+    });
+
+    emit transportReceived(transport);
+}
+
+QString MulticastTransportServer::joinGroup(const QHostAddress &group, const QHostAddress &sender)
+{
+    // Join the group on the interface for the subnet of the sender
+    QHostAddress ipv4Sender(sender.toIPv4Address());
+    QNetworkInterface senderInterface;
+    foreach (QNetworkInterface interface, QNetworkInterface::allInterfaces()) {
+        foreach (QNetworkAddressEntry entry, interface.addressEntries()) {
+            if (ipv4Sender.isInSubnet(entry.ip(), entry.prefixLength())) {
+                senderInterface = interface;
+                break;
+            }
+        }
+        if (senderInterface.isValid()) {
+            break;
+        }
+    }
+
+    // Groups are only joined once for each interface
+    QString membership = QString("%1/%2").arg(group.toString()).arg(senderInterface.name());
+    if (!mMemberships.value(membership)) {
+        bool joined = senderInterface.isValid() ?
+            mSocket.joinMulticastGroup(group, senderInterface) :
+            mSocket.joinMulticastGroup(group);
+        if (!joined) {
+            mApplication->logger()->log(new Message(
+                Message::Error,
+                MessageTag,
+                QString("unable to join %1: %2").arg(group.toString()).arg(mSocket.errorString())
+            ));
+            return QString();
+        }
+    }
+    ++mMemberships[membership];
+
+    return membership;
+}
+
+void MulticastTransportServer::leaveGroup(const QString &membership)
+{
+    QMap<QString, int>::iterator i = mMemberships.find(membership);
+    if (i == mMemberships.end() || --i.value()) {
+        return;
+    }
+    mMemberships.erase(i);
+
+    QStringList parts = membership.split('/');
+    QHostAddress group(parts.at(0));
+    QNetworkInterface interface = QNetworkInterface::interfaceFromName(parts.at(1));
+    if (interface.isValid()) {
+        mSocket.leaveMulticastGroup(group, interface);
+    } else {
+        mSocket.leaveMulticastGroup(group);
+    }
+}
@@ -0,0 +1,83 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef MULTICASTTRANSPORTSERVER_H
+#define MULTICASTTRANSPORTSERVER_H
+
+#include <QHash>
+#include <QHostAddress>
+#include <QMap>
+#include <QStringList>
+#include <QUdpSocket>
+
+#include <nitroshare/category.h>
+#include <nitroshare/setting.h>
+#include <nitroshare/transportserver.h>
+
+class Application;
+class MulticastReceiverTransport;
+
+/**
+ * @brief Transport server for multicast sessions
+ *
+ * Transports for sending are created by the session the device belongs to.
+ * Invitations to sessions arrive on the control socket, which also receives
+ * the datagrams sent to the groups joined for the sessions.
+ */
+class MulticastTransportServer : public TransportServer
+{
+    Q_OBJECT
+
+public:
+
+    explicit MulticastTransportServer(Application *application);
+    virtual ~MulticastTransportServer();
+
+    virtual QString name() const;
+    virtual Transport *createTransport(Device *device);
+
+private slots:
+
+    void onReadyRead();
+    void onSettingsChanged(const QStringList &keys);
+
+private:
+
+    void processInvite(const QByteArray &datagram, const QHostAddress &address, quint16 port);
+    QString joinGroup(const QHostAddress &group, const QHostAddress &sender);
+    void leaveGroup(const QString &membership);
+
+    Application *mApplication;
+
+    QUdpSocket mSocket;
+    QHash<quint32, MulticastReceiverTransport*> mTransports;
+    QMap<QString, int> mMemberships;
+
+    Category mMulticastCategory;
+    Setting mMulticastPort;
+    Setting mMulticastGroup;
+    Setting mMulticastRate;
+};
+
+#endif // MULTICASTTRANSPORTSERVER_H
@@ -0,0 +1,142 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QHostAddress>
+#include <QList>
+#include <QMap>
+#include <QNetworkInterface>
+
+#include <nitroshare/application.h>
+#include <nitroshare/device.h>
+#include <nitroshare/devicemodel.h>
+#include <nitroshare/logger.h>
+#include <nitroshare/message.h>
+#include <nitroshare/settingsregistry.h>
+
+#include "multicastsession.h"
+#include "sendmulticastaction.h"
+
+const QString MessageTag = "sendmulticast";
+
+const QString MulticastPort = "MulticastPort";
+const QString MulticastGroup = "MulticastGroup";
+const QString MulticastRate = "MulticastRate";
+
+SendMulticastAction::SendMulticastAction(Application *application, GroupEnumerator *enumerator)
+    : mApplication(application),
+      mEnumerator(enumerator)
+{
+}
+
+QString SendMulticastAction::name() const
+{
+    return "sendmulticast";
+}
+
+bool SendMulticastAction::api() const
+{
+    return true;
+}
+
+QString SendMulticastAction::title() const
+{
+    return tr("send items to devices using multicast");
+}
+
+QString SendMulticastAction::description() const
+{
+    return tr(
+        "Send a list of files or directories to many devices at once, "
+        "transmitting the data only once for each subnet. This action "
+        "expects one parameter:\n"
+        "\n"
+        "- \"items\" (array of strings) absolute paths for the items to send\n"
+        "\n"
+        "The optional \"devices\" (array of strings) parameter lists the UUIDs "
+        "of the devices to send to; by default, the items are sent to every "
+        "device discovered by broadcast that can receive them. The optional "
+        "\"streaming\" (boolean) parameter has the same meaning as for the "
+        "\"senditems\" action.\n"
+        "\n"
+        "A single transfer is created for each subnet, which reads the items "
+        "only once. Each device is also shown as a transfer of its own, which "
+        "succeeds or fails with that device. The return value will be the "
+        "number of transfers created for the subnets."
+    );
+}
+
+QVariant SendMulticastAction::invoke(const QVariantMap &params)
+{
+    QStringList uuids = params.value("devices").toStringList();
+
+    // Group the devices that can receive multicast sessions by subnet
+    QMap<QString, QList<Device*>> subnets;
+    DeviceModel *model = mApplication->deviceModel();
+    for (int i = 0; i < model->rowCount(); ++i) {
+        Device *device = model->data(model->index(i, 0), Qt::UserRole).value<Device*>();
+        if (!device->property("multicastPort").toInt() ||
+                device->property("subnet").toString().isEmpty() ||
+                device->property("addresses").toStringList().isEmpty()) {
+            continue;
+        }
+        if (!uuids.isEmpty() && !uuids.contains(device->uuid())) {
+            continue;
+        }
+        subnets[device->property("subnet").toString()].append(device);
+    }
+
+    QHostAddress group(mApplication->settingsRegistry()->value(MulticastGroup).toString());
+    qint64 rate = mApplication->settingsRegistry()->value(MulticastRate).toLongLong() * 125000;
+    if (!group.isMulticast() || rate <= 0) {
+        mApplication->logger()->log(new Message(
+            Message::Error,
+            MessageTag,
+            QString("invalid multicast group or rate")
+        ));
+        return 0;
+    }
+
+    int transfers = 0;
+    for (auto i = subnets.constBegin(); i != subnets.constEnd(); ++i) {
+
+        // Sessions send to the port of the first receiver since all of them
+        // normally use the default port
+        Device *first = i.value().first();
+        MulticastSession *session = new MulticastSession(
+            group,
+            first->property("multicastPort").toInt(),
+            QNetworkInterface::interfaceFromName(first->property("interfaceName").toString()),
+            rate
+        );
+        foreach (Device *device, i.value()) {
+            session->addReceiver(QHostAddress(device->property("addresses").toStringList().first()));
+        }
+
+        if (session->start(mApplication, mEnumerator, i.value(), params)) {
+            ++transfers;
+        }
+    }
+
+    return transfers;
+}
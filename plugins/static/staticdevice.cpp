@@ -24,17 +24,32 @@
 
 #include "staticdevice.h"
 
+const QString UdpScheme = "udp://";
+
 StaticDevice::StaticDevice(const QString &address)
+    : mTransportName("lan")
 {
-    int index = address.indexOf(':');
+    // Addresses prefixed with "udp://" use the UDP transport instead
+    QString hostAndPort = address;
+    quint16 defaultPort = 40818;
+    if (address.startsWith(UdpScheme)) {
+        hostAndPort = address.mid(UdpScheme.length());
+        mTransportName = "udp";
+        defaultPort = 40819;
+    }
+
+    int index = hostAndPort.indexOf(':');
     if (index == -1) {
-        mAddress = address;
-        mPort = 40818;
+        mAddress = hostAndPort;
+        mPort = defaultPort;
     } else {
-        mAddress = address.left(index);
-        mPort = address.mid(index + 1).toInt();
+        mAddress = hostAndPort.left(index);
+        mPort = hostAndPort.mid(index + 1).toInt();
     }
-    mName = QString("%1:%2").arg(mAddress).arg(mPort);
+    mName = QString("%1%2:%3")
+        .arg(mTransportName == "udp" ? UdpScheme : QString())
+        .arg(mAddress)
+        .arg(mPort);
 }
 
 QString StaticDevice::uuid() const
@@ -49,7 +64,7 @@ QString StaticDevice::name() const
 
 QString StaticDevice::transportName() const
 {
-    return "lan";
+    return mTransportName;
 }
 
 QStringList StaticDevice::addresses() const
@@ -27,6 +27,12 @@
 
 #include <nitroshare/device.h>
 
+/**
+ * @brief Device at an address entered by the user
+ *
+ * The address is in the form "host[:port]" for the LAN transport or
+ * "udp://host[:port]" for the UDP transport.
+ */
 class StaticDevice : public Device
 {
     Q_OBJECT
@@ -47,6 +53,7 @@ public:
 private:
 
     QString mName;
+    QString mTransportName;
 
     QString mAddress;
     quint16 mPort;
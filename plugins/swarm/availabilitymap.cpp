@@ -0,0 +1,118 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <climits>
+
+#include "availabilitymap.h"
+
+void AvailabilityMap::addChunks(const QString &uuid, const QBitArray &chunks)
+{
+    resize(chunks.size());
+    QBitArray &peer = mPeers[uuid];
+    if (peer.size() < chunks.size()) {
+        peer.resize(chunks.size());
+    }
+    for (int i = 0; i < chunks.size(); ++i) {
+        if (chunks.testBit(i) && !peer.testBit(i)) {
+            peer.setBit(i);
+            ++mCounts[i];
+        }
+    }
+}
+
+void AvailabilityMap::addChunk(const QString &uuid, int index)
+{
+    resize(index + 1);
+    QBitArray &peer = mPeers[uuid];
+    if (peer.size() <= index) {
+        peer.resize(index + 1);
+    }
+    if (!peer.testBit(index)) {
+        peer.setBit(index);
+        ++mCounts[index];
+    }
+}
+
+void AvailabilityMap::removeChunk(const QString &uuid, int index)
+{
+    QHash<QString, QBitArray>::iterator i = mPeers.find(uuid);
+    if (i != mPeers.end() && index < i->size() && i->testBit(index)) {
+        i->clearBit(index);
+        --mCounts[index];
+    }
+}
+
+void AvailabilityMap::removePeer(const QString &uuid)
+{
+    QBitArray peer = mPeers.take(uuid);
+    for (int i = 0; i < peer.size(); ++i) {
+        if (peer.testBit(i)) {
+            --mCounts[i];
+        }
+    }
+}
+
+QBitArray AvailabilityMap::chunks(const QString &uuid) const
+{
+    return mPeers.value(uuid);
+}
+
+int AvailabilityMap::count(int index) const
+{
+    return index < mCounts.size() ? mCounts.at(index) : 0;
+}
+
+int AvailabilityMap::pick(const QString &uuid, const QBitArray &have, const QSet<int> &pending,
+                          int limit, int start) const
+{
+    QBitArray peer = mPeers.value(uuid);
+    limit = qMin(limit, peer.size());
+    if (limit <= 0) {
+        return -1;
+    }
+
+    // Peers start searching at different places so that they do not all
+    // request the same chunks from the sender at first
+    int best = -1;
+    int bestCount = INT_MAX;
+    for (int n = 0; n < limit; ++n) {
+        int i = (start % limit + n) % limit;
+        if (peer.testBit(i) && (i >= have.size() || !have.testBit(i)) &&
+                !pending.contains(i) && mCounts.at(i) < bestCount) {
+            best = i;
+            bestCount = mCounts.at(i);
+            if (bestCount == 1) {
+                break;
+            }
+        }
+    }
+    return best;
+}
+
+void AvailabilityMap::resize(int size)
+{
+    if (mCounts.size() < size) {
+        mCounts.resize(size);
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef AVAILABILITYMAP_H
+#define AVAILABILITYMAP_H
+
+#include <QBitArray>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief Record of which peers have each chunk of a swarm
+ *
+ * The map combines what connected peers report with what other members of
+ * the swarm advertise through discovery, so that the rarity of a chunk
+ * reflects the whole swarm.
+ */
+class AvailabilityMap
+{
+public:
+
+    /**
+     * @brief Add chunks that a peer has
+     * @param uuid UUID of the peer
+     * @param chunks chunks the peer has (others it had are kept)
+     */
+    void addChunks(const QString &uuid, const QBitArray &chunks);
+
+    /**
+     * @brief Add a single chunk that a peer has
+     */
+    void addChunk(const QString &uuid, int index);
+
+    /**
+     * @brief Remove a chunk that a peer no longer has
+     */
+    void removeChunk(const QString &uuid, int index);
+
+    /**
+     * @brief Remove everything known about a peer
+     */
+    void removePeer(const QString &uuid);
+
+    /**
+     * @brief Retrieve the chunks a peer has
+     */
+    QBitArray chunks(const QString &uuid) const;
+
+    /**
+     * @brief Retrieve the number of peers that have a chunk
+     */
+    int count(int index) const;
+
+    /**
+     * @brief Select the next chunk to request from a peer (rarest first)
+     * @param uuid UUID of the peer
+     * @param have chunks that were already downloaded
+     * @param pending chunks that were already requested
+     * @param limit number of chunks that can be requested
+     * @param start index to begin searching at, which breaks ties between
+     *        chunks that are equally rare
+     * @return index of the chunk or -1 if the peer has nothing useful
+     */
+    int pick(const QString &uuid, const QBitArray &have, const QSet<int> &pending,
+             int limit, int start) const;
+
+private:
+
+    void resize(int size);
+
+    QHash<QString, QBitArray> mPeers;
+    QVector<int> mCounts;
+};
+
+#endif // AVAILABILITYMAP_H
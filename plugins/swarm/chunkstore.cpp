@@ -0,0 +1,76 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QDir>
+#include <QFile>
+
+#include "chunkstore.h"
+
+ChunkStore::ChunkStore()
+    : mDir(QDir::temp().filePath("nitroshare-swarm-XXXXXX"))
+{
+}
+
+bool ChunkStore::isValid() const
+{
+    return mDir.isValid();
+}
+
+bool ChunkStore::write(const QByteArray &hash, const QByteArray &data)
+{
+    int &references = mReferences[hash];
+    if (!references) {
+        QFile file(path(hash));
+        if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size()) {
+            mReferences.remove(hash);
+            file.remove();
+            return false;
+        }
+    }
+    ++references;
+    return true;
+}
+
+QByteArray ChunkStore::read(const QByteArray &hash) const
+{
+    QFile file(path(hash));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QByteArray();
+    }
+    return file.readAll();
+}
+
+void ChunkStore::remove(const QByteArray &hash)
+{
+    QHash<QByteArray, int>::iterator i = mReferences.find(hash);
+    if (i != mReferences.end() && !--i.value()) {
+        mReferences.erase(i);
+        QFile::remove(path(hash));
+    }
+}
+
+QString ChunkStore::path(const QByteArray &hash) const
+{
+    return mDir.filePath(QString::fromLatin1(hash.toHex()));
+}
@@ -0,0 +1,77 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CHUNKSTORE_H
+#define CHUNKSTORE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QTemporaryDir>
+
+/**
+ * @brief Content-addressed storage for the chunks of a swarm
+ *
+ * Chunks are stored in a temporary directory in files named after their hash,
+ * so identical chunks are only stored once. The directory is removed when the
+ * store is destroyed.
+ */
+class ChunkStore
+{
+public:
+
+    ChunkStore();
+
+    /**
+     * @brief Determine if the directory for the chunks could be created
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Store a chunk
+     * @param hash SHA-256 hash of the chunk
+     * @param data content of the chunk
+     * @return true if the chunk was stored
+     */
+    bool write(const QByteArray &hash, const QByteArray &data);
+
+    /**
+     * @brief Retrieve the content of a chunk
+     * @return content or a null array if the chunk could not be read
+     */
+    QByteArray read(const QByteArray &hash) const;
+
+    /**
+     * @brief Release a chunk, removing it once nothing refers to it
+     */
+    void remove(const QByteArray &hash);
+
+private:
+
+    QString path(const QByteArray &hash) const;
+
+    QTemporaryDir mDir;
+    QHash<QByteArray, int> mReferences;
+};
+
+#endif // CHUNKSTORE_H
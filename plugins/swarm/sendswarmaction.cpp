@@ -0,0 +1,129 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QHostAddress>
+#include <QList>
+
+#include <nitroshare/application.h>
+#include <nitroshare/device.h>
+#include <nitroshare/devicemodel.h>
+#include <nitroshare/logger.h>
+#include <nitroshare/message.h>
+
+#include "sendswarmaction.h"
+#include "swarmsession.h"
+
+const QString MessageTag = "sendswarm";
+
+SendSwarmAction::SendSwarmAction(Application *application, SwarmTransportServer *server,
+                                 GroupEnumerator *enumerator)
+    : mApplication(application),
+      mServer(server),
+      mEnumerator(enumerator)
+{
+}
+
+QString SendSwarmAction::name() const
+{
+    return "sendswarm";
+}
+
+bool SendSwarmAction::api() const
+{
+    return true;
+}
+
+QString SendSwarmAction::title() const
+{
+    return tr("send items to devices as a swarm");
+}
+
+QString SendSwarmAction::description() const
+{
+    return tr(
+        "Send a list of files or directories to many devices at once. The "
+        "devices download parts of the items from each other as well as from "
+        "this device. This action expects one parameter:\n"
+        "\n"
+        "- \"items\" (array of strings) absolute paths for the items to send\n"
+        "\n"
+        "The optional \"devices\" (array of strings) parameter lists the UUIDs "
+        "of the devices to send to; by default, the items are sent to every "
+        "device discovered that can receive them. The optional \"streaming\" "
+        "(boolean) parameter has the same meaning as for the \"senditems\" "
+        "action.\n"
+        "\n"
+        "A single transfer is created for all of the devices, which reads the "
+        "items only once. Each device is also shown as a transfer of its own, "
+        "which succeeds or fails with that device. The return value will be "
+        "the number of transfers created for all of the devices."
+    );
+}
+
+QVariant SendSwarmAction::invoke(const QVariantMap &params)
+{
+    QStringList uuids = params.value("devices").toStringList();
+
+    // Find the devices that can join a swarm (each device only once, even
+    // if more than one enumerator found it)
+    QList<Device*> devices;
+    QStringList found;
+    DeviceModel *model = mApplication->deviceModel();
+    for (int i = 0; i < model->rowCount(); ++i) {
+        Device *device = model->data(model->index(i, 0), Qt::UserRole).value<Device*>();
+        if (!device->property("swarmPort").toInt() ||
+                device->property("addresses").toStringList().isEmpty() ||
+                found.contains(device->uuid())) {
+            continue;
+        }
+        if (!uuids.isEmpty() && !uuids.contains(device->uuid())) {
+            continue;
+        }
+        devices.append(device);
+        found.append(device->uuid());
+    }
+    if (devices.isEmpty()) {
+        return 0;
+    }
+
+    SwarmSession *session = new SwarmSession(mApplication->deviceUuid(), mServer);
+    if (!session->swarm()->isValid()) {
+        mApplication->logger()->log(new Message(
+            Message::Error,
+            MessageTag,
+            QString("unable to create storage for chunks")
+        ));
+        delete session;
+        return 0;
+    }
+    foreach (Device *device, devices) {
+        session->addReceiver(
+            device->uuid(),
+            QHostAddress(device->property("addresses").toStringList().first()),
+            device->property("swarmPort").toInt()
+        );
+    }
+
+    return session->start(mApplication, mEnumerator, devices, params) ? 1 : 0;
+}
@@ -0,0 +1,300 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <random>
+
+#include <QCryptographicHash>
+#include <QJsonArray>
+
+#include "swarm.h"
+#include "swarmpeer.h"
+#include "swarmprotocol.h"
+
+using namespace SwarmProtocol;
+
+Swarm::Swarm(const QString &id, const QString &sender)
+    : mId(id),
+      mSender(sender),
+      mStart(std::random_device()() >> 1)
+{
+}
+
+Swarm::~Swarm()
+{
+    qDeleteAll(mPeers);
+}
+
+QString Swarm::id() const
+{
+    return mId;
+}
+
+QString Swarm::sender() const
+{
+    return mSender;
+}
+
+bool Swarm::isSender() const
+{
+    return mSender.isEmpty();
+}
+
+bool Swarm::isValid() const
+{
+    return mStore.isValid();
+}
+
+QBitArray Swarm::chunks() const
+{
+    return mChunks;
+}
+
+bool Swarm::hasChunk(int index) const
+{
+    return index >= 0 && index < mChunks.size() && mChunks.testBit(index);
+}
+
+QByteArray Swarm::chunk(int index) const
+{
+    if (!hasChunk(index)) {
+        return QByteArray();
+    }
+    return mStore.read(mHashes.at(index));
+}
+
+bool Swarm::addChunk(const QByteArray &data)
+{
+    int index = mHashes.count();
+    QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha256);
+    if (!mStore.write(hash, data)) {
+        return false;
+    }
+
+    mHashes.append(hash);
+    mChunks.resize(index + 1);
+    mChunks.setBit(index);
+
+    // Receivers need the hash before they can download the chunk
+    broadcast(createChunksMessage(index));
+
+    emit chunkAdded(index);
+    return true;
+}
+
+void Swarm::removeChunk(int index)
+{
+    if (index < mChunks.size() && mChunks.testBit(index)) {
+        mChunks.clearBit(index);
+        mStore.remove(mHashes.at(index));
+    }
+}
+
+void Swarm::addPeer(SwarmPeer *peer)
+{
+    peer->setParent(nullptr);
+    mPeers.append(peer);
+
+    connect(peer, &SwarmPeer::messageReceived, this, &Swarm::onMessageReceived);
+    connect(peer, &SwarmPeer::chunkReceived, this, &Swarm::onChunkReceived);
+    connect(peer, &SwarmPeer::disconnected, this, &Swarm::onDisconnected);
+
+    if (isSender() && mHashes.count()) {
+        peer->send(createChunksMessage(0));
+    }
+    peer->send({
+        { "type", Bitfield },
+        { "chunks", encodeBitfield(mChunks) }
+    });
+}
+
+SwarmPeer *Swarm::peer(const QString &uuid) const
+{
+    foreach (SwarmPeer *peer, mPeers) {
+        if (peer->uuid() == uuid) {
+            return peer;
+        }
+    }
+    return nullptr;
+}
+
+QBitArray Swarm::peerChunks(const QString &uuid) const
+{
+    return mAvailability.chunks(uuid);
+}
+
+void Swarm::addAvailability(const QString &uuid, const QBitArray &chunks)
+{
+    mAvailability.addChunks(uuid, chunks);
+}
+
+void Swarm::broadcast(const QJsonObject &message)
+{
+    foreach (SwarmPeer *peer, mPeers) {
+        peer->send(message);
+    }
+}
+
+void Swarm::onMessageReceived(const QJsonObject &message)
+{
+    SwarmPeer *peer = qobject_cast<SwarmPeer*>(sender());
+    QString type = message.value("type").toString();
+
+    if (type == Bitfield) {
+        mAvailability.addChunks(peer->uuid(), decodeBitfield(message.value("chunks").toString()));
+        emit peerChunksChanged(peer->uuid());
+        schedule();
+    } else if (type == Have) {
+        int index = message.value("index").toInt();
+        if (index < 0 || index >= MaxChunks) {
+            return;
+        }
+        mAvailability.addChunk(peer->uuid(), index);
+        emit peerChunksChanged(peer->uuid());
+        schedule();
+    } else if (type == Chunks) {
+
+        // Hashes are only trusted from the sender, which cut the chunks
+        if (peer->uuid() != mSender) {
+            return;
+        }
+        // The sender has the chunks it just cut
+        int first = message.value("first").toInt();
+        QJsonArray hashes = message.value("hashes").toArray();
+        for (int i = mHashes.count() - first; i >= 0 && i < hashes.count() &&
+                mHashes.count() < MaxChunks; ++i) {
+            mHashes.append(QByteArray::fromHex(hashes.at(i).toString().toLatin1()));
+            mAvailability.addChunk(mSender, mHashes.count() - 1);
+        }
+        mChunks.resize(mHashes.count());
+        schedule();
+    } else if (type == Request) {
+        int index = message.value("index").toInt();
+        QByteArray data = chunk(index);
+        if (data.isNull()) {
+            peer->send({
+                { "type", Reject },
+                { "index", index }
+            });
+        } else {
+            peer->sendChunk(index, data);
+        }
+    } else if (type == Reject) {
+        int index = message.value("index").toInt();
+        if (peer->requests().remove(index)) {
+            mPending.remove(index);
+            mAvailability.removeChunk(peer->uuid(), index);
+            schedule();
+        }
+    } else {
+        emit messageReceived(peer, message);
+    }
+}
+
+void Swarm::onChunkReceived(int index, const QByteArray &data)
+{
+    SwarmPeer *peer = qobject_cast<SwarmPeer*>(sender());
+    if (!peer->requests().remove(index)) {
+        return;
+    }
+    mPending.remove(index);
+
+    // Chunks are addressed by their content - anything else is discarded
+    // and requested again (from whichever peer is chosen next)
+    if (QCryptographicHash::hash(data, QCryptographicHash::Sha256) == mHashes.at(index)) {
+        storeChunk(index, data);
+    } else {
+        mAvailability.removeChunk(peer->uuid(), index);
+    }
+
+    schedule();
+}
+
+void Swarm::onDisconnected()
+{
+    SwarmPeer *peer = qobject_cast<SwarmPeer*>(sender());
+    mPeers.removeOne(peer);
+
+    foreach (int index, peer->requests()) {
+        mPending.remove(index);
+    }
+    mAvailability.removePeer(peer->uuid());
+
+    QString uuid = peer->uuid();
+    peer->deleteLater();
+
+    emit peerRemoved(uuid);
+    schedule();
+}
+
+QJsonObject Swarm::createChunksMessage(int first) const
+{
+    QJsonArray hashes;
+    for (int i = first; i < mHashes.count(); ++i) {
+        hashes.append(QString::fromLatin1(mHashes.at(i).toHex()));
+    }
+    return QJsonObject{
+        { "type", Chunks },
+        { "first", first },
+        { "hashes", hashes }
+    };
+}
+
+void Swarm::storeChunk(int index, const QByteArray &data)
+{
+    if (!mStore.write(mHashes.at(index), data)) {
+        return;
+    }
+    mChunks.setBit(index);
+
+    // Let peers know right away so that they can request it from here
+    broadcast({
+        { "type", Have },
+        { "index", index }
+    });
+
+    emit chunkAdded(index);
+}
+
+void Swarm::schedule()
+{
+    if (isSender()) {
+        return;
+    }
+
+    foreach (SwarmPeer *peer, mPeers) {
+        while (peer->requests().count() < PipelineDepth) {
+            int index = mAvailability.pick(peer->uuid(), mChunks, mPending,
+                mHashes.count(), mStart);
+            if (index == -1) {
+                break;
+            }
+            mPending.insert(index);
+            peer->requests().insert(index);
+            peer->send({
+                { "type", Request },
+                { "index", index }
+            });
+        }
+    }
+}
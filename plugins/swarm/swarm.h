@@ -0,0 +1,176 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SWARM_H
+#define SWARM_H
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+#include "availabilitymap.h"
+#include "chunkstore.h"
+
+class SwarmPeer;
+
+/**
+ * @brief Chunks of a stream shared between the members of a swarm
+ *
+ * The sender cuts the stream into chunks and announces their hashes to the
+ * receivers. Receivers download chunks from any peer that has them, rarest
+ * first, verify them against the hash and then serve them to other peers.
+ */
+class Swarm : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Create a swarm
+     * @param id unique identifier for the swarm
+     * @param sender UUID of the sender or empty if this is the sender
+     */
+    Swarm(const QString &id, const QString &sender = QString());
+    virtual ~Swarm();
+
+    QString id() const;
+    QString sender() const;
+    bool isSender() const;
+
+    /**
+     * @brief Determine if storage for the chunks is available
+     */
+    bool isValid() const;
+
+    /**
+     * @brief Retrieve the chunks that are available locally
+     */
+    QBitArray chunks() const;
+
+    /**
+     * @brief Determine if a chunk is available locally
+     */
+    bool hasChunk(int index) const;
+
+    /**
+     * @brief Retrieve the content of a chunk
+     * @return content or a null array if the chunk is not available
+     */
+    QByteArray chunk(int index) const;
+
+    /**
+     * @brief Add the next chunk of the stream (sender only)
+     * @return true if the chunk was stored
+     */
+    bool addChunk(const QByteArray &data);
+
+    /**
+     * @brief Remove a chunk that every receiver has (sender only)
+     */
+    void removeChunk(int index);
+
+    /**
+     * @brief Add a peer to the swarm
+     *
+     * Ownership of the peer is taken and the chunks available locally are
+     * sent to it.
+     */
+    void addPeer(SwarmPeer *peer);
+
+    /**
+     * @brief Find the peer with the specified UUID
+     */
+    SwarmPeer *peer(const QString &uuid) const;
+
+    /**
+     * @brief Retrieve the chunks a peer has
+     */
+    QBitArray peerChunks(const QString &uuid) const;
+
+    /**
+     * @brief Add chunks that a member advertised through discovery
+     */
+    void addAvailability(const QString &uuid, const QBitArray &chunks);
+
+    /**
+     * @brief Send a message to every peer
+     */
+    void broadcast(const QJsonObject &message);
+
+signals:
+
+    /**
+     * @brief Indicate that a chunk is now available locally
+     */
+    void chunkAdded(int index);
+
+    /**
+     * @brief Indicate that a peer reported new chunks
+     */
+    void peerChunksChanged(const QString &uuid);
+
+    /**
+     * @brief Indicate that a message not related to chunks was received
+     */
+    void messageReceived(SwarmPeer *peer, const QJsonObject &message);
+
+    /**
+     * @brief Indicate that a peer was disconnected
+     */
+    void peerRemoved(const QString &uuid);
+
+private slots:
+
+    void onMessageReceived(const QJsonObject &message);
+    void onChunkReceived(int index, const QByteArray &data);
+    void onDisconnected();
+
+private:
+
+    QJsonObject createChunksMessage(int first) const;
+    void storeChunk(int index, const QByteArray &data);
+    void schedule();
+
+    QString mId;
+    QString mSender;
+
+    ChunkStore mStore;
+    QVector<QByteArray> mHashes;
+    QBitArray mChunks;
+
+    QList<SwarmPeer*> mPeers;
+    AvailabilityMap mAvailability;
+    QSet<int> mPending;
+    // Where to begin looking for chunks to request, which is different
+    // for each receiver
+    int mStart;
+};
+
+#endif // SWARM_H
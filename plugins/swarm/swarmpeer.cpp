@@ -0,0 +1,150 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QJsonDocument>
+#include <QtEndian>
+
+#include <nitroshare/packet.h>
+#include <nitroshare/transport.h>
+
+#include "swarmpeer.h"
+
+SwarmPeer::SwarmPeer(Transport *transport, bool connected, const QString &uuid)
+    : mTransport(transport),
+      mConnected(connected),
+      mClosed(false),
+      mUuid(uuid)
+{
+    mTransport->setParent(this);
+
+    connect(mTransport, &Transport::connected, this, &SwarmPeer::onConnected);
+    connect(mTransport, &Transport::packetReceived, this, &SwarmPeer::onPacketReceived);
+    connect(mTransport, &Transport::error, this, &SwarmPeer::onError);
+}
+
+QString SwarmPeer::uuid() const
+{
+    return mUuid;
+}
+
+void SwarmPeer::setUuid(const QString &uuid)
+{
+    mUuid = uuid;
+}
+
+QSet<int> &SwarmPeer::requests()
+{
+    return mRequests;
+}
+
+void SwarmPeer::send(const QJsonObject &message)
+{
+    if (mClosed) {
+        return;
+    }
+
+    QByteArray content = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    if (mConnected) {
+        Packet packet(Packet::Json, content);
+        write(&packet);
+    } else {
+        mQueue.append(content);
+    }
+}
+
+void SwarmPeer::sendChunk(int index, const QByteArray &data)
+{
+    if (mClosed || !mConnected) {
+        return;
+    }
+
+    QByteArray content;
+    content.reserve(sizeof(qint32) + data.size());
+    qint32 value = qToLittleEndian<qint32>(index);
+    content.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    content.append(data);
+
+    Packet packet(Packet::Binary, content);
+    write(&packet);
+}
+
+void SwarmPeer::close()
+{
+    if (!mClosed) {
+        mClosed = true;
+        mTransport->close();
+    }
+}
+
+void SwarmPeer::onConnected()
+{
+    mConnected = true;
+
+    // Send the messages that were waiting for the connection
+    foreach (const QByteArray &content, mQueue) {
+        Packet packet(Packet::Json, content);
+        write(&packet);
+    }
+    mQueue.clear();
+}
+
+void SwarmPeer::onPacketReceived(Packet *packet)
+{
+    if (mClosed) {
+        return;
+    }
+
+    switch (packet->type()) {
+    case Packet::Json:
+        emit messageReceived(QJsonDocument::fromJson(packet->content()).object());
+        break;
+    case Packet::Binary:
+    {
+        QByteArray content = packet->content();
+        if (content.size() > static_cast<int>(sizeof(qint32))) {
+            qint32 index = qFromLittleEndian<qint32>(
+                reinterpret_cast<const uchar*>(content.constData()));
+            emit chunkReceived(index, content.mid(sizeof(qint32)));
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void SwarmPeer::onError()
+{
+    if (!mClosed) {
+        close();
+        emit disconnected();
+    }
+}
+
+void SwarmPeer::write(Packet *packet)
+{
+    // The LAN transport buffers whatever is written, so there is no need to
+    // wait for packetSent - the number of requests bounds what is queued
+    mTransport->sendPacket(packet);
+}
@@ -0,0 +1,106 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SWARMPEER_H
+#define SWARMPEER_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+class Packet;
+class Transport;
+
+/**
+ * @brief Connection to another member of a swarm
+ */
+class SwarmPeer : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Create a peer for a transport
+     * @param transport transport for the connection (ownership is taken)
+     * @param connected true if the transport is already connected
+     * @param uuid UUID of the peer if known
+     */
+    SwarmPeer(Transport *transport, bool connected, const QString &uuid = QString());
+
+    QString uuid() const;
+    void setUuid(const QString &uuid);
+
+    /**
+     * @brief Retrieve the chunks requested from the peer
+     */
+    QSet<int> &requests();
+
+    /**
+     * @brief Send a message, waiting for the connection if necessary
+     */
+    void send(const QJsonObject &message);
+
+    /**
+     * @brief Send the content of a chunk
+     */
+    void sendChunk(int index, const QByteArray &data);
+
+    /**
+     * @brief Close the connection
+     */
+    void close();
+
+signals:
+
+    void messageReceived(const QJsonObject &message);
+    void chunkReceived(int index, const QByteArray &data);
+
+    /**
+     * @brief Indicate that the connection was lost or could not be made
+     */
+    void disconnected();
+
+private slots:
+
+    void onConnected();
+    void onPacketReceived(Packet *packet);
+    void onError();
+
+private:
+
+    void write(Packet *packet);
+
+    Transport *mTransport;
+    bool mConnected;
+    bool mClosed;
+    QString mUuid;
+    QSet<int> mRequests;
+    QList<QByteArray> mQueue;
+};
+
+#endif // SWARMPEER_H
@@ -0,0 +1,105 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SWARMPROTOCOL_H
+#define SWARMPROTOCOL_H
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QString>
+
+/**
+ * Peers in a swarm exchange JSON packets with a "type" member over a LAN
+ * transport, and chunks as binary packets that begin with the index of the
+ * chunk.
+ */
+namespace SwarmProtocol
+{
+    /// First message from the sender to a receiver, asking it to join
+    const QString Invite = "invite";
+    /// First message between two receivers
+    const QString Hello = "hello";
+    /// Chunks the peer has
+    const QString Bitfield = "bitfield";
+    /// Peer finished downloading a chunk
+    const QString Have = "have";
+    /// Hashes and sizes of new chunks (only accepted from the sender)
+    const QString Chunks = "chunks";
+    /// Request for a chunk
+    const QString Request = "request";
+    /// Peer does not have a chunk that was requested
+    const QString Reject = "reject";
+    /// Packet sent by the transfer of a receiver to the sender
+    const QString Reply = "reply";
+    /// Sender is finished with the swarm
+    const QString Close = "close";
+
+    // Chunks are cut from the stream of packets sent by the transfers
+    const int ChunkSize = 1024 * 1024;
+
+    // Largest number of chunks in a swarm (4 TiB)
+    const int MaxChunks = 4 * 1024 * 1024;
+
+    // Requests each peer may have outstanding
+    const int PipelineDepth = 4;
+
+    // Amount of the stream the sender may cut beyond what every receiver has
+    const qint64 Window = 256 * ChunkSize;
+
+    // Largest number of chunks advertised through discovery
+    const int MaxAdvertisedChunks = 32768;
+
+    /**
+     * @brief Encode a set of chunks for sending to another peer
+     */
+    inline QString encodeBitfield(const QBitArray &bits)
+    {
+        QByteArray data((bits.size() + 7) / 8, 0);
+        for (int i = 0; i < bits.size(); ++i) {
+            if (bits.testBit(i)) {
+                data[i >> 3] = data.at(i >> 3) | (1 << (i & 7));
+            }
+        }
+        return QString::fromLatin1(data.toBase64());
+    }
+
+    /**
+     * @brief Decode a set of chunks received from another peer
+     *
+     * The size of the array is rounded up to a multiple of eight.
+     */
+    inline QBitArray decodeBitfield(const QString &encoded)
+    {
+        QByteArray data = QByteArray::fromBase64(encoded.toLatin1()).left(MaxChunks / 8);
+        QBitArray bits(data.size() * 8);
+        for (int i = 0; i < bits.size(); ++i) {
+            if (data.at(i >> 3) & (1 << (i & 7))) {
+                bits.setBit(i);
+            }
+        }
+        return bits;
+    }
+}
+
+#endif // SWARMPROTOCOL_H
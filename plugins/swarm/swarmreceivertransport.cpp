@@ -0,0 +1,111 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QJsonObject>
+
+#include <nitroshare/packet.h>
+#include <nitroshare/packetstream.h>
+
+#include "swarm.h"
+#include "swarmpeer.h"
+#include "swarmprotocol.h"
+#include "swarmreceivertransport.h"
+
+using namespace SwarmProtocol;
+
+SwarmReceiverTransport::SwarmReceiverTransport(Swarm *swarm)
+    : mSwarm(swarm),
+      mSender(swarm->sender()),
+      mNextChunk(0),
+      mClosed(false)
+{
+    connect(swarm, &Swarm::chunkAdded, this, &SwarmReceiverTransport::onChunkAdded);
+    connect(swarm, &Swarm::peerRemoved, this, &SwarmReceiverTransport::onPeerRemoved);
+    connect(swarm, &Swarm::destroyed, this, &SwarmReceiverTransport::onDestroyed);
+}
+
+void SwarmReceiverTransport::sendPacket(Packet *packet)
+{
+    if (mClosed || !mSwarm) {
+        return;
+    }
+
+    SwarmPeer *sender = mSwarm->peer(mSender);
+    if (sender) {
+        sender->send({
+            { "type", Reply },
+            { "packetType", static_cast<int>(packet->type()) },
+            { "content", QString::fromLatin1(packet->content().toBase64()) }
+        });
+    }
+}
+
+void SwarmReceiverTransport::close()
+{
+    // The swarm keeps serving chunks to other receivers until the sender
+    // closes it
+    mClosed = true;
+}
+
+void SwarmReceiverTransport::onChunkAdded()
+{
+    while (!mClosed && mSwarm->hasChunk(mNextChunk)) {
+        mStream.addData(mSwarm->chunk(mNextChunk++));
+        processBuffer();
+    }
+}
+
+void SwarmReceiverTransport::onPeerRemoved(const QString &uuid)
+{
+    if (uuid == mSender) {
+        reportError(tr("connection to the sender was lost"));
+    }
+}
+
+void SwarmReceiverTransport::onDestroyed()
+{
+    reportError(tr("the sender closed the swarm"));
+}
+
+void SwarmReceiverTransport::processBuffer()
+{
+    char type;
+    QByteArray data;
+    while (!mClosed && mStream.readPacket(&type, &data)) {
+        Packet packet(static_cast<Packet::Type>(type), data);
+        emit packetReceived(&packet);
+    }
+
+    if (mStream.hasError()) {
+        reportError(tr("invalid packet received"));
+    }
+}
+
+void SwarmReceiverTransport::reportError(const QString &message)
+{
+    if (!mClosed) {
+        mClosed = true;
+        emit error(message);
+    }
+}
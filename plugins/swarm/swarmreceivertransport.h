@@ -0,0 +1,73 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SWARMRECEIVERTRANSPORT_H
+#define SWARMRECEIVERTRANSPORT_H
+
+#include <QByteArray>
+#include <QPointer>
+
+#include <nitroshare/packetstream.h>
+#include <nitroshare/transport.h>
+
+class Packet;
+class Swarm;
+
+/**
+ * @brief Transport for receiving items sent to a swarm
+ *
+ * Chunks are downloaded in whatever order the swarm chooses; the transport
+ * passes the stream on to the transfer as soon as it is contiguous.
+ */
+class SwarmReceiverTransport : public Transport
+{
+    Q_OBJECT
+
+public:
+
+    explicit SwarmReceiverTransport(Swarm *swarm);
+
+    virtual void sendPacket(Packet *packet);
+    virtual void close();
+
+private slots:
+
+    void onChunkAdded();
+    void onPeerRemoved(const QString &uuid);
+    void onDestroyed();
+
+private:
+
+    void processBuffer();
+    void reportError(const QString &message);
+
+    QPointer<Swarm> mSwarm;
+    QString mSender;
+    int mNextChunk;
+    bool mClosed;
+
+    PacketStream mStream;
+};
+
+#endif // SWARMRECEIVERTRANSPORT_H
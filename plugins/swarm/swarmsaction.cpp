@@ -0,0 +1,60 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "swarmsaction.h"
+#include "swarmtransportserver.h"
+
+SwarmsAction::SwarmsAction(SwarmTransportServer *server)
+    : mServer(server)
+{
+}
+
+QString SwarmsAction::name() const
+{
+    return "swarms";
+}
+
+bool SwarmsAction::api() const
+{
+    return true;
+}
+
+QString SwarmsAction::title() const
+{
+    return tr("list swarms");
+}
+
+QString SwarmsAction::description() const
+{
+    return tr(
+        "Retrieve the swarms this device is a member of. The return value is "
+        "an object mapping the ID of each swarm to the chunks available on "
+        "this device, encoded as a base64 bitfield (empty for large swarms)."
+    );
+}
+
+QVariant SwarmsAction::invoke(const QVariantMap &)
+{
+    return mServer->advertisement();
+}
@@ -0,0 +1,271 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "lanconfig.h"
+
+#include <QBitArray>
+#include <QUuid>
+
+#include <nitroshare/packet.h>
+
+#include "lantransport.h"
+#include "swarmpeer.h"
+#include "swarmprotocol.h"
+#include "swarmsession.h"
+#include "swarmtransportserver.h"
+
+using namespace SwarmProtocol;
+
+// A partial chunk is cut once no more data was added for this long (in
+// milliseconds)
+const int FlushDelay = 5;
+
+// Time (in milliseconds) for receivers to join before giving up on them
+const int JoinTimeout = 10000;
+
+SwarmSession::SwarmSession(const QString &uuid, SwarmTransportServer *server)
+    : GroupSession(Window, JoinTimeout),
+      mUuid(uuid),
+      mServer(server),
+      mSwarm(QUuid::createUuid().toString().mid(1, 36)),
+      mTrimmed(0)
+{
+    connect(&mSwarm, &Swarm::peerChunksChanged, this, &SwarmSession::onPeerChunksChanged);
+    connect(&mSwarm, &Swarm::messageReceived, this, &SwarmSession::onMessageReceived);
+    connect(&mSwarm, &Swarm::peerRemoved, this, &SwarmSession::onPeerRemoved);
+    connect(&mFlushTimer, &QTimer::timeout, this, &SwarmSession::onFlushTimeout);
+
+    mFlushTimer.setSingleShot(true);
+    mFlushTimer.setInterval(FlushDelay);
+}
+
+SwarmSession::~SwarmSession()
+{
+    mServer->removeSwarm(&mSwarm);
+}
+
+Swarm *SwarmSession::swarm()
+{
+    return &mSwarm;
+}
+
+int SwarmSession::addReceiver(const QString &uuid, const QHostAddress &address, quint16 port)
+{
+    Receiver receiver;
+    receiver.uuid = uuid;
+    receiver.address = address;
+    receiver.port = port;
+    receiver.failed = false;
+    receiver.chunks = 0;
+    receiver.delivered = 0;
+    mReceivers.append(receiver);
+    return registerReceiver();
+}
+
+QString SwarmSession::sessionId() const
+{
+    return mSwarm.id();
+}
+
+QString SwarmSession::transportName() const
+{
+    return "swarm";
+}
+
+void SwarmSession::invite()
+{
+    // Receivers connect to the server once invited
+    mServer->addSwarm(&mSwarm);
+
+    for (int i = 0; i < mReceivers.count(); ++i) {
+        const Receiver &r = mReceivers.at(i);
+        if (isReceiverFinished(i)) {
+            continue;
+        }
+
+        SwarmPeer *peer = new SwarmPeer(new LanTransport(
+            r.address
+          , r.port
+#ifdef ENABLE_TLS
+          , QSslConfiguration()
+#endif
+        ), false, r.uuid);
+
+        // The invitation must be the first message on the connection
+        peer->send({
+            { "type", Invite },
+            { "swarm", mSwarm.id() },
+            { "uuid", mUuid }
+        });
+        mSwarm.addPeer(peer);
+    }
+}
+
+void SwarmSession::finishReceiver(int receiver)
+{
+    // The receiver stays in the swarm (serving chunks to the others) until
+    // the transfer is finished
+    Receiver &r = mReceivers[receiver];
+    if (!isReceiverJoined(receiver)) {
+        r.failed = true;
+    }
+
+    trim();
+    emit progress();
+}
+
+void SwarmSession::processPending()
+{
+    while (mPending.size() >= ChunkSize) {
+        cutChunk(ChunkSize);
+    }
+    if (mPending.size()) {
+        mFlushTimer.start();
+    }
+}
+
+void SwarmSession::closeSession()
+{
+    mSwarm.broadcast({ { "type", Close } });
+}
+
+void SwarmSession::onPeerChunksChanged(const QString &uuid)
+{
+    int receiver = findReceiver(uuid);
+    if (receiver == -1) {
+        return;
+    }
+    Receiver &r = mReceivers[receiver];
+
+    // The first bitfield from a receiver indicates it joined
+    if (!r.failed) {
+        setJoined(receiver);
+    }
+
+    QBitArray chunks = mSwarm.peerChunks(uuid);
+    int previous = r.chunks;
+    while (r.chunks < chunks.size() && r.chunks < mChunkEnds.count() &&
+            chunks.testBit(r.chunks)) {
+        ++r.chunks;
+    }
+    if (r.chunks != previous) {
+        r.delivered = mChunkEnds.at(r.chunks - 1);
+        trim();
+        emit progress();
+    }
+}
+
+void SwarmSession::onMessageReceived(SwarmPeer *peer, const QJsonObject &message)
+{
+    int receiver = findReceiver(peer->uuid());
+    if (receiver == -1 || message.value("type").toString() != Reply) {
+        return;
+    }
+
+    // The transfer of a receiver only ever sends success or an error
+    Packet packet(
+        static_cast<Packet::Type>(message.value("packetType").toInt()),
+        QByteArray::fromBase64(message.value("content").toString().toLatin1())
+    );
+    processReply(receiver, &packet);
+}
+
+void SwarmSession::onPeerRemoved(const QString &uuid)
+{
+    int receiver = findReceiver(uuid);
+    if (receiver != -1) {
+        fail(receiver, tr("connection to the receiver was lost"));
+    }
+}
+
+void SwarmSession::onFlushTimeout()
+{
+    if (mPending.size()) {
+        cutChunk(mPending.size());
+    }
+}
+
+int SwarmSession::findReceiver(const QString &uuid) const
+{
+    for (int i = 0; i < mReceivers.count(); ++i) {
+        if (mReceivers.at(i).uuid == uuid) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void SwarmSession::cutChunk(int length)
+{
+    if (!mSwarm.addChunk(mPending.left(length))) {
+        for (int i = 0; i < mReceivers.count(); ++i) {
+            fail(i, tr("unable to store chunk"));
+        }
+        return;
+    }
+    mPending.remove(0, length);
+
+    qint64 start = mChunkEnds.count() ? mChunkEnds.last() : 0;
+    mChunkEnds.append(start + length);
+}
+
+void SwarmSession::fail(int receiver, const QString &message)
+{
+    Receiver &r = mReceivers[receiver];
+    if (r.failed) {
+        return;
+    }
+    r.failed = true;
+
+    failReceiver(receiver, message);
+
+    // The receiver no longer holds back the others
+    trim();
+    emit progress();
+}
+
+void SwarmSession::trim()
+{
+    // Chunks that every receiver has are no longer needed here
+    int minimum = mChunkEnds.count();
+    foreach (const Receiver &r, mReceivers) {
+        if (!r.failed && r.chunks < minimum) {
+            minimum = r.chunks;
+        }
+    }
+    while (mTrimmed < minimum) {
+        mSwarm.removeChunk(mTrimmed++);
+    }
+}
+
+qint64 SwarmSession::minimumDelivered() const
+{
+    qint64 minimum = streamEnd();
+    foreach (const Receiver &r, mReceivers) {
+        if (!r.failed && r.delivered < minimum) {
+            minimum = r.delivered;
+        }
+    }
+    return minimum;
+}
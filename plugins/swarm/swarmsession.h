@@ -0,0 +1,120 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SWARMSESSION_H
+#define SWARMSESSION_H
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QJsonObject>
+#include <QTimer>
+#include <QVector>
+
+#include "groupsession.h"
+#include "swarm.h"
+
+class SwarmPeer;
+class SwarmTransportServer;
+
+/**
+ * @brief Sender side of a swarm
+ *
+ * The stream is cut into chunks that the receivers download from the sender
+ * and from each other.
+ */
+class SwarmSession : public GroupSession
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Create a session
+     * @param uuid UUID of this device
+     * @param server server that receivers connect to for the swarm
+     */
+    SwarmSession(const QString &uuid, SwarmTransportServer *server);
+    virtual ~SwarmSession();
+
+    /**
+     * @brief Retrieve the swarm for the stream
+     */
+    Swarm *swarm();
+
+    /**
+     * @brief Add a receiver to the session
+     * @param uuid UUID of the receiver
+     * @param address address of the receiver
+     * @param port port the receiver accepts swarm connections on
+     * @return index of the receiver
+     */
+    int addReceiver(const QString &uuid, const QHostAddress &address, quint16 port);
+
+    virtual QString sessionId() const;
+    virtual QString transportName() const;
+
+protected:
+
+    virtual void invite();
+    virtual qint64 minimumDelivered() const;
+    virtual void processPending();
+    virtual void finishReceiver(int receiver);
+    virtual void closeSession();
+
+private slots:
+
+    void onPeerChunksChanged(const QString &uuid);
+    void onMessageReceived(SwarmPeer *peer, const QJsonObject &message);
+    void onPeerRemoved(const QString &uuid);
+    void onFlushTimeout();
+
+private:
+
+    struct Receiver
+    {
+        QString uuid;
+        QHostAddress address;
+        quint16 port;
+        bool failed;
+        int chunks;
+        qint64 delivered;
+    };
+
+    int findReceiver(const QString &uuid) const;
+    void cutChunk(int length);
+    void fail(int receiver, const QString &message);
+    void trim();
+
+    QString mUuid;
+    SwarmTransportServer *mServer;
+    Swarm mSwarm;
+
+    QVector<Receiver> mReceivers;
+
+    QTimer mFlushTimer;
+    QVector<qint64> mChunkEnds;
+    int mTrimmed;
+};
+
+#endif // SWARMSESSION_H
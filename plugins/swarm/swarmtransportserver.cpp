@@ -0,0 +1,299 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "lanconfig.h"
+
+#include <QBitArray>
+#include <QHostAddress>
+
+#include <nitroshare/application.h>
+#include <nitroshare/category.h>
+#include <nitroshare/device.h>
+#include <nitroshare/devicemodel.h>
+#include <nitroshare/logger.h>
+#include <nitroshare/message.h>
+#include <nitroshare/settingsregistry.h>
+
+#include "groupdevice.h"
+#include "groupsession.h"
+#include "lantransport.h"
+#include "swarm.h"
+#include "swarmpeer.h"
+#include "swarmprotocol.h"
+#include "swarmreceivertransport.h"
+#include "swarmtransportserver.h"
+
+using namespace SwarmProtocol;
+
+const QString MessageTag = "swarmtransportserver";
+
+const QString SwarmCategory = "swarm";
+const QString SwarmPort = "SwarmPort";
+
+// Interval (in milliseconds) for looking for other members of swarms
+const int DiscoveryInterval = 2000;
+
+SwarmTransportServer::SwarmTransportServer(Application *application)
+    : mApplication(application)
+    , mSwarmCategory({
+          { Category::NameKey, SwarmCategory },
+          { Category::TitleKey, tr("Swarm") }
+      })
+    , mSwarmPort({
+          { Setting::TypeKey, Setting::Integer },
+          { Setting::NameKey, SwarmPort },
+          { Setting::TitleKey, tr("Swarm Port") },
+          { Setting::CategoryKey, SwarmCategory },
+          { Setting::DefaultValueKey, 40821 }
+      })
+{
+    connect(&mServer, &Server::newSocketDescriptor, this, &SwarmTransportServer::onNewSocketDescriptor);
+    connect(&mDiscoveryTimer, &QTimer::timeout, this, &SwarmTransportServer::onDiscoveryTimeout);
+    connect(mApplication->settingsRegistry(), &SettingsRegistry::settingsChanged, this, &SwarmTransportServer::onSettingsChanged);
+
+    mApplication->settingsRegistry()->addCategory(&mSwarmCategory);
+    mApplication->settingsRegistry()->addSetting(&mSwarmPort);
+
+    // Trigger loading the initial settings
+    onSettingsChanged({ SwarmPort });
+
+    mDiscoveryTimer.start(DiscoveryInterval);
+}
+
+SwarmTransportServer::~SwarmTransportServer()
+{
+    mApplication->settingsRegistry()->removeSetting(&mSwarmPort);
+    mApplication->settingsRegistry()->removeCategory(&mSwarmCategory);
+
+    // Swarms being sent are owned by their sessions
+    foreach (Swarm *swarm, mSwarms) {
+        if (!swarm->isSender()) {
+            delete swarm;
+        }
+    }
+}
+
+QString SwarmTransportServer::name() const
+{
+    return "swarm";
+}
+
+Transport *SwarmTransportServer::createTransport(Device *device)
+{
+    GroupDevice *groupDevice = qobject_cast<GroupDevice*>(device);
+    if (!groupDevice || groupDevice->transportName() != name()) {
+        mApplication->logger()->log(new Message(
+            Message::Error,
+            MessageTag,
+            QString("%1 is not part of a swarm").arg(device->uuid())
+        ));
+        return nullptr;
+    }
+
+    return groupDevice->session()->createTransport(groupDevice);
+}
+
+void SwarmTransportServer::addSwarm(Swarm *swarm)
+{
+    mSwarms.insert(swarm->id(), swarm);
+}
+
+void SwarmTransportServer::removeSwarm(Swarm *swarm)
+{
+    mSwarms.remove(swarm->id());
+}
+
+QVariantMap SwarmTransportServer::advertisement() const
+{
+    // Large swarms only advertise that they exist - the chunks are still
+    // exchanged once connected
+    QVariantMap swarms;
+    foreach (Swarm *swarm, mSwarms) {
+        QBitArray chunks = swarm->chunks();
+        swarms.insert(swarm->id(), chunks.size() > MaxAdvertisedChunks ?
+            QString() : encodeBitfield(chunks));
+    }
+    return swarms;
+}
+
+void SwarmTransportServer::onNewSocketDescriptor(qintptr socketDescriptor)
+{
+    SwarmPeer *peer = new SwarmPeer(new LanTransport(
+        socketDescriptor
+#ifdef ENABLE_TLS
+      , QSslConfiguration()
+#endif
+    ), true);
+    peer->setParent(this);
+
+    // The first message indicates which swarm the connection is for
+    connect(peer, &SwarmPeer::messageReceived, this, &SwarmTransportServer::onGreetingReceived);
+    connect(peer, &SwarmPeer::disconnected, peer, &SwarmPeer::deleteLater);
+}
+
+void SwarmTransportServer::onGreetingReceived(const QJsonObject &message)
+{
+    SwarmPeer *peer = qobject_cast<SwarmPeer*>(sender());
+    disconnect(peer, nullptr, this, nullptr);
+    disconnect(peer, &SwarmPeer::disconnected, peer, &SwarmPeer::deleteLater);
+
+    QString type = message.value("type").toString();
+    QString id = message.value("swarm").toString();
+    QString uuid = message.value("uuid").toString();
+    Swarm *swarm = mSwarms.value(id);
+
+    if (uuid.isEmpty() || (swarm && swarm->peer(uuid))) {
+        peer->close();
+        peer->deleteLater();
+        return;
+    }
+
+    if (type == Hello && swarm) {
+        peer->setUuid(uuid);
+        swarm->addPeer(peer);
+    } else if (type == Invite && !swarm) {
+        joinSwarm(peer, id, uuid);
+    } else {
+        peer->close();
+        peer->deleteLater();
+    }
+}
+
+void SwarmTransportServer::onDiscoveryTimeout()
+{
+    if (mSwarms.isEmpty()) {
+        return;
+    }
+
+    QString localUuid = mApplication->deviceUuid();
+    DeviceModel *model = mApplication->deviceModel();
+    for (int i = 0; i < model->rowCount(); ++i) {
+        Device *device = model->data(model->index(i, 0), Qt::UserRole).value<Device*>();
+        QVariantMap swarms = device->property("swarms").toMap();
+        QString uuid = device->uuid();
+        if (swarms.isEmpty() || uuid == localUuid) {
+            continue;
+        }
+
+        for (auto j = swarms.constBegin(); j != swarms.constEnd(); ++j) {
+            Swarm *swarm = mSwarms.value(j.key());
+            if (!swarm) {
+                continue;
+            }
+
+            // Chunks other members have count towards their rarity even if
+            // there is no connection to the member
+            if (!j.value().toString().isEmpty()) {
+                swarm->addAvailability(uuid, decodeBitfield(j.value().toString()));
+            }
+
+            // Only one of each pair of receivers connects to the other (the
+            // sender is already connected to all of them)
+            QStringList addresses = device->property("addresses").toStringList();
+            quint16 port = device->property("swarmPort").toInt();
+            if (swarm->isSender() || swarm->peer(uuid) || localUuid > uuid ||
+                    addresses.isEmpty() || !port) {
+                continue;
+            }
+
+            SwarmPeer *peer = new SwarmPeer(new LanTransport(
+                QHostAddress(addresses.first())
+              , port
+#ifdef ENABLE_TLS
+              , QSslConfiguration()
+#endif
+            ), false, uuid);
+            peer->send({
+                { "type", Hello },
+                { "swarm", swarm->id() },
+                { "uuid", localUuid }
+            });
+            swarm->addPeer(peer);
+        }
+    }
+}
+
+void SwarmTransportServer::onSettingsChanged(const QStringList &keys)
+{
+    if (keys.contains(SwarmPort)) {
+        mServer.close();
+        if (!mServer.listen(QHostAddress::Any,
+                mApplication->settingsRegistry()->value(SwarmPort).toInt())) {
+            mApplication->logger()->log(new Message(
+                Message::Error,
+                MessageTag,
+                mServer.errorString()
+            ));
+        }
+    }
+}
+
+void SwarmTransportServer::joinSwarm(SwarmPeer *peer, const QString &id, const QString &uuid)
+{
+    Swarm *swarm = new Swarm(id, uuid);
+    if (id.isEmpty() || !swarm->isValid()) {
+        mApplication->logger()->log(new Message(
+            Message::Error,
+            MessageTag,
+            QString("unable to join swarm %1").arg(id)
+        ));
+        delete swarm;
+        peer->close();
+        peer->deleteLater();
+        return;
+    }
+
+    mApplication->logger()->log(new Message(
+        Message::Info,
+        MessageTag,
+        QString("joining swarm %1 from %2").arg(id).arg(uuid)
+    ));
+
+    // The transport must exist before the sender's chunks arrive
+    SwarmReceiverTransport *transport = new SwarmReceiverTransport(swarm);
+
+    // The swarm is over once the sender closes it or disappears
+    mSwarms.insert(id, swarm);
+    auto leave = [this, swarm]() {
+        if (mSwarms.value(swarm->id()) == swarm) {
+            mSwarms.remove(swarm->id());
+            swarm->deleteLater();
+        }
+    };
+    connect(swarm, &Swarm::messageReceived, this, [swarm, leave](SwarmPeer *peer, const QJsonObject &message) {
+        if (peer->uuid() == swarm->sender() && message.value("type").toString() == Close) {
+            leave();
+        }
+    });
+    connect(swarm, &Swarm::peerRemoved, this, [swarm, leave](const QString &uuid) {
+        if (uuid == swarm->sender()) {
+            leave();
+        }
+    });
+
+    peer->setUuid(uuid);
+    swarm->addPeer(peer);
+
+    emit transportReceived(transport);
+}
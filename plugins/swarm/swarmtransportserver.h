@@ -0,0 +1,100 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SWARMTRANSPORTSERVER_H
+#define SWARMTRANSPORTSERVER_H
+
+#include <QHash>
+#include <QJsonObject>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantMap>
+
+#include <nitroshare/category.h>
+#include <nitroshare/setting.h>
+#include <nitroshare/transportserver.h>
+
+#include "server.h"
+
+class Application;
+class Swarm;
+class SwarmPeer;
+
+/**
+ * @brief Transport server for swarms
+ *
+ * Transports for sending are created by the session the device belongs to.
+ * Connections from other members of a swarm arrive on the swarm port and
+ * members that advertise a swarm through discovery are connected to.
+ */
+class SwarmTransportServer : public TransportServer
+{
+    Q_OBJECT
+
+public:
+
+    explicit SwarmTransportServer(Application *application);
+    virtual ~SwarmTransportServer();
+
+    virtual QString name() const;
+    virtual Transport *createTransport(Device *device);
+
+    /**
+     * @brief Add a swarm that is being sent from this device
+     */
+    void addSwarm(Swarm *swarm);
+
+    /**
+     * @brief Remove a swarm that was being sent from this device
+     */
+    void removeSwarm(Swarm *swarm);
+
+    /**
+     * @brief Retrieve the chunks available for each swarm
+     * @return map of swarm IDs to encoded chunks
+     */
+    QVariantMap advertisement() const;
+
+private slots:
+
+    void onNewSocketDescriptor(qintptr socketDescriptor);
+    void onGreetingReceived(const QJsonObject &message);
+    void onDiscoveryTimeout();
+    void onSettingsChanged(const QStringList &keys);
+
+private:
+
+    void joinSwarm(SwarmPeer *peer, const QString &id, const QString &uuid);
+
+    Application *mApplication;
+
+    Server mServer;
+    QTimer mDiscoveryTimer;
+    QHash<QString, Swarm*> mSwarms;
+
+    Category mSwarmCategory;
+    Setting mSwarmPort;
+};
+
+#endif // SWARMTRANSPORTSERVER_H
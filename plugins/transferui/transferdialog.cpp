@@ -29,6 +29,7 @@
 #include <QItemSelectionModel>
 #include <QModelIndexList>
 #include <QUrl>
+#include <QVariantMap>
 #include <QVBoxLayout>
 
 #include <nitroshare/application.h>
@@ -43,6 +44,7 @@ const QString TransferDirectory = "TransferDirectory";
 TransferDialog::TransferDialog(Application *application)
     : mApplication(application),
       mTableView(new QTableView),
+      mStatisticsLabel(new QLabel),
       mStopButton(new QPushButton(tr("Stop"))),
       mDismissButton(new QPushButton(tr("Dismiss")))
 {
@@ -58,10 +60,15 @@ TransferDialog::TransferDialog(Application *application)
     mTableView->setSelectionMode(QAbstractItemView::SingleSelection);
     mTableView->verticalHeader()->setVisible(false);
 
+    mStatisticsLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    mStatisticsLabel->setWordWrap(true);
+
     connect(&mModel, &TransferProxyModel::dataChanged, this, &TransferDialog::updateButtons);
     connect(&mModel, &TransferProxyModel::rowsInserted, this, &TransferDialog::updateButtons);
     connect(&mModel, &TransferProxyModel::rowsRemoved, this, &TransferDialog::updateButtons);
     connect(mTableView->selectionModel(), &QItemSelectionModel::selectionChanged, this, &TransferDialog::updateButtons);
+    connect(&mModel, &TransferProxyModel::dataChanged, this, &TransferDialog::updateStatistics);
+    connect(mTableView->selectionModel(), &QItemSelectionModel::selectionChanged, this, &TransferDialog::updateStatistics);
 
     connect(mStopButton, &QPushButton::clicked, this, &TransferDialog::onStop);
     connect(mDismissButton, &QPushButton::clicked, this, &TransferDialog::onDismiss);
@@ -84,13 +91,18 @@ TransferDialog::TransferDialog(Application *application)
     vboxLayout->addWidget(openReceivedButton);
     vboxLayout->addStretch(1);
 
+    QVBoxLayout *tableLayout = new QVBoxLayout;
+    tableLayout->addWidget(mTableView);
+    tableLayout->addWidget(mStatisticsLabel);
+
     QHBoxLayout *hboxLayout = new QHBoxLayout;
-    hboxLayout->addWidget(mTableView);
+    hboxLayout->addLayout(tableLayout);
     hboxLayout->addLayout(vboxLayout);
     setLayout(hboxLayout);
 
-    // Update the initial state of the buttons
+    // Update the initial state of the buttons and statistics
     updateButtons();
+    updateStatistics();
 }
 
 void TransferDialog::showEvent(QShowEvent *)
@@ -120,6 +132,44 @@ void TransferDialog::updateButtons()
     mDismissButton->setEnabled(transfer && transfer->isFinished());
 }
 
+void TransferDialog::updateStatistics()
+{
+    QModelIndex index = currentIndex();
+    if (!index.isValid()) {
+        mStatisticsLabel->setText(tr("Select a transfer to view its statistics."));
+        return;
+    }
+
+    Transfer *transfer = index.data(Qt::UserRole).value<Transfer*>();
+    QVariantMap statistics = transfer->statistics();
+    QVariantMap transport = statistics.value("transport").toMap();
+
+    // Times are reported in milliseconds
+    QString text = tr(
+        "Average speed: %1 KB/s, elapsed: %2 ms, packets sent: %3, received: %4\n"
+        "Time waiting on disk: %5 ms, socket: %6 ms, peer: %7 ms, headers: %8 ms"
+    )
+        .arg(transfer->averageSpeed() / 1000)
+        .arg(statistics.value("elapsedTime").toLongLong())
+        .arg(statistics.value("packetsSent").toLongLong())
+        .arg(statistics.value("packetsReceived").toLongLong())
+        .arg(statistics.value("diskTime").toLongLong())
+        .arg(statistics.value("socketTime").toLongLong())
+        .arg(statistics.value("peerTime").toLongLong())
+        .arg(statistics.value("headerTime").toLongLong());
+
+    // Not all transports can report details about the connection
+    if (transport.contains("rtt")) {
+        text += tr("\nRTT: %1 us (+/- %2 us), congestion window: %3, retransmits: %4")
+            .arg(transport.value("rtt").toUInt())
+            .arg(transport.value("rttVariance").toUInt())
+            .arg(transport.value("congestionWindow").toUInt())
+            .arg(transport.value("retransmits").toUInt());
+    }
+
+    mStatisticsLabel->setText(text);
+}
+
 void TransferDialog::onStop()
 {
     QModelIndex index = currentIndex();
@@ -26,6 +26,7 @@
 #define TRANSFERDIALOG_H
 
 #include <QDialog>
+#include <QLabel>
 #include <QPushButton>
 #include <QTableView>
 
@@ -49,6 +50,7 @@ protected:
 private slots:
 
     void updateButtons();
+    void updateStatistics();
 
     void onStop();
     void onDismiss();
@@ -66,6 +68,7 @@ private:
     Application *mApplication;
 
     QTableView *mTableView;
+    QLabel *mStatisticsLabel;
     TransferProxyModel mModel;
 
     QPushButton *mStopButton;
@@ -51,7 +51,7 @@ QVariant TransferProxyModel::data(const QModelIndex &proxyIndex, int role) const
         case SpeedColumn:
             return formatSpeed(transfer->speed());
         case TimeRemainingColumn:
-            return formatTimeRemaining(transfer->speed(), transfer->bytesRemaining());
+            return formatTimeRemaining(transfer->timeRemaining());
         case StatusColumn:
             switch (transfer->state()) {
             case Transfer::Connecting:
@@ -128,17 +128,13 @@ QString TransferProxyModel::formatSpeed(qint64 speed) const
     return tr("%1 %2/s").arg(unitSpeed, 0, 'f', 1).arg(*i);
 }
 
-QString TransferProxyModel::formatTimeRemaining(qint64 speed, qint64 bytesRemaining) const
+QString TransferProxyModel::formatTimeRemaining(qint64 secondsRemaining) const
 {
-    // If the speed is unknown, avoid dividing by zero
-    if (!speed) {
+    // The transfer cannot estimate the time if the speed or size is unknown
+    if (secondsRemaining < 0) {
         return tr("unknown");
     }
 
-    qint64 secondsRemaining = static_cast<qint64>(
-        static_cast<double>(bytesRemaining) / static_cast<double>(speed)
-    );
-
     // Calculate the number of hours, minutes, and seconds remaining
     qint64 hoursRemaining = secondsRemaining / 3600;
     qint64 minutesRemaining = secondsRemaining / 60 - hoursRemaining * 60;
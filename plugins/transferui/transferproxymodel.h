@@ -49,7 +49,7 @@ public:
 private:
 
     QString formatSpeed(qint64 speed) const;
-    QString formatTimeRemaining(qint64 speed, qint64 bytesRemaining) const;
+    QString formatTimeRemaining(qint64 secondsRemaining) const;
 };
 
 #endif // TRANSFERPROXYMODEL_H
@@ -0,0 +1,164 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "congestioncontrol.h"
+
+// Assumed round-trip time before the first sample and the amount of data
+// that may be sent before the first acknowledgement
+const qint64 InitialRtt = 100000;
+const qint64 InitialWindow = 32 * CongestionControl::MaxSegmentSize;
+
+// Smallest window, which allows for delayed acknowledgements
+const qint64 MinWindow = 4 * CongestionControl::MaxSegmentSize;
+
+const qint64 MinRetransmissionTimeout = 200000;
+
+// Gain used while searching for the bandwidth of the path (2/ln 2), which
+// doubles the sending rate each round
+const double StartupGain = 2.885;
+
+// Startup ends once the rate stops growing by 25% for three rounds
+const double FullRateGrowth = 1.25;
+const int FullRateRounds = 3;
+
+// Each round in turn probes for more bandwidth, drains the queue created by
+// doing so and then cruises at the measured rate
+const double CycleGains[] = { 1.25, 0.75, 1, 1, 1, 1, 1, 1 };
+const int CycleLength = sizeof(CycleGains) / sizeof(CycleGains[0]);
+
+// Allow twice the bandwidth-delay product in flight so that delayed and
+// aggregated acknowledgements do not stall the sender
+const double WindowGain = 2;
+
+const int CongestionControl::MaxSegmentSize;
+
+CongestionControl::CongestionControl()
+    : mMode(Startup),
+      mSmoothedRtt(0),
+      mRttVariance(0),
+      mMinRtt(0),
+      mMaxRate(0),
+      mRound(0),
+      mRoundStart(0),
+      mFullRate(0),
+      mFullRounds(0),
+      mCycleIndex(0)
+{
+    for (int i = 0; i < RateRounds; ++i) {
+        mRoundRates[i] = 0;
+    }
+}
+
+void CongestionControl::addRttSample(qint64 rtt)
+{
+    if (rtt <= 0) {
+        return;
+    }
+
+    // Estimators from RFC 6298
+    if (!mSmoothedRtt) {
+        mSmoothedRtt = rtt;
+        mRttVariance = rtt / 2;
+    } else {
+        mRttVariance = (3 * mRttVariance + qAbs(mSmoothedRtt - rtt)) / 4;
+        mSmoothedRtt = (7 * mSmoothedRtt + rtt) / 8;
+    }
+
+    if (!mMinRtt || rtt < mMinRtt) {
+        mMinRtt = rtt;
+    }
+}
+
+void CongestionControl::addRateSample(double rate, qint64 now)
+{
+    // Rounds last for one round-trip time
+    if (now - mRoundStart >= (mMinRtt ? mMinRtt : InitialRtt)) {
+        mRoundStart = now;
+        startRound();
+    }
+
+    double &roundRate = mRoundRates[mRound % RateRounds];
+    if (rate > roundRate) {
+        roundRate = rate;
+        if (rate > mMaxRate) {
+            mMaxRate = rate;
+        }
+    }
+}
+
+double CongestionControl::pacingRate() const
+{
+    double gain = mMode == Startup ? StartupGain : CycleGains[mCycleIndex];
+    if (!mMaxRate) {
+        return gain * InitialWindow * 1000000.0 / (mSmoothedRtt ? mSmoothedRtt : InitialRtt);
+    }
+    return gain * mMaxRate;
+}
+
+qint64 CongestionControl::window() const
+{
+    if (!mMaxRate || !mMinRtt) {
+        return InitialWindow;
+    }
+    double gain = mMode == Startup ? StartupGain : WindowGain;
+    return qMax(MinWindow, static_cast<qint64>(gain * mMaxRate * mMinRtt / 1000000.0));
+}
+
+qint64 CongestionControl::retransmissionTimeout() const
+{
+    if (!mSmoothedRtt) {
+        return 5 * MinRetransmissionTimeout;
+    }
+    return qMax(MinRetransmissionTimeout, mSmoothedRtt + 4 * mRttVariance);
+}
+
+qint64 CongestionControl::reorderingWindow() const
+{
+    return (mMinRtt ? mMinRtt : InitialRtt) / 4;
+}
+
+void CongestionControl::startRound()
+{
+    ++mRound;
+
+    // Forget the oldest round and find the highest rate in the others
+    mRoundRates[mRound % RateRounds] = 0;
+    mMaxRate = 0;
+    for (int i = 0; i < RateRounds; ++i) {
+        if (mRoundRates[i] > mMaxRate) {
+            mMaxRate = mRoundRates[i];
+        }
+    }
+
+    if (mMode == Startup) {
+        if (mMaxRate >= mFullRate * FullRateGrowth) {
+            mFullRate = mMaxRate;
+            mFullRounds = 0;
+        } else if (++mFullRounds >= FullRateRounds) {
+            mMode = ProbeBandwidth;
+        }
+    } else {
+        mCycleIndex = (mCycleIndex + 1) % CycleLength;
+    }
+}
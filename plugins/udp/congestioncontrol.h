@@ -0,0 +1,111 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef CONGESTIONCONTROL_H
+#define CONGESTIONCONTROL_H
+
+#include <QtGlobal>
+
+/**
+ * @brief Determine how quickly data may be sent over a UDP connection
+ *
+ * Rather than treating every lost datagram as a sign of congestion (which
+ * cripples throughput on lossy wireless links), the sending rate is derived
+ * from a model of the path: the highest delivery rate recently measured and
+ * the lowest round-trip time. The sender periodically probes for more
+ * bandwidth and drains any queue it built up while doing so.
+ *
+ * All times are in microseconds and all rates in bytes per second.
+ */
+class CongestionControl
+{
+public:
+
+    /**
+     * @brief Largest amount of data carried by a single datagram
+     */
+    static const int MaxSegmentSize = 1200;
+
+    CongestionControl();
+
+    /**
+     * @brief Record the round-trip time measured for a datagram
+     */
+    void addRttSample(qint64 rtt);
+
+    /**
+     * @brief Record the rate at which data was acknowledged
+     * @param rate delivery rate measured when a datagram was acknowledged
+     * @param now current time
+     */
+    void addRateSample(double rate, qint64 now);
+
+    /**
+     * @brief Retrieve the rate at which datagrams should be sent
+     */
+    double pacingRate() const;
+
+    /**
+     * @brief Retrieve the number of bytes that may be unacknowledged
+     */
+    qint64 window() const;
+
+    /**
+     * @brief Retrieve the time after which an unacknowledged datagram is lost
+     */
+    qint64 retransmissionTimeout() const;
+
+    /**
+     * @brief Retrieve the time a datagram may be reordered before it is lost
+     */
+    qint64 reorderingWindow() const;
+
+private:
+
+    enum Mode {
+        Startup,
+        ProbeBandwidth
+    };
+
+    static const int RateRounds = 10;
+
+    void startRound();
+
+    Mode mMode;
+
+    qint64 mSmoothedRtt;
+    qint64 mRttVariance;
+    qint64 mMinRtt;
+
+    double mRoundRates[RateRounds];
+    double mMaxRate;
+    int mRound;
+    qint64 mRoundStart;
+
+    double mFullRate;
+    int mFullRounds;
+    int mCycleIndex;
+};
+
+#endif // CONGESTIONCONTROL_H
@@ -0,0 +1,100 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cstring>
+
+#include <QByteArray>
+#include <QtEndian>
+
+#include "udpserver.h"
+#include "udptransport.h"
+
+const int SocketBufferSize = 4 * 1024 * 1024;
+
+UdpServer::UdpServer()
+{
+    connect(&mSocket, &QUdpSocket::readyRead, this, &UdpServer::onReadyRead);
+}
+
+bool UdpServer::listen(const QHostAddress &address, quint16 port)
+{
+    if (!mSocket.bind(address, port)) {
+        return false;
+    }
+    mSocket.setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, SocketBufferSize);
+    mSocket.setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, SocketBufferSize);
+    return true;
+}
+
+void UdpServer::close()
+{
+    mSocket.close();
+}
+
+quint16 UdpServer::serverPort() const
+{
+    return mSocket.localPort();
+}
+
+QString UdpServer::errorString() const
+{
+    return mSocket.errorString();
+}
+
+void UdpServer::onReadyRead()
+{
+    while (mSocket.hasPendingDatagrams()) {
+        QByteArray datagram(qMax<qint64>(mSocket.pendingDatagramSize(), 0), 0);
+        QHostAddress address;
+        quint16 port;
+        qint64 size = mSocket.readDatagram(datagram.data(), datagram.size(), &address, &port);
+        if (size < UdpTransport::HeaderSize) {
+            continue;
+        }
+        datagram.resize(size);
+
+        // memcpy must be used in order to avoid alignment issues
+        quint32 connectionId;
+        memcpy(&connectionId, datagram.constData() + 1, sizeof(connectionId));
+        connectionId = qFromLittleEndian(connectionId);
+
+        QString key = QString("%1:%2:%3").arg(address.toString()).arg(port).arg(connectionId);
+        UdpTransport *transport = mTransports.value(key);
+
+        // Only a handshake may create a new connection
+        if (!transport) {
+            if (datagram.at(0) != UdpTransport::Syn) {
+                continue;
+            }
+            transport = new UdpTransport(&mSocket, address, port, connectionId);
+            mTransports.insert(key, transport);
+            connect(transport, &QObject::destroyed, this, [this, key]() {
+                mTransports.remove(key);
+            });
+            emit transportReceived(transport);
+        }
+
+        transport->processDatagram(datagram);
+    }
+}
@@ -0,0 +1,87 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef UDPSERVER_H
+#define UDPSERVER_H
+
+#include <QHash>
+#include <QHostAddress>
+#include <QObject>
+#include <QString>
+#include <QUdpSocket>
+
+class UdpTransport;
+
+/**
+ * @brief Receive incoming UDP connections
+ *
+ * All connections share the server socket and datagrams are passed to the
+ * transport with a matching peer address and connection ID.
+ */
+class UdpServer : public QObject
+{
+    Q_OBJECT
+
+public:
+
+    UdpServer();
+
+    /**
+     * @brief Begin receiving datagrams
+     * @param address address to bind to
+     * @param port port to bind to or 0 to choose one
+     * @return true if the socket was bound
+     */
+    bool listen(const QHostAddress &address, quint16 port = 0);
+
+    /**
+     * @brief Stop receiving datagrams
+     *
+     * Existing connections stop receiving datagrams as well.
+     */
+    void close();
+
+    quint16 serverPort() const;
+    QString errorString() const;
+
+signals:
+
+    /**
+     * @brief Indicate that a new connection was received
+     *
+     * The receiver takes ownership of the transport.
+     */
+    void transportReceived(UdpTransport *transport);
+
+private slots:
+
+    void onReadyRead();
+
+private:
+
+    QUdpSocket mSocket;
+    QHash<QString, UdpTransport*> mTransports;
+};
+
+#endif // UDPSERVER_H
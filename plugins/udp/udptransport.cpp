@@ -0,0 +1,649 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <cstring>
+#include <random>
+
+#include <QUdpSocket>
+#include <QVector>
+#include <QtEndian>
+
+#include <nitroshare/packet.h>
+
+#include "udptransport.h"
+
+// Interval between timer ticks while data is being sent and while idle
+const int TickInterval = 1;
+const int IdleInterval = 1000;
+
+// Times (in microseconds) for retrying the handshake, sending keep-alive
+// acknowledgements and giving up on a silent peer
+const qint64 HandshakeInterval = 500000;
+const int HandshakeAttempts = 10;
+const qint64 KeepAliveInterval = 2000000;
+const qint64 IdleTimeout = 15000000;
+
+// Largest burst of datagrams sent at once (expressed as time at the pacing
+// rate) since the timer cannot fire for every datagram
+const qint64 MaxBurst = 2000;
+
+// Data waiting to be split into datagrams before packetSent() is withheld
+const int SendBufferSize = 1024 * 1024;
+
+// Number of datagrams beyond the next expected one that are accepted
+const quint32 ReceiveWindow = 8192;
+
+// Acknowledge every second datagram, or after a short delay
+const int AckFrequency = 2;
+const qint64 AckDelay = 5000;
+
+const int MaxSackRanges = 32;
+
+const int SocketBufferSize = 4 * 1024 * 1024;
+
+// Data datagrams carry the sequence number and the time they were sent, which
+// the acknowledgement echoes so that the round-trip time can be measured
+const int DataHeaderSize = UdpTransport::HeaderSize + 12;
+
+// Acknowledgements carry the cumulative acknowledgement, window, echoed time
+// and the number of SACK ranges that follow
+const int AckHeaderSize = UdpTransport::HeaderSize + 17;
+
+const int UdpTransport::HeaderSize;
+
+template<typename T>
+static void append(QByteArray &data, T value)
+{
+    value = qToLittleEndian(value);
+    data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+static T read(const char *data)
+{
+    // memcpy must be used in order to avoid alignment issues
+    T value;
+    memcpy(&value, data, sizeof(value));
+    return qFromLittleEndian(value);
+}
+
+UdpTransport::UdpTransport(const QHostAddress &address, quint16 port)
+    : UdpTransport(new QUdpSocket, address, port, std::random_device()(), Connecting)
+{
+    mSocket->setParent(this);
+    mSocket->bind(address.protocol() == QAbstractSocket::IPv6Protocol ?
+        QHostAddress::AnyIPv6 : QHostAddress::AnyIPv4);
+    mSocket->setSocketOption(QAbstractSocket::ReceiveBufferSizeSocketOption, SocketBufferSize);
+    mSocket->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption, SocketBufferSize);
+
+    connect(mSocket, &QUdpSocket::readyRead, this, &UdpTransport::onReadyRead);
+
+    sendDatagram(Syn);
+    mHandshakeAttempts = 1;
+    schedule();
+}
+
+UdpTransport::UdpTransport(QUdpSocket *socket, const QHostAddress &address, quint16 port, quint32 connectionId)
+    : UdpTransport(socket, address, port, connectionId, Connected)
+{
+    sendDatagram(SynAck);
+    schedule();
+}
+
+void UdpTransport::processDatagram(const QByteArray &datagram)
+{
+    if (mState == Closed || datagram.size() < HeaderSize ||
+            read<quint32>(datagram.constData() + 1) != mConnectionId) {
+        return;
+    }
+
+    qint64 time = now();
+    mLastReceived = time;
+
+    switch (static_cast<quint8>(datagram.at(0))) {
+    case Syn:
+        // The peer did not receive the reply to its handshake
+        if (mState != Connecting) {
+            sendDatagram(SynAck);
+        }
+        break;
+    case SynAck:
+        if (mState == Connecting) {
+            mState = Connected;
+            emit connected();
+            schedule();
+        }
+        break;
+    case Data:
+        processData(datagram, time);
+        break;
+    case Ack:
+        processAck(datagram, time);
+        break;
+    case Close:
+        // Both ends close the transport once they are finished with it
+        if (mState == Closing) {
+            shutdown();
+        } else {
+            reportError(tr("connection closed by peer"));
+        }
+        break;
+    }
+}
+
+void UdpTransport::sendPacket(Packet *packet)
+{
+    if (mState == Closing || mState == Closed) {
+        return;
+    }
+
+    PacketStream::encode(mSendBuffer, packet->type(), packet->content());
+
+    // Let the transfer continue while there is room in the buffer
+    if (mSendBuffer.size() - mSendOffset < SendBufferSize) {
+        QMetaObject::invokeMethod(this, "packetSent", Qt::QueuedConnection);
+    } else {
+        mWaitingForSpace = true;
+    }
+
+    schedule();
+}
+
+void UdpTransport::close()
+{
+    switch (mState) {
+    case Connecting:
+        sendDatagram(Close);
+        shutdown();
+        break;
+    case Connected:
+        // The peer is waiting for the last data to be acknowledged
+        if (mAckDeadline) {
+            sendAck();
+        }
+        if (mSendOffset == mSendBuffer.size() && mSegments.isEmpty()) {
+            sendDatagram(Close);
+            shutdown();
+        } else {
+            mState = Closing;
+            schedule();
+        }
+        break;
+    case Closing:
+    case Closed:
+        break;
+    }
+}
+
+void UdpTransport::onReadyRead()
+{
+    while (mState != Closed && mSocket->hasPendingDatagrams()) {
+        QByteArray datagram(qMax<qint64>(mSocket->pendingDatagramSize(), 0), 0);
+        QHostAddress address;
+        quint16 port;
+        qint64 size = mSocket->readDatagram(datagram.data(), datagram.size(), &address, &port);
+        if (size < 0 || port != mPort) {
+            continue;
+        }
+        datagram.resize(size);
+        processDatagram(datagram);
+    }
+}
+
+void UdpTransport::onTimeout()
+{
+    qint64 time = now();
+
+    if (mState == Connecting) {
+        if (time - mLastSent >= HandshakeInterval) {
+            if (mHandshakeAttempts++ >= HandshakeAttempts) {
+                reportError(tr("unable to connect to %1:%2")
+                    .arg(mAddress.toString())
+                    .arg(mPort));
+                return;
+            }
+            sendDatagram(Syn);
+        }
+        return;
+    }
+
+    if (time - mLastReceived >= IdleTimeout) {
+        if (mState == Closing) {
+            shutdown();
+        } else {
+            reportError(tr("connection timed out"));
+        }
+        return;
+    }
+
+    detectLosses(time);
+    sendSegments(time);
+
+    if (mAckDeadline && time >= mAckDeadline) {
+        sendAck();
+    }
+
+    // Once everything was acknowledged, the connection can be closed
+    if (mState == Closing && mSendOffset == mSendBuffer.size() && mSegments.isEmpty()) {
+        sendDatagram(Close);
+        shutdown();
+        return;
+    }
+
+    // Let the peer know that the connection is still alive
+    if (time - mLastSent >= KeepAliveInterval) {
+        sendAck();
+    }
+
+    // Slow down the timer when there is nothing to do
+    bool busy = mSendOffset < mSendBuffer.size() || !mSegments.isEmpty();
+    int interval = busy ? TickInterval : IdleInterval;
+    if (mTimer.interval() != interval) {
+        mTimer.start(interval);
+    }
+}
+
+UdpTransport::UdpTransport(QUdpSocket *socket, const QHostAddress &address, quint16 port, quint32 connectionId, State state)
+    : mSocket(socket),
+      mAddress(address),
+      mPort(port),
+      mConnectionId(connectionId),
+      mState(state),
+      mLastReceived(0),
+      mLastSent(0),
+      mHandshakeAttempts(0),
+      mSendOffset(0),
+      mWaitingForSpace(false),
+      mNextSequence(0),
+      mPeerCumulative(0),
+      mPeerWindow(ReceiveWindow),
+      mInflight(0),
+      mDelivered(0),
+      mDeliveredTime(0),
+      mLatestAckedSent(0),
+      mBudget(0),
+      mLastPaced(0),
+      mReceiveNext(0),
+      mUnacknowledged(0),
+      mAckDeadline(0),
+      mEchoTimestamp(0)
+{
+    connect(&mTimer, &QTimer::timeout, this, &UdpTransport::onTimeout);
+
+    mTimer.setTimerType(Qt::PreciseTimer);
+    mClock.start();
+}
+
+qint64 UdpTransport::now() const
+{
+    return mClock.nsecsElapsed() / 1000;
+}
+
+void UdpTransport::schedule()
+{
+    if (mState != Closed && (!mTimer.isActive() || mTimer.interval() != TickInterval)) {
+        mLastPaced = now();
+        mTimer.start(TickInterval);
+    }
+}
+
+void UdpTransport::sendDatagram(DatagramType type, const QByteArray &payload)
+{
+    QByteArray datagram;
+    datagram.reserve(HeaderSize + payload.size());
+    append<quint8>(datagram, type);
+    append<quint32>(datagram, mConnectionId);
+    datagram.append(payload);
+
+    // Datagrams that cannot be sent are treated as lost
+    mSocket->writeDatagram(datagram, mAddress, mPort);
+    mLastSent = now();
+}
+
+void UdpTransport::sendSegments(qint64 now)
+{
+    if (mState != Connected && mState != Closing) {
+        return;
+    }
+
+    // Accumulate the amount of data that may be sent since the last tick
+    double rate = mCongestion.pacingRate();
+    double burst = qMax(2.0 * CongestionControl::MaxSegmentSize, rate * MaxBurst / 1000000.0);
+    mBudget = qMin(burst, mBudget + rate * (now - mLastPaced) / 1000000.0);
+    mLastPaced = now;
+
+    // The timer sends datagrams in bursts, so allow at least a burst in flight
+    qint64 window = qMax(mCongestion.window(), static_cast<qint64>(burst));
+    while (mBudget > 0 && mInflight < window) {
+        quint32 sequence;
+
+        if (!mLost.empty()) {
+
+            // Lost datagrams are sent again before any new data, unless they
+            // were acknowledged after all
+            sequence = mLost.front();
+            mLost.pop_front();
+            QMap<quint32, Segment>::iterator i = mSegments.find(sequence);
+            if (i == mSegments.end() || !i->lost) {
+                continue;
+            }
+
+        } else if (mSendOffset < mSendBuffer.size() &&
+                mNextSequence - mPeerCumulative < mPeerWindow) {
+
+            int size = qMin(CongestionControl::MaxSegmentSize, mSendBuffer.size() - mSendOffset);
+            sequence = mNextSequence++;
+            mSegments[sequence].data = mSendBuffer.mid(mSendOffset, size);
+            mSendOffset += size;
+
+        } else {
+            break;
+        }
+
+        transmit(sequence, now);
+        mBudget -= DataHeaderSize + mSegments[sequence].data.size();
+    }
+
+    // Reclaim the space used by data that was split into datagrams
+    if (mSendOffset == mSendBuffer.size()) {
+        mSendBuffer.clear();
+        mSendOffset = 0;
+    } else if (mSendOffset >= SendBufferSize) {
+        mSendBuffer.remove(0, mSendOffset);
+        mSendOffset = 0;
+    }
+
+    if (mWaitingForSpace && mSendBuffer.size() - mSendOffset < SendBufferSize) {
+        mWaitingForSpace = false;
+        emit packetSent();
+    }
+}
+
+void UdpTransport::transmit(quint32 sequence, qint64 now)
+{
+    if (!mDeliveredTime) {
+        mDeliveredTime = now;
+    }
+
+    Segment &segment = mSegments[sequence];
+    segment.sentTime = now;
+    segment.delivered = mDelivered;
+    segment.deliveredTime = mDeliveredTime;
+    segment.lost = false;
+
+    mInflight += segment.data.size();
+    mTransmissions.push_back(qMakePair(sequence, now));
+
+    QByteArray payload;
+    payload.reserve(DataHeaderSize - HeaderSize + segment.data.size());
+    append<quint32>(payload, sequence);
+    append<qint64>(payload, now);
+    payload.append(segment.data);
+    sendDatagram(Data, payload);
+}
+
+void UdpTransport::markLost(Segment &segment, quint32 sequence)
+{
+    segment.lost = true;
+    mInflight -= segment.data.size();
+    mLost.push_back(sequence);
+}
+
+void UdpTransport::detectLosses(qint64 now)
+{
+    qint64 timeout = mCongestion.retransmissionTimeout();
+    qint64 reordering = mCongestion.reorderingWindow();
+
+    // Transmissions are in the order they were sent, so only the oldest need
+    // to be checked - a datagram is lost if one sent sufficiently later was
+    // acknowledged or if nothing was acknowledged for too long
+    while (!mTransmissions.empty()) {
+        const QPair<quint32, qint64> &transmission = mTransmissions.front();
+        QMap<quint32, Segment>::iterator i = mSegments.find(transmission.first);
+
+        // Skip datagrams that were acknowledged or sent again since
+        if (i == mSegments.end() || i->lost || i->sentTime != transmission.second) {
+            mTransmissions.pop_front();
+            continue;
+        }
+
+        if (transmission.second + reordering < mLatestAckedSent ||
+                transmission.second + timeout < now) {
+            markLost(i.value(), transmission.first);
+            mTransmissions.pop_front();
+            continue;
+        }
+
+        break;
+    }
+}
+
+void UdpTransport::processData(const QByteArray &datagram, qint64 now)
+{
+    if (datagram.size() < DataHeaderSize) {
+        return;
+    }
+
+    quint32 sequence = read<quint32>(datagram.constData() + HeaderSize);
+    mEchoTimestamp = read<qint64>(datagram.constData() + HeaderSize + 4);
+
+    if (sequence == mReceiveNext) {
+
+        mStream.addData(datagram.mid(DataHeaderSize));
+        ++mReceiveNext;
+
+        // The datagram may have filled a gap
+        QMap<quint32, QByteArray>::iterator i = mOutOfOrder.begin();
+        while (i != mOutOfOrder.end() && i.key() == mReceiveNext) {
+            mStream.addData(i.value());
+            i = mOutOfOrder.erase(i);
+            ++mReceiveNext;
+        }
+
+        // Acknowledge immediately while there are gaps so that the sender
+        // learns about losses quickly
+        if (++mUnacknowledged >= AckFrequency || !mOutOfOrder.isEmpty()) {
+            sendAck();
+        } else if (!mAckDeadline) {
+            mAckDeadline = now + AckDelay;
+            schedule();
+        }
+
+        processBuffer();
+
+    } else {
+
+        // Datagrams before the next one expected were already received (the
+        // acknowledgement was lost) and those too far ahead are dropped
+        if (sequence - mReceiveNext < ReceiveWindow && !mOutOfOrder.contains(sequence)) {
+            mOutOfOrder.insert(sequence, datagram.mid(DataHeaderSize));
+        }
+        sendAck();
+    }
+}
+
+void UdpTransport::processAck(const QByteArray &datagram, qint64 now)
+{
+    if (datagram.size() < AckHeaderSize) {
+        return;
+    }
+
+    const char *data = datagram.constData() + HeaderSize;
+    quint32 cumulative = read<quint32>(data);
+    quint32 window = read<quint32>(data + 4);
+    qint64 echo = read<qint64>(data + 8);
+    int count = static_cast<quint8>(data[16]);
+    if (datagram.size() < AckHeaderSize + count * 8) {
+        return;
+    }
+
+    // Acknowledgements may be reordered as well
+    if (cumulative >= mPeerCumulative) {
+        mPeerCumulative = cumulative;
+        mPeerWindow = window;
+    }
+
+    Segment latest;
+    latest.sentTime = -1;
+
+    QMap<quint32, Segment>::iterator i = mSegments.begin();
+    while (i != mSegments.end() && i.key() < cumulative) {
+        i = acknowledge(i, &latest);
+    }
+
+    const char *ranges = data + 17;
+    for (int j = 0; j < count; ++j) {
+        quint32 start = read<quint32>(ranges + j * 8);
+        quint32 end = read<quint32>(ranges + j * 8 + 4);
+        i = mSegments.lowerBound(start);
+        while (i != mSegments.end() && i.key() < end) {
+            i = acknowledge(i, &latest);
+        }
+    }
+
+    // Keep-alives and duplicates carry no new information
+    if (latest.sentTime < 0) {
+        return;
+    }
+
+    mDeliveredTime = now;
+    if (echo) {
+        mCongestion.addRttSample(now - echo);
+    }
+
+    // The delivery rate is measured over the time between sending the most
+    // recent datagram acknowledged and receiving its acknowledgement
+    qint64 interval = now - latest.deliveredTime;
+    if (interval > 0) {
+        mCongestion.addRateSample((mDelivered - latest.delivered) * 1000000.0 / interval, now);
+    }
+
+    mLatestAckedSent = qMax(mLatestAckedSent, latest.sentTime);
+
+    // Acknowledgements free up the window, so send more data right away
+    detectLosses(now);
+    sendSegments(now);
+    schedule();
+}
+
+QMap<quint32, UdpTransport::Segment>::iterator UdpTransport::acknowledge(
+        QMap<quint32, Segment>::iterator i, Segment *latest)
+{
+    const Segment &segment = i.value();
+    if (!segment.lost) {
+        mInflight -= segment.data.size();
+    }
+    mDelivered += segment.data.size();
+    if (segment.sentTime > latest->sentTime) {
+        *latest = segment;
+    }
+    return mSegments.erase(i);
+}
+
+void UdpTransport::sendAck()
+{
+    QByteArray payload;
+    append<quint32>(payload, mReceiveNext);
+    append<quint32>(payload, ReceiveWindow);
+    append<qint64>(payload, mEchoTimestamp);
+
+    // Describe the datagrams received after the gaps, starting from the
+    // lowest since those are the ones the sender needs to retransmit
+    QVector<QPair<quint32, quint32>> ranges;
+    QMap<quint32, QByteArray>::const_iterator i = mOutOfOrder.constBegin();
+    while (i != mOutOfOrder.constEnd() && ranges.count() < MaxSackRanges - 1) {
+        quint32 start = i.key();
+        quint32 end = start + 1;
+        for (++i; i != mOutOfOrder.constEnd() && i.key() == end; ++i) {
+            ++end;
+        }
+        ranges.append(qMakePair(start, end));
+    }
+
+    // Always include the most recent datagrams so that losses are detected
+    // even when there are more gaps than can be described
+    if (i != mOutOfOrder.constEnd()) {
+        QMap<quint32, QByteArray>::const_iterator j = mOutOfOrder.constEnd();
+        --j;
+        quint32 start = j.key();
+        quint32 end = start + 1;
+        while (j != i) {
+            --j;
+            if (j.key() != start - 1) {
+                break;
+            }
+            start = j.key();
+        }
+        ranges.append(qMakePair(start, end));
+    }
+
+    append<quint8>(payload, ranges.count());
+    foreach (const auto &range, ranges) {
+        append<quint32>(payload, range.first);
+        append<quint32>(payload, range.second);
+    }
+
+    sendDatagram(Ack, payload);
+
+    mUnacknowledged = 0;
+    mAckDeadline = 0;
+}
+
+void UdpTransport::processBuffer()
+{
+    char type;
+    QByteArray data;
+    while (mState != Closed && mStream.readPacket(&type, &data)) {
+        Packet packet(static_cast<Packet::Type>(type), data);
+        emit packetReceived(&packet);
+    }
+
+    if (mState != Closed && mStream.hasError()) {
+        reportError(tr("invalid packet received"));
+    }
+}
+
+void UdpTransport::reportError(const QString &message)
+{
+    shutdown();
+    emit error(message);
+}
+
+void UdpTransport::shutdown()
+{
+    mState = Closed;
+    mTimer.stop();
+
+    // The socket is only owned by the transport for outgoing connections
+    if (mSocket->parent() == this) {
+        mSocket->close();
+    }
+
+    mSendBuffer.clear();
+    mSegments.clear();
+    mTransmissions.clear();
+    mLost.clear();
+    mOutOfOrder.clear();
+    mStream.clear();
+}
@@ -0,0 +1,187 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef UDPTRANSPORT_H
+#define UDPTRANSPORT_H
+
+#include <deque>
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QMap>
+#include <QPair>
+#include <QTimer>
+
+#include <nitroshare/packetstream.h>
+#include <nitroshare/transport.h>
+
+#include "congestioncontrol.h"
+
+class Packet;
+class QUdpSocket;
+
+/**
+ * @brief Reliable transport built on UDP
+ *
+ * Packets are written to a byte stream that is split into numbered datagrams.
+ * The receiver acknowledges datagrams with selective acknowledgements (SACK)
+ * so that only those actually lost are sent again. Datagrams are paced
+ * according to CongestionControl instead of being sent in bursts, which
+ * avoids overflowing router queues and makes random loss much less costly
+ * than it is for TCP on wireless and long-RTT links.
+ *
+ * A connection is identified by the peer address and a random connection ID,
+ * allowing a single server socket to be shared by all incoming connections.
+ */
+class UdpTransport : public Transport
+{
+    Q_OBJECT
+
+public:
+
+    /**
+     * @brief Type of each datagram, stored in its first byte
+     */
+    enum DatagramType {
+        Syn = 1,
+        SynAck,
+        Data,
+        Ack,
+        Close
+    };
+
+    /**
+     * @brief Size of the type and connection ID at the start of each datagram
+     */
+    static const int HeaderSize = 5;
+
+    /**
+     * @brief Create a transport connecting to the specified server
+     */
+    UdpTransport(const QHostAddress &address, quint16 port);
+
+    /**
+     * @brief Create a transport for a connection received by a server
+     * @param socket server socket used for sending datagrams
+     * @param address address of the peer
+     * @param port port of the peer
+     * @param connectionId ID chosen by the peer
+     *
+     * The server must pass each datagram for the connection to
+     * processDatagram().
+     */
+    UdpTransport(QUdpSocket *socket, const QHostAddress &address, quint16 port, quint32 connectionId);
+
+    /**
+     * @brief Process a datagram received from the peer
+     */
+    void processDatagram(const QByteArray &datagram);
+
+    virtual void sendPacket(Packet *packet);
+    virtual void close();
+
+private slots:
+
+    void onReadyRead();
+    void onTimeout();
+
+private:
+
+    enum State {
+        Connecting,
+        Connected,
+        Closing,
+        Closed
+    };
+
+    struct Segment
+    {
+        QByteArray data;
+        qint64 sentTime;
+        qint64 delivered;
+        qint64 deliveredTime;
+        bool lost;
+    };
+
+    UdpTransport(QUdpSocket *socket, const QHostAddress &address, quint16 port, quint32 connectionId, State state);
+
+    qint64 now() const;
+    void schedule();
+
+    void sendDatagram(DatagramType type, const QByteArray &payload = QByteArray());
+    void sendSegments(qint64 now);
+    void transmit(quint32 sequence, qint64 now);
+    void markLost(Segment &segment, quint32 sequence);
+    void detectLosses(qint64 now);
+
+    void processData(const QByteArray &datagram, qint64 now);
+    void processAck(const QByteArray &datagram, qint64 now);
+    QMap<quint32, Segment>::iterator acknowledge(QMap<quint32, Segment>::iterator i, Segment *latest);
+    void sendAck();
+    void processBuffer();
+
+    void reportError(const QString &message);
+    void shutdown();
+
+    QUdpSocket *mSocket;
+    QHostAddress mAddress;
+    quint16 mPort;
+    quint32 mConnectionId;
+    State mState;
+
+    QElapsedTimer mClock;
+    QTimer mTimer;
+    qint64 mLastReceived;
+    qint64 mLastSent;
+    int mHandshakeAttempts;
+
+    // Sending
+    CongestionControl mCongestion;
+    QByteArray mSendBuffer;
+    int mSendOffset;
+    bool mWaitingForSpace;
+    QMap<quint32, Segment> mSegments;
+    std::deque<QPair<quint32, qint64>> mTransmissions;
+    std::deque<quint32> mLost;
+    quint32 mNextSequence;
+    quint32 mPeerCumulative;
+    quint32 mPeerWindow;
+    qint64 mInflight;
+    qint64 mDelivered;
+    qint64 mDeliveredTime;
+    qint64 mLatestAckedSent;
+    double mBudget;
+    qint64 mLastPaced;
+
+    // Receiving
+    quint32 mReceiveNext;
+    QMap<quint32, QByteArray> mOutOfOrder;
+    int mUnacknowledged;
+    qint64 mAckDeadline;
+    qint64 mEchoTimestamp;
+    PacketStream mStream;
+};
+
+#endif // UDPTRANSPORT_H
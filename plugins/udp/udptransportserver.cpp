@@ -0,0 +1,129 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include <QHostAddress>
+
+#include <nitroshare/application.h>
+#include <nitroshare/category.h>
+#include <nitroshare/device.h>
+#include <nitroshare/logger.h>
+#include <nitroshare/message.h>
+#include <nitroshare/settingsregistry.h>
+
+#include "udptransport.h"
+#include "udptransportserver.h"
+
+const QString MessageTag = "udptransportserver";
+
+const QString UdpCategory = "udp";
+const QString UdpPort = "UdpPort";
+
+UdpTransportServer::UdpTransportServer(Application *application)
+    : mApplication(application)
+    , mUdpCategory({
+          { Category::NameKey, UdpCategory },
+          { Category::TitleKey, tr("UDP") }
+      })
+    , mUdpPort({
+          { Setting::TypeKey, Setting::Integer },
+          { Setting::NameKey, UdpPort },
+          { Setting::TitleKey, tr("UDP Transfer Port") },
+          { Setting::CategoryKey, UdpCategory },
+          { Setting::DefaultValueKey, 40819 }
+      })
+{
+    connect(&mServer, &UdpServer::transportReceived, this, &UdpTransportServer::onTransportReceived);
+    connect(mApplication->settingsRegistry(), &SettingsRegistry::settingsChanged, this, &UdpTransportServer::onSettingsChanged);
+
+    mApplication->settingsRegistry()->addCategory(&mUdpCategory);
+    mApplication->settingsRegistry()->addSetting(&mUdpPort);
+
+    // Trigger loading the initial settings
+    onSettingsChanged({ UdpPort });
+}
+
+UdpTransportServer::~UdpTransportServer()
+{
+    mApplication->settingsRegistry()->removeSetting(&mUdpPort);
+    mApplication->settingsRegistry()->removeCategory(&mUdpCategory);
+}
+
+QString UdpTransportServer::name() const
+{
+    return "udp";
+}
+
+Transport *UdpTransportServer::createTransport(Device *device)
+{
+    QStringList addresses = device->property("addresses").toStringList();
+    quint16 port = device->property("port").toInt();
+
+    // Verify that valid data was passed
+    if (!addresses.count() || !port) {
+        mApplication->logger()->log(new Message(
+            Message::Error,
+            MessageTag,
+            QString("invalid addresses or port: %1, %2")
+                .arg(addresses.join(", "))
+                .arg(port)
+        ));
+        return nullptr;
+    }
+
+    mApplication->logger()->log(new Message(
+        Message::Info,
+        MessageTag,
+        QString("creating transport for %1:%2")
+            .arg(addresses.at(0))
+            .arg(port)
+    ));
+
+    return new UdpTransport(QHostAddress(addresses.at(0)), port);
+}
+
+void UdpTransportServer::onTransportReceived(UdpTransport *transport)
+{
+    mApplication->logger()->log(new Message(
+        Message::Debug,
+        MessageTag,
+        "incoming connection received"
+    ));
+
+    emit transportReceived(transport);
+}
+
+void UdpTransportServer::onSettingsChanged(const QStringList &keys)
+{
+    if (keys.contains(UdpPort)) {
+        mServer.close();
+        if (!mServer.listen(QHostAddress::Any,
+                mApplication->settingsRegistry()->value(UdpPort).toInt())) {
+            mApplication->logger()->log(new Message(
+                Message::Error,
+                MessageTag,
+                mServer.errorString()
+            ));
+        }
+    }
+}
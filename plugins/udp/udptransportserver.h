@@ -0,0 +1,72 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2018 Nathan Osman
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef UDPTRANSPORTSERVER_H
+#define UDPTRANSPORTSERVER_H
+
+#include <QStringList>
+
+#include <nitroshare/category.h>
+#include <nitroshare/setting.h>
+#include <nitroshare/transportserver.h>
+
+#include "udpserver.h"
+
+class Application;
+class UdpTransport;
+
+/**
+ * @brief Transport server for connections over UDP
+ *
+ * Devices use this transport when their transportName() is "udp" and they
+ * provide "addresses" and "port" properties, just like the LAN transport.
+ */
+class UdpTransportServer : public TransportServer
+{
+    Q_OBJECT
+
+public:
+
+    explicit UdpTransportServer(Application *application);
+    virtual ~UdpTransportServer();
+
+    virtual QString name() const;
+    virtual Transport *createTransport(Device *device);
+
+private slots:
+
+    void onTransportReceived(UdpTransport *transport);
+    void onSettingsChanged(const QStringList &keys);
+
+private:
+
+    Application *mApplication;
+
+    UdpServer mServer;
+
+    Category mUdpCategory;
+    Setting mUdpPort;
+};
+
+#endif // UDPTRANSPORTSERVER_H